@@ -151,8 +151,11 @@ namespace pika::detail {
     threads::detail::mask_cref_type affinity_data::get_pu_mask(
         threads::detail::topology const& topo, std::size_t global_thread_num) const
     {
-        // --pika:bind=none disables all affinity
-        if (threads::detail::test(no_affinity_, global_thread_num))
+        // --pika:bind=none disables all affinity. no_affinity_ is indexed by
+        // processing unit, which differs from the thread number when
+        // processing units are oversubscribed.
+        std::size_t pu_num = get_pu_num(global_thread_num);
+        if (threads::detail::test(no_affinity_, pu_num))
         {
             static threads::detail::mask_type m = threads::detail::mask_type();
             threads::detail::resize(m, threads::detail::hardware_concurrency());
@@ -164,7 +167,6 @@ namespace pika::detail {
             return affinity_masks_[global_thread_num];
 
         // otherwise return mask based on affinity domain
-        std::size_t pu_num = get_pu_num(global_thread_num);
         if (0 == std::string("pu").find(affinity_domain_))
         {
             // The affinity domain is 'processing unit', just convert the
@@ -35,6 +35,19 @@ namespace pika::execution::experimental {
     {
     } get_hint{};
 
+    // with_bulk_chunk_size sets the number of consecutive iterations that a
+    // bulk operation hands to a worker thread at a time. A chunk size of zero
+    // lets the scheduler choose the chunk size.
+    inline constexpr struct with_bulk_chunk_size_t final
+      : pika::functional::detail::tag<with_bulk_chunk_size_t>
+    {
+    } with_bulk_chunk_size{};
+
+    inline constexpr struct get_bulk_chunk_size_t final
+      : pika::functional::detail::tag<get_bulk_chunk_size_t>
+    {
+    } get_bulk_chunk_size{};
+
     // with_annotation uses tag_fallback as the base class to allow an
     // out-of-line fallback implementation for executors that don't support
     // annotations by themselves. See annotating_executor.
@@ -14,6 +14,7 @@
 #include <pika/synchronization/condition_variable.hpp>
 #include <pika/synchronization/mutex.hpp>
 
+#include <algorithm>
 #include <array>
 #include <atomic>
 #include <cstddef>
@@ -47,9 +48,16 @@ namespace pika::mpi::experimental {
         /// When a user first initiates an MPI call, a request is generated
         /// and a callback associated with it. We place these on a (lock-free) queue
         /// to avoid taking a lock on every invocation of an MPI function.
-        /// When a thread polls for MPI completions, it moves the request_callback(s)
-        /// into a vector that is passed to the mpi test function
+        /// Each thread enqueues through its own producer token, which gives it
+        /// a private sub-queue so that threads registering requests do not
+        /// contend with each other. When a thread polls for MPI completions,
+        /// it moves the request_callback(s) in batches into a vector that is
+        /// passed to the mpi test function
         using request_callback_queue_type = concurrency::detail::ConcurrentQueue<request_callback>;
+        using request_callback_producer_token_type = concurrency::detail::ProducerToken;
+
+        /// The number of requests moved from the queue to the vector at a time
+        constexpr std::size_t request_callback_batch_size = 64;
 
         // -----------------------------------------------------------------
         /// Spinlock is used as it can be called by OS threads or pika tasks
@@ -61,6 +69,12 @@ namespace pika::mpi::experimental {
         /// thread trying to send more data
         std::uint32_t get_throttling_default();
 
+        // -----------------------------------------------------------------
+        /// Queries an environment variable to get/override the largest number
+        /// of calls to the polling function that may be skipped when polling
+        /// finds no completed requests
+        std::uint32_t get_max_polling_interval_default();
+
         // -----------------------------------------------------------------
         /// To enable independent throttling of sends/receives/other
         /// we maintina several "queues" which have their own condition
@@ -111,9 +125,21 @@ namespace pika::mpi::experimental {
             // mutex needed to protect mpi request vector, note that the
             // mpi poll function usually takes place inside the main scheduling loop
             // though poll may also be called directly by a user task.
-            // we use a spinlock for both cases
+            // we use a spinlock for both cases. The poll function only ever
+            // tries to take the lock, so pollers never wait for each other
             mutex_type polling_vector_mtx_;
 
+            // Polling adapts to the number of outstanding requests: after
+            // polls that found no completed requests, up to polling_interval_
+            // calls to the polling function are skipped. The interval grows
+            // while no requests complete, but not beyond
+            // max_polling_interval_ divided by the number of outstanding
+            // requests, and drops to 1 when requests complete or new requests
+            // arrive. Protected by polling_vector_mtx_
+            std::uint32_t polling_interval_ = 1;
+            std::uint32_t polls_skipped_ = 0;
+            std::uint32_t max_polling_interval_{get_max_polling_interval_default()};
+
             // streams used when throttling mpi traffic,
             std::array<mpi_stream, max_mpi_streams> default_queues_;
         };
@@ -198,6 +224,22 @@ namespace pika::mpi::experimental {
             return def;
         }
 
+        // -----------------------------------------------------------------
+        std::uint32_t get_max_polling_interval_default()
+        {
+            std::uint32_t def = 16;
+            char* env = std::getenv("PIKA_MPI_MAX_POLLING_INTERVAL");
+            if (env)
+            {
+                def = std::atoi(env);
+                // badly formed env var, or polling on every call requested
+                if (def == 0)
+                    def = 1;
+                mpi_debug.debug(debug::detail::str<>("polling"), "max interval", def);
+            }
+            return def;
+        }
+
         // -----------------------------------------------------------------
         /// used internally to add an MPI_Request to the lockfree queue
         /// that will be used by the polling routines to check when requests
@@ -213,7 +255,11 @@ namespace pika::mpi::experimental {
                     debug::detail::dec<2>(std::uint32_t(req_callback.index_)));
             }
 
-            mpi_data_.request_callback_queue_.enqueue(PIKA_MOVE(req_callback));
+            // The token is created the first time a thread registers a
+            // request and reused for all requests of that thread
+            thread_local request_callback_producer_token_type token(
+                mpi_data_.request_callback_queue_);
+            mpi_data_.request_callback_queue_.enqueue(token, PIKA_MOVE(req_callback));
             ++mpi_data_.request_queue_size_;
             ++mpi_data_.default_queues_[static_cast<uint32_t>(stream)].in_flight_;
             ++mpi_data_.in_flight_;
@@ -298,20 +344,11 @@ namespace pika::mpi::experimental {
         }
 
         /// Remove all entries in request and callback vectors that are invalid
-        /// Ideally, would use a zip iterator to do both using remove_if
-        void compact_vectors()
+        /// Ideally, would use a zip iterator to do both using remove_if.
+        /// pos is the index of the first invalid entry
+        void compact_vectors(size_t pos)
         {
             size_t const size = detail::mpi_data_.request_vector_.size();
-            size_t pos = size;
-            // find index of first NULL request
-            for (size_t i = 0; i < size; ++i)
-            {
-                if (detail::mpi_data_.request_vector_[i] == MPI_REQUEST_NULL)
-                {
-                    pos = i;
-                    break;
-                }
-            }
             // move all non NULL requests/callbacks towards beginning of vector.
             for (size_t i = pos + 1; i < size; ++i)
             {
@@ -353,6 +390,17 @@ namespace pika::mpi::experimental {
                 return polling_status::idle;
             }
 
+            // Skip this poll if the previous polls found no completed
+            // requests, unless new requests have been queued
+            bool const requests_queued =
+                detail::mpi_data_.request_queue_size_.load(std::memory_order_relaxed) != 0;
+            if (!requests_queued &&
+                ++detail::mpi_data_.polls_skipped_ < detail::mpi_data_.polling_interval_)
+            {
+                return polling_status::busy;
+            }
+            detail::mpi_data_.polls_skipped_ = 0;
+
             if constexpr (mpi_debug.is_enabled())
             {
                 // for debugging, create a timer
@@ -362,19 +410,24 @@ namespace pika::mpi::experimental {
                 mpi_debug.timed(poll_deb, detail::mpi_data_);
             }
 
-            // Before moving requests from the queue to the vector
-            compact_vectors();
-
             // Move requests in the queue (that have not yet been polled for)
-            // into the polling vector ...
+            // into the polling vector in batches ...
             // Number in_flight does not change during this section as one
             // is moved off the queue and into the vector
-
-            detail::request_callback req_callback;
-            while (detail::mpi_data_.request_callback_queue_.try_dequeue(req_callback))
+            if (requests_queued)
             {
-                --detail::mpi_data_.request_queue_size_;
-                add_to_request_callback_vector(PIKA_MOVE(req_callback));
+                std::array<detail::request_callback, detail::request_callback_batch_size> batch;
+                while (std::size_t const count =
+                           detail::mpi_data_.request_callback_queue_.try_dequeue_bulk(
+                               batch.begin(), batch.size()))
+                {
+                    detail::mpi_data_.request_queue_size_.fetch_sub(
+                        static_cast<std::uint32_t>(count), std::memory_order_relaxed);
+                    for (std::size_t i = 0; i != count; ++i)
+                    {
+                        add_to_request_callback_vector(PIKA_MOVE(batch[i]));
+                    }
+                }
             }
 
             int outcount = 0;
@@ -398,10 +451,18 @@ namespace pika::mpi::experimental {
                     debug::detail::dec<4>(outcount));
             }
 
+            // MPI_UNDEFINED means there were no active requests
+            if (outcount == MPI_UNDEFINED)
+            {
+                outcount = 0;
+            }
+
             // for each completed request
+            size_t first_completed = static_cast<size_t>(vsize);
             for (int i = 0; i < outcount; ++i)
             {
                 size_t index = detail::mpi_data_.indices_vector_[i];
+                first_completed = (std::min)(first_completed, index);
 
                 if constexpr (mpi_debug.is_enabled())
                 {
@@ -414,7 +475,6 @@ namespace pika::mpi::experimental {
                 detail::mpi_stream* stream = std::get<1>(detail::mpi_data_.callback_vector_[index]);
                 size_t inflight = --stream->in_flight_;
                 --detail::mpi_data_.in_flight_;
-                --detail::mpi_data_.active_request_vector_size_;
 
                 // Invoke the callback with the status of the completed
                 // operation (status of the request is forwarded to MPI_Testany)
@@ -436,6 +496,32 @@ namespace pika::mpi::experimental {
                 }
             }
 
+            std::uint32_t const completed = static_cast<std::uint32_t>(outcount);
+            std::uint32_t const active = detail::mpi_data_.active_request_vector_size_.fetch_sub(
+                                             completed, std::memory_order_relaxed) -
+                completed;
+
+            // Remove completed requests from the vectors, starting at the
+            // first one. Only needed when requests completed
+            if (outcount > 0)
+            {
+                compact_vectors(first_completed);
+            }
+
+            // Poll on every call while requests complete or arrive. Otherwise
+            // back off, the more outstanding requests the less
+            if (outcount > 0 || requests_queued || active == 0)
+            {
+                detail::mpi_data_.polling_interval_ = 1;
+            }
+            else
+            {
+                std::uint32_t const max_interval =
+                    (std::max)(detail::mpi_data_.max_polling_interval_ / active, std::uint32_t(1));
+                detail::mpi_data_.polling_interval_ =
+                    (std::min)(detail::mpi_data_.polling_interval_ * 2, max_interval);
+            }
+
             return detail::mpi_data_.in_flight_.load(std::memory_order_relaxed) == 0 ?
                 polling_status::idle :
                 polling_status::busy;
@@ -0,0 +1,203 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark measures the latency and the message rate of MPI
+// communication through transform_mpi. It is meant to be run with an even
+// number of ranks on a single node, e.g. with mpirun -n 2. Ranks are paired
+// up as 0-1, 2-3, etc.
+//
+// The ping-pong test sends a message back and forth between the ranks of each
+// pair and reports the one-way latency. The message rate test has the even
+// ranks of each pair post a window of sends at once, which the odd ranks
+// receive with a window of receives, and reports the number of messages per
+// second summed over all pairs. Both tests are run for each of the given
+// message sizes.
+
+#include <pika/execution.hpp>
+#include <pika/init.hpp>
+#include <pika/modules/timing.hpp>
+#include <pika/mpi.hpp>
+
+#include <fmt/ostream.h>
+#include <fmt/printf.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mpi.h>
+#include <utility>
+#include <vector>
+
+namespace ex = pika::execution::experimental;
+namespace mpi = pika::mpi::experimental;
+namespace tt = pika::this_thread::experimental;
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+///////////////////////////////////////////////////////////////////////////////
+auto send(char* buffer, int size, int peer, int tag)
+{
+    return ex::just(buffer, size, MPI_CHAR, peer, tag, MPI_COMM_WORLD) |
+        mpi::transform_mpi(MPI_Isend, mpi::stream_type::send);
+}
+
+auto recv(char* buffer, int size, int peer, int tag)
+{
+    return ex::just(buffer, size, MPI_CHAR, peer, tag, MPI_COMM_WORLD) |
+        mpi::transform_mpi(MPI_Irecv, mpi::stream_type::receive);
+}
+
+// Returns the one-way latency in microseconds
+double ping_pong(int rank, int peer, int size, std::uint64_t iterations)
+{
+    std::vector<char> buffer(size);
+    bool const ping = rank % 2 == 0;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    pika::chrono::detail::high_resolution_timer timer;
+
+    for (std::uint64_t i = 0; i != iterations; ++i)
+    {
+        if (ping)
+        {
+            tt::sync_wait(send(buffer.data(), size, peer, 0));
+            tt::sync_wait(recv(buffer.data(), size, peer, 0));
+        }
+        else
+        {
+            tt::sync_wait(recv(buffer.data(), size, peer, 0));
+            tt::sync_wait(send(buffer.data(), size, peer, 0));
+        }
+    }
+
+    return timer.elapsed() / static_cast<double>(2 * iterations) * 1e6;
+}
+
+// Returns the number of messages per second sent by this rank
+double message_rate(int rank, int peer, int size, int window, std::uint64_t iterations)
+{
+    std::vector<char> buffer(static_cast<std::size_t>(size) * window);
+    char ack = 0;
+    bool const sender = rank % 2 == 0;
+
+    MPI_Barrier(MPI_COMM_WORLD);
+    pika::chrono::detail::high_resolution_timer timer;
+
+    for (std::uint64_t i = 0; i != iterations; ++i)
+    {
+        if (sender)
+        {
+            std::vector<decltype(send(nullptr, 0, 0, 0))> sends;
+            sends.reserve(window);
+            for (int j = 0; j != window; ++j)
+            {
+                sends.push_back(send(buffer.data() + j * size, size, peer, j));
+            }
+            tt::sync_wait(ex::when_all_vector(std::move(sends)));
+            tt::sync_wait(recv(&ack, 1, peer, window));
+        }
+        else
+        {
+            std::vector<decltype(recv(nullptr, 0, 0, 0))> recvs;
+            recvs.reserve(window);
+            for (int j = 0; j != window; ++j)
+            {
+                recvs.push_back(recv(buffer.data() + j * size, size, peer, j));
+            }
+            tt::sync_wait(ex::when_all_vector(std::move(recvs)));
+            tt::sync_wait(send(&ack, 1, peer, window));
+        }
+    }
+
+    double const elapsed = timer.elapsed();
+    return sender ? static_cast<double>(window * iterations) / elapsed : 0.0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int pika_main(variables_map& vm)
+{
+    std::uint64_t const iterations = vm["iterations"].as<std::uint64_t>();
+    int const window = vm["window"].as<int>();
+
+    int rank = 0;
+    int num_ranks = 0;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &num_ranks);
+
+    if (num_ranks < 2 || num_ranks % 2 != 0)
+    {
+        if (rank == 0)
+        {
+            std::cerr << "mpi_ping_pong: requires an even number of ranks\n";
+        }
+        return pika::finalize();
+    }
+    int const peer = rank ^ 1;
+
+    {
+        // this needs to scope all uses of transform_mpi
+        mpi::enable_user_polling enable_polling;
+
+        if (rank == 0 && !vm.count("no-header"))
+        {
+            std::cout << "ranks,threads,message size [B],window,iterations,latency [us],"
+                         "message rate [msg/s]\n";
+        }
+
+        for (int size : vm["sizes"].as<std::vector<int>>())
+        {
+            double const latency = ping_pong(rank, peer, size, iterations);
+            double const rate = message_rate(rank, peer, size, window, iterations);
+
+            double total_rate = 0.0;
+            MPI_Reduce(&rate, &total_rate, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+            if (rank == 0)
+            {
+                fmt::print(std::cout, "{},{},{},{},{},{:.3f},{:.0f}\n", num_ranks,
+                    pika::get_num_worker_threads(), size, window, iterations, latency,
+                    total_rate);
+            }
+        }
+    }
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    int provided = MPI_THREAD_MULTIPLE;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_MULTIPLE, &provided);
+    if (provided != MPI_THREAD_MULTIPLE)
+    {
+        std::cerr << "mpi_ping_pong: MPI does not provide MPI_THREAD_MULTIPLE\n";
+    }
+
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("iterations", value<std::uint64_t>()->default_value(10000),
+         "number of round trips or windows per message size")
+        ("window", value<int>()->default_value(64),
+         "number of messages in flight at once in the message rate test")
+        ("sizes", value<std::vector<int>>()->multitoken()->default_value(
+             std::vector<int>{8, 1024, 65536}, "8 1024 65536"),
+         "message sizes in bytes to benchmark")
+        ("no-header", "do not print out the csv header row");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    int const result = pika::init(pika_main, argc, argv, init_args);
+
+    MPI_Finalize();
+
+    return result;
+}
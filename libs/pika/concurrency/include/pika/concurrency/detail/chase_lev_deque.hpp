@@ -0,0 +1,200 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/assert.hpp>
+#include <pika/concurrency/cache_line_data.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace pika::concurrency::detail {
+    /// \brief A work-stealing deque with a single owner and multiple thieves.
+    ///
+    /// Implements the dynamic circular work-stealing deque of Chase and Lev
+    /// ("Dynamic Circular Work-Stealing Deque", SPAA 2005) with the memory
+    /// orderings of Lê et al. ("Correct and Efficient Work-Stealing for Weak
+    /// Memory Models", PPoPP 2013). Only the owner may call push_bottom and
+    /// pop_bottom, while any thread may call steal. The owner operations only
+    /// need an atomic read-modify-write operation when racing with a thief for
+    /// the last element. The buffer grows when it is full. Buffers that have
+    /// been replaced are kept alive until the deque is destroyed since thieves
+    /// may still be reading from them.
+    template <typename T>
+    class chase_lev_deque
+    {
+        static_assert(std::is_trivially_copyable_v<T>,
+            "chase_lev_deque requires trivially copyable elements to be able to store them in "
+            "atomics");
+
+        class buffer
+        {
+        public:
+            explicit buffer(std::int64_t capacity)
+              : mask_(capacity - 1)
+              , data_(new std::atomic<T>[std::size_t(capacity)])
+            {
+                PIKA_ASSERT(capacity > 0 && (capacity & mask_) == 0);
+            }
+
+            std::int64_t capacity() const noexcept { return mask_ + 1; }
+
+            T load(std::int64_t i) const noexcept
+            {
+                return data_[i & mask_].load(std::memory_order_relaxed);
+            }
+
+            void store(std::int64_t i, T val) noexcept
+            {
+                data_[i & mask_].store(val, std::memory_order_relaxed);
+            }
+
+            // Returns a new buffer with twice the capacity containing the
+            // elements in [top, bottom)
+            std::unique_ptr<buffer> grow(std::int64_t top, std::int64_t bottom) const
+            {
+                auto new_buffer = std::make_unique<buffer>(2 * capacity());
+                for (std::int64_t i = top; i != bottom; ++i)
+                {
+                    new_buffer->store(i, load(i));
+                }
+                return new_buffer;
+            }
+
+        private:
+            std::int64_t mask_;
+            std::unique_ptr<std::atomic<T>[]> data_;
+        };
+
+        static std::int64_t round_up_capacity(std::size_t initial_size) noexcept
+        {
+            std::int64_t capacity = 16;
+            while (capacity < std::int64_t(initial_size))
+            {
+                capacity *= 2;
+            }
+            return capacity;
+        }
+
+    public:
+        explicit chase_lev_deque(std::size_t initial_size = 0)
+        {
+            top_.data_.store(0, std::memory_order_relaxed);
+            bottom_.data_.store(0, std::memory_order_relaxed);
+            buffers_.push_back(std::make_unique<buffer>(round_up_capacity(initial_size)));
+            buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+        }
+
+        chase_lev_deque(chase_lev_deque const&) = delete;
+        chase_lev_deque(chase_lev_deque&&) = delete;
+        chase_lev_deque& operator=(chase_lev_deque const&) = delete;
+        chase_lev_deque& operator=(chase_lev_deque&&) = delete;
+
+        /// Push an element to the bottom of the deque. May only be called by
+        /// the owner.
+        void push_bottom(T val)
+        {
+            std::int64_t const b = bottom_.data_.load(std::memory_order_relaxed);
+            std::int64_t const t = top_.data_.load(std::memory_order_acquire);
+            buffer* a = buffer_.load(std::memory_order_relaxed);
+
+            if (b - t > a->capacity() - 1)
+            {
+                buffers_.push_back(a->grow(t, b));
+                a = buffers_.back().get();
+                buffer_.store(a, std::memory_order_release);
+            }
+
+            a->store(b, val);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom_.data_.store(b + 1, std::memory_order_relaxed);
+        }
+
+        /// Pop an element from the bottom of the deque. May only be called by
+        /// the owner. Returns false if the deque is empty.
+        bool pop_bottom(T& val) noexcept
+        {
+            std::int64_t const b = bottom_.data_.load(std::memory_order_relaxed) - 1;
+            buffer* a = buffer_.load(std::memory_order_relaxed);
+            bottom_.data_.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t t = top_.data_.load(std::memory_order_relaxed);
+
+            if (t > b)
+            {
+                // The deque is empty
+                bottom_.data_.store(b + 1, std::memory_order_relaxed);
+                return false;
+            }
+
+            val = a->load(b);
+            if (t == b)
+            {
+                // This is the last element, race with thieves for it
+                bool const success = top_.data_.compare_exchange_strong(
+                    t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+                bottom_.data_.store(b + 1, std::memory_order_relaxed);
+                return success;
+            }
+
+            return true;
+        }
+
+        /// Steal an element from the top of the deque. May be called by any
+        /// thread. Returns false if the deque is empty or if another thread
+        /// took the element first.
+        bool steal(T& val) noexcept
+        {
+            std::int64_t t = top_.data_.load(std::memory_order_acquire);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            std::int64_t const b = bottom_.data_.load(std::memory_order_acquire);
+
+            if (t >= b)
+            {
+                return false;
+            }
+
+            buffer* a = buffer_.load(std::memory_order_acquire);
+            T const result = a->load(t);
+            if (!top_.data_.compare_exchange_strong(
+                    t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            {
+                return false;
+            }
+
+            val = result;
+            return true;
+        }
+
+        bool empty() const noexcept
+        {
+            std::int64_t const b = bottom_.data_.load(std::memory_order_relaxed);
+            std::int64_t const t = top_.data_.load(std::memory_order_relaxed);
+            return b <= t;
+        }
+
+        std::size_t size() const noexcept
+        {
+            std::int64_t const b = bottom_.data_.load(std::memory_order_relaxed);
+            std::int64_t const t = top_.data_.load(std::memory_order_relaxed);
+            return b > t ? std::size_t(b - t) : 0;
+        }
+
+    private:
+        cache_line_data<std::atomic<std::int64_t>> top_;
+        cache_line_data<std::atomic<std::int64_t>> bottom_;
+        std::atomic<buffer*> buffer_{nullptr};
+
+        // Owns the current buffer and all buffers that have been replaced.
+        // Only modified by the owner.
+        std::vector<std::unique_ptr<buffer>> buffers_;
+    };
+}    // namespace pika::concurrency::detail
@@ -0,0 +1,141 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+#include <pika/assert.hpp>
+#include <pika/concurrency/cache_line_data.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+
+namespace pika::concurrency::detail {
+    /// \brief A bounded, lock-free ring buffer with a single producer and a
+    /// single consumer.
+    ///
+    /// Only one thread may call push at a time, and only one thread may call
+    /// pop and pop_n at a time. The producer and the consumer each keep a
+    /// cached copy of the other side's index so that the shared indices are
+    /// only read when the buffer looks full or empty. The capacity is rounded
+    /// up to a power of two.
+    template <typename T>
+    class spsc_ring_buffer
+    {
+        static_assert(std::is_default_constructible_v<T> && std::is_move_assignable_v<T>,
+            "spsc_ring_buffer requires default constructible and move assignable elements");
+
+        static std::size_t round_up_capacity(std::size_t capacity) noexcept
+        {
+            std::size_t rounded = 2;
+            while (rounded < capacity)
+            {
+                rounded *= 2;
+            }
+            return rounded;
+        }
+
+        // The index written by one side together with the cached copy of the
+        // index written by the other side. Only the owning side accesses the
+        // cached copy.
+        struct index
+        {
+            std::atomic<std::size_t> value{0};
+            std::size_t cached_other = 0;
+        };
+
+    public:
+        explicit spsc_ring_buffer(std::size_t capacity = 1024)
+          : mask_(round_up_capacity(capacity) - 1)
+          , data_(new T[mask_ + 1])
+        {
+        }
+
+        spsc_ring_buffer(spsc_ring_buffer const&) = delete;
+        spsc_ring_buffer& operator=(spsc_ring_buffer const&) = delete;
+
+        std::size_t capacity() const noexcept { return mask_ + 1; }
+
+        // Appends val to the buffer. Returns false and leaves val untouched if
+        // the buffer is full. Must only be called by the producer.
+        template <typename U>
+        bool push(U&& val)
+        {
+            std::size_t const tail = tail_.data_.value.load(std::memory_order_relaxed);
+            if (tail - tail_.data_.cached_other == capacity())
+            {
+                tail_.data_.cached_other = head_.data_.value.load(std::memory_order_acquire);
+                if (tail - tail_.data_.cached_other == capacity())
+                {
+                    return false;
+                }
+            }
+
+            data_[tail & mask_] = PIKA_FORWARD(U, val);
+            tail_.data_.value.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Removes the oldest element from the buffer and stores it in val.
+        // Returns false if the buffer is empty. Must only be called by the
+        // consumer.
+        bool pop(T& val)
+        {
+            return pop_n(&val, 1) != 0;
+        }
+
+        // Removes up to n of the oldest elements from the buffer and moves
+        // them to out. Returns the number of elements removed. Must only be
+        // called by the consumer.
+        std::size_t pop_n(T* out, std::size_t n)
+        {
+            std::size_t const head = head_.data_.value.load(std::memory_order_relaxed);
+            if (head_.data_.cached_other - head < n)
+            {
+                head_.data_.cached_other = tail_.data_.value.load(std::memory_order_acquire);
+            }
+
+            std::size_t const available = head_.data_.cached_other - head;
+            if (available < n)
+            {
+                n = available;
+            }
+
+            for (std::size_t i = 0; i != n; ++i)
+            {
+                out[i] = PIKA_MOVE(data_[(head + i) & mask_]);
+            }
+
+            if (n != 0)
+            {
+                head_.data_.value.store(head + n, std::memory_order_release);
+            }
+            return n;
+        }
+
+        // The number of elements in the buffer. The result is only exact if
+        // neither the producer nor the consumer is active.
+        std::size_t size() const noexcept
+        {
+            std::size_t const head = head_.data_.value.load(std::memory_order_acquire);
+            std::size_t const tail = tail_.data_.value.load(std::memory_order_acquire);
+            return tail - head;
+        }
+
+        bool empty() const noexcept
+        {
+            return size() == 0;
+        }
+
+    private:
+        std::size_t const mask_;
+        std::unique_ptr<T[]> data_;
+        cache_line_data<index> head_;
+        cache_line_data<index> tail_;
+    };
+}    // namespace pika::concurrency::detail
@@ -0,0 +1,160 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#include <pika/concurrency/detail/chase_lev_deque.hpp>
+#include <pika/testing.hpp>
+
+#include <pika/modules/program_options.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using deque = pika::concurrency::detail::chase_lev_deque<std::uint64_t>;
+
+std::uint64_t thieves = 3;
+std::uint64_t items = 500000;
+
+void test_single_thread()
+{
+    deque d;
+
+    std::uint64_t val = 0;
+    PIKA_TEST(d.empty());
+    PIKA_TEST(!d.pop_bottom(val));
+    PIKA_TEST(!d.steal(val));
+
+    // Push enough elements to force the buffer to grow a few times
+    for (std::uint64_t i = 0; i != 1000; ++i)
+    {
+        d.push_bottom(i);
+    }
+    PIKA_TEST_EQ(d.size(), std::size_t(1000));
+
+    // The owner pops in LIFO order, thieves steal in FIFO order
+    PIKA_TEST(d.pop_bottom(val));
+    PIKA_TEST_EQ(val, std::uint64_t(999));
+    PIKA_TEST(d.steal(val));
+    PIKA_TEST_EQ(val, std::uint64_t(0));
+
+    for (std::uint64_t i = 998; i != 0; --i)
+    {
+        PIKA_TEST(d.pop_bottom(val));
+        PIKA_TEST_EQ(val, i);
+    }
+
+    PIKA_TEST(d.empty());
+    PIKA_TEST(!d.pop_bottom(val));
+    PIKA_TEST(!d.steal(val));
+}
+
+void test_concurrent_steal()
+{
+    deque d;
+
+    // Every item has to be taken exactly once, either by the owner or by one
+    // of the thieves
+    std::vector<std::atomic<std::uint32_t>> taken(items);
+    std::atomic<bool> done{false};
+
+    auto thief = [&]() {
+        std::uint64_t val = 0;
+        while (!done.load(std::memory_order_acquire) || !d.empty())
+        {
+            if (d.steal(val))
+            {
+                ++taken[val];
+            }
+        }
+    };
+
+    std::vector<std::thread> threads;
+    for (std::uint64_t i = 0; i != thieves; ++i)
+    {
+        threads.emplace_back(thief);
+    }
+
+    // The owner alternates between pushing a few items and popping some of
+    // them to exercise the race for the last element
+    std::uint64_t val = 0;
+    for (std::uint64_t i = 0; i != items; ++i)
+    {
+        d.push_bottom(i);
+        if (i % 3 == 0 && d.pop_bottom(val))
+        {
+            ++taken[val];
+        }
+    }
+
+    while (d.pop_bottom(val))
+    {
+        ++taken[val];
+    }
+
+    done.store(true, std::memory_order_release);
+    for (auto& t : threads)
+    {
+        t.join();
+    }
+
+    std::uint64_t missing = 0;
+    std::uint64_t duplicate = 0;
+    for (auto const& t : taken)
+    {
+        std::uint32_t const count = t.load();
+        if (count == 0)
+            ++missing;
+        else if (count > 1)
+            ++duplicate;
+    }
+
+    PIKA_TEST_EQ(missing, std::uint64_t(0));
+    PIKA_TEST_EQ(duplicate, std::uint64_t(0));
+}
+
+int main(int argc, char** argv)
+{
+    using pika::program_options::command_line_parser;
+    using pika::program_options::notify;
+    using pika::program_options::options_description;
+    using pika::program_options::store;
+    using pika::program_options::value;
+    using pika::program_options::variables_map;
+
+    variables_map vm;
+
+    options_description desc_cmdline("Usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    desc_cmdline.add_options()
+        ("help,h", "print out program usage (this message)")
+        ("thieves,t", value<std::uint64_t>(&thieves)->default_value(3),
+         "the number of threads stealing from the deque")
+        ("items,i", value<std::uint64_t>(&items)->default_value(500000),
+         "the number of items pushed by the owner")
+    ;
+    // clang-format on
+
+    store(command_line_parser(argc, argv).options(desc_cmdline).allow_unregistered().run(), vm);
+
+    notify(vm);
+
+    // print help screen
+    if (vm.count("help"))
+    {
+        std::cout << desc_cmdline;
+        return 0;
+    }
+
+    test_single_thread();
+    test_concurrent_steal();
+
+    return pika::detail::report_errors();
+}
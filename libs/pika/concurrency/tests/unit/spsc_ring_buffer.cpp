@@ -0,0 +1,131 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#include <pika/concurrency/detail/spsc_ring_buffer.hpp>
+#include <pika/testing.hpp>
+
+#include <pika/modules/program_options.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using ring_buffer = pika::concurrency::detail::spsc_ring_buffer<std::uint64_t>;
+
+std::uint64_t items = 1000000;
+
+void test_single_thread()
+{
+    ring_buffer r(10);
+    PIKA_TEST_EQ(r.capacity(), std::size_t(16));
+
+    std::uint64_t val = 0;
+    PIKA_TEST(r.empty());
+    PIKA_TEST(!r.pop(val));
+
+    for (std::uint64_t i = 0; i != 16; ++i)
+    {
+        PIKA_TEST(r.push(i));
+    }
+    PIKA_TEST(!r.push(std::uint64_t(16)));
+    PIKA_TEST_EQ(r.size(), std::size_t(16));
+
+    PIKA_TEST(r.pop(val));
+    PIKA_TEST_EQ(val, std::uint64_t(0));
+    PIKA_TEST(r.push(std::uint64_t(16)));
+
+    // Elements are removed in FIFO order, also across the end of the buffer
+    std::uint64_t out[32];
+    PIKA_TEST_EQ(r.pop_n(out, 32), std::size_t(16));
+    for (std::uint64_t i = 0; i != 16; ++i)
+    {
+        PIKA_TEST_EQ(out[i], i + 1);
+    }
+
+    PIKA_TEST(r.empty());
+    PIKA_TEST_EQ(r.pop_n(out, 32), std::size_t(0));
+}
+
+void test_concurrent()
+{
+    ring_buffer r(64);
+
+    std::thread producer([&]() {
+        for (std::uint64_t i = 0; i != items; ++i)
+        {
+            while (!r.push(i))
+            {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    // The consumer has to see every item exactly once and in order
+    std::uint64_t expected = 0;
+    std::uint64_t out_of_order = 0;
+    std::vector<std::uint64_t> out(16);
+    while (expected != items)
+    {
+        std::size_t const n = r.pop_n(out.data(), out.size());
+        if (n == 0)
+        {
+            std::this_thread::yield();
+        }
+        for (std::size_t i = 0; i != n; ++i)
+        {
+            if (out[i] != expected++)
+            {
+                ++out_of_order;
+            }
+        }
+    }
+
+    producer.join();
+
+    PIKA_TEST_EQ(out_of_order, std::uint64_t(0));
+    PIKA_TEST(r.empty());
+}
+
+int main(int argc, char** argv)
+{
+    using pika::program_options::command_line_parser;
+    using pika::program_options::notify;
+    using pika::program_options::options_description;
+    using pika::program_options::store;
+    using pika::program_options::value;
+    using pika::program_options::variables_map;
+
+    variables_map vm;
+
+    options_description desc_cmdline("Usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    desc_cmdline.add_options()
+        ("help,h", "print out program usage (this message)")
+        ("items,i", value<std::uint64_t>(&items)->default_value(1000000),
+         "the number of items pushed by the producer")
+    ;
+    // clang-format on
+
+    store(command_line_parser(argc, argv).options(desc_cmdline).allow_unregistered().run(), vm);
+
+    notify(vm);
+
+    // print help screen
+    if (vm.count("help"))
+    {
+        std::cout << desc_cmdline;
+        return 0;
+    }
+
+    test_single_thread();
+    test_concurrent();
+
+    return pika::detail::report_errors();
+}
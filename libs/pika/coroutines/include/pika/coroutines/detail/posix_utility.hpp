@@ -50,6 +50,8 @@
 # include <stdexcept>
 
 # if defined(_POSIX_MAPPED_FILES) && _POSIX_MAPPED_FILES > 0
+#  include <pika/coroutines/detail/stack_arena.hpp>
+
 #  include <errno.h>
 #  include <sys/mman.h>
 #  include <sys/param.h>
@@ -77,6 +79,16 @@ namespace pika::threads::coroutines::detail::posix {
 
     inline void* alloc_stack(std::size_t size)
     {
+        if (stack_arena_params.enabled)
+        {
+            // Fall back to a separate mapping if the stack size can't be
+            // handled by the arena
+            if (void* stack = arena_alloc_stack(size))
+            {
+                return stack;
+            }
+        }
+
         void* real_stack = ::mmap(nullptr, size + EXEC_PAGESIZE, PROT_EXEC | PROT_READ | PROT_WRITE,
 #  if defined(__APPLE__)
             MAP_PRIVATE | MAP_ANON | MAP_NORESERVE,
@@ -142,6 +154,11 @@ namespace pika::threads::coroutines::detail::posix {
 
     inline void free_stack(void* stack, std::size_t size)
     {
+        if (stack_arena_params.enabled && arena_free_stack(stack, size))
+        {
+            return;
+        }
+
 #  if defined(PIKA_HAVE_THREAD_GUARD_PAGE)
         if (use_guard_pages)
         {
@@ -0,0 +1,70 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * Arena based stack allocation for stackful coroutines.
+ *
+ * Instead of mapping every stack separately, stacks are carved out of large
+ * arenas. Arenas are mapped by the thread that needs a stack, i.e. usually the
+ * worker thread that creates the coroutine, and on Linux the memory policy of
+ * the arena is set to prefer the NUMA node of that thread (mbind).
+ * Freed stacks are kept on a free list of the calling thread. Stacks exceeding
+ * the per-thread cache size, and all cached stacks of exiting threads, are
+ * handed to a lock-free pool shared by all threads.
+ */
+namespace pika::threads::coroutines::detail::posix {
+    enum class stack_arena_huge_pages : int
+    {
+        // Use the default page size.
+        none = 0,
+        // Ask for transparent huge pages using madvise(MADV_HUGEPAGE).
+        transparent = 1,
+        // Map arenas from the explicit huge page pool (MAP_HUGETLB), falling
+        // back to transparent huge pages if the pool is exhausted. Guard pages
+        // can not be set up in explicit huge pages.
+        explicit_ = 2,
+    };
+
+    struct stack_arena_parameters
+    {
+        bool enabled = false;
+        stack_arena_huge_pages huge_pages = stack_arena_huge_pages::none;
+        // Minimum size of a single arena in bytes.
+        std::size_t arena_size = std::size_t(16) * 1024 * 1024;
+        // Maximum number of free stacks per size class kept by each thread.
+        std::size_t cache_size = 256;
+    };
+
+    // The stack arena is configured once during runtime initialization, from
+    // the pika.stacks configuration section.
+    PIKA_EXPORT extern stack_arena_parameters stack_arena_params;
+
+    struct stack_arena_statistics
+    {
+        std::uint64_t arenas_mapped = 0;
+        std::uint64_t bytes_mapped = 0;
+        std::uint64_t stacks_carved = 0;
+        std::uint64_t shared_pool_hits = 0;
+    };
+
+    PIKA_EXPORT stack_arena_statistics get_stack_arena_statistics();
+
+    // Returns a stack of the given size, or nullptr if the stack can not be
+    // handled by the arena (too many distinct stack sizes are in use, or the
+    // current thread is exiting and no shared stack is available).
+    PIKA_EXPORT void* arena_alloc_stack(std::size_t size);
+
+    // Returns true if the stack has been returned to the arena, false if it
+    // was not allocated by arena_alloc_stack.
+    PIKA_EXPORT bool arena_free_stack(void* stack, std::size_t size) noexcept;
+}    // namespace pika::threads::coroutines::detail::posix
@@ -0,0 +1,480 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#if defined(__linux) || defined(linux) || defined(__linux__) || defined(__FreeBSD__) ||            \
+    defined(__APPLE__)
+# include <pika/coroutines/detail/posix_utility.hpp>
+# include <pika/coroutines/detail/stack_arena.hpp>
+
+# if defined(PIKA_HAVE_THREAD_STACK_MMAP) && defined(_POSIX_MAPPED_FILES) && _POSIX_MAPPED_FILES > 0
+#  include <boost/lockfree/detail/tagged_ptr.hpp>
+
+#  include <array>
+#  include <atomic>
+#  include <cerrno>
+#  include <climits>
+#  include <cstddef>
+#  include <cstdint>
+#  include <stdexcept>
+
+#  if defined(__linux__)
+#   include <linux/mempolicy.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#  endif
+# endif
+
+namespace pika::threads::coroutines::detail::posix {
+    PIKA_EXPORT stack_arena_parameters stack_arena_params{};
+
+# if defined(PIKA_HAVE_THREAD_STACK_MMAP) && defined(_POSIX_MAPPED_FILES) && _POSIX_MAPPED_FILES > 0
+    namespace {
+        // Stack sizes are configured at startup, normally there are at most
+        // four distinct sizes (small, medium, large, and huge).
+        constexpr std::size_t max_size_classes = 8;
+        constexpr std::size_t huge_page_size = std::size_t(2) * 1024 * 1024;
+
+        constexpr std::size_t round_up(std::size_t n, std::size_t multiple) noexcept
+        {
+            return (n + multiple - 1) / multiple * multiple;
+        }
+
+        // Free stacks are chained through the last word of their usable range.
+        // The topmost page of a stack is always resident since the context of
+        // the coroutine is initialized there.
+        void*& next_free_stack(void* stack, std::size_t size) noexcept
+        {
+            return *reinterpret_cast<void**>(static_cast<char*>(stack) + size - sizeof(void*));
+        }
+
+        struct statistics
+        {
+            std::atomic<std::uint64_t> arenas_mapped{0};
+            std::atomic<std::uint64_t> bytes_mapped{0};
+            std::atomic<std::uint64_t> stacks_carved{0};
+            std::atomic<std::uint64_t> shared_pool_hits{0};
+        };
+
+        // Only used to give free stacks a distinct pointer type
+        struct free_stack;
+        using tagged_stack_ptr = boost::lockfree::detail::tagged_ptr<free_stack>;
+
+        // Free stacks shared by all threads, kept in a lock-free (Treiber)
+        // stack. The stacks are chained like the free stacks of a thread,
+        // pushing and popping never allocates. The tag of the head is
+        // incremented by every pop to prevent ABA problems.
+        struct shared_pool
+        {
+            void push(void* stack) noexcept
+            {
+                std::size_t const stack_size = size.load(std::memory_order_relaxed);
+                tagged_stack_ptr old_head = head.load(std::memory_order_relaxed);
+                tagged_stack_ptr new_head;
+                do
+                {
+                    next_free_stack(stack, stack_size) = old_head.get_ptr();
+                    new_head = tagged_stack_ptr(static_cast<free_stack*>(stack), old_head.get_tag());
+                } while (!head.compare_exchange_weak(
+                    old_head, new_head, std::memory_order_release, std::memory_order_relaxed));
+            }
+
+            void* pop() noexcept
+            {
+                std::size_t const stack_size = size.load(std::memory_order_relaxed);
+                tagged_stack_ptr old_head = head.load(std::memory_order_acquire);
+                while (old_head.get_ptr() != nullptr)
+                {
+                    // The stack may have been popped and reused by another
+                    // thread in the meantime. Arenas are never unmapped, so
+                    // reading the link is safe, and the changed tag makes
+                    // the exchange fail in that case.
+                    auto* next = static_cast<free_stack*>(
+                        next_free_stack(old_head.get_ptr(), stack_size));
+                    tagged_stack_ptr const new_head(next, old_head.get_next_tag());
+                    if (head.compare_exchange_weak(old_head, new_head, std::memory_order_acquire,
+                            std::memory_order_acquire))
+                    {
+                        return old_head.get_ptr();
+                    }
+                }
+                return nullptr;
+            }
+
+            // 0 while the pool is not associated with a stack size yet
+            std::atomic<std::size_t> size{0};
+            std::atomic<tagged_stack_ptr> head{tagged_stack_ptr(nullptr)};
+        };
+
+        struct shared_pools
+        {
+            std::array<shared_pool, max_size_classes> pools;
+            statistics stats;
+        };
+
+        // The shared pools are intentionally never destroyed, stacks may be
+        // freed from static destructors.
+        shared_pools& get_shared_pools()
+        {
+            static shared_pools* pools = new shared_pools();
+            return *pools;
+        }
+
+        // Returns the index of the size class for the given size, registering
+        // a new size class if necessary. Returns max_size_classes if all size
+        // classes are taken.
+        std::size_t get_size_class(std::size_t size, bool create) noexcept
+        {
+            auto& pools = get_shared_pools().pools;
+            for (std::size_t i = 0; i != max_size_classes; ++i)
+            {
+                std::size_t current = pools[i].size.load(std::memory_order_acquire);
+                if (current == size)
+                {
+                    return i;
+                }
+
+                if (current == 0)
+                {
+                    if (!create)
+                    {
+                        return max_size_classes;
+                    }
+
+                    if (pools[i].size.compare_exchange_strong(
+                            current, size, std::memory_order_acq_rel) ||
+                        current == size)
+                    {
+                        return i;
+                    }
+                }
+            }
+            return max_size_classes;
+        }
+
+        bool use_arena_guard_pages() noexcept
+        {
+#  if defined(PIKA_HAVE_THREAD_GUARD_PAGE)
+            return use_guard_pages;
+#  else
+            return false;
+#  endif
+        }
+
+        // Set the memory policy of the arena to prefer the NUMA node of the
+        // calling thread. The pages are then allocated there even if a stack
+        // is first touched by a thread on another node, e.g. after it has
+        // been handed out by the shared pool. Failures are ignored, the pages
+        // are then placed by the default first-touch policy.
+        void bind_arena_to_current_node(char* arena, std::size_t length) noexcept
+        {
+#  if defined(__linux__) && defined(SYS_mbind) && defined(SYS_getcpu)
+            unsigned cpu = 0;
+            unsigned node = 0;
+            if (::syscall(SYS_getcpu, &cpu, &node, nullptr) != 0)
+            {
+                return;
+            }
+
+            constexpr std::size_t bits_per_word = sizeof(unsigned long) * CHAR_BIT;
+            std::array<unsigned long, 16> nodemask{};
+            if (node >= nodemask.size() * bits_per_word)
+            {
+                return;
+            }
+            nodemask[node / bits_per_word] = 1ul << (node % bits_per_word);
+
+            ::syscall(SYS_mbind, arena, length, MPOL_PREFERRED, nodemask.data(),
+                nodemask.size() * bits_per_word + 1, 0);
+#  else
+            (void) arena;
+            (void) length;
+#  endif
+        }
+
+        // Map a new arena of at least the given length. Sets hugetlb to true
+        // if the arena was taken from the explicit huge page pool.
+        char* map_arena(std::size_t& length, bool& hugetlb)
+        {
+            auto const huge_pages = stack_arena_params.huge_pages;
+            hugetlb = false;
+
+            if (huge_pages != stack_arena_huge_pages::none)
+            {
+                length = round_up(length, huge_page_size);
+            }
+
+#  if defined(MAP_HUGETLB)
+            if (huge_pages == stack_arena_huge_pages::explicit_)
+            {
+                void* arena = ::mmap(nullptr, length, PROT_EXEC | PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE | MAP_HUGETLB, -1, 0);
+                if (arena != MAP_FAILED)
+                {
+                    hugetlb = true;
+                    bind_arena_to_current_node(static_cast<char*>(arena), length);
+                    return static_cast<char*>(arena);
+                }
+            }
+#  endif
+
+            // Over-allocate to be able to align the arena to the huge page size
+            std::size_t const alignment = huge_pages != stack_arena_huge_pages::none ?
+                huge_page_size :
+                static_cast<std::size_t>(EXEC_PAGESIZE);
+            std::size_t const mapped_length =
+                length + alignment - static_cast<std::size_t>(EXEC_PAGESIZE);
+
+            void* mapped = ::mmap(nullptr, mapped_length, PROT_EXEC | PROT_READ | PROT_WRITE,
+#  if defined(__APPLE__)
+                MAP_PRIVATE | MAP_ANON | MAP_NORESERVE,
+#  elif defined(__FreeBSD__)
+                MAP_PRIVATE | MAP_ANON,
+#  else
+                MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE,
+#  endif
+                -1, 0);
+
+            if (mapped == MAP_FAILED)
+            {
+                throw std::runtime_error("mmap() failed to allocate thread stack arena");
+            }
+
+            char* begin = static_cast<char*>(mapped);
+            char* arena = reinterpret_cast<char*>(
+                round_up(reinterpret_cast<std::uintptr_t>(begin), alignment));
+            char* end = begin + mapped_length;
+
+            // Give back the parts which were only needed for aligning the arena
+            if (arena != begin)
+            {
+                ::munmap(begin, static_cast<std::size_t>(arena - begin));
+            }
+            if (arena + length != end)
+            {
+                ::munmap(arena + length, static_cast<std::size_t>(end - (arena + length)));
+            }
+
+#  if defined(MADV_HUGEPAGE)
+            if (huge_pages != stack_arena_huge_pages::none)
+            {
+                ::madvise(arena, length, MADV_HUGEPAGE);
+            }
+#  endif
+            bind_arena_to_current_node(arena, length);
+            return arena;
+        }
+
+        // Set when the cache of the current thread has been destroyed.
+        // Stacks freed later during the exit of the thread go to the shared
+        // pools. The flag is trivially destructible and can be read until
+        // the thread is gone.
+        thread_local bool thread_cache_destroyed = false;
+
+        struct thread_cache
+        {
+            struct size_class
+            {
+                void* free_list = nullptr;
+                std::size_t free_count = 0;
+
+                // The part of the current arena which has not been handed out
+                char* arena_next = nullptr;
+                char* arena_end = nullptr;
+                bool arena_hugetlb = false;
+            };
+
+            ~thread_cache()
+            {
+                thread_cache_destroyed = true;
+
+                // Make all stacks owned by this thread available to other
+                // threads, including the unused part of the current arenas
+                auto& pools = get_shared_pools().pools;
+                for (std::size_t i = 0; i != max_size_classes; ++i)
+                {
+                    size_class& c = classes[i];
+                    std::size_t const size = pools[i].size.load(std::memory_order_acquire);
+
+                    while (c.free_list != nullptr)
+                    {
+                        void* stack = c.free_list;
+                        c.free_list = next_free_stack(stack, size);
+                        pools[i].push(stack);
+                    }
+
+                    while (void* stack = carve(c, size))
+                    {
+                        pools[i].push(stack);
+                    }
+                }
+            }
+
+            static std::size_t slot_size(std::size_t size) noexcept
+            {
+                return use_arena_guard_pages() ? size + EXEC_PAGESIZE : size;
+            }
+
+            // Take the next stack from the current arena of the size class,
+            // returns nullptr if the arena is exhausted
+            static void* carve(size_class& c, std::size_t size) noexcept
+            {
+                std::size_t const slot = slot_size(size);
+                if (c.arena_next == nullptr ||
+                    static_cast<std::size_t>(c.arena_end - c.arena_next) < slot)
+                {
+                    return nullptr;
+                }
+
+                char* stack = c.arena_next;
+                c.arena_next += slot;
+
+                if (slot != size)
+                {
+                    // Add a guard page below the stack. Explicit huge pages
+                    // can't be protected with a smaller granularity.
+                    if (!c.arena_hugetlb)
+                    {
+                        ::mprotect(stack, EXEC_PAGESIZE, PROT_NONE);
+                    }
+                    stack += EXEC_PAGESIZE;
+                }
+
+                get_shared_pools().stats.stacks_carved.fetch_add(1, std::memory_order_relaxed);
+                return stack;
+            }
+
+            void* allocate(std::size_t index, std::size_t size)
+            {
+                size_class& c = classes[index];
+
+                // Fast path: reuse a stack previously freed on this thread
+                if (c.free_list != nullptr)
+                {
+                    void* stack = c.free_list;
+                    c.free_list = next_free_stack(stack, size);
+                    --c.free_count;
+                    return stack;
+                }
+
+                auto& pools = get_shared_pools();
+                if (void* stack = pools.pools[index].pop())
+                {
+                    pools.stats.shared_pool_hits.fetch_add(1, std::memory_order_relaxed);
+                    return stack;
+                }
+
+                if (void* carved = carve(c, size))
+                {
+                    return carved;
+                }
+
+                // Map a new arena, the remainder of the current one (less than
+                // a single stack) is abandoned
+                std::size_t length = stack_arena_params.arena_size;
+                length = (length < slot_size(size)) ? slot_size(size) : length;
+                c.arena_next = map_arena(length, c.arena_hugetlb);
+                c.arena_end = c.arena_next + length;
+
+                pools.stats.arenas_mapped.fetch_add(1, std::memory_order_relaxed);
+                pools.stats.bytes_mapped.fetch_add(length, std::memory_order_relaxed);
+
+                return carve(c, size);
+            }
+
+            void deallocate(std::size_t index, void* stack, std::size_t size) noexcept
+            {
+                size_class& c = classes[index];
+                if (c.free_count >= stack_arena_params.cache_size)
+                {
+                    get_shared_pools().pools[index].push(stack);
+                    return;
+                }
+
+                next_free_stack(stack, size) = c.free_list;
+                c.free_list = stack;
+                ++c.free_count;
+            }
+
+            std::array<size_class, max_size_classes> classes;
+        };
+
+        // Returns nullptr once the cache of the current thread has been
+        // destroyed
+        thread_cache* get_thread_cache() noexcept
+        {
+            if (thread_cache_destroyed)
+            {
+                return nullptr;
+            }
+
+            static thread_local thread_cache cache;
+            return &cache;
+        }
+    }    // namespace
+
+    stack_arena_statistics get_stack_arena_statistics()
+    {
+        auto const& stats = get_shared_pools().stats;
+        stack_arena_statistics result;
+        result.arenas_mapped = stats.arenas_mapped.load(std::memory_order_relaxed);
+        result.bytes_mapped = stats.bytes_mapped.load(std::memory_order_relaxed);
+        result.stacks_carved = stats.stacks_carved.load(std::memory_order_relaxed);
+        result.shared_pool_hits = stats.shared_pool_hits.load(std::memory_order_relaxed);
+        return result;
+    }
+
+    void* arena_alloc_stack(std::size_t size)
+    {
+        std::size_t const index = get_size_class(size, true);
+        if (index == max_size_classes)
+        {
+            return nullptr;
+        }
+
+        if (thread_cache* cache = get_thread_cache())
+        {
+            return cache->allocate(index, size);
+        }
+        return get_shared_pools().pools[index].pop();
+    }
+
+    bool arena_free_stack(void* stack, std::size_t size) noexcept
+    {
+        std::size_t const index = get_size_class(size, false);
+        if (index == max_size_classes)
+        {
+            return false;
+        }
+
+        if (thread_cache* cache = get_thread_cache())
+        {
+            cache->deallocate(index, stack, size);
+        }
+        else
+        {
+            get_shared_pools().pools[index].push(stack);
+        }
+        return true;
+    }
+# else
+    stack_arena_statistics get_stack_arena_statistics()
+    {
+        return {};
+    }
+
+    void* arena_alloc_stack(std::size_t)
+    {
+        return nullptr;
+    }
+
+    bool arena_free_stack(void*, std::size_t) noexcept
+    {
+        return false;
+    }
+# endif
+}    // namespace pika::threads::coroutines::detail::posix
+#endif
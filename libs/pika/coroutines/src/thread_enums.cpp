@@ -12,6 +12,7 @@
 #include <pika/coroutines/thread_enums.hpp>
 
 #include <cstddef>
+#include <ostream>
 
 namespace pika::threads::detail {
     namespace strings {
@@ -0,0 +1,79 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This test spawns threads of all stack sizes with coroutine stacks allocated
+// from stack arenas and checks that the stacks are usable and recycled.
+
+#include <pika/coroutines/detail/stack_arena.hpp>
+#include <pika/execution.hpp>
+#include <pika/init.hpp>
+#include <pika/testing.hpp>
+#include <pika/thread.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ex = pika::execution::experimental;
+namespace tt = pika::this_thread::experimental;
+namespace posix = pika::threads::coroutines::detail::posix;
+
+constexpr std::size_t num_tasks = 1000;
+
+void touch_stack()
+{
+    // Use a part of the stack to make sure it is mapped and writable
+    char buffer[2048];
+    std::memset(buffer, static_cast<int>(pika::get_worker_thread_num()), sizeof(buffer));
+    PIKA_TEST_EQ(buffer[0], buffer[sizeof(buffer) - 1]);
+}
+
+int pika_main()
+{
+    PIKA_TEST(posix::stack_arena_params.enabled);
+    PIKA_TEST(posix::get_stack_arena_statistics().arenas_mapped > 0);
+
+    constexpr std::array<pika::execution::thread_stacksize, 4> stacksizes{
+        {pika::execution::thread_stacksize::small_, pika::execution::thread_stacksize::medium,
+            pika::execution::thread_stacksize::large, pika::execution::thread_stacksize::huge}};
+
+    for (int round = 0; round != 3; ++round)
+    {
+        for (auto const stacksize : stacksizes)
+        {
+            auto sched = ex::with_stacksize(ex::thread_pool_scheduler{}, stacksize);
+
+            std::vector<ex::unique_any_sender<>> senders;
+            senders.reserve(num_tasks);
+            for (std::size_t i = 0; i != num_tasks; ++i)
+            {
+                senders.emplace_back(ex::schedule(sched) | ex::then(&touch_stack));
+            }
+            tt::sync_wait(ex::when_all_vector(std::move(senders)));
+        }
+    }
+
+    auto const stats = posix::get_stack_arena_statistics();
+    PIKA_TEST(stats.bytes_mapped >= stats.stacks_carved * std::size_t(PIKA_SMALL_STACK_SIZE));
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    // Use small arenas to make sure that more than one arena is needed
+    std::vector<std::string> const cfg = {"pika.stacks.use_arena=1",
+        "pika.stacks.arena_size=0x100000", "pika.stacks.arena_cache_size=16"};
+
+    pika::init_params init_args;
+    init_args.cfg = cfg;
+
+    PIKA_TEST_EQ(pika::init(pika_main, argc, argv, init_args), 0);
+    return 0;
+}
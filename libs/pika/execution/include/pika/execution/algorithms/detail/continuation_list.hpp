@@ -0,0 +1,114 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+
+#include <atomic>
+
+namespace pika::execution::experimental::detail {
+    /// A node of a continuation_list. Operation states waiting for a shared
+    /// state to be completed derive from continuation_node, so that adding a
+    /// continuation to the list never allocates. complete is called exactly
+    /// once with the node when the list is completed. The node may be
+    /// destroyed by complete.
+    struct continuation_node
+    {
+        using complete_function_type = void (*)(continuation_node*) noexcept;
+
+        explicit continuation_node(complete_function_type complete) noexcept
+          : complete(complete)
+        {
+        }
+
+        continuation_node* next = nullptr;
+        complete_function_type complete;
+    };
+
+    /// An intrusive lock-free list of continuations which are run once when
+    /// the list is completed. Continuations are pushed onto the head of a
+    /// singly linked list with a compare-and-swap. Completing the list
+    /// exchanges the head with a marker, after which no more continuations
+    /// can be pushed, and runs the continuations in the order they were
+    /// pushed.
+    class continuation_list
+    {
+    public:
+        continuation_list() = default;
+        continuation_list(continuation_list&&) = delete;
+        continuation_list& operator=(continuation_list&&) = delete;
+        continuation_list(continuation_list const&) = delete;
+        continuation_list& operator=(continuation_list const&) = delete;
+
+        /// Returns true if complete has been called. Writes made before
+        /// calling complete are visible to the caller if true is returned.
+        bool completed() const noexcept
+        {
+            return head.load(std::memory_order_acquire) == completed_marker();
+        }
+
+        /// Adds a continuation to the list. Returns false without adding the
+        /// continuation if the list has already been completed. The caller
+        /// is responsible for running the continuation in that case.
+        [[nodiscard]] bool push(continuation_node* node) noexcept
+        {
+            void* old_head = head.load(std::memory_order_acquire);
+            do
+            {
+                if (old_head == completed_marker())
+                {
+                    return false;
+                }
+                node->next = static_cast<continuation_node*>(old_head);
+            } while (!head.compare_exchange_weak(
+                old_head, node, std::memory_order_acq_rel, std::memory_order_acquire));
+
+            return true;
+        }
+
+        /// Marks the list as completed and runs all continuations that have
+        /// been pushed. The list itself is not accessed after the
+        /// continuations have been taken from it, so the last continuation
+        /// may destroy the list.
+        void complete() noexcept
+        {
+            auto* node = static_cast<continuation_node*>(
+                head.exchange(completed_marker(), std::memory_order_acq_rel));
+
+            // The continuations are stored in reverse order. We reverse the
+            // list to run them in the order they were pushed.
+            continuation_node* reversed = nullptr;
+            while (node != nullptr)
+            {
+                continuation_node* next = node->next;
+                node->next = reversed;
+                reversed = node;
+                node = next;
+            }
+
+            while (reversed != nullptr)
+            {
+                // The next node has to be read before calling complete since
+                // complete may destroy the node
+                continuation_node* next = reversed->next;
+                reversed->complete(reversed);
+                reversed = next;
+            }
+        }
+
+    private:
+        void* completed_marker() const noexcept
+        {
+            return const_cast<continuation_list*>(this);
+        }
+
+        // nullptr if no continuations have been pushed, completed_marker()
+        // if the list has been completed, and otherwise the most recently
+        // pushed continuation
+        std::atomic<void*> head{nullptr};
+    };
+}    // namespace pika::execution::experimental::detail
@@ -17,6 +17,7 @@
 # include <pika/assert.hpp>
 # include <pika/concepts/concepts.hpp>
 # include <pika/datastructures/variant.hpp>
+# include <pika/execution/algorithms/detail/continuation_list.hpp>
 # include <pika/execution/algorithms/detail/helpers.hpp>
 # include <pika/execution/algorithms/detail/partial_algorithm.hpp>
 # include <pika/execution_base/operation_state.hpp>
@@ -25,9 +26,7 @@
 # include <pika/functional/bind_front.hpp>
 # include <pika/functional/detail/tag_fallback_invoke.hpp>
 # include <pika/functional/invoke_fused.hpp>
-# include <pika/functional/unique_function.hpp>
 # include <pika/memory/intrusive_ptr.hpp>
-# include <pika/synchronization/spinlock.hpp>
 # include <pika/thread_support/atomic_count.hpp>
 # include <pika/type_support/detail/with_result_of.hpp>
 # include <pika/type_support/pack.hpp>
@@ -36,7 +35,6 @@
 # include <cstddef>
 # include <exception>
 # include <memory>
-# include <mutex>
 # include <optional>
 # include <tuple>
 # include <type_traits>
@@ -123,11 +121,8 @@ namespace pika::ensure_started_detail {
             using allocator_type =
                 typename std::allocator_traits<Allocator>::template rebind_alloc<shared_state>;
             PIKA_NO_UNIQUE_ADDRESS allocator_type alloc;
-            using mutex_type = pika::spinlock;
-            mutex_type mtx;
             pika::detail::atomic_count reference_count{0};
             std::atomic<bool> start_called{false};
-            std::atomic<bool> predecessor_done{false};
 
             using operation_state_type = std::decay_t<
                 pika::execution::experimental::connect_result_t<Sender, ensure_started_receiver>>;
@@ -154,8 +149,9 @@ namespace pika::ensure_started_detail {
                 error_type, value_type>
                 v;
 
-            using continuation_type = pika::util::detail::unique_function<void()>;
-            std::optional<continuation_type> continuation;
+            // The operation state of the consumer of the ensure_started
+            // sender if it is waiting for the predecessor to complete
+            pika::execution::experimental::detail::continuation_list continuations;
 
             struct ensure_started_receiver
             {
@@ -262,102 +258,11 @@ namespace pika::ensure_started_detail {
                 // shared state by now.
                 os.reset();
 
-                predecessor_done = true;
-
-                {
-                    // We require taking the lock here to synchronize with
-                    // threads attempting to add continuations to the vector
-                    // of continuations. However, it is enough to take it
-                    // once and release it immediately.
-                    //
-                    // Without the lock we may not see writes to the vector.
-                    // With the lock threads attempting to add continuations
-                    // will either:
-                    // - See predecessor_done = true in which case they will
-                    //   call the continuation directly without adding it to
-                    //   the vector of continuations. Accessing the vector
-                    //   below without the lock is safe in this case because
-                    //   the vector is not modified.
-                    // - See predecessor_done = false and proceed to take
-                    //   the lock. If they see predecessor_done after taking
-                    //   the lock they can again release the lock and call
-                    //   the continuation directly. Accessing the vector
-                    //   without the lock is again safe because the vector
-                    //   is not modified.
-                    // - See predecessor_done = false and proceed to take
-                    //   the lock. If they see predecessor_done is still
-                    //   false after taking the lock, they will proceed to
-                    //   add a continuation to the vector. Since they keep
-                    //   the lock they can safely write to the vector. This
-                    //   thread will not proceed past the lock until they
-                    //   have finished writing to the vector.
-                    //
-                    // Importantly, once this thread has taken and released
-                    // this lock, threads attempting to add continuations to
-                    // the vector must see predecessor_done = true after
-                    // taking the lock in their threads and will not add
-                    // continuations to the vector.
-                    std::unique_lock<mutex_type> l{mtx};
-                }
-
-                if (continuation)
-                {
-                    continuation.value()();
-                    continuation.reset();
-                }
-            }
-
-            template <typename Receiver>
-            void add_continuation(Receiver& receiver) = delete;
-
-            template <typename Receiver>
-            void add_continuation(Receiver&& receiver)
-            {
-                PIKA_ASSERT(!continuation.has_value());
-
-                if (predecessor_done)
-                {
-                    // If we read predecessor_done here it means that one of
-                    // set_error/set_stopped/set_value has been called and
-                    // values/errors have been stored into the shared state.
-                    // We can trigger the continuation directly.
-                    // TODO: Should this preserve the scheduler? It does not
-                    // if we call set_* inline.
-                    pika::detail::visit(
-                        stopped_error_value_visitor<Receiver>{PIKA_FORWARD(Receiver, receiver)},
-                        PIKA_MOVE(v));
-                }
-                else
-                {
-                    // If predecessor_done is false, we have to take the
-                    // lock to potentially store the continuation.
-                    std::unique_lock<mutex_type> l{mtx};
-
-                    if (predecessor_done)
-                    {
-                        // By the time the lock has been taken,
-                        // predecessor_done might already be true and we can
-                        // release the lock early and call the continuation
-                        // directly again.
-                        l.unlock();
-                        pika::detail::visit(
-                            stopped_error_value_visitor<Receiver>{PIKA_FORWARD(Receiver, receiver)},
-                            PIKA_MOVE(v));
-                    }
-                    else
-                    {
-                        // If predecessor_done is still false, we store the
-                        // continuation. This has to be done while holding
-                        // the lock since predecessor signalling completion
-                        // may otherwise not see the continuation.
-                        continuation.emplace(
-                            [this, receiver = PIKA_FORWARD(Receiver, receiver)]() mutable {
-                                pika::detail::visit(
-                                    stopped_error_value_visitor<Receiver>{PIKA_MOVE(receiver)},
-                                    PIKA_MOVE(v));
-                            });
-                    }
-                }
+                // Completing the list of continuations makes the values
+                // stored above visible to all consumers. Consumers that
+                // attempt to add themselves to the list after this will see
+                // that the list has been completed and complete inline.
+                continuations.complete();
             }
 
             void start() & noexcept
@@ -413,14 +318,15 @@ namespace pika::ensure_started_detail {
         ensure_started_sender_type& operator=(ensure_started_sender_type const&) = delete;
 
         template <typename Receiver>
-        struct operation_state
+        struct operation_state : pika::execution::experimental::detail::continuation_node
         {
             PIKA_NO_UNIQUE_ADDRESS std::decay_t<Receiver> receiver;
             pika::intrusive_ptr<shared_state> state;
 
             template <typename Receiver_>
             operation_state(Receiver_&& receiver, pika::intrusive_ptr<shared_state> state)
-              : receiver(PIKA_FORWARD(Receiver_, receiver))
+              : continuation_node(&operation_state::continuation)
+              , receiver(PIKA_FORWARD(Receiver_, receiver))
               , state(PIKA_MOVE(state))
             {
             }
@@ -430,10 +336,30 @@ namespace pika::ensure_started_detail {
             operation_state(operation_state const&) = delete;
             operation_state& operator=(operation_state const&) = delete;
 
+            // Called once one of set_error/set_stopped/set_value has been
+            // called on the predecessor and the values/errors have been
+            // stored into the shared state.
+            static void continuation(continuation_node* node) noexcept
+            {
+                auto& os = static_cast<operation_state&>(*node);
+                pika::detail::visit(typename shared_state::template stopped_error_value_visitor<
+                                        Receiver>{PIKA_MOVE(os.receiver)},
+                    PIKA_MOVE(os.state->v));
+            }
+
             friend void tag_invoke(
                 pika::execution::experimental::start_t, operation_state& os) noexcept
             {
-                os.state->add_continuation(PIKA_MOVE(os.receiver));
+                // The operation state is added to the list of continuations
+                // of the shared state without allocating. If the predecessor
+                // has already completed we can trigger the continuation
+                // directly.
+                // TODO: Should this preserve the scheduler? It does not if
+                // we call set_* inline.
+                if (!os.state->continuations.push(&os))
+                {
+                    continuation(&os);
+                }
             }
         };
 
@@ -0,0 +1,51 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+#if defined(PIKA_HAVE_P2300_REFERENCE_IMPLEMENTATION)
+# include <pika/execution_base/p2300_forward.hpp>
+#endif
+
+#include <pika/concepts/concepts.hpp>
+#include <pika/execution_base/sender.hpp>
+#include <pika/functional/detail/tag_fallback_invoke.hpp>
+#include <pika/functional/tag_invoke.hpp>
+#include <pika/timing/steady_clock.hpp>
+
+#include <utility>
+
+namespace pika::execution::experimental {
+    /// schedule_at is a customization point object returning a sender that
+    /// completes on the given scheduler once the given point in time has
+    /// passed. Schedulers customize schedule_at to wait for the deadline
+    /// without blocking a thread. If stop is requested through the stop
+    /// token of the receiver before the deadline the sender completes with
+    /// set_stopped.
+    inline constexpr struct schedule_at_t final : pika::functional::detail::tag<schedule_at_t>
+    {
+    } schedule_at{};
+
+    /// schedule_after is a customization point object returning a sender
+    /// that completes on the given scheduler once the given duration has
+    /// passed. Schedulers may customize schedule_after to measure the
+    /// duration from when the operation is started. By default
+    /// schedule_after is implemented with schedule_at, measuring the
+    /// duration from when the sender is created.
+    inline constexpr struct schedule_after_t final
+      : pika::functional::detail::tag_fallback<schedule_after_t>
+    {
+    private:
+        template <typename Scheduler, PIKA_CONCEPT_REQUIRES_(is_scheduler_v<Scheduler>)>
+        friend constexpr PIKA_FORCEINLINE auto tag_fallback_invoke(schedule_after_t,
+            Scheduler&& scheduler, pika::chrono::steady_duration const& rel_time)
+        {
+            return schedule_at(PIKA_FORWARD(Scheduler, scheduler),
+                pika::chrono::steady_time_point(rel_time.from_now()));
+        }
+    } schedule_after{};
+}    // namespace pika::execution::experimental
@@ -7,6 +7,7 @@
 #pragma once
 
 #include <pika/config.hpp>
+#include <pika/assert.hpp>
 
 #if defined(PIKA_HAVE_P2300_REFERENCE_IMPLEMENTATION)
 # include <pika/execution_base/p2300_forward.hpp>
@@ -19,12 +20,10 @@
 #include <pika/execution_base/receiver.hpp>
 #include <pika/execution_base/sender.hpp>
 #include <pika/functional/detail/tag_fallback_invoke.hpp>
-#include <pika/synchronization/condition_variable.hpp>
-#include <pika/synchronization/spinlock.hpp>
+#include <pika/synchronization/detail/completion_flag.hpp>
 #include <pika/type_support/pack.hpp>
 #include <pika/type_support/unused.hpp>
 
-#include <atomic>
 #include <exception>
 #include <type_traits>
 #include <utility>
@@ -128,26 +127,16 @@ namespace pika::sync_wait_detail {
             std::exception_ptr>>;
 #endif
 
-        // We use a spinlock here to allow taking the lock on non-pika threads.
-        using mutex_type = pika::spinlock;
-
         struct shared_state
         {
-            pika::condition_variable cond_var;
-            mutex_type mtx;
-            std::atomic<bool> set_called = false;
+            // The completion flag can be waited for on both pika and non-pika
+            // threads without taking a lock on the completion path.
+            pika::detail::completion_flag set_called;
             pika::detail::variant<pika::detail::monostate, error_type, value_type> value;
 
             void wait()
             {
-                if (!set_called)
-                {
-                    std::unique_lock<mutex_type> l(mtx);
-                    if (!set_called)
-                    {
-                        cond_var.wait(l);
-                    }
-                }
+                set_called.wait();
             }
 
             auto get_value()
@@ -179,11 +168,7 @@ namespace pika::sync_wait_detail {
 
         void signal_set_called() noexcept
         {
-            std::unique_lock<mutex_type> l(state.mtx);
-            state.set_called = true;
-            [[maybe_unused]] pika::util::ignore_while_checking<decltype(l)> il(&l);
-
-            state.cond_var.notify_one();
+            state.set_called.set();
         }
 
         template <typename Error>
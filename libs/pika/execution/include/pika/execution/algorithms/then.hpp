@@ -55,6 +55,14 @@ namespace pika::then_detail {
             pika::execution::experimental::set_stopped(PIKA_MOVE(r.receiver));
         }
 
+        // Forward the environment, and with it the stop token, of the
+        // receiver to the predecessor sender
+        friend constexpr decltype(auto) tag_invoke(
+            pika::execution::experimental::get_env_t, then_receiver_type const& r) noexcept
+        {
+            return pika::execution::experimental::get_env(r.receiver);
+        }
+
     private:
         template <typename... Ts>
         void set_value_helper(Ts&&... ts) noexcept
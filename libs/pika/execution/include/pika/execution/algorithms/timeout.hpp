@@ -0,0 +1,408 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+
+#if defined(PIKA_HAVE_P2300_REFERENCE_IMPLEMENTATION)
+# include <pika/execution_base/p2300_forward.hpp>
+#endif
+
+#include <pika/assert.hpp>
+#include <pika/concepts/concepts.hpp>
+#include <pika/datastructures/variant.hpp>
+#include <pika/execution/algorithms/detail/partial_algorithm.hpp>
+#include <pika/execution/algorithms/schedule_at.hpp>
+#include <pika/execution_base/operation_state.hpp>
+#include <pika/execution_base/receiver.hpp>
+#include <pika/execution_base/sender.hpp>
+#include <pika/execution_base/stop_token.hpp>
+#include <pika/functional/bind_front.hpp>
+#include <pika/functional/detail/tag_fallback_invoke.hpp>
+#include <pika/functional/invoke_fused.hpp>
+#include <pika/synchronization/stop_token.hpp>
+#include <pika/timing/steady_clock.hpp>
+#include <pika/type_support/pack.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <optional>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace pika::timeout_detail {
+    template <typename Receiver>
+    struct error_visitor
+    {
+        std::decay_t<Receiver>& receiver;
+
+        template <typename Error>
+        void operator()(Error&& error)
+        {
+            pika::execution::experimental::set_error(
+                PIKA_MOVE(receiver), PIKA_FORWARD(Error, error));
+        }
+    };
+
+    template <typename Receiver>
+    struct value_visitor
+    {
+        std::decay_t<Receiver>& receiver;
+
+        template <typename Ts>
+        void operator()(Ts&& ts)
+        {
+            pika::util::detail::invoke_fused(
+                pika::util::detail::bind_front(
+                    pika::execution::experimental::set_value, PIKA_MOVE(receiver)),
+                PIKA_FORWARD(Ts, ts));
+        }
+    };
+
+    // The environment of the receivers connected to the predecessor sender
+    // and to the timer. Stop is requested on the stop token when either of
+    // them completes first, or when stop is requested on the stop token of
+    // the receiver connected to the timeout sender.
+    struct env
+    {
+        pika::stop_token stop_token;
+
+        friend pika::stop_token tag_invoke(
+            pika::execution::experimental::get_stop_token_t, env const& e) noexcept
+        {
+            return e.stop_token;
+        }
+    };
+
+    template <typename Sender, typename Scheduler, typename Receiver>
+    struct operation_state
+    {
+        template <typename Tuple>
+        struct value_type_helper
+        {
+            using type = pika::util::detail::transform_t<Tuple, std::decay>;
+        };
+
+#if defined(PIKA_HAVE_P2300_REFERENCE_IMPLEMENTATION)
+        using value_type = pika::util::detail::transform_t<
+            pika::execution::experimental::value_types_of_t<Sender,
+                pika::execution::experimental::empty_env, std::tuple, pika::detail::variant>,
+            value_type_helper>;
+        using error_type = pika::util::detail::unique_t<pika::util::detail::prepend_t<
+            pika::util::detail::transform_t<
+                pika::execution::experimental::error_types_of_t<Sender,
+                    pika::execution::experimental::empty_env, pika::detail::variant>,
+                std::decay>,
+            std::exception_ptr>>;
+#else
+        using value_type = pika::util::detail::transform_t<
+            typename pika::execution::experimental::sender_traits<Sender>::template value_types<
+                std::tuple, pika::detail::variant>,
+            value_type_helper>;
+        using error_type = pika::util::detail::unique_t<pika::util::detail::prepend_t<
+            pika::util::detail::transform_t<
+                typename pika::execution::experimental::sender_traits<
+                    Sender>::template error_types<pika::detail::variant>,
+                std::decay>,
+            std::exception_ptr>>;
+#endif
+
+        struct sender_receiver
+        {
+            using is_receiver = void;
+
+            operation_state& op;
+
+            template <typename Error>
+            friend void tag_invoke(pika::execution::experimental::set_error_t,
+                sender_receiver&& r, Error&& error) noexcept
+            {
+                if (r.op.try_complete_first())
+                {
+                    r.op.result.template emplace<error_type>(
+                        error_type(PIKA_FORWARD(Error, error)));
+                }
+                r.op.stop_source.request_stop();
+                r.op.arrive();
+            }
+
+            friend void tag_invoke(
+                pika::execution::experimental::set_stopped_t, sender_receiver&& r) noexcept
+            {
+                if (r.op.try_complete_first())
+                {
+                    r.op.result.template emplace<pika::execution::detail::stopped_type>();
+                }
+                r.op.stop_source.request_stop();
+                r.op.arrive();
+            }
+
+            template <typename... Ts>
+            friend auto tag_invoke(pika::execution::experimental::set_value_t,
+                sender_receiver&& r, Ts&&... ts) noexcept
+                -> decltype(std::declval<pika::detail::variant<pika::detail::monostate,
+                                    value_type>>()
+                                .template emplace<value_type>(
+                                    std::make_tuple<>(PIKA_FORWARD(Ts, ts)...)),
+                    void())
+            {
+                if (r.op.try_complete_first())
+                {
+                    r.op.result.template emplace<value_type>(
+                        std::make_tuple<>(PIKA_FORWARD(Ts, ts)...));
+                }
+                r.op.stop_source.request_stop();
+                r.op.arrive();
+            }
+
+            friend env tag_invoke(
+                pika::execution::experimental::get_env_t, sender_receiver const& r) noexcept
+            {
+                return {r.op.stop_source.get_token()};
+            }
+        };
+
+        struct timer_receiver
+        {
+            using is_receiver = void;
+
+            operation_state& op;
+
+            friend void tag_invoke(pika::execution::experimental::set_error_t,
+                timer_receiver&& r, std::exception_ptr ep) noexcept
+            {
+                if (r.op.try_complete_first())
+                {
+                    r.op.result.template emplace<error_type>(error_type(PIKA_MOVE(ep)));
+                    r.op.stop_source.request_stop();
+                }
+                r.op.arrive();
+            }
+
+            // The timer is stopped when the predecessor sender completes
+            // first
+            friend void tag_invoke(
+                pika::execution::experimental::set_stopped_t, timer_receiver&& r) noexcept
+            {
+                r.op.arrive();
+            }
+
+            // The deadline has passed before the predecessor sender completed
+            friend void tag_invoke(
+                pika::execution::experimental::set_value_t, timer_receiver&& r) noexcept
+            {
+                if (r.op.try_complete_first())
+                {
+                    r.op.result.template emplace<pika::execution::detail::stopped_type>();
+                    r.op.stop_source.request_stop();
+                }
+                r.op.arrive();
+            }
+
+            friend env tag_invoke(
+                pika::execution::experimental::get_env_t, timer_receiver const& r) noexcept
+            {
+                return {r.op.stop_source.get_token()};
+            }
+        };
+
+        struct forward_stop_request
+        {
+            pika::stop_source& stop_source;
+
+            void operator()() noexcept
+            {
+                stop_source.request_stop();
+            }
+        };
+
+        using receiver_stop_token_type =
+            pika::execution::experimental::stop_token_of_t<std::decay_t<std::invoke_result_t<
+                pika::execution::experimental::get_env_t, std::decay_t<Receiver> const&>>>;
+        using stop_callback_type = pika::execution::experimental::detail::stop_callback_for_t<
+            receiver_stop_token_type, forward_stop_request>;
+        using timer_sender_type =
+            std::invoke_result_t<pika::execution::experimental::schedule_after_t,
+                std::decay_t<Scheduler>&, pika::chrono::steady_duration const&>;
+
+        PIKA_NO_UNIQUE_ADDRESS std::decay_t<Receiver> receiver;
+        pika::stop_source stop_source;
+        std::optional<stop_callback_type> stop_callback;
+        std::atomic<bool> completed_first{false};
+        std::atomic<int> pending{2};
+        pika::detail::variant<pika::detail::monostate, pika::execution::detail::stopped_type,
+            error_type, value_type>
+            result;
+
+        std::decay_t<pika::execution::experimental::connect_result_t<Sender, sender_receiver>>
+            sender_op_state;
+        std::decay_t<
+            pika::execution::experimental::connect_result_t<timer_sender_type, timer_receiver>>
+            timer_op_state;
+
+        template <typename Sender_, typename Scheduler_, typename Receiver_>
+        operation_state(Sender_&& sender, Scheduler_&& scheduler,
+            pika::chrono::steady_duration const& rel_time, Receiver_&& receiver)
+          : receiver(PIKA_FORWARD(Receiver_, receiver))
+          , sender_op_state(pika::execution::experimental::connect(
+                PIKA_FORWARD(Sender_, sender), sender_receiver{*this}))
+          , timer_op_state(pika::execution::experimental::connect(
+                pika::execution::experimental::schedule_after(scheduler, rel_time),
+                timer_receiver{*this}))
+        {
+        }
+
+        operation_state(operation_state&&) = delete;
+        operation_state(operation_state const&) = delete;
+        operation_state& operator=(operation_state&&) = delete;
+        operation_state& operator=(operation_state const&) = delete;
+
+        bool try_complete_first() noexcept
+        {
+            return !completed_first.exchange(true, std::memory_order_relaxed);
+        }
+
+        struct result_visitor
+        {
+            std::decay_t<Receiver>& receiver;
+
+            [[noreturn]] void operator()(pika::detail::monostate) const
+            {
+                PIKA_UNREACHABLE;
+            }
+
+            void operator()(pika::execution::detail::stopped_type)
+            {
+                pika::execution::experimental::set_stopped(PIKA_MOVE(receiver));
+            }
+
+            void operator()(error_type&& error)
+            {
+                pika::detail::visit(error_visitor<Receiver>{receiver}, PIKA_MOVE(error));
+            }
+
+            void operator()(value_type&& ts)
+            {
+                pika::detail::visit(value_visitor<Receiver>{receiver}, PIKA_MOVE(ts));
+            }
+        };
+
+        // Called when the predecessor sender and the timer have completed
+        void arrive() noexcept
+        {
+            if (pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+            {
+                return;
+            }
+
+            stop_callback.reset();
+            pika::detail::visit(result_visitor{receiver}, PIKA_MOVE(result));
+        }
+
+        friend void tag_invoke(pika::execution::experimental::start_t, operation_state& os) noexcept
+        {
+            os.stop_callback.emplace(
+                pika::execution::experimental::get_stop_token(
+                    pika::execution::experimental::get_env(os.receiver)),
+                forward_stop_request{os.stop_source});
+
+            // The predecessor sender is started first so that the timer
+            // doesn't have to be scheduled if the sender completes inline
+            pika::execution::experimental::start(os.sender_op_state);
+            pika::execution::experimental::start(os.timer_op_state);
+        }
+    };
+
+    template <typename Sender, typename Scheduler>
+    struct timeout_sender_impl
+    {
+        struct timeout_sender_type;
+    };
+
+    template <typename Sender, typename Scheduler>
+    using timeout_sender = typename timeout_sender_impl<Sender, Scheduler>::timeout_sender_type;
+
+    template <typename Sender, typename Scheduler>
+    struct timeout_sender_impl<Sender, Scheduler>::timeout_sender_type
+    {
+        using is_sender = void;
+
+        PIKA_NO_UNIQUE_ADDRESS std::decay_t<Sender> sender;
+        PIKA_NO_UNIQUE_ADDRESS std::decay_t<Scheduler> scheduler;
+        pika::chrono::steady_duration rel_time;
+
+#if defined(PIKA_HAVE_P2300_REFERENCE_IMPLEMENTATION)
+        using completion_signatures =
+            pika::execution::experimental::make_completion_signatures<Sender,
+                pika::execution::experimental::empty_env,
+                pika::execution::experimental::completion_signatures<
+                    pika::execution::experimental::set_error_t(std::exception_ptr),
+                    pika::execution::experimental::set_stopped_t()>>;
+#else
+        template <template <typename...> class Tuple, template <typename...> class Variant>
+        using value_types = typename pika::execution::experimental::sender_traits<
+            Sender>::template value_types<Tuple, Variant>;
+
+        template <template <typename...> class Variant>
+        using error_types = pika::util::detail::unique_t<
+            pika::util::detail::prepend_t<typename pika::execution::experimental::sender_traits<
+                                              Sender>::template error_types<Variant>,
+                std::exception_ptr>>;
+
+        static constexpr bool sends_done = true;
+#endif
+
+        template <typename Receiver>
+        friend operation_state<Sender, Scheduler, Receiver> tag_invoke(
+            pika::execution::experimental::connect_t, timeout_sender_type&& s, Receiver&& receiver)
+        {
+            return {PIKA_MOVE(s.sender), PIKA_MOVE(s.scheduler), s.rel_time,
+                PIKA_FORWARD(Receiver, receiver)};
+        }
+
+        template <typename Receiver>
+        friend operation_state<Sender, Scheduler, Receiver>
+        tag_invoke(pika::execution::experimental::connect_t, timeout_sender_type const& s,
+            Receiver&& receiver)
+        {
+            return {std::decay_t<Sender>(s.sender), s.scheduler, s.rel_time,
+                PIKA_FORWARD(Receiver, receiver)};
+        }
+    };
+}    // namespace pika::timeout_detail
+
+namespace pika::execution::experimental {
+    /// timeout races the given sender against a timer on the given
+    /// scheduler. If the sender completes before the duration has passed,
+    /// the timer is cancelled and the returned sender completes with the
+    /// result of the sender. Otherwise stop is requested through the stop
+    /// token passed to the sender, and the returned sender completes with
+    /// set_stopped once the sender has completed. The sender must
+    /// therefore react to stop requests to be able to time out early.
+    inline constexpr struct timeout_t final : pika::functional::detail::tag_fallback<timeout_t>
+    {
+    private:
+        template <typename Sender, typename Scheduler,
+            PIKA_CONCEPT_REQUIRES_(is_sender_v<Sender>&& is_scheduler_v<Scheduler>)>
+        friend constexpr PIKA_FORCEINLINE auto tag_fallback_invoke(timeout_t, Sender&& sender,
+            Scheduler&& scheduler, pika::chrono::steady_duration const& rel_time)
+        {
+            return timeout_detail::timeout_sender<std::decay_t<Sender>, std::decay_t<Scheduler>>{
+                PIKA_FORWARD(Sender, sender), PIKA_FORWARD(Scheduler, scheduler), rel_time};
+        }
+
+        template <typename Scheduler, PIKA_CONCEPT_REQUIRES_(is_scheduler_v<Scheduler>)>
+        friend constexpr PIKA_FORCEINLINE auto tag_fallback_invoke(
+            timeout_t, Scheduler&& scheduler, pika::chrono::steady_duration const& rel_time)
+        {
+            return detail::partial_algorithm<timeout_t, Scheduler, pika::chrono::steady_duration>{
+                PIKA_FORWARD(Scheduler, scheduler), rel_time};
+        }
+    } timeout{};
+}    // namespace pika::execution::experimental
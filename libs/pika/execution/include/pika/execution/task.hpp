@@ -0,0 +1,583 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+
+#if defined(PIKA_HAVE_CXX20_COROUTINES)
+
+# include <pika/assert.hpp>
+
+# if defined(PIKA_HAVE_P2300_REFERENCE_IMPLEMENTATION)
+#  include <pika/execution_base/p2300_forward.hpp>
+# endif
+
+# include <pika/datastructures/variant.hpp>
+# include <pika/execution/algorithms/detail/helpers.hpp>
+# include <pika/execution_base/operation_state.hpp>
+# include <pika/execution_base/receiver.hpp>
+# include <pika/execution_base/sender.hpp>
+# include <pika/type_support/pack.hpp>
+
+# include <atomic>
+# include <coroutine>
+# include <cstddef>
+# include <exception>
+# include <optional>
+# include <type_traits>
+# include <utility>
+
+namespace pika::execution::experimental {
+    template <typename T = void>
+    class task;
+
+    namespace detail {
+        // Coroutine frames of tasks are allocated from a cache local to the
+        // worker thread, to avoid going through the global allocator for
+        // short-lived tasks. Frames can be freed on any thread.
+        PIKA_EXPORT void* allocate_task_frame(std::size_t size);
+        PIKA_EXPORT void deallocate_task_frame(void* p, std::size_t size) noexcept;
+
+        template <typename T>
+        struct is_task : std::false_type
+        {
+        };
+
+        template <typename T>
+        struct is_task<task<T>> : std::true_type
+        {
+        };
+
+        template <typename Sender>
+        struct task_sender_awaiter;
+
+        template <typename T>
+        class task_awaiter;
+
+        struct task_promise_base
+        {
+            static void* operator new(std::size_t size)
+            {
+                return allocate_task_frame(size);
+            }
+
+            static void operator delete(void* p, std::size_t size) noexcept
+            {
+                deallocate_task_frame(p, size);
+            }
+
+            // Tasks are lazy, they only start running when awaited or when
+            // the operation state of the task is started
+            std::suspend_always initial_suspend() noexcept
+            {
+                return {};
+            }
+
+            struct final_awaiter
+            {
+                bool await_ready() noexcept
+                {
+                    return false;
+                }
+
+                template <typename Promise>
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> h) noexcept
+                {
+                    return h.promise().complete();
+                }
+
+                void await_resume() noexcept {}
+            };
+
+            final_awaiter final_suspend() noexcept
+            {
+                return {};
+            }
+
+            void unhandled_exception() noexcept
+            {
+                exception = std::current_exception();
+            }
+
+            // Tasks are awaited directly, senders are awaited through an
+            // awaiter that connects them to a receiver resuming the task.
+            // Other awaitables are awaited as they are.
+            template <typename T>
+            task_awaiter<T> await_transform(task<T>&& t) noexcept
+            {
+                return task_awaiter<T>(PIKA_MOVE(t), *this);
+            }
+
+            template <typename Sender,
+                typename = std::enable_if_t<!is_task<std::decay_t<Sender>>::value &&
+                    is_sender_v<std::decay_t<Sender>>>>
+            task_sender_awaiter<Sender> await_transform(Sender&& sender)
+            {
+                return task_sender_awaiter<Sender>(PIKA_FORWARD(Sender, sender), *this);
+            }
+
+            template <typename Awaitable,
+                typename = std::enable_if_t<!is_task<std::decay_t<Awaitable>>::value &&
+                    !is_sender_v<std::decay_t<Awaitable>>>,
+                typename = void>
+            Awaitable&& await_transform(Awaitable&& awaitable) noexcept
+            {
+                return PIKA_FORWARD(Awaitable, awaitable);
+            }
+
+            // Returns the coroutine to resume once the task has finished.
+            // This is the awaiting task, if any. Otherwise the task is
+            // completed through its operation state.
+            std::coroutine_handle<> complete() noexcept
+            {
+                if (continuation)
+                {
+                    return continuation;
+                }
+
+                complete_operation_state(operation_state);
+                return std::noop_coroutine();
+            }
+
+            // Completes the task and all tasks awaiting it with set_stopped
+            // without resuming them. This may destroy the task.
+            void set_stopped() noexcept
+            {
+                stopped = true;
+                if (parent != nullptr)
+                {
+                    parent->set_stopped();
+                }
+                else
+                {
+                    complete_operation_state(operation_state);
+                }
+            }
+
+            // The awaiting task, or the operation state and the function
+            // completing it if the task has been connected to a receiver
+            std::coroutine_handle<> continuation;
+            task_promise_base* parent = nullptr;
+            void* operation_state = nullptr;
+            void (*complete_operation_state)(void*) noexcept = nullptr;
+
+            std::exception_ptr exception;
+            bool stopped = false;
+        };
+
+        template <typename T>
+        struct task_promise : task_promise_base
+        {
+            task<T> get_return_object() noexcept;
+
+            template <typename U>
+            void return_value(U&& u)
+            {
+                value.emplace(PIKA_FORWARD(U, u));
+            }
+
+            T get_result()
+            {
+                if (exception)
+                {
+                    std::rethrow_exception(exception);
+                }
+                return PIKA_MOVE(*value);
+            }
+
+            std::optional<T> value;
+        };
+
+        template <>
+        struct task_promise<void> : task_promise_base
+        {
+            task<void> get_return_object() noexcept;
+
+            void return_void() noexcept {}
+
+            void get_result()
+            {
+                if (exception)
+                {
+                    std::rethrow_exception(exception);
+                }
+            }
+        };
+
+        // Awaits a task from another task. The awaited task is resumed
+        // directly and resumes the awaiting task when it finishes, without
+        // growing the stack.
+        template <typename T>
+        class task_awaiter
+        {
+        public:
+            task_awaiter(task<T>&& t, task_promise_base& parent) noexcept
+              : handle(std::exchange(t.handle, {}))
+              , parent(parent)
+            {
+            }
+
+            task_awaiter(task_awaiter&&) = delete;
+            task_awaiter(task_awaiter const&) = delete;
+            task_awaiter& operator=(task_awaiter&&) = delete;
+            task_awaiter& operator=(task_awaiter const&) = delete;
+
+            ~task_awaiter()
+            {
+                if (handle)
+                {
+                    handle.destroy();
+                }
+            }
+
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept
+            {
+                auto& promise = handle.promise();
+                promise.continuation = continuation;
+                promise.parent = &parent;
+                return handle;
+            }
+
+            T await_resume()
+            {
+                return handle.promise().get_result();
+            }
+
+        private:
+            std::coroutine_handle<task_promise<T>> handle;
+            task_promise_base& parent;
+        };
+
+        // Awaits a sender from a task. The task is resumed on the thread
+        // completing the sender, or continues inline if the sender completes
+        // before the task could be suspended. If the sender completes with
+        // set_stopped the task completes with set_stopped without being
+        // resumed.
+        template <typename Sender>
+        struct task_sender_awaiter
+        {
+# if defined(PIKA_HAVE_P2300_REFERENCE_IMPLEMENTATION)
+            template <template <typename...> class Tuple, template <typename...> class Variant>
+            using predecessor_value_types = value_types_of_t<std::decay_t<Sender>, empty_env,
+                Tuple, Variant>;
+# else
+            template <template <typename...> class Tuple, template <typename...> class Variant>
+            using predecessor_value_types = typename sender_traits<
+                std::decay_t<Sender>>::template value_types<Tuple, Variant>;
+# endif
+
+            // The type of the single void or non-void result of the sender.
+            // Senders sending multiple values or variants can't be awaited.
+            using result_type = std::decay_t<detail::single_result_t<
+                predecessor_value_types<pika::util::detail::pack, pika::util::detail::pack>>>;
+
+            static constexpr bool is_void_result = std::is_void_v<result_type>;
+
+            struct void_value_type
+            {
+            };
+
+            using value_type = std::conditional_t<is_void_result, void_value_type, result_type>;
+
+            struct stopped_type
+            {
+            };
+
+            struct awaiter_receiver
+            {
+                using is_receiver = void;
+
+                task_sender_awaiter& awaiter;
+
+                template <typename Error>
+                friend void tag_invoke(set_error_t, awaiter_receiver&& r, Error&& error) noexcept
+                {
+                    if constexpr (std::is_same_v<std::decay_t<Error>, std::exception_ptr>)
+                    {
+                        r.awaiter.result.template emplace<std::exception_ptr>(
+                            PIKA_FORWARD(Error, error));
+                    }
+                    else
+                    {
+                        r.awaiter.result.template emplace<std::exception_ptr>(
+                            std::make_exception_ptr(PIKA_FORWARD(Error, error)));
+                    }
+                    r.awaiter.resume();
+                }
+
+                friend void tag_invoke(set_stopped_t, awaiter_receiver&& r) noexcept
+                {
+                    r.awaiter.result.template emplace<stopped_type>();
+                    r.awaiter.resume();
+                }
+
+                template <typename... Us,
+                    typename = std::enable_if_t<(is_void_result && sizeof...(Us) == 0) ||
+                        (!is_void_result && sizeof...(Us) == 1)>>
+                friend void tag_invoke(set_value_t, awaiter_receiver&& r, Us&&... us) noexcept
+                {
+                    r.awaiter.result.template emplace<value_type>(PIKA_FORWARD(Us, us)...);
+                    r.awaiter.resume();
+                }
+
+                friend constexpr empty_env tag_invoke(get_env_t, awaiter_receiver const&) noexcept
+                {
+                    return {};
+                }
+            };
+
+            task_sender_awaiter(Sender&& sender, task_promise_base& promise)
+              : promise(promise)
+              , op_state(pika::execution::experimental::connect(
+                    PIKA_FORWARD(Sender, sender), awaiter_receiver{*this}))
+            {
+            }
+
+            task_sender_awaiter(task_sender_awaiter&&) = delete;
+            task_sender_awaiter(task_sender_awaiter const&) = delete;
+            task_sender_awaiter& operator=(task_sender_awaiter&&) = delete;
+            task_sender_awaiter& operator=(task_sender_awaiter const&) = delete;
+
+            bool await_ready() const noexcept
+            {
+                return false;
+            }
+
+            bool await_suspend(std::coroutine_handle<> h) noexcept
+            {
+                continuation = h;
+                pika::execution::experimental::start(op_state);
+
+                // Whoever of await_suspend and the receiver gets here last
+                // continues the task. The awaiter may be destroyed by the
+                // receiver as soon as it is done with it.
+                if (!done.exchange(true, std::memory_order_acq_rel))
+                {
+                    return true;
+                }
+
+                if (pika::detail::holds_alternative<stopped_type>(result))
+                {
+                    promise.set_stopped();
+                    return true;
+                }
+
+                return false;
+            }
+
+            auto await_resume()
+            {
+                if (pika::detail::holds_alternative<std::exception_ptr>(result))
+                {
+                    std::rethrow_exception(pika::detail::get<std::exception_ptr>(result));
+                }
+
+                if constexpr (!is_void_result)
+                {
+                    return PIKA_MOVE(pika::detail::get<value_type>(result));
+                }
+            }
+
+            void resume() noexcept
+            {
+                if (done.exchange(true, std::memory_order_acq_rel))
+                {
+                    if (pika::detail::holds_alternative<stopped_type>(result))
+                    {
+                        promise.set_stopped();
+                    }
+                    else
+                    {
+                        continuation.resume();
+                    }
+                }
+            }
+
+            task_promise_base& promise;
+            std::coroutine_handle<> continuation;
+            std::atomic<bool> done{false};
+            pika::detail::variant<pika::detail::monostate, value_type, std::exception_ptr,
+                stopped_type>
+                result;
+            connect_result_t<Sender, awaiter_receiver> op_state;
+        };
+    }    // namespace detail
+
+    /// A lazily started C++20 coroutine returning a value of type T. A task
+    /// does not have a stack of its own, the coroutine frame is allocated
+    /// from a cache local to the worker thread. A task runs on the thread
+    /// starting or resuming it.
+    ///
+    /// Tasks can co_await other tasks and any sender sending at most one
+    /// value. Awaiting a sender resumes the task on the thread completing
+    /// the sender, e.g. co_await schedule(sched) continues the task on
+    /// sched. Errors sent by awaited senders are rethrown from the co_await
+    /// expression, and a sender completing with set_stopped completes the
+    /// task and the tasks awaiting it with set_stopped.
+    ///
+    /// A task is a sender sending the value returned by the coroutine, or
+    /// the exception thrown by it as an std::exception_ptr. It can be
+    /// started with e.g. start_detached, sync_wait or let_value. Together
+    /// with a thread_pool_scheduler with the nostack stack size, tasks can
+    /// be run concurrently without allocating a stack for every task.
+    ///
+    /// Tasks must not block the thread running them, e.g. with sync_wait,
+    /// as they may run on threads without a stack of their own.
+    template <typename T>
+    class task
+    {
+    public:
+        using promise_type = detail::task_promise<T>;
+
+        task(task&& other) noexcept
+          : handle(std::exchange(other.handle, {}))
+        {
+        }
+
+        task& operator=(task&& other) noexcept
+        {
+            if (this != &other)
+            {
+                if (handle)
+                {
+                    handle.destroy();
+                }
+                handle = std::exchange(other.handle, {});
+            }
+            return *this;
+        }
+
+        task(task const&) = delete;
+        task& operator=(task const&) = delete;
+
+        ~task()
+        {
+            if (handle)
+            {
+                handle.destroy();
+            }
+        }
+
+        using is_sender = void;
+
+# if defined(PIKA_HAVE_P2300_REFERENCE_IMPLEMENTATION)
+        using completion_signatures = pika::execution::experimental::completion_signatures<
+            std::conditional_t<std::is_void_v<T>, set_value_t(), set_value_t(T)>,
+            set_error_t(std::exception_ptr), set_stopped_t()>;
+# else
+        template <template <typename...> class Tuple, template <typename...> class Variant>
+        using value_types =
+            Variant<std::conditional_t<std::is_void_v<T>, Tuple<>, Tuple<std::decay_t<T>>>>;
+
+        template <template <typename...> class Variant>
+        using error_types = Variant<std::exception_ptr>;
+
+        static constexpr bool sends_done = true;
+# endif
+
+    private:
+        friend struct detail::task_promise<T>;
+        friend class detail::task_awaiter<T>;
+
+        explicit task(std::coroutine_handle<promise_type> handle) noexcept
+          : handle(handle)
+        {
+        }
+
+        template <typename Receiver>
+        struct operation_state
+        {
+            std::coroutine_handle<promise_type> handle;
+            PIKA_NO_UNIQUE_ADDRESS std::decay_t<Receiver> receiver;
+
+            template <typename Receiver_>
+            operation_state(std::coroutine_handle<promise_type> handle, Receiver_&& receiver)
+              : handle(handle)
+              , receiver(PIKA_FORWARD(Receiver_, receiver))
+            {
+                auto& promise = handle.promise();
+                promise.operation_state = this;
+                promise.complete_operation_state = &complete;
+            }
+
+            operation_state(operation_state&&) = delete;
+            operation_state(operation_state const&) = delete;
+            operation_state& operator=(operation_state&&) = delete;
+            operation_state& operator=(operation_state const&) = delete;
+
+            ~operation_state()
+            {
+                if (handle)
+                {
+                    handle.destroy();
+                }
+            }
+
+            // The receiver may destroy the operation state, and with it the
+            // coroutine frame. Results are moved out of the frame first.
+            static void complete(void* p) noexcept
+            {
+                auto& os = *static_cast<operation_state*>(p);
+                auto& promise = os.handle.promise();
+
+                if (promise.stopped)
+                {
+                    pika::execution::experimental::set_stopped(PIKA_MOVE(os.receiver));
+                }
+                else if (promise.exception)
+                {
+                    std::exception_ptr ep = PIKA_MOVE(promise.exception);
+                    pika::execution::experimental::set_error(PIKA_MOVE(os.receiver), PIKA_MOVE(ep));
+                }
+                else if constexpr (std::is_void_v<T>)
+                {
+                    pika::execution::experimental::set_value(PIKA_MOVE(os.receiver));
+                }
+                else
+                {
+                    T value = PIKA_MOVE(*promise.value);
+                    pika::execution::experimental::set_value(
+                        PIKA_MOVE(os.receiver), PIKA_MOVE(value));
+                }
+            }
+
+            friend void tag_invoke(start_t, operation_state& os) noexcept
+            {
+                os.handle.resume();
+            }
+        };
+
+        template <typename Receiver>
+        friend operation_state<Receiver> tag_invoke(connect_t, task&& t, Receiver&& receiver)
+        {
+            PIKA_ASSERT(t.handle);
+            return {std::exchange(t.handle, {}), PIKA_FORWARD(Receiver, receiver)};
+        }
+
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    namespace detail {
+        template <typename T>
+        task<T> task_promise<T>::get_return_object() noexcept
+        {
+            return task<T>(std::coroutine_handle<task_promise<T>>::from_promise(*this));
+        }
+
+        inline task<void> task_promise<void>::get_return_object() noexcept
+        {
+            return task<void>(std::coroutine_handle<task_promise<void>>::from_promise(*this));
+        }
+    }    // namespace detail
+}    // namespace pika::execution::experimental
+
+#endif
@@ -0,0 +1,120 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+
+#if defined(PIKA_HAVE_CXX20_COROUTINES)
+# include <pika/execution/task.hpp>
+
+# include <array>
+# include <cstddef>
+# include <new>
+
+namespace pika::execution::experimental::detail {
+    namespace {
+        // Frames are rounded up to multiples of frame_granularity bytes. Each
+        // size class keeps a list of at most max_cached_frames free frames.
+        // Larger frames are not cached.
+        constexpr std::size_t frame_granularity = 64;
+        constexpr std::size_t num_size_classes = 32;
+        constexpr std::size_t max_cached_frames = 1024;
+
+        struct free_frame
+        {
+            free_frame* next;
+        };
+
+        class frame_cache
+        {
+        public:
+            frame_cache() = default;
+            frame_cache(frame_cache const&) = delete;
+            frame_cache& operator=(frame_cache const&) = delete;
+
+            ~frame_cache()
+            {
+                for (auto& c : size_classes)
+                {
+                    while (c.head != nullptr)
+                    {
+                        free_frame* f = c.head;
+                        c.head = f->next;
+                        ::operator delete(f);
+                    }
+                }
+            }
+
+            void* allocate(std::size_t size_class)
+            {
+                auto& c = size_classes[size_class];
+                if (c.head != nullptr)
+                {
+                    free_frame* f = c.head;
+                    c.head = f->next;
+                    --c.count;
+                    return f;
+                }
+                return ::operator new((size_class + 1) * frame_granularity);
+            }
+
+            void deallocate(void* p, std::size_t size_class) noexcept
+            {
+                auto& c = size_classes[size_class];
+                if (c.count == max_cached_frames)
+                {
+                    ::operator delete(p);
+                    return;
+                }
+                c.head = ::new (p) free_frame{c.head};
+                ++c.count;
+            }
+
+        private:
+            struct size_class_list
+            {
+                free_frame* head = nullptr;
+                std::size_t count = 0;
+            };
+
+            std::array<size_class_list, num_size_classes> size_classes;
+        };
+
+        // Worker threads are OS threads, a thread local cache is a cache per
+        // worker. Frames freed on another worker are cached by that worker.
+        frame_cache& get_frame_cache()
+        {
+            thread_local frame_cache cache;
+            return cache;
+        }
+
+        constexpr std::size_t get_size_class(std::size_t size) noexcept
+        {
+            return (size + frame_granularity - 1) / frame_granularity - 1;
+        }
+    }    // namespace
+
+    void* allocate_task_frame(std::size_t size)
+    {
+        std::size_t const size_class = get_size_class(size);
+        if (size == 0 || size_class >= num_size_classes)
+        {
+            return ::operator new(size);
+        }
+        return get_frame_cache().allocate(size_class);
+    }
+
+    void deallocate_task_frame(void* p, std::size_t size) noexcept
+    {
+        std::size_t const size_class = get_size_class(size);
+        if (size == 0 || size_class >= num_size_classes)
+        {
+            ::operator delete(p);
+            return;
+        }
+        get_frame_cache().deallocate(p, size_class);
+    }
+}    // namespace pika::execution::experimental::detail
+#endif
@@ -0,0 +1,331 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/execution/task.hpp>
+#include <pika/modules/execution.hpp>
+#include <pika/testing.hpp>
+
+#include "algorithm_test_utils.hpp"
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <utility>
+
+namespace ex = pika::execution::experimental;
+
+// Completes with set_stopped
+struct stopped_sender
+{
+    template <template <typename...> class Tuple, template <typename...> class Variant>
+    using value_types = Variant<Tuple<>>;
+
+    template <template <typename...> class Variant>
+    using error_types = Variant<>;
+
+    static constexpr bool sends_done = true;
+
+    using completion_signatures = pika::execution::experimental::completion_signatures<
+        pika::execution::experimental::set_value_t(),
+        pika::execution::experimental::set_stopped_t()>;
+
+    template <typename R>
+    struct operation_state
+    {
+        std::decay_t<R> r;
+        friend void tag_invoke(ex::start_t, operation_state& os) noexcept
+        {
+            ex::set_stopped(std::move(os.r));
+        }
+    };
+
+    template <typename R>
+    friend operation_state<R> tag_invoke(ex::connect_t, stopped_sender, R&& r)
+    {
+        return {std::forward<R>(r)};
+    }
+};
+
+// Sends 42 from a new thread
+struct thread_sender
+{
+    template <template <typename...> class Tuple, template <typename...> class Variant>
+    using value_types = Variant<Tuple<int>>;
+
+    template <template <typename...> class Variant>
+    using error_types = Variant<>;
+
+    static constexpr bool sends_done = false;
+
+    using completion_signatures = pika::execution::experimental::completion_signatures<
+        pika::execution::experimental::set_value_t(int)>;
+
+    template <typename R>
+    struct operation_state
+    {
+        std::decay_t<R> r;
+
+        // The receiver may destroy the operation state on the new thread
+        friend void tag_invoke(ex::start_t, operation_state& os) noexcept
+        {
+            std::thread([&os] { ex::set_value(std::move(os.r), 42); }).detach();
+        }
+    };
+
+    template <typename R>
+    friend operation_state<R> tag_invoke(ex::connect_t, thread_sender, R&& r)
+    {
+        return {std::forward<R>(r)};
+    }
+};
+
+struct stopped_receiver
+{
+    std::atomic<bool>& set_stopped_called;
+
+    template <typename E>
+    friend void tag_invoke(ex::set_error_t, stopped_receiver&&, E&&) noexcept
+    {
+        PIKA_TEST(false);
+    }
+
+    friend void tag_invoke(ex::set_stopped_t, stopped_receiver&& r) noexcept
+    {
+        r.set_stopped_called = true;
+    }
+
+    template <typename... Ts>
+    friend void tag_invoke(ex::set_value_t, stopped_receiver&&, Ts&&...) noexcept
+    {
+        PIKA_TEST(false);
+    }
+
+    friend constexpr ex::empty_env tag_invoke(ex::get_env_t, stopped_receiver const&) noexcept
+    {
+        return {};
+    }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+ex::task<int> return_int(int x)
+{
+    co_return x;
+}
+
+ex::task<> return_void(bool& called)
+{
+    called = true;
+    co_return;
+}
+
+ex::task<std::unique_ptr<int>> return_move_only()
+{
+    co_return std::make_unique<int>(42);
+}
+
+ex::task<int> throw_error()
+{
+    throw std::runtime_error("error");
+    co_return 0;
+}
+
+ex::task<int> await_tasks()
+{
+    bool called = false;
+    co_await return_void(called);
+    PIKA_TEST(called);
+
+    int const x = co_await return_int(1);
+    std::unique_ptr<int> p = co_await return_move_only();
+    co_return x + *p;
+}
+
+ex::task<int> recurse(int depth)
+{
+    if (depth == 0)
+    {
+        co_return 0;
+    }
+    co_return 1 + co_await recurse(depth - 1);
+}
+
+ex::task<std::string> await_senders()
+{
+    co_await void_sender{};
+    int const x = co_await ex::just(42);
+    std::string s = co_await (ex::just(std::string("hello")) | ex::then([](std::string s) {
+        return s + " world";
+    }));
+    int const y = co_await thread_sender{};
+    PIKA_TEST_EQ(x, y);
+    co_return s;
+}
+
+ex::task<int> await_error_sender()
+{
+    bool exception_thrown = false;
+    try
+    {
+        co_await error_sender<>{};
+        PIKA_TEST(false);
+    }
+    catch (std::runtime_error const& e)
+    {
+        PIKA_TEST_EQ(std::string(e.what()), std::string("error"));
+        exception_thrown = true;
+    }
+    PIKA_TEST(exception_thrown);
+
+    exception_thrown = false;
+    try
+    {
+        co_await throw_error();
+        PIKA_TEST(false);
+    }
+    catch (std::runtime_error const&)
+    {
+        exception_thrown = true;
+    }
+    PIKA_TEST(exception_thrown);
+
+    co_await error_sender<>{};
+    PIKA_TEST(false);
+    co_return 0;
+}
+
+ex::task<int> await_stopped_sender(bool& resumed)
+{
+    co_await stopped_sender{};
+    resumed = true;
+    co_return 0;
+}
+
+ex::task<int> await_stopped_task(bool& resumed, bool& inner_resumed)
+{
+    co_await await_stopped_sender(inner_resumed);
+    resumed = true;
+    co_return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main()
+{
+    static_assert(ex::is_sender_v<ex::task<int>>);
+    static_assert(ex::is_sender_v<ex::task<>>);
+
+    // Tasks are lazy and complete with the returned value
+    {
+        bool called = false;
+        std::atomic<bool> set_value_called{false};
+        auto t = return_void(called);
+        PIKA_TEST(!called);
+        auto f = [] {};
+        auto r = callback_receiver<decltype(f)>{f, set_value_called};
+        auto os = ex::connect(std::move(t), std::move(r));
+        PIKA_TEST(!called);
+        ex::start(os);
+        PIKA_TEST(called);
+        PIKA_TEST(set_value_called);
+    }
+
+    {
+        std::atomic<bool> set_value_called{false};
+        auto f = [](std::unique_ptr<int> p) { PIKA_TEST_EQ(*p, 42); };
+        auto r = callback_receiver<decltype(f)>{f, set_value_called};
+        auto os = ex::connect(return_move_only(), std::move(r));
+        ex::start(os);
+        PIKA_TEST(set_value_called);
+    }
+
+    // Tasks can await other tasks and senders
+    {
+        std::atomic<bool> set_value_called{false};
+        auto f = [](int x) { PIKA_TEST_EQ(x, 43); };
+        auto r = callback_receiver<decltype(f)>{f, set_value_called};
+        auto os = ex::connect(await_tasks(), std::move(r));
+        ex::start(os);
+        PIKA_TEST(set_value_called);
+    }
+
+    {
+        std::atomic<bool> set_value_called{false};
+        auto f = [](int x) { PIKA_TEST_EQ(x, 1000); };
+        auto r = callback_receiver<decltype(f)>{f, set_value_called};
+        auto os = ex::connect(recurse(1000), std::move(r));
+        ex::start(os);
+        PIKA_TEST(set_value_called);
+    }
+
+    // The task is resumed on the thread completing the sender
+    {
+        std::atomic<bool> set_value_called{false};
+        auto f = [](std::string s) { PIKA_TEST_EQ(s, std::string("hello world")); };
+        auto r = callback_receiver<decltype(f)>{f, set_value_called};
+        auto os = ex::connect(await_senders(), std::move(r));
+        ex::start(os);
+        while (!set_value_called)
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    // Tasks can be used with sender adaptors
+    {
+        std::atomic<bool> set_value_called{false};
+        auto f = [](int x) { PIKA_TEST_EQ(x, 44); };
+        auto r = callback_receiver<decltype(f)>{f, set_value_called};
+        auto os = ex::connect(
+            ex::just(43) | ex::let_value([](int& x) { return return_int(x); }) |
+                ex::then([](int x) { return x + 1; }),
+            std::move(r));
+        ex::start(os);
+        PIKA_TEST(set_value_called);
+    }
+
+    // Exceptions are sent as errors
+    {
+        std::atomic<bool> set_error_called{false};
+        auto f = [](std::exception_ptr ep) {
+            PIKA_TEST_THROW(std::rethrow_exception(ep), std::runtime_error);
+        };
+        auto r = error_callback_receiver<decltype(f)>{f, set_error_called};
+        auto os = ex::connect(await_error_sender(), std::move(r));
+        ex::start(os);
+        PIKA_TEST(set_error_called);
+    }
+
+    // Stopped senders complete the task and the tasks awaiting it with
+    // set_stopped
+    {
+        bool resumed = false;
+        bool inner_resumed = false;
+        std::atomic<bool> set_stopped_called{false};
+        auto os = ex::connect(await_stopped_task(resumed, inner_resumed),
+            stopped_receiver{set_stopped_called});
+        ex::start(os);
+        PIKA_TEST(set_stopped_called);
+        PIKA_TEST(!resumed);
+        PIKA_TEST(!inner_resumed);
+    }
+
+    // Frames are reused from the cache of the thread
+    {
+        void* p = ex::detail::allocate_task_frame(200);
+        ex::detail::deallocate_task_frame(p, 200);
+        void* q = ex::detail::allocate_task_frame(250);
+        PIKA_TEST_EQ(p, q);
+        ex::detail::deallocate_task_frame(q, 250);
+
+        void* large = ex::detail::allocate_task_frame(1 << 20);
+        ex::detail::deallocate_task_frame(large, 1 << 20);
+    }
+
+    return pika::detail::report_errors();
+}
@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <pika/config.hpp>
 #include <pika/assert.hpp>
 #include <pika/errors/error.hpp>
 #include <pika/errors/throw_exception.hpp>
@@ -81,10 +82,46 @@ namespace pika::detail {
     }
 #endif
 
+    // Allocate and free storage for objects that don't fit in the embedded
+    // storage of movable_sbo_storage. Small blocks are rounded up to a size
+    // class and freed blocks are cached by the freeing thread, so that
+    // repeatedly creating and destroying type-erased objects of similar size
+    // does not go through the global allocator.
+    PIKA_EXPORT void* allocate_sbo_heap_storage(std::size_t size, std::size_t alignment);
+    PIKA_EXPORT void deallocate_sbo_heap_storage(void* p) noexcept;
+
+    template <typename T, typename... Ts>
+    T* sbo_heap_construct(Ts&&... ts)
+    {
+        void* p = allocate_sbo_heap_storage(sizeof(T), alignof(T));
+        try
+        {
+            return new (p) T(PIKA_FORWARD(Ts, ts)...);
+        }
+        catch (...)
+        {
+            deallocate_sbo_heap_storage(p);
+            throw;
+        }
+    }
+
+    // Destroys an object created with sbo_heap_construct through a pointer
+    // to its base class. Like the embedded storage this relies on the base
+    // class being at the start of the object.
+    template <typename T>
+    void sbo_heap_destroy(T* p) noexcept
+    {
+        p->~T();
+        deallocate_sbo_heap_storage(p);
+    }
+
     template <typename Base, std::size_t EmbeddedStorageSize,
         std::size_t AlignmentSize = sizeof(void*)>
     class movable_sbo_storage
     {
+        static_assert(EmbeddedStorageSize >= sizeof(void*),
+            "The embedded storage must be able to hold at least a pointer");
+
     protected:
         using base_type = Base;
         static constexpr std::size_t embedded_storage_size = EmbeddedStorageSize;
@@ -133,7 +170,7 @@ namespace pika::detail {
             }
             else
             {
-                delete heap_storage;
+                sbo_heap_destroy(heap_storage);
                 heap_storage = nullptr;
             }
 
@@ -229,7 +266,7 @@ namespace pika::detail {
             }
             else
             {
-                heap_storage = new Impl(PIKA_FORWARD(Ts, ts)...);
+                heap_storage = sbo_heap_construct<Impl>(PIKA_FORWARD(Ts, ts)...);
                 object = heap_storage;
             }
         }
@@ -351,6 +388,11 @@ namespace pika::execution::experimental::detail {
         using base_type = detail::any_operation_state_base;
         template <typename Sender, typename Receiver>
         using impl_type = detail::any_operation_state_impl<Sender, Receiver>;
+        // The embedded storage holds operation states of senders that are not
+        // type-erased themselves. The operation state of a type-erased stage
+        // contains the any_operation_state of its predecessor and never fits,
+        // however large the embedded storage is. Such operation states use
+        // the size-class pool instead.
         using storage_type = pika::detail::movable_sbo_storage<base_type, 8 * sizeof(void*)>;
 
         storage_type storage{};
@@ -652,7 +694,7 @@ namespace pika::execution::experimental::detail {
 
         any_sender_base<Ts...>* clone() const override
         {
-            return new any_sender_impl(sender);
+            return pika::detail::sbo_heap_construct<any_sender_impl>(sender);
         }
 
         void clone_into(void* p) const override
@@ -673,6 +715,10 @@ namespace pika::execution::experimental::detail {
 }    // namespace pika::execution::experimental::detail
 
 namespace pika::execution::experimental {
+    namespace detail {
+        inline constexpr std::size_t default_any_sender_embedded_storage_size = 4 * sizeof(void*);
+    }    // namespace detail
+
 #if !defined(PIKA_HAVE_CXX20_TRIVIAL_VIRTUAL_DESTRUCTOR)
     namespace detail {
         // This helper only exists to make it possible to use
@@ -698,8 +744,13 @@ namespace pika::execution::experimental {
     }    // namespace detail
 #endif
 
-    template <typename... Ts>
-    class unique_any_sender
+    /// \brief A type-erased, move-only sender sending Ts.
+    ///
+    /// Senders up to EmbeddedStorageSize bytes are stored in the
+    /// basic_unique_any_sender itself. Larger senders are allocated from a
+    /// thread-local pool of blocks of a few size classes.
+    template <std::size_t EmbeddedStorageSize, typename... Ts>
+    class basic_unique_any_sender
 #if !defined(PIKA_HAVE_CXX20_TRIVIAL_VIRTUAL_DESTRUCTOR)
       : private detail::any_sender_static_empty_vtable_helper<Ts...>
 #endif
@@ -707,33 +758,35 @@ namespace pika::execution::experimental {
         using base_type = detail::unique_any_sender_base<Ts...>;
         template <typename Sender>
         using impl_type = detail::unique_any_sender_impl<Sender, Ts...>;
-        using storage_type = pika::detail::movable_sbo_storage<base_type, 4 * sizeof(void*)>;
+        using storage_type = pika::detail::movable_sbo_storage<base_type, EmbeddedStorageSize>;
 
         storage_type storage{};
 
     public:
-        unique_any_sender() = default;
+        basic_unique_any_sender() = default;
 
         template <typename Sender,
-            typename = std::enable_if_t<!std::is_same_v<std::decay_t<Sender>, unique_any_sender>>>
-        unique_any_sender(Sender&& sender)
+            typename =
+                std::enable_if_t<!std::is_same_v<std::decay_t<Sender>, basic_unique_any_sender>>>
+        basic_unique_any_sender(Sender&& sender)
         {
             storage.template store<impl_type<Sender>>(PIKA_FORWARD(Sender, sender));
         }
 
         template <typename Sender,
-            typename = std::enable_if_t<!std::is_same_v<std::decay_t<Sender>, unique_any_sender>>>
-        unique_any_sender& operator=(Sender&& sender)
+            typename =
+                std::enable_if_t<!std::is_same_v<std::decay_t<Sender>, basic_unique_any_sender>>>
+        basic_unique_any_sender& operator=(Sender&& sender)
         {
             storage.template store<impl_type<Sender>>(PIKA_FORWARD(Sender, sender));
             return *this;
         }
 
-        ~unique_any_sender() = default;
-        unique_any_sender(unique_any_sender&&) = default;
-        unique_any_sender(unique_any_sender const&) = delete;
-        unique_any_sender& operator=(unique_any_sender&&) = default;
-        unique_any_sender& operator=(unique_any_sender const&) = delete;
+        ~basic_unique_any_sender() = default;
+        basic_unique_any_sender(basic_unique_any_sender&&) = default;
+        basic_unique_any_sender(basic_unique_any_sender const&) = delete;
+        basic_unique_any_sender& operator=(basic_unique_any_sender&&) = default;
+        basic_unique_any_sender& operator=(basic_unique_any_sender const&) = delete;
 
         template <template <typename...> class Tuple, template <typename...> class Variant>
         using value_types = Variant<Tuple<Ts...>>;
@@ -750,7 +803,7 @@ namespace pika::execution::experimental {
 
         template <typename R>
         friend detail::any_operation_state
-        tag_invoke(pika::execution::experimental::connect_t, unique_any_sender&& s, R&& r)
+        tag_invoke(pika::execution::experimental::connect_t, basic_unique_any_sender&& s, R&& r)
         {
             // We first move the storage to a temporary variable so that this
             // any_sender is empty after this connect. Doing
@@ -763,7 +816,7 @@ namespace pika::execution::experimental {
 
         template <typename R>
         friend detail::any_operation_state
-        tag_invoke(pika::execution::experimental::connect_t, unique_any_sender const&, R&&)
+        tag_invoke(pika::execution::experimental::connect_t, basic_unique_any_sender const&, R&&)
         {
             static_assert(sizeof(R) == 0,
                 "Are you missing a std::move? unique_any_sender is not copyable and thus not "
@@ -783,8 +836,13 @@ namespace pika::execution::experimental {
         }
     };
 
-    template <typename... Ts>
-    class any_sender
+    /// \brief A type-erased, copyable sender sending Ts.
+    ///
+    /// Senders up to EmbeddedStorageSize bytes are stored in the
+    /// basic_any_sender itself. Larger senders are allocated from a
+    /// thread-local pool of blocks of a few size classes.
+    template <std::size_t EmbeddedStorageSize, typename... Ts>
+    class basic_any_sender
 #if !defined(PIKA_HAVE_CXX20_TRIVIAL_VIRTUAL_DESTRUCTOR)
       : private detail::any_sender_static_empty_vtable_helper<Ts...>
 #endif
@@ -792,16 +850,17 @@ namespace pika::execution::experimental {
         using base_type = detail::any_sender_base<Ts...>;
         template <typename Sender>
         using impl_type = detail::any_sender_impl<Sender, Ts...>;
-        using storage_type = pika::detail::copyable_sbo_storage<base_type, 4 * sizeof(void*)>;
+        using storage_type = pika::detail::copyable_sbo_storage<base_type, EmbeddedStorageSize>;
 
         storage_type storage{};
 
     public:
-        any_sender() = default;
+        basic_any_sender() = default;
 
         template <typename Sender,
-            typename = std::enable_if_t<!std::is_same_v<std::decay_t<Sender>, any_sender>>>
-        any_sender(Sender&& sender)
+            typename =
+                std::enable_if_t<!std::is_same_v<std::decay_t<Sender>, basic_any_sender>>>
+        basic_any_sender(Sender&& sender)
         {
             static_assert(std::is_copy_constructible_v<std::decay_t<Sender>>,
                 "any_sender requires the given sender to be copy constructible. Ensure the used "
@@ -811,8 +870,9 @@ namespace pika::execution::experimental {
         }
 
         template <typename Sender,
-            typename = std::enable_if_t<!std::is_same_v<std::decay_t<Sender>, any_sender>>>
-        any_sender& operator=(Sender&& sender)
+            typename =
+                std::enable_if_t<!std::is_same_v<std::decay_t<Sender>, basic_any_sender>>>
+        basic_any_sender& operator=(Sender&& sender)
         {
             static_assert(std::is_copy_constructible_v<std::decay_t<Sender>>,
                 "any_sender requires the given sender to be copy constructible. Ensure the used "
@@ -822,11 +882,11 @@ namespace pika::execution::experimental {
             return *this;
         }
 
-        ~any_sender() = default;
-        any_sender(any_sender&&) = default;
-        any_sender(any_sender const&) = default;
-        any_sender& operator=(any_sender&&) = default;
-        any_sender& operator=(any_sender const&) = default;
+        ~basic_any_sender() = default;
+        basic_any_sender(basic_any_sender&&) = default;
+        basic_any_sender(basic_any_sender const&) = default;
+        basic_any_sender& operator=(basic_any_sender&&) = default;
+        basic_any_sender& operator=(basic_any_sender const&) = default;
 
         template <template <typename...> class Tuple, template <typename...> class Variant>
         using value_types = Variant<Tuple<Ts...>>;
@@ -843,14 +903,14 @@ namespace pika::execution::experimental {
 
         template <typename R>
         friend detail::any_operation_state
-        tag_invoke(pika::execution::experimental::connect_t, any_sender const& s, R&& r)
+        tag_invoke(pika::execution::experimental::connect_t, basic_any_sender const& s, R&& r)
         {
             return s.storage.get().connect(detail::any_receiver<Ts...>{PIKA_FORWARD(R, r)});
         }
 
         template <typename R>
         friend detail::any_operation_state
-        tag_invoke(pika::execution::experimental::connect_t, any_sender&& s, R&& r)
+        tag_invoke(pika::execution::experimental::connect_t, basic_any_sender&& s, R&& r)
         {
             // We first move the storage to a temporary variable so that this
             // any_sender is empty after this connect. Doing
@@ -872,6 +932,13 @@ namespace pika::execution::experimental {
         }
     };
 
+    template <typename... Ts>
+    using unique_any_sender =
+        basic_unique_any_sender<detail::default_any_sender_embedded_storage_size, Ts...>;
+
+    template <typename... Ts>
+    using any_sender = basic_any_sender<detail::default_any_sender_embedded_storage_size, Ts...>;
+
     namespace detail {
         template <template <typename...> class AnySender, typename Sender>
         auto make_any_sender_impl(Sender&& sender)
@@ -895,6 +962,16 @@ namespace pika::execution::experimental {
 
             return any_sender_type(std::forward<Sender>(sender));
         }
+
+        template <std::size_t EmbeddedStorageSize>
+        struct any_sender_with_embedded_storage_size
+        {
+            template <typename... Ts>
+            using unique_type = basic_unique_any_sender<EmbeddedStorageSize, Ts...>;
+
+            template <typename... Ts>
+            using type = basic_any_sender<EmbeddedStorageSize, Ts...>;
+        };
     }    // namespace detail
 
     template <typename Sender, typename = std::enable_if_t<is_sender_v<Sender>>>
@@ -908,6 +985,24 @@ namespace pika::execution::experimental {
     {
         return detail::make_any_sender_impl<any_sender>(std::forward<Sender>(sender));
     }
+
+    template <std::size_t EmbeddedStorageSize, typename Sender,
+        typename = std::enable_if_t<is_sender_v<Sender>>>
+    auto make_unique_any_sender(Sender&& sender)
+    {
+        using any_sender_types = detail::any_sender_with_embedded_storage_size<EmbeddedStorageSize>;
+        return detail::make_any_sender_impl<any_sender_types::template unique_type>(
+            std::forward<Sender>(sender));
+    }
+
+    template <std::size_t EmbeddedStorageSize, typename Sender,
+        typename = std::enable_if_t<is_sender_v<Sender>>>
+    auto make_any_sender(Sender&& sender)
+    {
+        using any_sender_types = detail::any_sender_with_embedded_storage_size<EmbeddedStorageSize>;
+        return detail::make_any_sender_impl<any_sender_types::template type>(
+            std::forward<Sender>(sender));
+    }
 }    // namespace pika::execution::experimental
 
 namespace pika::detail {
@@ -460,7 +460,7 @@ namespace pika::execution::experimental {
         template <typename T>
         friend constexpr auto tag_fallback_invoke(get_env_t const&, T const&) noexcept
         {
-            if constexpr (is_sender_v<T>)
+            if constexpr (is_sender_v<T> || is_receiver_v<T>)
             {
                 return empty_env{};
             }
@@ -0,0 +1,80 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+#if defined(PIKA_HAVE_P2300_REFERENCE_IMPLEMENTATION)
+# include <pika/execution_base/p2300_forward.hpp>
+#else
+# include <pika/functional/detail/tag_fallback_invoke.hpp>
+
+# include <type_traits>
+# include <utility>
+
+namespace pika::execution::experimental {
+    /// A stop token for which stop can never be requested. This is the stop
+    /// token returned by get_stop_token for environments that don't provide
+    /// a stop token.
+    struct never_stop_token
+    {
+        template <typename F>
+        struct callback_type
+        {
+            template <typename F_>
+            explicit callback_type(never_stop_token, F_&&) noexcept
+            {
+            }
+        };
+
+        static constexpr bool stop_requested() noexcept
+        {
+            return false;
+        }
+
+        static constexpr bool stop_possible() noexcept
+        {
+            return false;
+        }
+
+        friend constexpr bool operator==(never_stop_token, never_stop_token) noexcept
+        {
+            return true;
+        }
+
+        friend constexpr bool operator!=(never_stop_token, never_stop_token) noexcept
+        {
+            return false;
+        }
+    };
+
+    /// get_stop_token is a customization point object returning the stop
+    /// token of an environment, i.e. the environment of a receiver. Operation
+    /// states use the stop token to learn that the result of the operation is
+    /// no longer needed. Environments without a stop token return a
+    /// never_stop_token.
+    inline constexpr struct get_stop_token_t final
+      : pika::functional::detail::tag_fallback<get_stop_token_t>
+    {
+        template <typename Env>
+        friend constexpr never_stop_token tag_fallback_invoke(
+            get_stop_token_t, Env const&) noexcept
+        {
+            return {};
+        }
+    } get_stop_token{};
+
+    template <typename Env>
+    using stop_token_of_t = std::decay_t<decltype(get_stop_token(std::declval<Env>()))>;
+}    // namespace pika::execution::experimental
+#endif
+
+namespace pika::execution::experimental::detail {
+    /// The type of the stop callback calling F which can be registered with a
+    /// stop token of type Token.
+    template <typename Token, typename F>
+    using stop_callback_for_t = typename Token::template callback_type<F>;
+}    // namespace pika::execution::experimental::detail
@@ -10,11 +10,176 @@
 
 #include <fmt/format.h>
 
+#include <array>
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
+#include <new>
 #include <string>
 #include <utility>
 
+namespace pika::detail {
+    namespace {
+        // Blocks handed out by allocate_sbo_heap_storage are preceded by a
+        // header that records how the block has to be freed. The header is
+        // stored in the last bytes before the object so that it can be found
+        // from the pointer to the object alone.
+        struct sbo_heap_header
+        {
+            // The size class of the block, or no_size_class for blocks
+            // allocated directly with the global allocator
+            std::uint32_t size_class;
+
+            // The distance from the start of the block to the object. This
+            // is also the alignment of blocks of over-aligned objects.
+            std::uint32_t offset;
+        };
+
+        constexpr std::uint32_t no_size_class = std::uint32_t(-1);
+        constexpr std::size_t default_offset = alignof(std::max_align_t);
+        static_assert(sizeof(sbo_heap_header) <= default_offset);
+
+        // Size classes are powers of two starting from min_block_size bytes,
+        // including the header.
+        constexpr std::size_t min_block_size = 64;
+        constexpr std::size_t num_size_classes = 7;
+        constexpr std::size_t max_cached_blocks = 32;
+
+        constexpr std::size_t block_size(std::size_t size_class) noexcept
+        {
+            return min_block_size << size_class;
+        }
+
+        constexpr std::uint32_t get_size_class(std::size_t total_size) noexcept
+        {
+            for (std::uint32_t size_class = 0; size_class != num_size_classes; ++size_class)
+            {
+                if (total_size <= block_size(size_class))
+                {
+                    return size_class;
+                }
+            }
+            return no_size_class;
+        }
+
+        struct free_block
+        {
+            free_block* next;
+        };
+
+        // The cache is constant initialized and trivially destructible so
+        // that it can still be accessed when objects are freed during thread
+        // exit after the cached blocks have been released.
+        struct sbo_heap_cache
+        {
+            std::array<free_block*, num_size_classes> free_lists;
+            std::array<std::size_t, num_size_classes> num_blocks;
+            bool released;
+        };
+
+        thread_local sbo_heap_cache cache{};
+
+        struct sbo_heap_cache_release
+        {
+            ~sbo_heap_cache_release()
+            {
+                for (std::size_t size_class = 0; size_class != num_size_classes; ++size_class)
+                {
+                    free_block* block = cache.free_lists[size_class];
+                    while (block != nullptr)
+                    {
+                        free_block* next = block->next;
+                        ::operator delete(block);
+                        block = next;
+                    }
+                    cache.free_lists[size_class] = nullptr;
+                    cache.num_blocks[size_class] = 0;
+                }
+                cache.released = true;
+            }
+        };
+
+        sbo_heap_cache* get_cache() noexcept
+        {
+            if (cache.released)
+            {
+                return nullptr;
+            }
+
+            // Releases the cached blocks on thread exit
+            static thread_local sbo_heap_cache_release release;
+            (void) release;
+
+            return &cache;
+        }
+
+        void* init_block(void* block, std::uint32_t size_class, std::size_t offset) noexcept
+        {
+            void* p = static_cast<char*>(block) + offset;
+            new (static_cast<char*>(p) - sizeof(sbo_heap_header))
+                sbo_heap_header{size_class, static_cast<std::uint32_t>(offset)};
+            return p;
+        }
+    }    // namespace
+
+    void* allocate_sbo_heap_storage(std::size_t size, std::size_t alignment)
+    {
+        if (alignment > default_offset)
+        {
+            void* block = ::operator new(size + alignment, std::align_val_t(alignment));
+            return init_block(block, no_size_class, alignment);
+        }
+
+        std::uint32_t const size_class = get_size_class(size + default_offset);
+        if (size_class == no_size_class)
+        {
+            return init_block(::operator new(size + default_offset), no_size_class, default_offset);
+        }
+
+        if (sbo_heap_cache* c = get_cache(); c != nullptr && c->free_lists[size_class] != nullptr)
+        {
+            free_block* block = c->free_lists[size_class];
+            c->free_lists[size_class] = block->next;
+            --c->num_blocks[size_class];
+            return init_block(block, size_class, default_offset);
+        }
+
+        return init_block(::operator new(block_size(size_class)), size_class, default_offset);
+    }
+
+    void deallocate_sbo_heap_storage(void* p) noexcept
+    {
+        sbo_heap_header const header =
+            *reinterpret_cast<sbo_heap_header*>(static_cast<char*>(p) - sizeof(sbo_heap_header));
+        void* block = static_cast<char*>(p) - header.offset;
+
+        if (header.size_class == no_size_class)
+        {
+            if (header.offset > default_offset)
+            {
+                ::operator delete(block, std::align_val_t(header.offset));
+            }
+            else
+            {
+                ::operator delete(block);
+            }
+            return;
+        }
+
+        if (sbo_heap_cache* c = get_cache();
+            c != nullptr && c->num_blocks[header.size_class] < max_cached_blocks)
+        {
+            free_block* fb = new (block) free_block{c->free_lists[header.size_class]};
+            c->free_lists[header.size_class] = fb;
+            ++c->num_blocks[header.size_class];
+            return;
+        }
+
+        ::operator delete(block);
+    }
+}    // namespace pika::detail
+
 namespace pika::execution::experimental::detail {
     void empty_any_operation_state::start() & noexcept
     {
@@ -193,15 +193,34 @@ namespace pika::execution {
         }
 
         void default_agent::sleep_for(
-            pika::chrono::steady_duration const& sleep_duration, char const* /* desc */)
+            pika::chrono::steady_duration const& sleep_duration, char const* desc)
         {
-            std::this_thread::sleep_for(sleep_duration.value());
+            sleep_until(sleep_duration.from_now(), desc);
         }
 
         void default_agent::sleep_until(
             pika::chrono::steady_time_point const& sleep_time, char const* /* desc */)
         {
-            std::this_thread::sleep_until(sleep_time.value());
+            // Sleep like suspend, but also return when the time has passed
+            std::unique_lock<std::mutex> l(mtx_);
+            PIKA_ASSERT(running_);
+
+            running_ = false;
+            resume_cv_.notify_all();
+
+            while (!running_)
+            {
+                if (suspend_cv_.wait_until(l, sleep_time.value()) == std::cv_status::timeout)
+                {
+                    running_ = true;
+                }
+            }
+
+            if (aborted_)
+            {
+                PIKA_THROW_EXCEPTION(pika::error::yield_aborted, "sleep_until",
+                    "std::thread({}) aborted (yield returned wait_abort)", id_);
+            }
         }
     }}    // namespace detail
 
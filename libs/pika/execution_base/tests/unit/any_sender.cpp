@@ -13,6 +13,8 @@
 #include <pika/testing.hpp>
 
 #include <atomic>
+#include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <string>
 #include <tuple>
@@ -661,6 +663,54 @@ void test_make_any_sender()
                   ex::any_sender<int, std::string, double>>);
 }
 
+void test_embedded_storage_size()
+{
+    using large_any_sender = ex::basic_any_sender<256, int>;
+    using large_unique_any_sender = ex::basic_unique_any_sender<256, int>;
+
+    static_assert(sizeof(large_any_sender) > sizeof(ex::any_sender<int>));
+    static_assert(sizeof(large_unique_any_sender) > sizeof(ex::unique_any_sender<int>));
+    static_assert(
+        std::is_same_v<decltype(ex::make_any_sender<256>(ex::just(42))), large_any_sender>);
+    static_assert(std::is_same_v<decltype(ex::make_unique_any_sender<256>(ex::just(42))),
+        large_unique_any_sender>);
+
+    // large_sender fits in the embedded storage of large_any_sender
+    large_any_sender as1{large_sender<int>{42}};
+    large_any_sender as2 = as1;
+    PIKA_TEST_EQ(tt::sync_wait(std::move(as1)), 42);
+    PIKA_TEST_EQ(tt::sync_wait(as2), 42);
+    PIKA_TEST_EQ(tt::sync_wait(std::move(as2)), 42);
+
+    large_unique_any_sender uas{large_non_copyable_sender<int>{43}};
+    PIKA_TEST_EQ(tt::sync_wait(std::move(uas)), 43);
+
+    // Type-erased senders with different embedded storage can wrap each other
+    ex::any_sender<int> as3{ex::make_any_sender<256>(ex::just(44))};
+    PIKA_TEST_EQ(tt::sync_wait(std::move(as3)), 44);
+}
+
+void test_sbo_heap_storage()
+{
+    // Blocks of the same size class are reused by the freeing thread
+    void* p1 = pika::detail::allocate_sbo_heap_storage(100, alignof(std::max_align_t));
+    pika::detail::deallocate_sbo_heap_storage(p1);
+    void* p2 = pika::detail::allocate_sbo_heap_storage(90, alignof(std::max_align_t));
+    PIKA_TEST_EQ(p1, p2);
+    pika::detail::deallocate_sbo_heap_storage(p2);
+
+    // Large and over-aligned blocks go directly to the global allocator
+    void* p3 = pika::detail::allocate_sbo_heap_storage(1 << 20, alignof(std::max_align_t));
+    PIKA_TEST_EQ(reinterpret_cast<std::uintptr_t>(p3) % alignof(std::max_align_t),
+        std::uintptr_t(0));
+    pika::detail::deallocate_sbo_heap_storage(p3);
+
+    constexpr std::size_t large_alignment = 4 * alignof(std::max_align_t);
+    void* p4 = pika::detail::allocate_sbo_heap_storage(100, large_alignment);
+    PIKA_TEST_EQ(reinterpret_cast<std::uintptr_t>(p4) % large_alignment, std::uintptr_t(0));
+    pika::detail::deallocate_sbo_heap_storage(p4);
+}
+
 void test_when_all()
 {
     ex::any_sender<> as1{ex::just()};
@@ -762,5 +812,10 @@ int main()
     // Test using any_senders together with when_all
     test_when_all();
 
+    // Test choosing the embedded storage size and the heap storage used for
+    // senders that don't fit in the embedded storage
+    test_embedded_storage_size();
+    test_sbo_heap_storage();
+
     return 0;
 }
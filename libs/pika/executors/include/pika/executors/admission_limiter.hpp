@@ -0,0 +1,346 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+
+#if defined(PIKA_HAVE_P2300_REFERENCE_IMPLEMENTATION)
+# include <pika/execution_base/p2300_forward.hpp>
+#endif
+
+#include <pika/concepts/concepts.hpp>
+#include <pika/execution/algorithms/detail/partial_algorithm.hpp>
+#include <pika/execution_base/operation_state.hpp>
+#include <pika/execution_base/receiver.hpp>
+#include <pika/execution_base/sender.hpp>
+#include <pika/functional/detail/tag_fallback_invoke.hpp>
+#include <pika/synchronization/spinlock.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+#include <pika/config/warnings_prefix.hpp>
+
+namespace pika::execution::experimental {
+    struct admission_limiter_statistics
+    {
+        // Number of operations admitted
+        std::uint64_t admitted = 0;
+        // Number of admitted operations that had to wait
+        std::uint64_t waited = 0;
+        // Number of operations admitted and not yet released
+        std::size_t in_flight = 0;
+        // Number of operations currently waiting
+        std::size_t queue_depth = 0;
+        // Largest number of operations waiting at the same time
+        std::size_t max_queue_depth = 0;
+        // Total and largest time spent waiting by the operations that had to
+        // wait, from the start of the operation to its admission
+        std::chrono::nanoseconds total_wait_time{0};
+        std::chrono::nanoseconds max_wait_time{0};
+    };
+
+    namespace detail {
+        // An operation waiting to be admitted. The nodes are embedded in the
+        // operation states of the senders so that waiting does not allocate.
+        struct admission_waiter
+        {
+            admission_waiter* next = nullptr;
+            void (*resume)(admission_waiter*) noexcept = nullptr;
+            std::chrono::steady_clock::time_point enqueue_time;
+        };
+    }    // namespace detail
+
+    /// Limits the number of operations in flight. At most limit operations
+    /// are admitted at a time. Further operations wait in an intrusive FIFO
+    /// queue without blocking a thread, and are admitted in the order they
+    /// started as admitted operations are released. The limit can be changed
+    /// at any time, raising it admits waiting operations immediately.
+    ///
+    /// Operations are admitted through the sender returned by acquire, which
+    /// completes once admitted and has to be followed by a call to release,
+    /// or through the admit sender adaptor and limiting_scheduler, which
+    /// release automatically. Waiting operations are admitted on the thread
+    /// releasing an operation or raising the limit. A pika thread can wait
+    /// for admission with sync_wait(limiter.acquire()), which suspends the
+    /// thread until it is admitted.
+    ///
+    /// The limiter has to outlive all operations using it.
+    class admission_limiter
+    {
+    public:
+        PIKA_EXPORT explicit admission_limiter(std::size_t limit);
+        PIKA_EXPORT ~admission_limiter();
+
+        admission_limiter(admission_limiter&&) = delete;
+        admission_limiter(admission_limiter const&) = delete;
+        admission_limiter& operator=(admission_limiter&&) = delete;
+        admission_limiter& operator=(admission_limiter const&) = delete;
+
+        /// Changes the maximum number of operations in flight. Lowering the
+        /// limit does not affect operations that have already been admitted.
+        PIKA_EXPORT void set_limit(std::size_t limit) noexcept;
+        PIKA_EXPORT std::size_t get_limit() const noexcept;
+
+        /// Admits an operation if the limit has not been reached and no
+        /// other operations are waiting. Returns true if the operation has
+        /// been admitted.
+        PIKA_EXPORT bool try_acquire() noexcept;
+
+        /// Releases an admitted operation and admits the next waiting
+        /// operation, if any.
+        PIKA_EXPORT void release() noexcept;
+
+        PIKA_EXPORT admission_limiter_statistics get_statistics() const;
+
+        /// Resets the cumulative statistics. The maximum queue depth is set
+        /// to the current queue depth.
+        PIKA_EXPORT void reset_statistics() noexcept;
+
+        /// \cond NOINTERNAL
+        // Admits the waiter immediately or adds it to the queue
+        PIKA_EXPORT void add_waiter(detail::admission_waiter* waiter) noexcept;
+        /// \endcond
+
+    private:
+        template <typename Receiver>
+        struct acquire_operation_state : detail::admission_waiter
+        {
+            admission_limiter& limiter;
+            PIKA_NO_UNIQUE_ADDRESS std::decay_t<Receiver> receiver;
+
+            template <typename Receiver_>
+            acquire_operation_state(admission_limiter& limiter, Receiver_&& receiver)
+              : limiter(limiter)
+              , receiver(PIKA_FORWARD(Receiver_, receiver))
+            {
+                resume = [](detail::admission_waiter* waiter) noexcept {
+                    auto& os = static_cast<acquire_operation_state&>(*waiter);
+                    pika::execution::experimental::set_value(PIKA_MOVE(os.receiver));
+                };
+            }
+
+            acquire_operation_state(acquire_operation_state&&) = delete;
+            acquire_operation_state(acquire_operation_state const&) = delete;
+            acquire_operation_state& operator=(acquire_operation_state&&) = delete;
+            acquire_operation_state& operator=(acquire_operation_state const&) = delete;
+
+            friend void tag_invoke(
+                pika::execution::experimental::start_t, acquire_operation_state& os) noexcept
+            {
+                os.limiter.add_waiter(&os);
+            }
+        };
+
+        struct acquire_sender
+        {
+            using is_sender = void;
+
+            admission_limiter* limiter;
+
+            template <template <typename...> class Tuple, template <typename...> class Variant>
+            using value_types = Variant<Tuple<>>;
+
+            template <template <typename...> class Variant>
+            using error_types = Variant<>;
+
+            static constexpr bool sends_done = false;
+
+            using completion_signatures = pika::execution::experimental::completion_signatures<
+                pika::execution::experimental::set_value_t()>;
+
+            template <typename Receiver>
+            friend acquire_operation_state<Receiver> tag_invoke(
+                pika::execution::experimental::connect_t, acquire_sender s, Receiver&& receiver)
+            {
+                return {*s.limiter, PIKA_FORWARD(Receiver, receiver)};
+            }
+        };
+
+    public:
+        /// Returns a sender that completes with set_value() once an
+        /// operation has been admitted. The admitted operation has to be
+        /// released with release.
+        acquire_sender acquire() noexcept
+        {
+            return {this};
+        }
+
+    private:
+        void drain(std::unique_lock<pika::spinlock>& l) noexcept;
+
+        mutable pika::spinlock mtx_;
+        std::size_t limit_;
+        std::size_t in_flight_ = 0;
+        detail::admission_waiter* head_ = nullptr;
+        detail::admission_waiter* tail_ = nullptr;
+        std::size_t queue_depth_ = 0;
+        // Set while a thread admits waiting operations
+        bool draining_ = false;
+        admission_limiter_statistics statistics_;
+    };
+}    // namespace pika::execution::experimental
+
+namespace pika::admit_detail {
+    template <typename Sender, typename Receiver>
+    struct operation_state : pika::execution::experimental::detail::admission_waiter
+    {
+        // Releases the admitted operation before forwarding the completion,
+        // so that the receiver may wait for other operations admitted by the
+        // same limiter
+        struct admitted_receiver
+        {
+            using is_receiver = void;
+
+            operation_state& op;
+
+            template <typename Error>
+            friend void tag_invoke(pika::execution::experimental::set_error_t,
+                admitted_receiver&& r, Error&& error) noexcept
+            {
+                r.op.limiter.release();
+                pika::execution::experimental::set_error(
+                    PIKA_MOVE(r.op.receiver), PIKA_FORWARD(Error, error));
+            }
+
+            friend void tag_invoke(
+                pika::execution::experimental::set_stopped_t, admitted_receiver&& r) noexcept
+            {
+                r.op.limiter.release();
+                pika::execution::experimental::set_stopped(PIKA_MOVE(r.op.receiver));
+            }
+
+            template <typename... Ts>
+            friend auto tag_invoke(pika::execution::experimental::set_value_t,
+                admitted_receiver&& r, Ts&&... ts) noexcept
+                -> decltype(pika::execution::experimental::set_value(
+                                std::declval<std::decay_t<Receiver>&&>(), PIKA_FORWARD(Ts, ts)...),
+                    void())
+            {
+                r.op.limiter.release();
+                pika::execution::experimental::set_value(
+                    PIKA_MOVE(r.op.receiver), PIKA_FORWARD(Ts, ts)...);
+            }
+
+            friend constexpr decltype(auto) tag_invoke(
+                pika::execution::experimental::get_env_t, admitted_receiver const& r) noexcept
+            {
+                return pika::execution::experimental::get_env(r.op.receiver);
+            }
+        };
+
+        pika::execution::experimental::admission_limiter& limiter;
+        PIKA_NO_UNIQUE_ADDRESS std::decay_t<Receiver> receiver;
+        std::decay_t<pika::execution::experimental::connect_result_t<Sender, admitted_receiver>>
+            sender_op_state;
+
+        template <typename Sender_, typename Receiver_>
+        operation_state(Sender_&& sender,
+            pika::execution::experimental::admission_limiter& limiter, Receiver_&& receiver)
+          : limiter(limiter)
+          , receiver(PIKA_FORWARD(Receiver_, receiver))
+          , sender_op_state(pika::execution::experimental::connect(
+                PIKA_FORWARD(Sender_, sender), admitted_receiver{*this}))
+        {
+            resume = [](pika::execution::experimental::detail::admission_waiter* waiter) noexcept {
+                pika::execution::experimental::start(
+                    static_cast<operation_state&>(*waiter).sender_op_state);
+            };
+        }
+
+        operation_state(operation_state&&) = delete;
+        operation_state(operation_state const&) = delete;
+        operation_state& operator=(operation_state&&) = delete;
+        operation_state& operator=(operation_state const&) = delete;
+
+        friend void tag_invoke(pika::execution::experimental::start_t, operation_state& os) noexcept
+        {
+            os.limiter.add_waiter(&os);
+        }
+    };
+
+    template <typename Sender>
+    struct admit_sender_impl
+    {
+        struct admit_sender_type;
+    };
+
+    template <typename Sender>
+    using admit_sender = typename admit_sender_impl<Sender>::admit_sender_type;
+
+    template <typename Sender>
+    struct admit_sender_impl<Sender>::admit_sender_type
+    {
+        using is_sender = void;
+
+        PIKA_NO_UNIQUE_ADDRESS std::decay_t<Sender> sender;
+        pika::execution::experimental::admission_limiter* limiter;
+
+#if defined(PIKA_HAVE_P2300_REFERENCE_IMPLEMENTATION)
+        using completion_signatures = pika::execution::experimental::make_completion_signatures<
+            Sender, pika::execution::experimental::empty_env>;
+#else
+        template <template <typename...> class Tuple, template <typename...> class Variant>
+        using value_types = typename pika::execution::experimental::sender_traits<
+            Sender>::template value_types<Tuple, Variant>;
+
+        template <template <typename...> class Variant>
+        using error_types = typename pika::execution::experimental::sender_traits<
+            Sender>::template error_types<Variant>;
+
+        static constexpr bool sends_done =
+            pika::execution::experimental::sender_traits<Sender>::sends_done;
+#endif
+
+        template <typename Receiver>
+        friend operation_state<Sender, Receiver> tag_invoke(
+            pika::execution::experimental::connect_t, admit_sender_type&& s, Receiver&& receiver)
+        {
+            return {PIKA_MOVE(s.sender), *s.limiter, PIKA_FORWARD(Receiver, receiver)};
+        }
+
+        template <typename Receiver>
+        friend operation_state<Sender, Receiver> tag_invoke(
+            pika::execution::experimental::connect_t, admit_sender_type const& s,
+            Receiver&& receiver)
+        {
+            return {s.sender, *s.limiter, PIKA_FORWARD(Receiver, receiver)};
+        }
+    };
+}    // namespace pika::admit_detail
+
+namespace pika::execution::experimental {
+    /// admit starts the given sender once the limiter admits it, and
+    /// releases the admitted operation when the sender completes. The
+    /// operation waits in the queue of the limiter until then, without
+    /// blocking a thread.
+    inline constexpr struct admit_t final : pika::functional::detail::tag_fallback<admit_t>
+    {
+    private:
+        template <typename Sender, PIKA_CONCEPT_REQUIRES_(is_sender_v<Sender>)>
+        friend constexpr PIKA_FORCEINLINE auto
+        tag_fallback_invoke(admit_t, Sender&& sender, admission_limiter& limiter)
+        {
+            return admit_detail::admit_sender<std::decay_t<Sender>>{
+                PIKA_FORWARD(Sender, sender), &limiter};
+        }
+
+        friend PIKA_FORCEINLINE auto tag_fallback_invoke(admit_t, admission_limiter& limiter)
+        {
+            return detail::partial_algorithm<admit_t, std::reference_wrapper<admission_limiter>>{
+                std::ref(limiter)};
+        }
+    } admit{};
+}    // namespace pika::execution::experimental
+
+#include <pika/config/warnings_suffix.hpp>
@@ -19,6 +19,7 @@
 #include <pika/execution_base/traits/is_executor.hpp>
 #include <pika/functional/invoke.hpp>
 #include <pika/functional/invoke_fused.hpp>
+#include <pika/iterator_support/counting_shape.hpp>
 #include <pika/modules/itt_notify.hpp>
 #include <pika/synchronization/spinlock.hpp>
 #include <pika/threading/thread.hpp>
@@ -26,6 +27,7 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
 #include <atomic>
 #include <chrono>
 #include <cstddef>
@@ -57,19 +59,29 @@ namespace pika::execution::experimental {
     /// worker threads is a slow operation the executor should be reused
     /// whenever possible for multiple adjacent parallel algorithms or
     /// invocations of bulk_(a)sync_execute.
+    ///
+    /// Consecutive parallel loops that should not return the worker threads
+    /// to the idle state in between can be run in a single parallel_region.
+    /// All worker threads execute the region and can synchronize with each
+    /// other through the region_context passed to the region.
     class fork_join_executor
     {
     public:
         /// Type of loop schedule for use with the fork_join_executor.
         /// loop_schedule::static_ implies no work-stealing;
         /// loop_schedule::dynamic allows stealing when a worker has finished
-        /// its local work.
+        /// its local work; loop_schedule::guided lets all workers take chunks
+        /// of decreasing size from a shared range, which balances irregular
+        /// work without a separate stealing phase.
         enum class loop_schedule
         {
             static_,
             dynamic,
+            guided,
         };
 
+        class region_context;
+
         /// \cond nointernal
         using execution_category = pika::execution::parallel_execution_tag;
         using executor_parameters_type = pika::execution::static_chunk_size;
@@ -94,9 +106,11 @@ namespace pika::execution::experimental {
             using queues_type =
                 std::vector<pika::concurrency::detail::cache_aligned_data<queue_type>>;
 
+            using index_type = pika::concurrency::detail::cache_line_data<std::atomic<std::size_t>>;
+
             struct region_data_type;
             using thread_function_helper_type = void(region_data_type&, std::size_t, std::size_t,
-                queues_type&, pika::spinlock&, std::exception_ptr&) noexcept;
+                queues_type&, index_type&, pika::spinlock&, std::exception_ptr&) noexcept;
 
             // Members that change for each parallel region.
             struct region_data
@@ -143,10 +157,21 @@ namespace pika::execution::experimental {
             // The current queues for each worker pika thread.
             queues_type queues_;
 
-            template <typename Op>
-            static thread_state
-            wait_state_this_thread_while(std::atomic<thread_state> const& tstate,
-                thread_state state, std::uint64_t yield_delay, Op&& op)
+            // The next index to be processed with the guided loop schedule.
+            index_type next_index_;
+
+            // The number of threads that have arrived at the current barrier
+            // of a parallel region, and the number of completed barriers.
+            index_type barrier_arrived_;
+            index_type barrier_generation_;
+
+            // Pointers to the values contributed by each thread to the
+            // current reduction of a parallel region.
+            std::vector<pika::concurrency::detail::cache_aligned_data<void const*>> reduce_slots_;
+
+            template <typename T, typename Op>
+            static T wait_state_this_thread_while(
+                std::atomic<T> const& tstate, T state, std::uint64_t yield_delay, Op&& op)
             {
                 auto current = tstate.load(std::memory_order_acquire);
                 if (op(current, state))
@@ -192,6 +217,7 @@ namespace pika::execution::experimental {
                 // Changing data for each parallel region.
                 region_data_type& region_data_;
                 queues_type& queues_;
+                index_type& next_index_;
 
                 void set_state_this_thread(thread_state state) noexcept
                 {
@@ -218,7 +244,7 @@ namespace pika::execution::experimental {
                     while (state != thread_state::stopping)
                     {
                         data.thread_function_helper_(region_data_, thread_index_, num_threads_,
-                            queues_, exception_mutex_, exception_);
+                            queues_, next_index_, exception_mutex_, exception_);
 
                         // wait as long the state is 'idle'
                         state = shared_data::wait_state_this_thread_while(
@@ -281,7 +307,7 @@ namespace pika::execution::experimental {
                     pika::detail::async_launch_policy_dispatch<launch::async_policy>::call(policy,
                         desc, pool_,
                         thread_function{num_threads_, t, schedule_, exception_mutex_, exception_,
-                            yield_delay_, region_data_, queues_});
+                            yield_delay_, region_data_, queues_, next_index_});
                 }
 
                 wait_state_all(thread_state::idle);
@@ -311,8 +337,12 @@ namespace pika::execution::experimental {
               , exception_mutex_()
               , exception_()
               , region_data_(num_threads_)
+              , reduce_slots_(num_threads_)
             {
                 PIKA_ASSERT(pool_);
+                next_index_.data_.store(0, std::memory_order_relaxed);
+                barrier_arrived_.data_.store(0, std::memory_order_relaxed);
+                barrier_generation_.data_.store(0, std::memory_order_relaxed);
                 init_threads();
             }
 
@@ -366,8 +396,8 @@ namespace pika::execution::experimental {
                 /// Main entry point for a single parallel region (static
                 /// scheduling).
                 static void call_static(region_data_type& rdata, std::size_t thread_index,
-                    std::size_t num_threads, queues_type&, pika::spinlock& exception_mutex,
-                    std::exception_ptr& exception) noexcept
+                    std::size_t num_threads, queues_type&, index_type&,
+                    pika::spinlock& exception_mutex, std::exception_ptr& exception) noexcept
                 {
                     region_data& data = rdata[thread_index].data_;
                     try
@@ -410,8 +440,8 @@ namespace pika::execution::experimental {
                 /// Main entry point for a single parallel region (dynamic
                 /// scheduling).
                 static void call_dynamic(region_data_type& rdata, std::size_t thread_index,
-                    std::size_t num_threads, queues_type& queues, pika::spinlock& exception_mutex,
-                    std::exception_ptr& exception) noexcept
+                    std::size_t num_threads, queues_type& queues, index_type&,
+                    pika::spinlock& exception_mutex, std::exception_ptr& exception) noexcept
                 {
                     region_data& data = rdata[thread_index].data_;
                     try
@@ -470,21 +500,82 @@ namespace pika::execution::experimental {
 
                     set_state(data.state_, thread_state::idle);
                 }
+
+                /// Main entry point for a single parallel region (guided
+                /// scheduling).
+                static void call_guided(region_data_type& rdata, std::size_t thread_index,
+                    std::size_t num_threads, queues_type&, index_type& next_index,
+                    pika::spinlock& exception_mutex, std::exception_ptr& exception) noexcept
+                {
+                    region_data& data = rdata[thread_index].data_;
+                    try
+                    {
+                        // Cast void pointers back to the actual types given to
+                        // bulk_sync_execute.
+                        auto& element_function = *static_cast<F*>(data.element_function_);
+                        auto& shape = *static_cast<S const*>(data.shape_);
+                        auto& argument_pack = *static_cast<Tuple*>(data.argument_pack_);
+
+                        std::size_t const size = pika::util::size(shape);
+
+                        set_state(data.state_, thread_state::active);
+
+                        // Take chunks proportional to the remaining work until
+                        // all items have been taken.
+                        std::size_t begin = next_index.data_.load(std::memory_order_relaxed);
+                        while (begin < size)
+                        {
+                            std::size_t const chunk_size =
+                                (std::max)(std::size_t(1), (size - begin) / (2 * num_threads));
+                            if (!next_index.data_.compare_exchange_weak(
+                                    begin, begin + chunk_size, std::memory_order_relaxed))
+                            {
+                                continue;
+                            }
+
+                            auto it = std::next(pika::util::begin(shape), begin);
+                            for (std::size_t i = 0; i != chunk_size; ++i, ++it)
+                            {
+                                invoke_helper(
+                                    index_pack_type{}, element_function, *it, argument_pack);
+                            }
+
+                            begin = next_index.data_.load(std::memory_order_relaxed);
+                        }
+                    }
+                    catch (...)
+                    {
+                        std::lock_guard l(exception_mutex);
+                        if (!exception)
+                        {
+                            exception = std::current_exception();
+                        }
+                    }
+
+                    set_state(data.state_, thread_state::idle);
+                }
             };
 
             template <typename F, typename S, typename Args>
-            thread_function_helper_type* set_all_states_and_region_data(
-                thread_state state, F& f, S const& shape, Args& argument_pack) noexcept
+            thread_function_helper_type* set_all_states_and_region_data(thread_state state,
+                loop_schedule schedule, F& f, S const& shape, Args& argument_pack) noexcept
             {
                 thread_function_helper_type* func = nullptr;
-                if (schedule_ == loop_schedule::static_ || num_threads_ == 1)
+                if (schedule == loop_schedule::static_ || num_threads_ == 1)
                 {
                     func = &thread_function_helper<F, S, Args>::call_static;
                 }
-                else
+                else if (schedule == loop_schedule::dynamic)
                 {
                     func = &thread_function_helper<F, S, Args>::call_dynamic;
                 }
+                else
+                {
+                    // The worker threads only read the index after observing
+                    // their new state below.
+                    next_index_.data_.store(0, std::memory_order_relaxed);
+                    func = &thread_function_helper<F, S, Args>::call_guided;
+                }
 
                 for (std::size_t t = 0; t < num_threads_; ++t)
                 {
@@ -500,27 +591,20 @@ namespace pika::execution::experimental {
                 return func;
             }
 
-        public:
             template <typename F, typename S, typename... Ts>
-            void bulk_sync_execute(F&& f, S const& shape, Ts&&... ts)
+            void bulk_sync_execute_helper(loop_schedule schedule, F&& f, S const& shape, Ts&&... ts)
             {
-#if PIKA_HAVE_ITTNOTIFY != 0 && !defined(PIKA_HAVE_APEX)
-                static pika::util::itt::event notify_event("fork_join_executor::bulk_sync_execute");
-
-                pika::util::itt::mark_event e(notify_event);
-#endif
-
                 // Set the data for this parallel region
                 auto argument_pack = std::forward_as_tuple(PIKA_FORWARD(Ts, ts)...);
 
                 // Signal all worker threads to start partitioning work for
                 // themselves, and then starting the actual work.
                 thread_function_helper_type* func = set_all_states_and_region_data(
-                    thread_state::partitioning_work, f, shape, argument_pack);
+                    thread_state::partitioning_work, schedule, f, shape, argument_pack);
 
                 // Start work on the main thread.
-                func(region_data_, main_thread_, num_threads_, queues_, exception_mutex_,
-                    exception_);
+                func(region_data_, main_thread_, num_threads_, queues_, next_index_,
+                    exception_mutex_, exception_);
 
                 // Wait for all threads to finish their work assigned to
                 // them in this parallel region.
@@ -533,6 +617,124 @@ namespace pika::execution::experimental {
                 }
             }
 
+        public:
+            std::size_t num_threads() const noexcept
+            {
+                return num_threads_;
+            }
+
+            // Wait until all worker threads have arrived at the barrier. May
+            // only be called from within a parallel region.
+            void barrier() noexcept
+            {
+                std::size_t const generation =
+                    barrier_generation_.data_.load(std::memory_order_acquire);
+                if (barrier_arrived_.data_.fetch_add(1, std::memory_order_acq_rel) + 1 ==
+                    num_threads_)
+                {
+                    // The last thread to arrive releases all other threads.
+                    barrier_arrived_.data_.store(0, std::memory_order_relaxed);
+                    barrier_generation_.data_.store(generation + 1, std::memory_order_release);
+                    return;
+                }
+
+                wait_state_this_thread_while(barrier_generation_.data_, generation, yield_delay_,
+                    std::equal_to<>());
+            }
+
+            // Combine the values of all worker threads with op, in the order
+            // of the worker threads. May only be called from within a
+            // parallel region.
+            template <typename T, typename Op>
+            T reduce(std::size_t thread_index, T const& value, Op&& op)
+            {
+                reduce_slots_[thread_index].data_ = &value;
+                barrier();
+
+                T result = *static_cast<T const*>(reduce_slots_[0].data_);
+                for (std::size_t t = 1; t < num_threads_; ++t)
+                {
+                    result = PIKA_INVOKE(op, PIKA_MOVE(result),
+                        *static_cast<T const*>(reduce_slots_[t].data_));
+                }
+
+                // Keep the values alive until all threads have read them.
+                barrier();
+                return result;
+            }
+
+            template <typename F, typename S, typename... Ts>
+            void bulk_sync_execute(F&& f, S const& shape, Ts&&... ts)
+            {
+#if PIKA_HAVE_ITTNOTIFY != 0 && !defined(PIKA_HAVE_APEX)
+                static pika::util::itt::event notify_event("fork_join_executor::bulk_sync_execute");
+
+                pika::util::itt::mark_event e(notify_event);
+#endif
+
+                bulk_sync_execute_helper(
+                    schedule_, PIKA_FORWARD(F, f), shape, PIKA_FORWARD(Ts, ts)...);
+            }
+
+            template <typename F>
+            void parallel_region(F&& f)
+            {
+#if PIKA_HAVE_ITTNOTIFY != 0 && !defined(PIKA_HAVE_APEX)
+                static pika::util::itt::event notify_event("fork_join_executor::parallel_region");
+
+                pika::util::itt::mark_event e(notify_event);
+#endif
+
+                // With static scheduling and one item per worker thread each
+                // worker thread gets the item with its own index.
+                bulk_sync_execute_helper(
+                    loop_schedule::static_,
+                    [this, &f](std::size_t thread_index) {
+                        region_context context{*this, thread_index};
+                        PIKA_INVOKE(f, context);
+                    },
+                    pika::util::detail::make_counting_shape(num_threads_));
+            }
+
+            template <typename F, typename S, typename T, typename Op>
+            T bulk_sync_reduce(F&& f, S const& shape, T init, Op&& op)
+            {
+                // One padded accumulator per worker thread. Each worker
+                // thread reduces a contiguous part of the shape so that the
+                // partial results can be combined in order.
+                std::vector<pika::concurrency::detail::cache_aligned_data<std::optional<T>>>
+                    partial_results(num_threads_);
+
+                parallel_region([&](region_context& context) {
+                    std::size_t const size = pika::util::size(shape);
+                    std::size_t const thread_index = context.thread_index();
+                    std::size_t part_begin = (thread_index * size) / num_threads_;
+                    std::size_t const part_end = ((thread_index + 1) * size) / num_threads_;
+                    if (part_begin == part_end)
+                    {
+                        return;
+                    }
+
+                    auto it = std::next(pika::util::begin(shape), part_begin);
+                    T partial_result = PIKA_INVOKE(f, *it);
+                    for (++part_begin, ++it; part_begin != part_end; ++part_begin, ++it)
+                    {
+                        partial_result =
+                            PIKA_INVOKE(op, PIKA_MOVE(partial_result), PIKA_INVOKE(f, *it));
+                    }
+                    partial_results[thread_index].data_.emplace(PIKA_MOVE(partial_result));
+                });
+
+                for (auto& partial_result : partial_results)
+                {
+                    if (partial_result.data_)
+                    {
+                        init = PIKA_INVOKE(op, PIKA_MOVE(init), PIKA_MOVE(*partial_result.data_));
+                    }
+                }
+                return init;
+            }
+
             template <typename F, typename S, typename... Ts>
             std::vector<pika::future<
                 pika::parallel::execution::detail::bulk_function_result_t<F, S, Ts...>>>
@@ -561,6 +763,81 @@ namespace pika::execution::experimental {
         std::shared_ptr<shared_data> shared_data_ = nullptr;
 
     public:
+        /// \endcond
+
+        /// \brief The context passed to each worker thread executing a
+        /// parallel_region.
+        ///
+        /// The barrier and reduce member functions must be called by all
+        /// worker threads of the region, in the same order. Exceptions thrown
+        /// by only some of the worker threads in a region that uses them will
+        /// leave the remaining worker threads waiting forever.
+        class region_context
+        {
+        public:
+            /// \cond NOINTERNAL
+            region_context(shared_data& data, std::size_t thread_index) noexcept
+              : data_(data)
+              , thread_index_(thread_index)
+            {
+            }
+            /// \endcond
+
+            /// Return the index of the calling worker thread in [0,
+            /// num_threads()).
+            std::size_t thread_index() const noexcept
+            {
+                return thread_index_;
+            }
+
+            /// Return the number of worker threads executing the region.
+            std::size_t num_threads() const noexcept
+            {
+                return data_.num_threads();
+            }
+
+            /// Wait until all worker threads of the region have arrived at the
+            /// barrier.
+            void barrier() noexcept
+            {
+                data_.barrier();
+            }
+
+            /// Call f for each element of shape, with the elements statically
+            /// partitioned among the worker threads of the region, and wait
+            /// for all worker threads to finish.
+            template <typename S, typename F>
+            void for_each(S const& shape, F&& f)
+            {
+                std::size_t const size = pika::util::size(shape);
+                std::size_t const num_threads = data_.num_threads();
+                std::size_t part_begin = (thread_index_ * size) / num_threads;
+                std::size_t const part_end = ((thread_index_ + 1) * size) / num_threads;
+
+                auto it = std::next(pika::util::begin(shape), part_begin);
+                for (; part_begin != part_end; ++part_begin, ++it)
+                {
+                    PIKA_INVOKE(f, *it);
+                }
+
+                barrier();
+            }
+
+            /// Combine the values passed by all worker threads of the region
+            /// with op, in the order of the worker threads. All worker threads
+            /// receive the same result.
+            template <typename T, typename Op>
+            T reduce(T const& value, Op&& op)
+            {
+                return data_.reduce(thread_index_, value, PIKA_FORWARD(Op, op));
+            }
+
+        private:
+            shared_data& data_;
+            std::size_t thread_index_;
+        };
+
+        /// \cond NOINTERNAL
         template <typename F, typename S, typename... Ts>
         void bulk_sync_execute(F&& f, S const& shape, Ts&&... ts)
         {
@@ -590,6 +867,31 @@ namespace pika::execution::experimental {
         }
         /// \endcond
 
+        /// \brief Run f on all worker threads of the executor.
+        ///
+        /// f is called with a region_context& that can be used to run
+        /// parallel loops, barriers, and reductions without the worker threads
+        /// returning to the idle state in between. The call returns once f
+        /// has returned on all worker threads.
+        template <typename F>
+        void parallel_region(F&& f)
+        {
+            shared_data_->parallel_region(PIKA_FORWARD(F, f));
+        }
+
+        /// \brief Reduce f(x) for all elements x of shape with op, starting
+        /// from init.
+        ///
+        /// Each worker thread accumulates a contiguous part of shape in its
+        /// own cache line aligned accumulator. The partial results are
+        /// combined in order, so op only needs to be associative.
+        template <typename F, typename S, typename T, typename Op>
+        T bulk_sync_reduce(F&& f, S const& shape, T init, Op&& op)
+        {
+            return shared_data_->bulk_sync_reduce(
+                PIKA_FORWARD(F, f), shape, PIKA_MOVE(init), PIKA_FORWARD(Op, op));
+        }
+
         /// \brief Construct a fork_join_executor.
         ///
         /// \param priority The priority of the worker threads.
@@ -638,6 +940,9 @@ struct fmt::formatter<pika::execution::experimental::fork_join_executor::loop_sc
         case fork_join_executor::loop_schedule::dynamic:
             schedule_str = "dynamic";
             break;
+        case fork_join_executor::loop_schedule::guided:
+            schedule_str = "guided";
+            break;
         default:
             schedule_str = "<unknown>";
             break;
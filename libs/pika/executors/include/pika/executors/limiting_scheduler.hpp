@@ -0,0 +1,201 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+
+#if defined(PIKA_HAVE_P2300_REFERENCE_IMPLEMENTATION)
+# include <pika/execution_base/p2300_forward.hpp>
+#endif
+
+#include <pika/execution_base/completion_scheduler.hpp>
+#include <pika/execution_base/operation_state.hpp>
+#include <pika/execution_base/receiver.hpp>
+#include <pika/execution_base/sender.hpp>
+#include <pika/executors/admission_limiter.hpp>
+
+#include <type_traits>
+#include <utility>
+
+namespace pika::execution::experimental {
+    /// A scheduler that runs at most as many tasks at a time on the
+    /// underlying scheduler as the limiter admits. Tasks are scheduled on the
+    /// underlying scheduler once they have been admitted. A task is released
+    /// when the receiver connected to the sender returned by schedule
+    /// returns from set_value, i.e. work chained directly after schedule
+    /// counts as part of the task.
+    template <typename Scheduler>
+    struct limiting_scheduler
+    {
+        limiting_scheduler(Scheduler scheduler, admission_limiter& limiter)
+          : scheduler_(PIKA_MOVE(scheduler))
+          , limiter_(&limiter)
+        {
+        }
+
+        /// \cond NOINTERNAL
+        bool operator==(limiting_scheduler const& rhs) const noexcept
+        {
+            return scheduler_ == rhs.scheduler_ && limiter_ == rhs.limiter_;
+        }
+
+        bool operator!=(limiting_scheduler const& rhs) const noexcept
+        {
+            return !(*this == rhs);
+        }
+        /// \endcond
+
+        Scheduler const& get_underlying_scheduler() const noexcept
+        {
+            return scheduler_;
+        }
+
+        admission_limiter& get_limiter() const noexcept
+        {
+            return *limiter_;
+        }
+
+    private:
+        using schedule_sender_type =
+            std::decay_t<std::invoke_result_t<schedule_t, Scheduler const&>>;
+
+        template <typename Receiver>
+        struct operation_state : detail::admission_waiter
+        {
+            struct scheduled_receiver
+            {
+                using is_receiver = void;
+
+                operation_state& op;
+
+                template <typename Error>
+                friend void tag_invoke(
+                    set_error_t, scheduled_receiver&& r, Error&& error) noexcept
+                {
+                    r.op.limiter.release();
+                    pika::execution::experimental::set_error(
+                        PIKA_MOVE(r.op.receiver), PIKA_FORWARD(Error, error));
+                }
+
+                friend void tag_invoke(set_stopped_t, scheduled_receiver&& r) noexcept
+                {
+                    r.op.limiter.release();
+                    pika::execution::experimental::set_stopped(PIKA_MOVE(r.op.receiver));
+                }
+
+                // The receiver may destroy the operation state
+                friend void tag_invoke(set_value_t, scheduled_receiver&& r) noexcept
+                {
+                    admission_limiter& limiter = r.op.limiter;
+                    pika::execution::experimental::set_value(PIKA_MOVE(r.op.receiver));
+                    limiter.release();
+                }
+
+                friend constexpr decltype(auto) tag_invoke(
+                    get_env_t, scheduled_receiver const& r) noexcept
+                {
+                    return pika::execution::experimental::get_env(r.op.receiver);
+                }
+            };
+
+            admission_limiter& limiter;
+            PIKA_NO_UNIQUE_ADDRESS std::decay_t<Receiver> receiver;
+            std::decay_t<connect_result_t<schedule_sender_type, scheduled_receiver>>
+                schedule_op_state;
+
+            template <typename Receiver_>
+            operation_state(
+                Scheduler const& scheduler, admission_limiter& limiter, Receiver_&& receiver)
+              : limiter(limiter)
+              , receiver(PIKA_FORWARD(Receiver_, receiver))
+              , schedule_op_state(pika::execution::experimental::connect(
+                    pika::execution::experimental::schedule(scheduler),
+                    scheduled_receiver{*this}))
+            {
+                resume = [](detail::admission_waiter* waiter) noexcept {
+                    pika::execution::experimental::start(
+                        static_cast<operation_state&>(*waiter).schedule_op_state);
+                };
+            }
+
+            operation_state(operation_state&&) = delete;
+            operation_state(operation_state const&) = delete;
+            operation_state& operator=(operation_state&&) = delete;
+            operation_state& operator=(operation_state const&) = delete;
+
+            friend void tag_invoke(start_t, operation_state& os) noexcept
+            {
+                os.limiter.add_waiter(&os);
+            }
+        };
+
+        struct sender
+        {
+            using is_sender = void;
+
+            limiting_scheduler scheduler;
+
+#if defined(PIKA_HAVE_P2300_REFERENCE_IMPLEMENTATION)
+            using completion_signatures =
+                make_completion_signatures<schedule_sender_type, empty_env>;
+#else
+            template <template <typename...> class Tuple, template <typename...> class Variant>
+            using value_types = typename sender_traits<
+                schedule_sender_type>::template value_types<Tuple, Variant>;
+
+            template <template <typename...> class Variant>
+            using error_types =
+                typename sender_traits<schedule_sender_type>::template error_types<Variant>;
+
+            static constexpr bool sends_done = sender_traits<schedule_sender_type>::sends_done;
+#endif
+
+            template <typename Receiver>
+            friend operation_state<Receiver> tag_invoke(
+                connect_t, sender&& s, Receiver&& receiver)
+            {
+                return {s.scheduler.get_underlying_scheduler(), s.scheduler.get_limiter(),
+                    PIKA_FORWARD(Receiver, receiver)};
+            }
+
+            template <typename Receiver>
+            friend operation_state<Receiver> tag_invoke(
+                connect_t, sender const& s, Receiver&& receiver)
+            {
+                return {s.scheduler.get_underlying_scheduler(), s.scheduler.get_limiter(),
+                    PIKA_FORWARD(Receiver, receiver)};
+            }
+
+            struct env
+            {
+                limiting_scheduler scheduler;
+
+                friend limiting_scheduler tag_invoke(
+                    get_completion_scheduler_t<set_value_t>, env const& e) noexcept
+                {
+                    return e.scheduler;
+                }
+            };
+
+            friend env tag_invoke(get_env_t, sender const& s)
+            {
+                return {s.scheduler};
+            }
+        };
+
+        friend sender tag_invoke(schedule_t, limiting_scheduler const& sched)
+        {
+            return {sched};
+        }
+
+        Scheduler scheduler_;
+        admission_limiter* limiter_;
+    };
+
+    template <typename Scheduler>
+    limiting_scheduler(Scheduler, admission_limiter&) -> limiting_scheduler<Scheduler>;
+}    // namespace pika::execution::experimental
@@ -11,16 +11,25 @@
 #include <pika/coroutines/thread_enums.hpp>
 #include <pika/errors/try_catch_exception_ptr.hpp>
 #include <pika/execution/algorithms/execute.hpp>
+#include <pika/execution/algorithms/schedule_at.hpp>
 #include <pika/execution/algorithms/schedule_from.hpp>
 #include <pika/execution/executors/execution_parameters.hpp>
 #include <pika/execution_base/receiver.hpp>
 #include <pika/execution_base/sender.hpp>
+#include <pika/execution_base/stop_token.hpp>
 #include <pika/threading_base/annotated_function.hpp>
+#include <pika/threading_base/detail/timer_wheel.hpp>
 #include <pika/threading_base/register_thread.hpp>
+#include <pika/threading_base/scheduler_base.hpp>
 #include <pika/threading_base/thread_description.hpp>
+#include <pika/threading_base/thread_pool_base.hpp>
+#include <pika/timing/steady_clock.hpp>
 
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <exception>
+#include <optional>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -38,7 +47,8 @@ namespace pika::execution::experimental {
         bool operator==(thread_pool_scheduler const& rhs) const noexcept
         {
             return pool_ == rhs.pool_ && priority_ == rhs.priority_ &&
-                stacksize_ == rhs.stacksize_ && schedulehint_ == rhs.schedulehint_;
+                stacksize_ == rhs.stacksize_ && schedulehint_ == rhs.schedulehint_ &&
+                bulk_chunk_size_ == rhs.bulk_chunk_size_;
         }
 
         bool operator!=(thread_pool_scheduler const& rhs) const noexcept
@@ -97,6 +107,22 @@ namespace pika::execution::experimental {
             return scheduler.schedulehint_;
         }
 
+        // support with_bulk_chunk_size property
+        friend thread_pool_scheduler tag_invoke(
+            pika::execution::experimental::with_bulk_chunk_size_t,
+            thread_pool_scheduler const& scheduler, std::size_t chunk_size)
+        {
+            auto sched_with_chunk_size = scheduler;
+            sched_with_chunk_size.bulk_chunk_size_ = chunk_size;
+            return sched_with_chunk_size;
+        }
+
+        friend std::size_t tag_invoke(pika::execution::experimental::get_bulk_chunk_size_t,
+            thread_pool_scheduler const& scheduler)
+        {
+            return scheduler.bulk_chunk_size_;
+        }
+
         // support with_annotation property
         friend constexpr thread_pool_scheduler tag_invoke(
             pika::execution::experimental::with_annotation_t,
@@ -248,6 +274,217 @@ namespace pika::execution::experimental {
             return {sched};
         }
 
+        // The operation state of the senders returned by schedule_at and
+        // schedule_after. The timer is an entry of the timer wheel of the
+        // scheduler of the thread pool. A stop request removes the timer from
+        // the wheel in constant time if it hasn't expired yet. The timer is
+        // detached so that the operation can complete from the callback of
+        // the timer.
+        template <typename Scheduler, typename Receiver>
+        struct timed_operation_state : private pika::threads::detail::timer_wheel_entry
+        {
+            using stop_token_type = stop_token_of_t<std::decay_t<
+                std::invoke_result_t<get_env_t, std::decay_t<Receiver> const&>>>;
+
+            struct stop_callback_fn
+            {
+                timed_operation_state& os;
+
+                void operator()() noexcept
+                {
+                    os.on_stop_requested();
+                }
+            };
+
+            using stop_callback_type =
+                pika::execution::experimental::detail::stop_callback_for_t<stop_token_type,
+                    stop_callback_fn>;
+
+            PIKA_NO_UNIQUE_ADDRESS std::decay_t<Scheduler> scheduler;
+            PIKA_NO_UNIQUE_ADDRESS std::decay_t<Receiver> receiver;
+            char const* fallback_annotation;
+            bool relative;
+            std::chrono::steady_clock::time_point deadline;
+            std::chrono::steady_clock::duration delay;
+            pika::threads::detail::timer_wheel* wheel = nullptr;
+            std::optional<stop_callback_type> stop_callback;
+
+            // Both start and the expiry or cancellation of the timer have to
+            // arrive before the operation completes, since the timer may be
+            // cancelled by a stop callback before start has returned
+            std::atomic<int> pending{2};
+            bool stopped = false;
+
+            template <typename Scheduler_, typename Receiver_>
+            timed_operation_state(Scheduler_&& scheduler, Receiver_&& receiver,
+                char const* fallback_annotation, bool relative,
+                std::chrono::steady_clock::time_point deadline,
+                std::chrono::steady_clock::duration delay)
+              : pika::threads::detail::timer_wheel_entry(&timed_operation_state::on_expired, true)
+              , scheduler(PIKA_FORWARD(Scheduler_, scheduler))
+              , receiver(PIKA_FORWARD(Receiver_, receiver))
+              , fallback_annotation(fallback_annotation)
+              , relative(relative)
+              , deadline(deadline)
+              , delay(delay)
+            {
+                PIKA_ASSERT(fallback_annotation != nullptr);
+            }
+
+            timed_operation_state(timed_operation_state&&) = delete;
+            timed_operation_state(timed_operation_state const&) = delete;
+            timed_operation_state& operator=(timed_operation_state&&) = delete;
+            timed_operation_state& operator=(timed_operation_state const&) = delete;
+
+            static void on_expired(
+                pika::threads::detail::timer_wheel_entry& entry, bool fired) noexcept
+            {
+                auto& os = static_cast<timed_operation_state&>(entry);
+
+                // The timer wheel is destroyed with the scheduler of the
+                // thread pool before the deadline was reached
+                os.stopped = !fired;
+                os.arrive();
+            }
+
+            void on_stop_requested() noexcept
+            {
+                if (wheel->cancel(*this))
+                {
+                    stopped = true;
+                    arrive();
+                }
+            }
+
+            void arrive() noexcept
+            {
+                if (pending.fetch_sub(1, std::memory_order_acq_rel) != 1)
+                {
+                    return;
+                }
+
+                stop_callback.reset();
+
+                if (stopped)
+                {
+                    pika::execution::experimental::set_stopped(PIKA_MOVE(receiver));
+                    return;
+                }
+
+                pika::detail::try_catch_exception_ptr(
+                    [&]() {
+                        scheduler.execute(
+                            [&os = *this]() {
+                                pika::execution::experimental::set_value(PIKA_MOVE(os.receiver));
+                            },
+                            fallback_annotation);
+                    },
+                    [&](std::exception_ptr ep) {
+                        pika::execution::experimental::set_error(
+                            PIKA_MOVE(receiver), PIKA_MOVE(ep));
+                    });
+            }
+
+            void start() noexcept
+            {
+                auto stop_token = pika::execution::experimental::get_stop_token(
+                    pika::execution::experimental::get_env(receiver));
+                if (stop_token.stop_requested())
+                {
+                    pika::execution::experimental::set_stopped(PIKA_MOVE(receiver));
+                    return;
+                }
+
+                bool scheduled = false;
+                pika::detail::try_catch_exception_ptr(
+                    [&]() {
+                        wheel = &scheduler.get_thread_pool()->get_scheduler()->get_timer_wheel();
+                        wheel->schedule(
+                            *this, relative ? std::chrono::steady_clock::now() + delay : deadline);
+                        scheduled = true;
+                    },
+                    [&](std::exception_ptr ep) {
+                        pika::execution::experimental::set_error(
+                            PIKA_MOVE(receiver), PIKA_MOVE(ep));
+                    });
+
+                if (scheduled)
+                {
+                    stop_callback.emplace(PIKA_MOVE(stop_token), stop_callback_fn{*this});
+                    arrive();
+                }
+            }
+
+            friend void tag_invoke(start_t, timed_operation_state& os) noexcept
+            {
+                os.start();
+            }
+        };
+
+        template <typename Scheduler>
+        struct timed_sender
+        {
+            using is_sender = void;
+
+            PIKA_NO_UNIQUE_ADDRESS std::decay_t<Scheduler> scheduler;
+
+            // The timer expires at the deadline if relative is false, and
+            // after the delay measured from when the operation is started
+            // otherwise
+            bool relative;
+            std::chrono::steady_clock::time_point deadline;
+            std::chrono::steady_clock::duration delay;
+
+            char const* fallback_annotation = scheduler.get_fallback_annotation();
+
+            template <template <typename...> class Tuple, template <typename...> class Variant>
+            using value_types = Variant<Tuple<>>;
+
+            template <template <typename...> class Variant>
+            using error_types = Variant<std::exception_ptr>;
+
+            static constexpr bool sends_done = true;
+
+            using completion_signatures = pika::execution::experimental::completion_signatures<
+                pika::execution::experimental::set_value_t(),
+                pika::execution::experimental::set_error_t(std::exception_ptr),
+                pika::execution::experimental::set_stopped_t()>;
+
+            template <typename Receiver>
+            friend timed_operation_state<Scheduler, Receiver>
+            tag_invoke(connect_t, timed_sender&& s, Receiver&& receiver)
+            {
+                return {PIKA_MOVE(s.scheduler), PIKA_FORWARD(Receiver, receiver),
+                    s.fallback_annotation, s.relative, s.deadline, s.delay};
+            }
+
+            template <typename Receiver>
+            friend timed_operation_state<Scheduler, Receiver>
+            tag_invoke(connect_t, timed_sender const& s, Receiver&& receiver)
+            {
+                return {s.scheduler, PIKA_FORWARD(Receiver, receiver), s.fallback_annotation,
+                    s.relative, s.deadline, s.delay};
+            }
+
+            friend typename sender<Scheduler>::env tag_invoke(
+                pika::execution::experimental::get_env_t, timed_sender const& s)
+            {
+                return {s.scheduler};
+            }
+        };
+
+        friend timed_sender<thread_pool_scheduler> tag_invoke(schedule_at_t,
+            thread_pool_scheduler const& sched, pika::chrono::steady_time_point const& abs_time)
+        {
+            return {sched, false, abs_time.value(), {}};
+        }
+
+        friend timed_sender<thread_pool_scheduler> tag_invoke(schedule_after_t,
+            thread_pool_scheduler const& sched, pika::chrono::steady_duration const& rel_time)
+        {
+            return {sched, true, {}, rel_time.value()};
+        }
+
         // We customize schedule_from to customize transfer. We want transfer to
         // take the annotation from the calling context of transfer if needed
         // and available. If we don't customize schedule_from the schedule
@@ -322,6 +559,7 @@ namespace pika::execution::experimental {
         pika::execution::thread_stacksize stacksize_ = pika::execution::thread_stacksize::small_;
         pika::execution::thread_schedule_hint schedulehint_{};
         char const* annotation_ = nullptr;
+        std::size_t bulk_chunk_size_ = 0;
         /// \endcond
     };
 }    // namespace pika::execution::experimental
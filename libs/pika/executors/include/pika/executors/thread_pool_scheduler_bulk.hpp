@@ -30,10 +30,12 @@
 #include <pika/threading_base/register_thread.hpp>
 #include <pika/threading_base/thread_description.hpp>
 
+#include <algorithm>
 #include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <exception>
+#include <memory>
 #include <optional>
 #include <string>
 #include <tuple>
@@ -172,7 +174,8 @@ namespace pika::thread_pool_bulk_detail {
                     // Visit the values sent from the predecessor sender.
                     // This function first tries to handle all chunks in the
                     // queue owned by worker_thread. It then tries to steal
-                    // chunks from neighboring threads.
+                    // chunks from other threads, starting with the threads
+                    // that are closest to worker_thread in the topology.
                     template <typename Ts,
                         typename = std::enable_if_t<
                             !std::is_same_v<std::decay_t<Ts>, pika::detail::monostate>>>
@@ -187,12 +190,11 @@ namespace pika::thread_pool_bulk_detail {
                             do_work_chunk(ts, index.value());
                         }
 
-                        // Then steal from neighboring queues
-                        for (std::uint32_t offset = 1; offset < op_state->num_worker_threads;
-                             ++offset)
+                        // Then steal from other queues, closest first
+                        PIKA_ASSERT(task_f->worker_thread < op_state->steal_orders->size());
+                        for (std::size_t neighbor_worker_thread :
+                            (*op_state->steal_orders)[task_f->worker_thread])
                         {
-                            std::size_t neighbor_worker_thread =
-                                (task_f->worker_thread + offset) % op_state->num_worker_threads;
                             auto& neighbor_queue = op_state->queues[neighbor_worker_thread].data_;
 
                             while ((index = neighbor_queue.pop_right()))
@@ -305,12 +307,26 @@ namespace pika::thread_pool_bulk_detail {
                 };
 
                 // Compute a chunk size given a number of worker threads and
-                // a total number of items n. Returns a power-of-2 chunk
+                // a total number of items n. If requested_chunk_size is
+                // nonzero it is used as long as the number of chunks fits
+                // in the index queues. Otherwise returns a power-of-2 chunk
                 // size that produces at most 8 and at least 4 chunks per
                 // worker thread.
-                static constexpr std::uint32_t get_chunk_size(
-                    std::uint32_t const num_threads, size_type const n)
+                static constexpr std::uint32_t get_chunk_size(std::uint32_t const num_threads,
+                    size_type const n, std::size_t const requested_chunk_size)
                 {
+                    if (requested_chunk_size != 0)
+                    {
+                        std::uint64_t chunk_size =
+                            (std::min)(requested_chunk_size, std::size_t((std::uint32_t(-1))));
+                        while (
+                            (std::uint64_t(n) + chunk_size - 1) / chunk_size > std::uint32_t(-1))
+                        {
+                            chunk_size *= 2;
+                        }
+                        return static_cast<std::uint32_t>(chunk_size);
+                    }
+
                     std::uint32_t chunk_size = 1;
                     while (chunk_size * num_threads * 8 < n)
                     {
@@ -330,10 +346,12 @@ namespace pika::thread_pool_bulk_detail {
                     queue.reset(part_begin, part_end);
                 }
 
-                // Spawn a task which will process a number of chunks. If
-                // the queue contains no chunks no task will be spawned.
-                void do_work_task(size_type const n, std::uint32_t const chunk_size,
-                    std::uint32_t const worker_thread) const
+                // Create the init data for a task which will process a
+                // number of chunks. If the queue contains no chunks no task
+                // is needed and the function returns false.
+                bool make_work_task(size_type const n, std::uint32_t const chunk_size,
+                    std::uint32_t const worker_thread,
+                    std::vector<threads::detail::thread_init_data>& tasks) const
                 {
                     task_function task_f{this->op_state, n, chunk_size, worker_thread};
 
@@ -343,7 +361,7 @@ namespace pika::thread_pool_bulk_detail {
                         // If the queue is empty we don't spawn a task. We
                         // only signal that this "task" is ready.
                         task_f.finish();
-                        return;
+                        return false;
                     }
 
                     // Only apply hint if none was given.
@@ -363,12 +381,11 @@ namespace pika::thread_pool_bulk_detail {
                         pika::threads::detail::get_thread_description(
                             pika::threads::detail::get_self_id());
 
-                    // Spawn the task.
-                    threads::detail::thread_init_data data(
+                    tasks.emplace_back(
                         threads::detail::make_thread_function_nullary(PIKA_MOVE(task_f)), desc,
                         pika::execution::experimental::get_priority(op_state->scheduler), hint,
                         pika::execution::experimental::get_stacksize(op_state->scheduler));
-                    threads::detail::register_work(data, op_state->scheduler.get_thread_pool());
+                    return true;
                 }
 
                 // Do the work on the worker thread that called set_value
@@ -397,8 +414,11 @@ namespace pika::thread_pool_bulk_detail {
                         return;
                     }
 
-                    // Calculate chunk size and number of chunks
-                    auto const chunk_size = get_chunk_size(r.op_state->num_worker_threads, n);
+                    // Calculate chunk size and number of chunks. A chunk
+                    // size set on the scheduler takes precedence over the
+                    // default.
+                    auto const chunk_size = get_chunk_size(r.op_state->num_worker_threads, n,
+                        pika::execution::experimental::get_bulk_chunk_size(r.op_state->scheduler));
                     auto const num_chunks = (n + chunk_size - 1) / chunk_size;
 
                     // Store sent values in the operation state
@@ -413,8 +433,17 @@ namespace pika::thread_pool_bulk_detail {
                         r.init_queue(worker_thread, num_chunks);
                     }
 
+                    // Look up the steal orders once for all worker threads,
+                    // stealing should not touch the pool
+                    r.op_state->steal_orders =
+                        r.op_state->scheduler.get_thread_pool()->get_steal_orders();
+
                     // Spawn the worker threads for all except the local queue.
+                    // The tasks are registered in one batch so that the
+                    // scheduler wakes up each worker thread at most once.
                     auto const local_worker_thread = pika::get_local_worker_thread_num();
+                    std::vector<threads::detail::thread_init_data> tasks;
+                    tasks.reserve(r.op_state->num_worker_threads);
                     for (std::size_t worker_thread = 0;
                          worker_thread < r.op_state->num_worker_threads; ++worker_thread)
                     {
@@ -425,7 +454,13 @@ namespace pika::thread_pool_bulk_detail {
                             continue;
                         }
 
-                        r.do_work_task(n, chunk_size, worker_thread);
+                        r.make_work_task(n, chunk_size, worker_thread, tasks);
+                    }
+
+                    if (!tasks.empty())
+                    {
+                        threads::detail::register_work_batch(tasks.data(), tasks.size(),
+                            r.op_state->scheduler.get_thread_pool());
                     }
 
                     // Handle the queue for the local thread.
@@ -448,6 +483,7 @@ namespace pika::thread_pool_bulk_detail {
             std::vector<pika::concurrency::detail::cache_aligned_data<
                 pika::concurrency::detail::contiguous_index_queue<>>>
                 queues{num_worker_threads};
+            std::shared_ptr<std::vector<std::vector<std::size_t>> const> steal_orders;
             PIKA_NO_UNIQUE_ADDRESS std::decay_t<Shape> shape;
             PIKA_NO_UNIQUE_ADDRESS std::decay_t<F> f;
             PIKA_NO_UNIQUE_ADDRESS std::decay_t<Receiver> receiver;
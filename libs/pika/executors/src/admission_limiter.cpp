@@ -0,0 +1,153 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#include <pika/assert.hpp>
+#include <pika/executors/admission_limiter.hpp>
+#include <pika/synchronization/spinlock.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+
+namespace pika::execution::experimental {
+    admission_limiter::admission_limiter(std::size_t limit)
+      : limit_(limit)
+    {
+    }
+
+    admission_limiter::~admission_limiter()
+    {
+        PIKA_ASSERT_MSG(head_ == nullptr,
+            "admission_limiter destroyed while operations are waiting to be admitted");
+    }
+
+    void admission_limiter::set_limit(std::size_t limit) noexcept
+    {
+        std::unique_lock<pika::spinlock> l(mtx_);
+        limit_ = limit;
+        drain(l);
+    }
+
+    std::size_t admission_limiter::get_limit() const noexcept
+    {
+        std::lock_guard<pika::spinlock> l(mtx_);
+        return limit_;
+    }
+
+    bool admission_limiter::try_acquire() noexcept
+    {
+        std::lock_guard<pika::spinlock> l(mtx_);
+        if (head_ != nullptr || in_flight_ >= limit_)
+        {
+            return false;
+        }
+
+        ++in_flight_;
+        ++statistics_.admitted;
+        return true;
+    }
+
+    void admission_limiter::release() noexcept
+    {
+        std::unique_lock<pika::spinlock> l(mtx_);
+        PIKA_ASSERT(in_flight_ != 0);
+        --in_flight_;
+        drain(l);
+    }
+
+    void admission_limiter::add_waiter(detail::admission_waiter* waiter) noexcept
+    {
+        {
+            std::lock_guard<pika::spinlock> l(mtx_);
+
+            // Operations are only admitted immediately if no other
+            // operations are waiting, to keep the order of admission
+            if (head_ != nullptr || in_flight_ >= limit_)
+            {
+                waiter->next = nullptr;
+                waiter->enqueue_time = std::chrono::steady_clock::now();
+                if (tail_ == nullptr)
+                {
+                    head_ = waiter;
+                }
+                else
+                {
+                    tail_->next = waiter;
+                }
+                tail_ = waiter;
+
+                ++queue_depth_;
+                statistics_.max_queue_depth =
+                    (std::max)(statistics_.max_queue_depth, queue_depth_);
+                return;
+            }
+
+            ++in_flight_;
+            ++statistics_.admitted;
+        }
+
+        waiter->resume(waiter);
+    }
+
+    // Admits waiting operations while the limit allows it. Only one thread
+    // admits operations at a time. Operations released while the waiters are
+    // resumed, e.g. because they complete inline, are picked up by the loop
+    // instead of recursing into drain.
+    void admission_limiter::drain(std::unique_lock<pika::spinlock>& l) noexcept
+    {
+        PIKA_ASSERT(l.owns_lock());
+
+        if (draining_)
+        {
+            return;
+        }
+        draining_ = true;
+
+        while (head_ != nullptr && in_flight_ < limit_)
+        {
+            detail::admission_waiter* waiter = head_;
+            head_ = waiter->next;
+            if (head_ == nullptr)
+            {
+                tail_ = nullptr;
+            }
+            --queue_depth_;
+            ++in_flight_;
+
+            auto const wait_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - waiter->enqueue_time);
+            ++statistics_.admitted;
+            ++statistics_.waited;
+            statistics_.total_wait_time += wait_time;
+            statistics_.max_wait_time = (std::max)(statistics_.max_wait_time, wait_time);
+
+            // Resuming the waiter may destroy it
+            l.unlock();
+            waiter->resume(waiter);
+            l.lock();
+        }
+
+        draining_ = false;
+    }
+
+    admission_limiter_statistics admission_limiter::get_statistics() const
+    {
+        std::lock_guard<pika::spinlock> l(mtx_);
+        admission_limiter_statistics statistics = statistics_;
+        statistics.in_flight = in_flight_;
+        statistics.queue_depth = queue_depth_;
+        return statistics;
+    }
+
+    void admission_limiter::reset_statistics() noexcept
+    {
+        std::lock_guard<pika::spinlock> l(mtx_);
+        statistics_ = admission_limiter_statistics{};
+        statistics_.max_queue_depth = queue_depth_;
+    }
+}    // namespace pika::execution::experimental
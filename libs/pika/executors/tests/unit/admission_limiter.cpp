@@ -0,0 +1,246 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/execution.hpp>
+#include <pika/executors/admission_limiter.hpp>
+#include <pika/executors/limiting_scheduler.hpp>
+#include <pika/init.hpp>
+#include <pika/testing.hpp>
+#include <pika/thread.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ex = pika::execution::experimental;
+namespace tt = pika::this_thread::experimental;
+
+///////////////////////////////////////////////////////////////////////////////
+// Waiting operations are admitted in the order they were started
+void test_acquire_fifo()
+{
+    ex::admission_limiter limiter(2);
+    std::vector<int> order;
+
+    for (int i = 0; i < 5; ++i)
+    {
+        ex::start_detached(limiter.acquire() | ex::then([&order, i] { order.push_back(i); }));
+    }
+
+    PIKA_TEST(order == (std::vector<int>{0, 1}));
+    auto statistics = limiter.get_statistics();
+    PIKA_TEST_EQ(statistics.admitted, std::uint64_t(2));
+    PIKA_TEST_EQ(statistics.in_flight, std::size_t(2));
+    PIKA_TEST_EQ(statistics.queue_depth, std::size_t(3));
+    PIKA_TEST_EQ(statistics.max_queue_depth, std::size_t(3));
+
+    limiter.release();
+    PIKA_TEST(order == (std::vector<int>{0, 1, 2}));
+
+    // Raising the limit admits waiting operations immediately
+    limiter.set_limit(10);
+    PIKA_TEST_EQ(limiter.get_limit(), std::size_t(10));
+    PIKA_TEST(order == (std::vector<int>{0, 1, 2, 3, 4}));
+
+    statistics = limiter.get_statistics();
+    PIKA_TEST_EQ(statistics.admitted, std::uint64_t(5));
+    PIKA_TEST_EQ(statistics.waited, std::uint64_t(3));
+    PIKA_TEST_EQ(statistics.in_flight, std::size_t(4));
+    PIKA_TEST_EQ(statistics.queue_depth, std::size_t(0));
+    PIKA_TEST_EQ(statistics.max_queue_depth, std::size_t(3));
+    PIKA_TEST(statistics.max_wait_time <= statistics.total_wait_time);
+
+    for (int i = 0; i < 4; ++i)
+    {
+        limiter.release();
+    }
+    PIKA_TEST_EQ(limiter.get_statistics().in_flight, std::size_t(0));
+
+    limiter.reset_statistics();
+    statistics = limiter.get_statistics();
+    PIKA_TEST_EQ(statistics.admitted, std::uint64_t(0));
+    PIKA_TEST_EQ(statistics.waited, std::uint64_t(0));
+    PIKA_TEST_EQ(statistics.max_queue_depth, std::size_t(0));
+}
+
+void test_try_acquire()
+{
+    ex::admission_limiter limiter(1);
+
+    PIKA_TEST(limiter.try_acquire());
+    PIKA_TEST(!limiter.try_acquire());
+
+    bool admitted = false;
+    ex::start_detached(limiter.acquire() | ex::then([&] { admitted = true; }));
+    PIKA_TEST(!admitted);
+
+    // The waiting operation is admitted first
+    limiter.release();
+    PIKA_TEST(admitted);
+    PIKA_TEST(!limiter.try_acquire());
+
+    limiter.release();
+    PIKA_TEST(limiter.try_acquire());
+    limiter.release();
+
+    // Nothing is admitted with a limit of zero
+    limiter.set_limit(0);
+    PIKA_TEST(!limiter.try_acquire());
+    admitted = false;
+    ex::start_detached(limiter.acquire() | ex::then([&] { admitted = true; }));
+    PIKA_TEST(!admitted);
+    limiter.set_limit(1);
+    PIKA_TEST(admitted);
+    limiter.release();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+struct in_flight_counter
+{
+    std::atomic<std::size_t> active{0};
+    std::atomic<std::size_t> max_active{0};
+    std::atomic<std::size_t> total{0};
+
+    void operator()()
+    {
+        std::size_t const a = ++active;
+        std::size_t m = max_active.load();
+        while (a > m && !max_active.compare_exchange_weak(m, a))
+        {
+        }
+
+        // Give other tasks a chance to run
+        for (int i = 0; i < 10; ++i)
+        {
+            pika::this_thread::yield();
+        }
+
+        ++total;
+        --active;
+    }
+};
+
+void test_admit()
+{
+    constexpr std::size_t limit = 3;
+    constexpr std::size_t num_tasks = 100;
+
+    ex::thread_pool_scheduler sched{};
+    ex::admission_limiter limiter(limit);
+    in_flight_counter counter;
+
+    std::vector<ex::unique_any_sender<>> senders;
+    for (std::size_t i = 0; i < num_tasks; ++i)
+    {
+        senders.emplace_back(ex::ensure_started(
+            ex::admit(ex::schedule(sched) | ex::then(std::ref(counter)), limiter)));
+    }
+    tt::sync_wait(ex::when_all_vector(std::move(senders)));
+
+    PIKA_TEST_EQ(counter.total.load(), num_tasks);
+    PIKA_TEST_LTE(counter.max_active.load(), limit);
+
+    // The operations are released before they complete
+    auto const statistics = limiter.get_statistics();
+    PIKA_TEST_EQ(statistics.admitted, std::uint64_t(num_tasks));
+    PIKA_TEST_EQ(statistics.in_flight, std::size_t(0));
+    PIKA_TEST_EQ(statistics.queue_depth, std::size_t(0));
+
+    // Values and errors are forwarded, and release the operation
+    PIKA_TEST_EQ(tt::sync_wait(ex::just(42) | ex::admit(std::ref(limiter))), 42);
+
+    bool exception_thrown = false;
+    try
+    {
+        tt::sync_wait(ex::admit(
+            ex::schedule(sched) | ex::then([] { throw std::runtime_error("error"); }), limiter));
+        PIKA_TEST(false);
+    }
+    catch (std::runtime_error const&)
+    {
+        exception_thrown = true;
+    }
+    PIKA_TEST(exception_thrown);
+    PIKA_TEST_EQ(limiter.get_statistics().in_flight, std::size_t(0));
+}
+
+void test_limiting_scheduler()
+{
+    constexpr std::size_t limit = 2;
+    constexpr std::size_t num_tasks = 100;
+
+    ex::admission_limiter limiter(limit);
+    ex::limiting_scheduler sched{ex::thread_pool_scheduler{}, limiter};
+    in_flight_counter counter;
+
+    static_assert(ex::is_scheduler_v<decltype(sched)>);
+    PIKA_TEST(sched == (ex::limiting_scheduler{ex::thread_pool_scheduler{}, limiter}));
+    PIKA_TEST(
+        ex::get_completion_scheduler<ex::set_value_t>(ex::get_env(ex::schedule(sched))) == sched);
+
+    std::vector<ex::unique_any_sender<>> senders;
+    for (std::size_t i = 0; i < num_tasks; ++i)
+    {
+        senders.emplace_back(
+            ex::ensure_started(ex::schedule(sched) | ex::then(std::ref(counter))));
+    }
+    tt::sync_wait(ex::when_all_vector(std::move(senders)));
+
+    PIKA_TEST_EQ(counter.total.load(), num_tasks);
+    PIKA_TEST_LTE(counter.max_active.load(), limit);
+    PIKA_TEST_EQ(limiter.get_statistics().admitted, std::uint64_t(num_tasks));
+
+    // Tasks are released after set_value returns, which may be after
+    // sync_wait returns
+    while (limiter.get_statistics().in_flight != 0)
+    {
+        pika::this_thread::yield();
+    }
+}
+
+// sync_wait suspends a pika thread until it is admitted
+void test_sync_wait_acquire()
+{
+    ex::admission_limiter limiter(1);
+    PIKA_TEST(limiter.try_acquire());
+
+    std::atomic<bool> released{false};
+    ex::start_detached(ex::schedule(ex::thread_pool_scheduler{}) | ex::then([&] {
+        for (int i = 0; i < 10; ++i)
+        {
+            pika::this_thread::yield();
+        }
+        released = true;
+        limiter.release();
+    }));
+
+    tt::sync_wait(limiter.acquire());
+    PIKA_TEST(released.load());
+    limiter.release();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int pika_main()
+{
+    test_acquire_fifo();
+    test_try_acquire();
+    test_admit();
+    test_limiting_scheduler();
+    test_sync_wait_acquire();
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    PIKA_TEST_EQ_MSG(pika::init(pika_main, argc, argv), 0, "pika main exited with non-zero status");
+
+    return 0;
+}
@@ -19,9 +19,11 @@
 #include <atomic>
 #include <cstddef>
 #include <cstdlib>
+#include <functional>
 #include <iostream>
 #include <iterator>
 #include <numeric>
+#include <stdexcept>
 #include <string>
 #include <utility>
 #include <vector>
@@ -151,6 +153,99 @@ void test_bulk_async_exception(ExecutorArgs&&... args)
     PIKA_TEST(caught_exception);
 }
 
+template <typename... ExecutorArgs>
+void test_parallel_region(ExecutorArgs&&... args)
+{
+    fmt::print(std::cerr, "test_parallel_region\n");
+
+    fork_join_executor exec{std::forward<ExecutorArgs>(args)...};
+
+    std::size_t const n = 107;
+    std::vector<std::size_t> v(n, 0);
+    std::atomic<std::size_t> num_threads{0};
+    std::atomic<std::size_t> thread_indices{0};
+    std::atomic<bool> barrier_ok{true};
+    std::atomic<bool> reduce_ok{true};
+
+    exec.parallel_region([&](fork_join_executor::region_context& context) {
+        ++num_threads;
+        thread_indices |= std::size_t(1) << context.thread_index();
+
+        // Consecutive loops in the same region see the results of the
+        // previous loops.
+        context.for_each(pika::util::detail::make_counting_shape(n), [&](std::size_t i) {
+            v[i] = i;
+        });
+        context.for_each(pika::util::detail::make_counting_shape(n), [&](std::size_t i) {
+            if (v[n - 1 - i] != n - 1 - i)
+            {
+                barrier_ok = false;
+            }
+        });
+
+        context.barrier();
+        if (num_threads.load() != context.num_threads())
+        {
+            barrier_ok = false;
+        }
+
+        std::size_t const sum = context.reduce(context.thread_index() + 1, std::plus<>());
+        std::size_t const expected = context.num_threads() * (context.num_threads() + 1) / 2;
+        if (sum != expected)
+        {
+            reduce_ok = false;
+        }
+    });
+
+    std::size_t const expected_threads = pika::get_num_worker_threads();
+    PIKA_TEST_EQ(num_threads.load(), expected_threads);
+    PIKA_TEST_EQ(thread_indices.load(), (std::size_t(1) << expected_threads) - 1);
+    PIKA_TEST(barrier_ok.load());
+    PIKA_TEST(reduce_ok.load());
+
+    bool caught_exception = false;
+    try
+    {
+        exec.parallel_region(
+            [](fork_join_executor::region_context&) { throw std::runtime_error("test"); });
+
+        PIKA_TEST(false);
+    }
+    catch (std::runtime_error const& /*e*/)
+    {
+        caught_exception = true;
+    }
+    PIKA_TEST(caught_exception);
+}
+
+template <typename... ExecutorArgs>
+void test_bulk_sync_reduce(ExecutorArgs&&... args)
+{
+    fmt::print(std::cerr, "test_bulk_sync_reduce\n");
+
+    fork_join_executor exec{std::forward<ExecutorArgs>(args)...};
+
+    for (std::size_t const n : {0, 1, 3, 107, 10007})
+    {
+        std::vector<double> v(n);
+        std::iota(std::begin(v), std::end(v), 0.0);
+
+        double const sum =
+            exec.bulk_sync_reduce([](double x) { return 2 * x; }, v, 1.0, std::plus<>());
+        PIKA_TEST_EQ(sum, 1.0 + double(n) * double(n - 1));
+
+        // The partial results are combined in order
+        std::string const concatenated = exec.bulk_sync_reduce(
+            [](std::size_t i) { return std::to_string(i % 10); },
+            pika::util::detail::make_counting_shape(n), std::string(), std::plus<>());
+        PIKA_TEST_EQ(concatenated.size(), n);
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            PIKA_TEST_EQ(concatenated[i], char('0' + i % 10));
+        }
+    }
+}
+
 void static_check_executor()
 {
     using namespace pika::traits;
@@ -182,6 +277,8 @@ void test_executor(pika::execution::thread_priority priority,
     test_bulk_async(priority, stacksize, schedule);
     test_bulk_sync_exception(priority, stacksize, schedule);
     test_bulk_async_exception(priority, stacksize, schedule);
+    test_parallel_region(priority, stacksize, schedule);
+    test_bulk_sync_reduce(priority, stacksize, schedule);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -206,6 +303,7 @@ int pika_main()
             for (auto const schedule : {
                      fork_join_executor::loop_schedule::static_,
                      fork_join_executor::loop_schedule::dynamic,
+                     fork_join_executor::loop_schedule::guided,
                  })
             {
                 {
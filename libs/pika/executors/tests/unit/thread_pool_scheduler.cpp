@@ -9,14 +9,17 @@
 #include <pika/functional.hpp>
 #include <pika/init.hpp>
 #include <pika/mutex.hpp>
+#include <pika/stop_token.hpp>
 #include <pika/testing.hpp>
 #include <pika/thread.hpp>
+#include <pika/type_support/detail/with_result_of.hpp>
 
 #include <array>
 #include <atomic>
 #include <chrono>
 #include <cstddef>
 #include <exception>
+#include <optional>
 #include <stdexcept>
 #include <string>
 #include <thread>
@@ -319,6 +322,13 @@ void test_properties()
         // thread_pool_scheduler holds the property.
     }
 
+    PIKA_TEST_EQ(ex::get_bulk_chunk_size(sched), std::size_t(0));
+    for (std::size_t const chunk_size : {std::size_t(0), std::size_t(1), std::size_t(7)})
+    {
+        auto exec_prop = ex::with_bulk_chunk_size(sched, chunk_size);
+        PIKA_TEST_EQ(ex::get_bulk_chunk_size(exec_prop), chunk_size);
+    }
+
     {
         char const* annotation = "<test>";
         auto exec_prop = ex::with_annotation(sched, annotation);
@@ -1691,6 +1701,24 @@ void test_bulk()
         }
     }
 
+    // explicit chunk sizes
+    for (int n : ns)
+    {
+        for (std::size_t const chunk_size : {std::size_t(1), std::size_t(3), std::size_t(64)})
+        {
+            std::vector<int> v(n, 0);
+
+            tt::sync_wait(
+                ex::schedule(ex::with_bulk_chunk_size(ex::thread_pool_scheduler{}, chunk_size)) |
+                ex::bulk(n, [&](int i) { ++v[i]; }));
+
+            for (int i = 0; i < n; ++i)
+            {
+                PIKA_TEST_EQ(v[i], 1);
+            }
+        }
+    }
+
     // l-value reference sender
     for (int n : ns)
     {
@@ -1949,6 +1977,257 @@ void test_scheduler_queries()
         ex::forward_progress_guarantee::weakly_parallel);
 }
 
+struct stop_token_env
+{
+    pika::stop_token stop_token;
+
+    friend pika::stop_token tag_invoke(ex::get_stop_token_t, stop_token_env const& e) noexcept
+    {
+        return e.stop_token;
+    }
+};
+
+struct timed_receiver
+{
+    using is_receiver = void;
+
+    std::atomic<int>& value_calls;
+    std::atomic<int>& stopped_calls;
+    pika::stop_token stop_token;
+
+    friend void tag_invoke(ex::set_value_t, timed_receiver&& r) noexcept
+    {
+        ++r.value_calls;
+    }
+
+    friend void tag_invoke(ex::set_stopped_t, timed_receiver&& r) noexcept
+    {
+        ++r.stopped_calls;
+    }
+
+    friend void tag_invoke(ex::set_error_t, timed_receiver&&, std::exception_ptr) noexcept
+    {
+        PIKA_TEST(false);
+    }
+
+    friend stop_token_env tag_invoke(ex::get_env_t, timed_receiver const& r) noexcept
+    {
+        return {r.stop_token};
+    }
+};
+
+void wait_for_calls(std::atomic<int>& calls)
+{
+    while (calls.load() == 0)
+    {
+        pika::this_thread::yield();
+    }
+}
+
+void test_schedule_after()
+{
+    using std::chrono::steady_clock;
+
+    ex::thread_pool_scheduler sched{};
+
+    {
+        auto const start = steady_clock::now();
+        tt::sync_wait(ex::schedule_after(sched, std::chrono::milliseconds(10)));
+        PIKA_TEST(steady_clock::now() - start >= std::chrono::milliseconds(10));
+    }
+
+    {
+        auto const deadline = steady_clock::now() + std::chrono::milliseconds(10);
+        auto s = ex::schedule_at(sched, deadline) | ex::then([deadline] {
+            PIKA_TEST(steady_clock::now() >= deadline);
+            PIKA_TEST_NEQ(pika::threads::detail::get_self_id(),
+                pika::threads::detail::invalid_thread_id);
+            return 42;
+        });
+        PIKA_TEST_EQ(tt::sync_wait(std::move(s)), 42);
+    }
+
+    {
+        // Deadlines in the past complete immediately
+        tt::sync_wait(ex::schedule_at(sched, steady_clock::now() - std::chrono::hours(1)));
+        tt::sync_wait(ex::schedule_after(sched, std::chrono::hours(-1)));
+    }
+
+    {
+        // The duration is measured from when the operation is started
+        auto s = ex::schedule_after(sched, std::chrono::milliseconds(10));
+        pika::this_thread::sleep_for(std::chrono::milliseconds(20));
+        auto const start = steady_clock::now();
+        tt::sync_wait(std::move(s));
+        PIKA_TEST(steady_clock::now() - start >= std::chrono::milliseconds(10));
+    }
+}
+
+void test_schedule_after_stop()
+{
+    ex::thread_pool_scheduler sched{};
+    auto& wheel = sched.get_thread_pool()->get_scheduler()->get_timer_wheel();
+    std::size_t const num_timers = wheel.size();
+
+    {
+        // A stop request removes the timer and completes the operation
+        std::atomic<int> value_calls{0};
+        std::atomic<int> stopped_calls{0};
+        pika::stop_source ss;
+        auto os = ex::connect(ex::schedule_after(sched, std::chrono::hours(1)),
+            timed_receiver{value_calls, stopped_calls, ss.get_token()});
+        ex::start(os);
+        PIKA_TEST_EQ(wheel.size(), num_timers + 1);
+
+        ss.request_stop();
+        PIKA_TEST_EQ(stopped_calls.load(), 1);
+        PIKA_TEST_EQ(value_calls.load(), 0);
+        PIKA_TEST_EQ(wheel.size(), num_timers);
+    }
+
+    {
+        // The stop token is forwarded through then
+        std::atomic<int> value_calls{0};
+        std::atomic<int> stopped_calls{0};
+        pika::stop_source ss;
+        auto os = ex::connect(
+            ex::schedule_at(sched, std::chrono::steady_clock::now() + std::chrono::hours(1)) |
+                ex::then([] { PIKA_TEST(false); }),
+            timed_receiver{value_calls, stopped_calls, ss.get_token()});
+        ex::start(os);
+
+        ss.request_stop();
+        PIKA_TEST_EQ(stopped_calls.load(), 1);
+        PIKA_TEST_EQ(wheel.size(), num_timers);
+    }
+
+    {
+        // Stop requested before start
+        std::atomic<int> value_calls{0};
+        std::atomic<int> stopped_calls{0};
+        pika::stop_source ss;
+        ss.request_stop();
+        auto os = ex::connect(ex::schedule_after(sched, std::chrono::hours(1)),
+            timed_receiver{value_calls, stopped_calls, ss.get_token()});
+        ex::start(os);
+        PIKA_TEST_EQ(stopped_calls.load(), 1);
+        PIKA_TEST_EQ(wheel.size(), num_timers);
+    }
+
+    {
+        // Stop requested after the timer expired has no effect
+        std::atomic<int> value_calls{0};
+        std::atomic<int> stopped_calls{0};
+        pika::stop_source ss;
+        auto os = ex::connect(ex::schedule_after(sched, std::chrono::milliseconds(1)),
+            timed_receiver{value_calls, stopped_calls, ss.get_token()});
+        ex::start(os);
+        wait_for_calls(value_calls);
+        ss.request_stop();
+        PIKA_TEST_EQ(value_calls.load(), 1);
+        PIKA_TEST_EQ(stopped_calls.load(), 0);
+    }
+
+    {
+        // Concurrent expiry and stop requests complete exactly once
+        std::vector<std::atomic<int>> value_calls(100);
+        std::vector<std::atomic<int>> stopped_calls(100);
+        std::vector<pika::stop_source> stop_sources(100);
+        std::vector<std::optional<decltype(ex::connect(
+            ex::schedule_after(sched, std::chrono::microseconds(0)),
+            std::declval<timed_receiver>()))>>
+            op_states(100);
+
+        for (std::size_t i = 0; i != op_states.size(); ++i)
+        {
+            op_states[i].emplace(pika::detail::with_result_of([&] {
+                return ex::connect(ex::schedule_after(sched, std::chrono::microseconds(i * 10)),
+                    timed_receiver{value_calls[i], stopped_calls[i], stop_sources[i].get_token()});
+            }));
+            ex::start(*op_states[i]);
+        }
+
+        pika::this_thread::sleep_for(std::chrono::microseconds(500));
+        for (auto& ss : stop_sources)
+        {
+            ss.request_stop();
+        }
+
+        for (std::size_t i = 0; i != op_states.size(); ++i)
+        {
+            while (value_calls[i].load() + stopped_calls[i].load() == 0)
+            {
+                pika::this_thread::yield();
+            }
+            PIKA_TEST_EQ(value_calls[i].load() + stopped_calls[i].load(), 1);
+        }
+        PIKA_TEST_EQ(wheel.size(), num_timers);
+    }
+}
+
+void test_timeout()
+{
+    ex::thread_pool_scheduler sched{};
+    auto& wheel = sched.get_thread_pool()->get_scheduler()->get_timer_wheel();
+    std::size_t const num_timers = wheel.size();
+
+    {
+        // Senders completing before the deadline forward their values
+        PIKA_TEST_EQ(tt::sync_wait(ex::timeout(ex::just(42), sched, std::chrono::hours(1))), 42);
+
+        auto s = ex::schedule_after(sched, std::chrono::milliseconds(1)) |
+            ex::then([] { return std::string("hello"); }) |
+            ex::timeout(sched, std::chrono::hours(1));
+        PIKA_TEST_EQ(tt::sync_wait(std::move(s)), std::string("hello"));
+        PIKA_TEST_EQ(wheel.size(), num_timers);
+    }
+
+    {
+        // Errors are forwarded
+        bool exception_thrown = false;
+        try
+        {
+            tt::sync_wait(ex::schedule(sched) |
+                ex::then([] { throw std::runtime_error("error"); }) |
+                ex::timeout(sched, std::chrono::hours(1)));
+            PIKA_TEST(false);
+        }
+        catch (std::runtime_error const& e)
+        {
+            PIKA_TEST_EQ(std::string(e.what()), std::string("error"));
+            exception_thrown = true;
+        }
+        PIKA_TEST(exception_thrown);
+    }
+
+    {
+        // Senders are stopped when the deadline passes
+        std::atomic<int> value_calls{0};
+        std::atomic<int> stopped_calls{0};
+        auto os = ex::connect(ex::timeout(ex::schedule_after(sched, std::chrono::hours(1)), sched,
+                                  std::chrono::milliseconds(10)),
+            timed_receiver{value_calls, stopped_calls, pika::stop_token()});
+        ex::start(os);
+        wait_for_calls(stopped_calls);
+        PIKA_TEST_EQ(value_calls.load(), 0);
+        PIKA_TEST_EQ(wheel.size(), num_timers);
+    }
+
+    {
+        // Stop requests of the receiver are forwarded
+        std::atomic<int> value_calls{0};
+        std::atomic<int> stopped_calls{0};
+        pika::stop_source ss;
+        auto os = ex::connect(ex::timeout(ex::schedule_after(sched, std::chrono::hours(1)), sched,
+                                  std::chrono::hours(1)),
+            timed_receiver{value_calls, stopped_calls, ss.get_token()});
+        ex::start(os);
+        ss.request_stop();
+        PIKA_TEST_EQ(stopped_calls.load(), 1);
+        PIKA_TEST_EQ(wheel.size(), num_timers);
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 int pika_main()
 {
@@ -1983,6 +2262,9 @@ int pika_main()
     test_split_tuple();
     test_completion_scheduler();
     test_scheduler_queries();
+    test_schedule_after();
+    test_schedule_after_stop();
+    test_timeout();
 
     return pika::finalize();
 }
@@ -10,7 +10,6 @@
 #include <pika/assert.hpp>
 #include <pika/async_base/launch_policy.hpp>
 #include <pika/coroutines/detail/get_stack_pointer.hpp>
-#include <pika/datastructures/detail/small_vector.hpp>
 #include <pika/errors/try_catch_exception_ptr.hpp>
 #include <pika/functional/function.hpp>
 #include <pika/futures/future_fwd.hpp>
@@ -28,12 +27,14 @@
 #include <atomic>
 #include <chrono>
 #include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include <pika/config/warnings_prefix.hpp>
 
@@ -76,8 +77,7 @@ namespace pika::lcos::detail {
 
     public:
         using completed_callback_type = util::detail::unique_function<void()>;
-        using completed_callback_vector_type =
-            pika::detail::small_vector<completed_callback_type, 1>;
+        using completed_callback_vector_type = std::vector<completed_callback_type>;
 
         using has_future_data_refcnt_base = void;
 
@@ -242,7 +242,7 @@ namespace pika::lcos::detail {
 
         bool has_value() const noexcept
         {
-            return state_.load(std::memory_order_acquire) == value;
+            return get_state() == value;
         }
 
         bool has_exception() const noexcept
@@ -251,7 +251,7 @@ namespace pika::lcos::detail {
 # pragma GCC diagnostic push
 # pragma GCC diagnostic ignored "-Wstringop-overflow"
 #endif
-            return state_.load(std::memory_order_acquire) == exception;
+            return get_state() == exception;
 #if defined(__GNUC__) && !defined(__clang__)
 # pragma GCC diagnostic pop
 #endif
@@ -317,10 +317,45 @@ namespace pika::lcos::detail {
         }
 
     protected:
+        // Flags stored in state_ next to the state. has_waiters is set once a
+        // thread has blocked in wait or wait_until, and has_continuation once
+        // a continuation has been stored in on_completed_. The flags are only
+        // set while holding mtx_. Making the shared state ready only takes
+        // mtx_ if one of the flags is set.
+        static constexpr std::uint32_t state_mask = 7;
+        static constexpr std::uint32_t has_waiters = 8;
+        static constexpr std::uint32_t has_continuation = 16;
+
+        state get_state(std::memory_order order = std::memory_order_acquire) const noexcept
+        {
+            return static_cast<state>(state_.load(order) & state_mask);
+        }
+
+        // Changes the state to new_state, which must be value or exception,
+        // wakes up waiting threads and runs the continuation, if any. Throws
+        // if the shared state is already ready.
+        void set_ready(state new_state, char const* function);
+
+        // Sets the given flag, which must be has_waiters or has_continuation,
+        // unless the shared state is ready. Returns false if the shared state
+        // is ready and the flag has not been set. The lock must be held.
+        bool set_flag(std::unique_lock<mutex_type>& l, std::uint32_t flag) noexcept;
+
+        // Data that is only needed when threads block on the shared state or
+        // when more than one continuation is attached to it. It is allocated
+        // on first use.
+        struct waiter_data
+        {
+            pika::detail::condition_variable cond_;    // threads waiting in read
+            completed_callback_vector_type on_completed_;
+        };
+
+        waiter_data& get_waiter_data(std::unique_lock<mutex_type>& l);
+
         mutable mutex_type mtx_;
-        std::atomic<state> state_;    // current state
-        completed_callback_vector_type on_completed_;
-        pika::detail::condition_variable cond_;    // threads waiting in read
+        std::atomic<std::uint32_t> state_;    // current state and flags
+        completed_callback_type on_completed_;    // the first continuation
+        std::unique_ptr<waiter_data> waiters_;
     };
 
     struct in_place
@@ -434,47 +469,9 @@ namespace pika::lcos::detail {
             result_type* value_ptr = reinterpret_cast<result_type*>(&storage_);
             construct(value_ptr, PIKA_FORWARD(Ts, ts)...);
 
-            // At this point the lock needs to be acquired to safely access the
-            // registered continuations
-            std::unique_lock<mutex_type> l(mtx_);
-
-            // handle all threads waiting for the future to become ready
-            auto on_completed = PIKA_MOVE(on_completed_);
-            on_completed_.clear();
-
             // The value has been set, changing the state to 'value' at this
             // point signals to all other threads that this future is ready.
-            state expected = empty;
-            if (!state_.compare_exchange_strong(expected, value, std::memory_order_release))
-            {
-                // this future should be 'empty' still (it can't be made ready
-                // more than once).
-                l.unlock();
-                PIKA_THROW_EXCEPTION(pika::error::promise_already_satisfied,
-                    "future_data_base::set_value", "data has already been set for this future");
-                return;
-            }
-
-            // Note: we use notify_one repeatedly instead of notify_all as we
-            //       know: a) that most of the time we have at most one thread
-            //       waiting on the future (most futures are not shared), and
-            //       b) our implementation of condition_variable::notify_one
-            //       relinquishes the lock before resuming the waiting thread
-            //       which avoids suspension of this thread when it tries to
-            //       re-lock the mutex while exiting from condition_variable::wait
-            while (cond_.notify_one(PIKA_MOVE(l), execution::thread_priority::boost))
-            {
-                l = std::unique_lock<mutex_type>(mtx_);
-            }
-
-            // Note: cv.notify_one() above 'consumes' the lock 'l' and leaves
-            //       it unlocked when returning.
-
-            // invoke the callback (continuation) function
-            if (!on_completed.empty())
-            {
-                handle_on_completed(PIKA_MOVE(on_completed));
-            }
+            this->set_ready(value, "future_data_base::set_value");
         }
 
         void set_exception(std::exception_ptr data) override
@@ -489,47 +486,9 @@ namespace pika::lcos::detail {
             std::exception_ptr* exception_ptr = reinterpret_cast<std::exception_ptr*>(&storage_);
             ::new ((void*) exception_ptr) std::exception_ptr(PIKA_MOVE(data));
 
-            // At this point the lock needs to be acquired to safely access the
-            // registered continuations
-            std::unique_lock<mutex_type> l(mtx_);
-
-            // handle all threads waiting for the future to become ready
-            auto on_completed = PIKA_MOVE(on_completed_);
-            on_completed_.clear();
-
             // The value has been set, changing the state to 'exception' at this
             // point signals to all other threads that this future is ready.
-            state expected = empty;
-            if (!state_.compare_exchange_strong(expected, exception, std::memory_order_release))
-            {
-                // this future should be 'empty' still (it can't be made ready
-                // more than once).
-                l.unlock();
-                PIKA_THROW_EXCEPTION(pika::error::promise_already_satisfied,
-                    "future_data_base::set_exception", "data has already been set for this future");
-                return;
-            }
-
-            // Note: we use notify_one repeatedly instead of notify_all as we
-            //       know: a) that most of the time we have at most one thread
-            //       waiting on the future (most futures are not shared), and
-            //       b) our implementation of condition_variable::notify_one
-            //       relinquishes the lock before resuming the waiting thread
-            //       which avoids suspension of this thread when it tries to
-            //       re-lock the mutex while exiting from condition_variable::wait
-            while (cond_.notify_one(PIKA_MOVE(l), execution::thread_priority::boost))
-            {
-                l = std::unique_lock<mutex_type>(mtx_);
-            }
-
-            // Note: cv.notify_one() above 'consumes' the lock 'l' and leaves
-            //       it unlocked when returning.
-
-            // invoke the callback (continuation) function
-            if (!on_completed.empty())
-            {
-                handle_on_completed(PIKA_MOVE(on_completed));
-            }
+            this->set_ready(exception, "future_data_base::set_exception");
         }
 
         // helper functions for setting data (if successful) or the error (if
@@ -556,7 +515,7 @@ namespace pika::lcos::detail {
             // and no reader
 
             // release any stored data and callback functions
-            switch (state_.exchange(empty))
+            switch (state_.exchange(empty) & state_mask)
             {
             case value:
             {
@@ -575,12 +534,16 @@ namespace pika::lcos::detail {
                 break;
             }
 
-            on_completed_.clear();
+            on_completed_.reset();
+            if (this->waiters_)
+            {
+                this->waiters_->on_completed_.clear();
+            }
         }
 
         std::exception_ptr get_exception_ptr() const override
         {
-            PIKA_ASSERT(state_.load(std::memory_order_acquire) == exception);
+            PIKA_ASSERT(this->get_state() == exception);
             return *reinterpret_cast<std::exception_ptr const*>(&storage_);
         }
 
@@ -590,7 +553,6 @@ namespace pika::lcos::detail {
         using base_type::state_;
 
     private:
-        using base_type::cond_;
         future_data_storage_t<Result> storage_;
     };
 
@@ -21,8 +21,10 @@
 
 #include <atomic>
 #include <cstddef>
+#include <cstdint>
 #include <exception>
 #include <functional>
+#include <memory>
 #include <mutex>
 #include <utility>
 
@@ -110,7 +112,7 @@ namespace pika::lcos::detail {
         // thread was suspended, in this case we need to load it again.
         if (s == empty)
         {
-            s = state_.load(std::memory_order_relaxed);
+            s = get_state(std::memory_order_relaxed);
         }
 
         if (s == value)
@@ -236,6 +238,116 @@ namespace pika::lcos::detail {
     future_data_base<traits::detail::future_data_void>::handle_on_completed<
         completed_callback_vector_type>(completed_callback_vector_type&&);
 
+    future_data_base<traits::detail::future_data_void>::waiter_data&
+    future_data_base<traits::detail::future_data_void>::get_waiter_data(
+        [[maybe_unused]] std::unique_lock<mutex_type>& l)
+    {
+        PIKA_ASSERT_OWNS_LOCK(l);
+
+        if (!waiters_)
+        {
+            waiters_ = std::make_unique<waiter_data>();
+        }
+        return *waiters_;
+    }
+
+    void future_data_base<traits::detail::future_data_void>::set_ready(
+        state new_state, char const* function)
+    {
+        std::uint32_t s = state_.load(std::memory_order_relaxed);
+        do
+        {
+            if ((s & ready) != 0)
+            {
+                // this future should be 'empty' still (it can't be made ready
+                // more than once).
+                PIKA_THROW_EXCEPTION(pika::error::promise_already_satisfied, function,
+                    "data has already been set for this future");
+                return;
+            }
+        } while (!state_.compare_exchange_weak(
+            s, s | new_state, std::memory_order_acq_rel, std::memory_order_relaxed));
+
+        // Nobody has blocked on the future or attached a continuation. Any
+        // thread trying to do so from now on will see that the future is
+        // ready.
+        if ((s & (has_waiters | has_continuation)) == 0)
+        {
+            return;
+        }
+
+        // The flags are set while holding the lock. Taking the lock here
+        // ensures that the continuations and the condition variable are
+        // visible to this thread.
+        std::unique_lock<mutex_type> l(mtx_);
+
+        completed_callback_type on_completed;
+        completed_callback_vector_type more_on_completed;
+        if ((s & has_continuation) != 0)
+        {
+            on_completed = PIKA_MOVE(on_completed_);
+            on_completed_.reset();
+            if (waiters_)
+            {
+                more_on_completed = PIKA_MOVE(waiters_->on_completed_);
+                waiters_->on_completed_.clear();
+            }
+        }
+
+        if ((s & has_waiters) != 0)
+        {
+            // Note: we use notify_one repeatedly instead of notify_all as we
+            //       know: a) that most of the time we have at most one thread
+            //       waiting on the future (most futures are not shared), and
+            //       b) our implementation of condition_variable::notify_one
+            //       relinquishes the lock before resuming the waiting thread
+            //       which avoids suspension of this thread when it tries to
+            //       re-lock the mutex while exiting from condition_variable::wait
+            while (waiters_->cond_.notify_one(PIKA_MOVE(l), execution::thread_priority::boost))
+            {
+                l = std::unique_lock<mutex_type>(mtx_);
+            }
+
+            // Note: cv.notify_one() above 'consumes' the lock 'l' and leaves
+            //       it unlocked when returning.
+        }
+        else
+        {
+            l.unlock();
+        }
+
+        // invoke the callback (continuation) functions
+        if (!more_on_completed.empty())
+        {
+            more_on_completed.insert(more_on_completed.begin(), PIKA_MOVE(on_completed));
+            handle_on_completed(PIKA_MOVE(more_on_completed));
+        }
+        else if (on_completed)
+        {
+            handle_on_completed(PIKA_MOVE(on_completed));
+        }
+    }
+
+    bool future_data_base<traits::detail::future_data_void>::set_flag(
+        [[maybe_unused]] std::unique_lock<mutex_type>& l, std::uint32_t flag) noexcept
+    {
+        PIKA_ASSERT_OWNS_LOCK(l);
+
+        // The only concurrent modification of the state while the lock is
+        // held is the future becoming ready
+        std::uint32_t s = state_.load(std::memory_order_acquire);
+        while ((s & ready) == 0)
+        {
+            if ((s & flag) != 0 ||
+                state_.compare_exchange_weak(
+                    s, s | flag, std::memory_order_acq_rel, std::memory_order_acquire))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
     /// Set the callback which needs to be invoked when the future becomes
     /// ready. If the future is ready the function will be invoked
     /// immediately.
@@ -245,48 +357,59 @@ namespace pika::lcos::detail {
         if (!data_sink)
             return;
 
-        if (is_ready())
-        {
-            // invoke the callback (continuation) function right away
-            handle_on_completed(PIKA_MOVE(data_sink));
-        }
-        else
+        if (!is_ready())
         {
             std::unique_lock l(mtx_);
-            if (is_ready())
+            if (!is_ready())
             {
-                l.unlock();
+                if (on_completed_)
+                {
+                    // A continuation has already been attached and the flag
+                    // has been set. The thread making the future ready will
+                    // take the lock before running the continuations. Only
+                    // continuations beyond the first one need an allocation.
+                    get_waiter_data(l).on_completed_.push_back(PIKA_MOVE(data_sink));
+                    return;
+                }
 
-                // invoke the callback (continuation) function
-                handle_on_completed(PIKA_MOVE(data_sink));
-            }
-            else
-            {
-                on_completed_.push_back(PIKA_MOVE(data_sink));
+                // If the future becomes ready before the flag can be set the
+                // thread making it ready does not see the continuation and we
+                // have to run it ourselves.
+                on_completed_ = PIKA_MOVE(data_sink);
+                if (set_flag(l, has_continuation))
+                {
+                    return;
+                }
+
+                data_sink = PIKA_MOVE(on_completed_);
+                on_completed_.reset();
             }
         }
+
+        // invoke the callback (continuation) function right away
+        handle_on_completed(PIKA_MOVE(data_sink));
     }
 
     future_data_base<traits::detail::future_data_void>::state
     future_data_base<traits::detail::future_data_void>::wait(error_code& ec)
     {
         // block if this entry is empty
-        state s = state_.load(std::memory_order_acquire);
+        state s = get_state();
         if (s == empty)
         {
             std::unique_lock l(mtx_);
-            s = state_.load(std::memory_order_relaxed);
-            if (s == empty)
+            waiter_data& waiters = get_waiter_data(l);
+            if (set_flag(l, has_waiters))
             {
-                cond_.wait(l, "future_data_base::wait", ec);
+                waiters.cond_.wait(l, "future_data_base::wait", ec);
                 if (ec)
                 {
                     return s;
                 }
-
-                // reload the state, it's not empty anymore
-                s = state_.load(std::memory_order_relaxed);
             }
+
+            // reload the state, it's not empty anymore
+            s = get_state();
         }
 
         if (&ec != &throws)
@@ -300,20 +423,20 @@ namespace pika::lcos::detail {
         std::chrono::steady_clock::time_point const& abs_time, error_code& ec)
     {
         // block if this entry is empty
-        if (state_.load(std::memory_order_acquire) == empty)
+        if (!is_ready())
         {
             std::unique_lock l(mtx_);
-            if (state_.load(std::memory_order_relaxed) == empty)
+            waiter_data& waiters = get_waiter_data(l);
+            if (set_flag(l, has_waiters))
             {
                 threads::detail::thread_restart_state const reason =
-                    cond_.wait_until(l, abs_time, "future_data_base::wait_until", ec);
+                    waiters.cond_.wait_until(l, abs_time, "future_data_base::wait_until", ec);
                 if (ec)
                 {
                     return pika::future_status::uninitialized;
                 }
 
-                if (reason == threads::detail::thread_restart_state::timeout &&
-                    state_.load(std::memory_order_acquire) == empty)
+                if (reason == threads::detail::thread_restart_state::timeout && !is_ready())
                 {
                     return pika::future_status::timeout;
                 }
@@ -14,10 +14,12 @@
 # include <pika/runtime/get_worker_thread_num.hpp>
 # include <pika/runtime_configuration/runtime_configuration.hpp>
 # include <pika/threading_base/thread_data.hpp>
+# include <pika/util/get_entry_as.hpp>
 
 # include <fmt/ostream.h>
 # include <fmt/printf.h>
 
+# include <chrono>
 # include <cstddef>
 # include <cstdint>
 # include <cstdlib>
@@ -693,6 +695,33 @@ namespace pika::util {
             init_debuglog_console_log(lvl, PIKA_MOVE(settings.dest_), PIKA_MOVE(settings.format_));
         }
 
+        ///////////////////////////////////////////////////////////////////////
+        // settings of the async_file destinations created from now on
+        void init_async_file_settings(runtime_configuration& ini)
+        {
+            using async_file = logging::destination::async_file;
+            using pika::detail::get_entry_as;
+
+            async_file::async_settings settings;
+            settings.buffer_size = get_entry_as<std::size_t>(
+                ini, "pika.logging.async.buffer_size", settings.buffer_size);
+            settings.flush_interval = std::chrono::milliseconds(get_entry_as<std::int64_t>(
+                ini, "pika.logging.async.flush_interval", settings.flush_interval.count()));
+
+            std::string const overflow = ini.get_entry("pika.logging.async.overflow", "drop");
+            if (overflow == "block")
+            {
+                settings.overflow = async_file::overflow_policy::block;
+            }
+            else if (overflow != "drop")
+            {
+                std::cerr << "pika::init_logging: warning: unknown overflow policy \"" << overflow
+                          << "\" for pika.logging.async.overflow, using \"drop\"" << std::endl;
+            }
+
+            async_file::set_default_settings(settings);
+        }
+
         ///////////////////////////////////////////////////////////////////////
         static void (*default_set_console_dest)(logger_writer_type&, char const*, logging::level,
             logging_destination) = get_console_local;
@@ -711,6 +740,8 @@ namespace pika::util {
             default_set_console_dest = set_console_dest;
             default_define_formatters = define_formatters;
 
+            init_async_file_settings(ini);
+
             // initialize normal logs
             init_timing_log(ini, isconsole, set_console_dest, define_formatters);
             init_pika_log(ini, isconsole, set_console_dest, define_formatters);
@@ -221,6 +221,14 @@ namespace pika {
 #if defined(__linux) || defined(linux) || defined(__linux__) || defined(__FreeBSD__)
             threads::coroutines::detail::posix::use_guard_pages =
                 cmdline.rtcfg_.use_stack_guard_pages();
+
+            auto& stack_arena_params = threads::coroutines::detail::posix::stack_arena_params;
+            stack_arena_params.enabled = cmdline.rtcfg_.use_stack_arena();
+            stack_arena_params.arena_size = cmdline.rtcfg_.get_stack_arena_size();
+            stack_arena_params.huge_pages =
+                static_cast<threads::coroutines::detail::posix::stack_arena_huge_pages>(
+                    cmdline.rtcfg_.get_stack_arena_huge_pages());
+            stack_arena_params.cache_size = cmdline.rtcfg_.get_stack_arena_cache_size();
 #endif
 #ifdef PIKA_HAVE_VERIFY_LOCKS
             if (cmdline.rtcfg_.enable_lock_detection())
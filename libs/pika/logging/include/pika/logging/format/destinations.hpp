@@ -19,6 +19,10 @@
 #include <pika/config.hpp>
 #include <pika/logging/manipulator.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <ios>
 #include <iosfwd>
 #include <memory>
@@ -158,4 +162,74 @@ namespace pika::util::logging::destination {
         file_settings settings;
     };
 
+    /**
+    @brief Writes the string to a file from a background thread
+
+    Each thread writing to the destination copies the message into its own
+    lock-free ring buffer. A background OS thread drains the ring buffers of
+    all threads in batches, using a single writev call per batch where
+    available. The file is only opened when the first message is written.
+
+    Messages written by one thread appear in the file in the order they have
+    been written, but messages of different threads may be reordered.
+
+    @note Messages larger than the ring buffer are dropped when the overflow
+    policy is drop. Otherwise they are written directly to the file by the
+    thread logging them, once its earlier messages have been written.
+*/
+    struct async_file : manipulator
+    {
+        /// What to do when the ring buffer of a thread is full
+        enum class overflow_policy
+        {
+            /// drop the message and count it in get_dropped_messages()
+            drop,
+            /// wait until the background thread has made enough room
+            block
+        };
+
+        struct async_settings
+        {
+            /// the size of the ring buffer of each thread in bytes
+            std::size_t buffer_size = 1024 * 1024;
+            overflow_policy overflow = overflow_policy::drop;
+            /// the longest time a message waits in a ring buffer
+            std::chrono::milliseconds flush_interval{10};
+        };
+
+        /**
+        @brief constructs the asynchronous file destination
+
+        @param file_name name of the file
+        @param set settings - see async_settings. Destinations created by
+        named_write use the settings set with set_default_settings.
+    */
+        PIKA_EXPORT static std::unique_ptr<async_file> make(
+            std::string const& file_name, async_settings set);
+        PIKA_EXPORT static std::unique_ptr<async_file> make(std::string const& file_name);
+
+        /// @brief Sets the settings used by async_file destinations created
+        /// from now on without explicit settings.
+        PIKA_EXPORT static void set_default_settings(async_settings set);
+
+        /// Writes all buffered messages and stops the background thread.
+        PIKA_EXPORT ~async_file();
+
+        std::uint64_t get_dropped_messages() const noexcept
+        {
+            return dropped_messages.load(std::memory_order_relaxed);
+        }
+
+    protected:
+        async_file(std::string const& file_name, async_settings set)
+          : name(file_name)
+          , settings(set)
+        {
+        }
+
+        std::string name;
+        async_settings settings;
+        std::atomic<std::uint64_t> dropped_messages{0};
+    };
+
 }    // namespace pika::util::logging::destination
@@ -336,8 +336,10 @@ namespace pika::util::logging::writer {
     ///   - <tt>"debug"</tt> - writes to the debug window: OutputDebugString in Windows,
     ///   console on Linux (destination::dbg_window)
     ///   - <tt>"file"</tt> - writes to a file (destination::file)
+    ///   - <tt>"async_file"</tt> - writes to a file from a background thread
+    ///   (destination::async_file)
     /// - If a destination is configurable, append @em (params) to it
-    ///   - Right now, @c "file" is configurable
+    ///   - Right now, @c "file" and @c "async_file" are configurable
     ///     - Append <tt>(</tt><em>filename</em><tt>)</tt> to them to specify the file name.
     ///     Example: @c "file(out.txt)" will write to the out.txt file
     ///
@@ -0,0 +1,570 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/logging/format/destinations.hpp>
+
+#include <pika/config.hpp>
+#include <pika/logging/message.hpp>
+#include <pika/modules/logging.hpp>
+
+#if defined(PIKA_WINDOWS)
+# include <cstdio>
+#else
+# include <fcntl.h>
+# include <limits.h>
+# include <sys/uio.h>
+# include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pika::util::logging::destination {
+
+    namespace {
+#if defined(PIKA_WINDOWS)
+        struct iovec
+        {
+            void* iov_base;
+            std::size_t iov_len;
+        };
+
+        constexpr std::size_t max_iovecs = 64;
+#else
+        constexpr std::size_t max_iovecs = IOV_MAX < 1024 ? IOV_MAX : 1024;
+#endif
+
+        // A ring buffer of bytes with a single producer and a single consumer.
+        // The producer only publishes complete messages, and the consumer
+        // reads the contents directly from the buffer without copying.
+        class byte_ring
+        {
+        public:
+            explicit byte_ring(std::size_t capacity)
+            {
+                std::size_t rounded = 64;
+                while (rounded < capacity)
+                {
+                    rounded *= 2;
+                }
+                mask_ = rounded - 1;
+                data_.reset(new char[rounded]);
+            }
+
+            std::size_t capacity() const noexcept
+            {
+                return mask_ + 1;
+            }
+
+            // Copies all of [data, data + size) into the buffer, or nothing
+            // if there is not enough room. Called by the producer.
+            bool try_write(char const* data, std::size_t size) noexcept
+            {
+                std::size_t const tail = tail_.load(std::memory_order_relaxed);
+                if (capacity() - (tail - cached_head_) < size)
+                {
+                    cached_head_ = head_.load(std::memory_order_acquire);
+                    if (capacity() - (tail - cached_head_) < size)
+                    {
+                        return false;
+                    }
+                }
+
+                std::size_t const offset = tail & mask_;
+                std::size_t const first = (std::min)(size, capacity() - offset);
+                std::memcpy(&data_[offset], data, first);
+                std::memcpy(&data_[0], data + first, size - first);
+
+                tail_.store(tail + size, std::memory_order_release);
+                return true;
+            }
+
+            // The number of bytes in the buffer
+            std::size_t size() const noexcept
+            {
+                return tail_.load(std::memory_order_acquire) -
+                    head_.load(std::memory_order_relaxed);
+            }
+
+            // Describes the contents of the buffer by at most two iovecs.
+            // Returns the number of iovecs used. Called by the consumer.
+            std::size_t get_contents(iovec* iov) const noexcept
+            {
+                std::size_t const head = head_.load(std::memory_order_relaxed);
+                std::size_t const size = tail_.load(std::memory_order_acquire) - head;
+                if (size == 0)
+                {
+                    return 0;
+                }
+
+                std::size_t const offset = head & mask_;
+                std::size_t const first = (std::min)(size, capacity() - offset);
+                iov[0].iov_base = &data_[offset];
+                iov[0].iov_len = first;
+                if (first == size)
+                {
+                    return 1;
+                }
+
+                iov[1].iov_base = &data_[0];
+                iov[1].iov_len = size - first;
+                return 2;
+            }
+
+            // Releases the first size bytes. Called by the consumer.
+            void consume(std::size_t size) noexcept
+            {
+                head_.store(
+                    head_.load(std::memory_order_relaxed) + size, std::memory_order_release);
+            }
+
+            // Set when the destination the buffer belongs to is destroyed,
+            // the producer thread then releases the buffer
+            std::atomic<bool> orphaned{false};
+
+            // Set when the producer thread has exited, the writer then
+            // releases the buffer once it has been drained
+            std::atomic<bool> producer_exited{false};
+
+        private:
+            std::size_t mask_;
+            std::unique_ptr<char[]> data_;
+
+            alignas(64) std::atomic<std::size_t> head_{0};
+            alignas(64) std::atomic<std::size_t> tail_{0};
+            // only accessed by the producer
+            std::size_t cached_head_ = 0;
+        };
+
+        // The ring buffers of the current thread, one per async_file
+        // destination it has written to. Destinations are identified by a
+        // unique id instead of their address since addresses may be reused.
+        struct thread_rings
+        {
+            ~thread_rings()
+            {
+                for (auto& r : rings)
+                {
+                    r.second->producer_exited.store(true, std::memory_order_release);
+                }
+            }
+
+            std::vector<std::pair<std::uint64_t, std::shared_ptr<byte_ring>>> rings;
+        };
+
+        thread_local thread_rings current_thread_rings;
+
+        std::atomic<std::uint64_t> next_async_file_id{0};
+
+        std::mutex default_settings_mtx;
+        async_file::async_settings default_settings;
+    }    // namespace
+
+    async_file::~async_file() = default;
+
+    struct async_file_impl : async_file
+    {
+        explicit async_file_impl(std::string const& file_name, async_settings set)
+          : async_file(file_name, set)
+        {
+        }
+
+        ~async_file_impl() override
+        {
+            stop();
+
+            for (auto& ring : rings_)
+            {
+                ring->orphaned.store(true, std::memory_order_relaxed);
+            }
+        }
+
+        void operator()(message const& msg) override
+        {
+            std::string const& str = msg.full_string();
+            if (str.empty())
+            {
+                return;
+            }
+
+            byte_ring& ring = get_thread_ring();
+            if (ring.try_write(str.data(), str.size()))
+            {
+                // Wake up the writer early if the buffer is filling up
+                if (ring.size() > ring.capacity() / 2)
+                {
+                    wake_writer();
+                }
+                return;
+            }
+
+            if (settings.overflow == overflow_policy::drop)
+            {
+                ++dropped_messages;
+                wake_writer();
+                return;
+            }
+
+            // Block until the writer has made enough room. Messages are
+            // always written to the buffer as a whole so that messages of
+            // different threads are not interleaved in the file.
+            if (str.size() <= ring.capacity())
+            {
+                while (!ring.try_write(str.data(), str.size()))
+                {
+                    wait_for_room(ring, str.size());
+                }
+                wake_writer();
+                return;
+            }
+
+            // Messages that don't fit into the buffer at all are written
+            // directly, after the preceding messages of this thread
+            wait_for_drain(ring);
+            write_direct(str);
+        }
+
+        // Changes the file name. The background thread reopens the file
+        // before writing the next batch of messages.
+        void configure(std::string const& str) override
+        {
+            {
+                std::lock_guard<std::mutex> l(mtx_);
+                name = str;
+                reopen_ = true;
+            }
+            cond_.notify_one();
+        }
+
+    private:
+        byte_ring& get_thread_ring()
+        {
+            auto& rings = current_thread_rings.rings;
+            for (auto& r : rings)
+            {
+                if (r.first == id_)
+                {
+                    return *r.second;
+                }
+            }
+
+            // First message written by this thread, release the buffers of
+            // destroyed destinations and register a new ring buffer with the
+            // writer
+            rings.erase(std::remove_if(rings.begin(), rings.end(),
+                            [](auto const& r) {
+                                return r.second->orphaned.load(std::memory_order_relaxed);
+                            }),
+                rings.end());
+
+            auto ring = std::make_shared<byte_ring>(settings.buffer_size);
+            rings.emplace_back(id_, ring);
+
+            std::lock_guard<std::mutex> l(mtx_);
+            rings_.push_back(ring);
+            if (!writer_.joinable())
+            {
+                writer_ = std::thread(&async_file_impl::writer_loop, this);
+            }
+            return *ring;
+        }
+
+        void wake_writer()
+        {
+            if (!wakeup_requested_.exchange(true, std::memory_order_acq_rel))
+            {
+                // Taking the lock makes sure that the writer is either
+                // waiting or will see the request before waiting
+                {
+                    std::lock_guard<std::mutex> l(mtx_);
+                }
+                cond_.notify_one();
+            }
+        }
+
+        // Wakes up the writer and waits until it has drained the buffer
+        // far enough for size bytes. The writer notifies space_cond_ with
+        // mtx_ held after every drain, checking the room with mtx_ held
+        // makes sure that no notification is missed.
+        void wait_for_room(byte_ring& ring, std::size_t size)
+        {
+            std::unique_lock<std::mutex> l(mtx_);
+            wakeup_requested_.store(true, std::memory_order_relaxed);
+            cond_.notify_one();
+            space_cond_.wait_for(l, settings.flush_interval,
+                [&] { return stop_ || ring.capacity() - ring.size() >= size; });
+        }
+
+        // Waits until the writer has written all contents of the buffer and
+        // opened the file, if that is pending
+        void wait_for_drain(byte_ring& ring)
+        {
+            std::unique_lock<std::mutex> l(mtx_);
+            while (!stop_ && (reopen_ || ring.size() != 0))
+            {
+                wakeup_requested_.store(true, std::memory_order_relaxed);
+                cond_.notify_one();
+                space_cond_.wait_for(l, settings.flush_interval);
+            }
+        }
+
+        // Writes a message to the file bypassing the ring buffers. file_mtx_
+        // keeps the writer from writing at the same time.
+        void write_direct(std::string const& str)
+        {
+            std::lock_guard<std::mutex> l(file_mtx_);
+            if (!opened_)
+            {
+                ++dropped_messages;
+                return;
+            }
+
+            iovec iov;
+            iov.iov_base = const_cast<char*>(str.data());
+            iov.iov_len = str.size();
+            while (iov.iov_len != 0)
+            {
+                std::ptrdiff_t const written = write(&iov, 1);
+                if (written <= 0)
+                {
+                    break;
+                }
+                iov.iov_base = static_cast<char*>(iov.iov_base) + written;
+                iov.iov_len -= std::size_t(written);
+            }
+        }
+
+        void stop()
+        {
+            {
+                std::lock_guard<std::mutex> l(mtx_);
+                stop_ = true;
+            }
+            cond_.notify_one();
+
+            if (writer_.joinable())
+            {
+                writer_.join();
+            }
+        }
+
+        bool open(std::string const& file_name)
+        {
+#if defined(PIKA_WINDOWS)
+            file_ = std::fopen(file_name.c_str(), "ab");
+            bool const opened = file_ != nullptr;
+#else
+            fd_ = ::open(file_name.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+            bool const opened = fd_ != -1;
+#endif
+            if (!opened)
+            {
+                LERR_(error).format(
+                    "async_file: could not open \"{}\": {}", file_name, std::strerror(errno));
+            }
+            return opened;
+        }
+
+        void close()
+        {
+#if defined(PIKA_WINDOWS)
+            if (file_ != nullptr)
+            {
+                std::fclose(file_);
+                file_ = nullptr;
+            }
+#else
+            if (fd_ != -1)
+            {
+                ::close(fd_);
+                fd_ = -1;
+            }
+#endif
+        }
+
+        // Writes the given buffers and returns the number of bytes written,
+        // or -1 on errors
+        std::ptrdiff_t write(iovec* iov, std::size_t count)
+        {
+#if defined(PIKA_WINDOWS)
+            std::ptrdiff_t written = 0;
+            for (std::size_t i = 0; i != count; ++i)
+            {
+                written += std::ptrdiff_t(std::fwrite(iov[i].iov_base, 1, iov[i].iov_len, file_));
+            }
+            std::fflush(file_);
+            return written;
+#else
+            std::ptrdiff_t written = 0;
+            do
+            {
+                written = ::writev(fd_, iov, static_cast<int>(count));
+            } while (written == -1 && errno == EINTR);
+            return written;
+#endif
+        }
+
+        // Writes the contents of all ring buffers to the file. If the file
+        // could not be opened the contents are discarded. Called with
+        // file_mtx_ held.
+        void drain(std::vector<std::shared_ptr<byte_ring>> const& rings)
+        {
+            iovec iov[max_iovecs];
+            byte_ring* iov_rings[max_iovecs];
+
+            for (std::size_t first_ring = 0; first_ring != rings.size();)
+            {
+                // Collect the contents of as many ring buffers as fit into
+                // one call to writev
+                std::size_t count = 0;
+                std::size_t last_ring = first_ring;
+                for (; last_ring != rings.size() && count + 2 <= max_iovecs; ++last_ring)
+                {
+                    std::size_t const n = rings[last_ring]->get_contents(&iov[count]);
+                    std::fill_n(&iov_rings[count], n, rings[last_ring].get());
+                    count += n;
+                }
+                first_ring = last_ring;
+
+                // Release the written bytes of each ring buffer, taking into
+                // account that writev may write only part of the data
+                for (std::size_t i = 0; i != count;)
+                {
+                    std::ptrdiff_t written = opened_ ? write(&iov[i], count - i) : -1;
+                    if (written <= 0)
+                    {
+                        // Discard what can't be written instead of retrying
+                        // forever
+                        for (; i != count; ++i)
+                        {
+                            iov_rings[i]->consume(iov[i].iov_len);
+                        }
+                        break;
+                    }
+
+                    for (; i != count && written != 0; ++i)
+                    {
+                        std::size_t const n = (std::min)(std::size_t(written), iov[i].iov_len);
+                        iov_rings[i]->consume(n);
+                        written -= std::ptrdiff_t(n);
+                        if (n != iov[i].iov_len)
+                        {
+                            iov[i].iov_base = static_cast<char*>(iov[i].iov_base) + n;
+                            iov[i].iov_len -= n;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+
+        void writer_loop()
+        {
+            std::string file_name;
+
+            std::vector<std::shared_ptr<byte_ring>> rings;
+            std::unique_lock<std::mutex> l(mtx_);
+            while (true)
+            {
+                cond_.wait_for(l, settings.flush_interval, [this] {
+                    return stop_ || reopen_ || wakeup_requested_.load(std::memory_order_relaxed);
+                });
+                wakeup_requested_.store(false, std::memory_order_relaxed);
+                bool const stopping = stop_;
+                bool const reopen = std::exchange(reopen_, false);
+                if (reopen)
+                {
+                    file_name = name;
+                }
+
+                // Forget ring buffers of threads that have exited once they
+                // have been drained
+                rings_.erase(std::remove_if(rings_.begin(), rings_.end(),
+                                 [](auto const& r) {
+                                     return r->producer_exited.load(std::memory_order_acquire) &&
+                                         r->size() == 0;
+                                 }),
+                    rings_.end());
+                rings = rings_;
+
+                // Take file_mtx_ before releasing mtx_, so that a thread
+                // writing a message directly after waiting for the reopen
+                // finds the file opened
+                std::unique_lock<std::mutex> fl(file_mtx_);
+                l.unlock();
+
+                if (reopen)
+                {
+                    close();
+                    opened_ = open(file_name);
+                }
+                drain(rings);
+                fl.unlock();
+
+                if (stopping)
+                {
+                    break;
+                }
+                l.lock();
+                space_cond_.notify_all();
+            }
+
+            std::lock_guard<std::mutex> fl(file_mtx_);
+            close();
+        }
+
+        std::uint64_t const id_ = ++next_async_file_id;
+
+        std::mutex mtx_;
+        std::condition_variable cond_;
+        std::condition_variable space_cond_;
+        std::atomic<bool> wakeup_requested_{false};
+        bool stop_ = false;
+        bool reopen_ = true;
+        std::vector<std::shared_ptr<byte_ring>> rings_;
+        std::thread writer_;
+
+        // Protects the file, which is written by the writer and by threads
+        // writing messages that don't fit into their buffer
+        std::mutex file_mtx_;
+        bool opened_ = false;
+#if defined(PIKA_WINDOWS)
+        std::FILE* file_ = nullptr;
+#else
+        int fd_ = -1;
+#endif
+    };
+
+    std::unique_ptr<async_file> async_file::make(std::string const& file_name, async_settings set)
+    {
+        return std::unique_ptr<async_file>(new async_file_impl(file_name, set));
+    }
+
+    std::unique_ptr<async_file> async_file::make(std::string const& file_name)
+    {
+        std::lock_guard<std::mutex> l(default_settings_mtx);
+        return make(file_name, default_settings);
+    }
+
+    void async_file::set_default_settings(async_settings set)
+    {
+        std::lock_guard<std::mutex> l(default_settings_mtx);
+        default_settings = set;
+    }
+
+}    // namespace pika::util::logging::destination
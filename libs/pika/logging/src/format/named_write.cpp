@@ -279,6 +279,7 @@ namespace pika::util::logging::writer {
         set_formatter<formatter::thread_id>("thread_id");
 
         set_destination<destination::file>("file", "");
+        set_destination<destination::async_file>("async_file", "");
         set_destination<destination::cout>("cout");
         set_destination<destination::cerr>("cerr");
         set_destination<destination::dbg_window>("debug");
@@ -0,0 +1,274 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#include <pika/logging/format/destinations.hpp>
+#include <pika/logging/message.hpp>
+#include <pika/testing.hpp>
+
+#include <pika/modules/program_options.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using async_file = pika::util::logging::destination::async_file;
+using pika::util::logging::message;
+
+std::uint64_t messages = 10000;
+std::size_t num_threads = 4;
+
+void write(async_file& dest, std::string const& str)
+{
+    std::stringstream s;
+    s << str;
+    dest(message(std::move(s)));
+}
+
+std::vector<std::string> read_lines(std::string const& file_name)
+{
+    std::vector<std::string> lines;
+    std::ifstream in(file_name);
+    for (std::string line; std::getline(in, line);)
+    {
+        lines.push_back(line);
+    }
+    return lines;
+}
+
+void test_concurrent_writers()
+{
+    std::string const file_name = "async_file_test_concurrent.log";
+    std::remove(file_name.c_str());
+
+    {
+        async_file::async_settings settings;
+        settings.buffer_size = 4096;
+        settings.overflow = async_file::overflow_policy::block;
+        auto dest = async_file::make(file_name, settings);
+
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t != num_threads; ++t)
+        {
+            threads.emplace_back([&, t]() {
+                for (std::uint64_t i = 0; i != messages; ++i)
+                {
+                    write(*dest, std::to_string(t) + " " + std::to_string(i) + "\n");
+                }
+            });
+        }
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+
+        PIKA_TEST_EQ(dest->get_dropped_messages(), std::uint64_t(0));
+    }
+
+    // Every message has to be written exactly once, and the messages of each
+    // thread in the order they have been written
+    std::vector<std::string> const lines = read_lines(file_name);
+    PIKA_TEST_EQ(lines.size(), num_threads * messages);
+
+    std::vector<std::uint64_t> next(num_threads, 0);
+    std::uint64_t out_of_order = 0;
+    for (std::string const& line : lines)
+    {
+        std::istringstream in(line);
+        std::size_t t = num_threads;
+        std::uint64_t i = 0;
+        in >> t >> i;
+        if (t >= num_threads || i != next[t]++)
+        {
+            ++out_of_order;
+        }
+    }
+    PIKA_TEST_EQ(out_of_order, std::uint64_t(0));
+
+    std::remove(file_name.c_str());
+}
+
+// Messages larger than half of or larger than the whole buffer must not be
+// interleaved with messages of other threads
+void test_concurrent_large_messages()
+{
+    std::string const file_name = "async_file_test_large.log";
+    std::remove(file_name.c_str());
+
+    std::uint64_t const large_messages = (std::min)(messages, std::uint64_t(1000));
+    auto message_size = [](std::uint64_t i) { return std::size_t(20 + (i * 37) % 400); };
+
+    {
+        async_file::async_settings settings;
+        settings.buffer_size = 256;
+        settings.overflow = async_file::overflow_policy::block;
+        auto dest = async_file::make(file_name, settings);
+
+        std::vector<std::thread> threads;
+        for (std::size_t t = 0; t != num_threads; ++t)
+        {
+            threads.emplace_back([&, t]() {
+                for (std::uint64_t i = 0; i != large_messages; ++i)
+                {
+                    write(*dest,
+                        std::to_string(t) + " " + std::to_string(i) + " " +
+                            std::string(message_size(i), char('a' + t % 26)) + "\n");
+                }
+            });
+        }
+        for (auto& t : threads)
+        {
+            t.join();
+        }
+
+        PIKA_TEST_EQ(dest->get_dropped_messages(), std::uint64_t(0));
+    }
+
+    std::vector<std::string> const lines = read_lines(file_name);
+    PIKA_TEST_EQ(lines.size(), num_threads * large_messages);
+
+    std::vector<std::uint64_t> next(num_threads, 0);
+    std::uint64_t broken = 0;
+    for (std::string const& line : lines)
+    {
+        std::istringstream in(line);
+        std::size_t t = num_threads;
+        std::uint64_t i = 0;
+        std::string payload;
+        in >> t >> i >> payload;
+        if (t >= num_threads || i != next[t]++ ||
+            payload != std::string(message_size(i), char('a' + t % 26)))
+        {
+            ++broken;
+        }
+    }
+    PIKA_TEST_EQ(broken, std::uint64_t(0));
+
+    std::remove(file_name.c_str());
+}
+
+void test_overflow()
+{
+    std::string const file_name = "async_file_test_overflow.log";
+    std::remove(file_name.c_str());
+
+    std::string const small(31, 's');
+    std::string const large(1000, 'l');
+
+    // With the drop policy messages that don't fit are counted and dropped
+    {
+        async_file::async_settings settings;
+        settings.buffer_size = 64;
+        settings.flush_interval = std::chrono::hours(1);
+        auto dest = async_file::make(file_name, settings);
+
+        write(*dest, small + "\n");
+        write(*dest, large + "\n");
+        PIKA_TEST_EQ(dest->get_dropped_messages(), std::uint64_t(1));
+    }
+
+    std::vector<std::string> lines = read_lines(file_name);
+    PIKA_TEST_EQ(lines.size(), std::size_t(1));
+    PIKA_TEST(lines.size() == 1 && lines[0] == small);
+
+    // With the block policy messages larger than the buffer are written
+    // directly
+    {
+        async_file::async_settings settings;
+        settings.buffer_size = 64;
+        settings.overflow = async_file::overflow_policy::block;
+        auto dest = async_file::make(file_name, settings);
+
+        write(*dest, large + "\n");
+        PIKA_TEST_EQ(dest->get_dropped_messages(), std::uint64_t(0));
+    }
+
+    lines = read_lines(file_name);
+    PIKA_TEST_EQ(lines.size(), std::size_t(2));
+    PIKA_TEST(lines.size() == 2 && lines[1] == large);
+
+    std::remove(file_name.c_str());
+}
+
+void test_configure()
+{
+    std::string const first = "async_file_test_first.log";
+    std::string const second = "async_file_test_second.log";
+    std::remove(first.c_str());
+    std::remove(second.c_str());
+
+    {
+        auto dest = async_file::make(first);
+        write(*dest, "first\n");
+
+        // Wait until the message has been written before switching files
+        for (int i = 0; i != 1000 && read_lines(first).empty(); ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        dest->configure(second);
+        write(*dest, "second\n");
+    }
+
+    std::vector<std::string> lines = read_lines(first);
+    PIKA_TEST(lines.size() == 1 && lines[0] == "first");
+    lines = read_lines(second);
+    PIKA_TEST(lines.size() == 1 && lines[0] == "second");
+
+    std::remove(first.c_str());
+    std::remove(second.c_str());
+}
+
+int main(int argc, char** argv)
+{
+    using pika::program_options::command_line_parser;
+    using pika::program_options::notify;
+    using pika::program_options::options_description;
+    using pika::program_options::store;
+    using pika::program_options::value;
+    using pika::program_options::variables_map;
+
+    variables_map vm;
+
+    options_description desc_cmdline("Usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    desc_cmdline.add_options()
+        ("help,h", "print out program usage (this message)")
+        ("messages,m", value<std::uint64_t>(&messages)->default_value(10000),
+         "the number of messages written by each thread")
+        ("threads,t", value<std::size_t>(&num_threads)->default_value(4),
+         "the number of threads writing messages")
+    ;
+    // clang-format on
+
+    store(command_line_parser(argc, argv).options(desc_cmdline).allow_unregistered().run(), vm);
+
+    notify(vm);
+
+    // print help screen
+    if (vm.count("help"))
+    {
+        std::cout << desc_cmdline;
+        return 0;
+    }
+
+    test_concurrent_writers();
+    test_concurrent_large_messages();
+    test_overflow();
+    test_configure();
+
+    return pika::detail::report_errors();
+}
@@ -59,6 +59,7 @@ int main(int argc, char* argv[])
     std::vector<pika::resource::scheduling_policy> schedulers = {
         pika::resource::scheduling_policy::local,
         pika::resource::scheduling_policy::local_priority_fifo,
+        pika::resource::scheduling_policy::local_priority_chase_lev,
 #if defined(PIKA_HAVE_CXX11_STD_ATOMIC_128BIT)
         pika::resource::scheduling_policy::local_priority_lifo,
 #endif
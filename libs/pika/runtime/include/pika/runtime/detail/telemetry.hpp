@@ -0,0 +1,141 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+#include <pika/concurrency/detail/spsc_ring_buffer.hpp>
+#include <pika/runtime_configuration/runtime_configuration.hpp>
+#include <pika/threading_base/thread_pool_base.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <pika/config/warnings_prefix.hpp>
+
+namespace pika::detail {
+    enum class telemetry_format
+    {
+        csv,
+        binary
+    };
+
+    struct telemetry_params
+    {
+        bool enabled = false;
+        std::chrono::milliseconds interval{100};
+        // A file name, or "unix:<path>" to connect to a Unix domain socket
+        std::string destination = "pika-telemetry.csv";
+        telemetry_format format = telemetry_format::csv;
+        // The number of samples that can be buffered before samples are
+        // dropped
+        std::size_t buffer_size = 4096;
+    };
+
+    /// Reads the [pika.telemetry] section of the configuration.
+    PIKA_EXPORT telemetry_params get_telemetry_params(util::runtime_configuration const& rtcfg);
+
+    /// One snapshot of the counters of a worker thread, or of a whole thread
+    /// pool if worker_thread is all_worker_threads. Counters that are not
+    /// available in the current configuration are -1. The binary format
+    /// writes this struct as is, in native byte order.
+    struct telemetry_sample
+    {
+        static constexpr std::uint32_t all_worker_threads = std::uint32_t(-1);
+
+        // Nanoseconds since the sampler was started
+        std::uint64_t timestamp = 0;
+        std::uint32_t pool_index = 0;
+        std::uint32_t worker_thread = all_worker_threads;
+        std::int64_t queue_length = -1;
+        std::int64_t thread_count = -1;
+        std::int64_t staged_thread_count = -1;
+        std::int64_t executed_threads = -1;
+        std::int64_t cumulative_duration = -1;
+        std::int64_t idle_rate = -1;
+        std::int64_t idle_loop_count = -1;
+        std::int64_t busy_loop_count = -1;
+    };
+
+    /// Periodically snapshots the counters of all worker threads and thread
+    /// pools and writes them to a file or a Unix domain socket.
+    ///
+    /// Sampling and writing happen on two dedicated OS threads which
+    /// communicate through a lock-free ring buffer, so that a slow
+    /// destination does not delay sampling. Samples are dropped when the
+    /// ring buffer is full. Only counters that can be read without taking
+    /// scheduler locks are sampled, so the worker threads are not affected by
+    /// the sampler beyond the cache traffic caused by reading their counters.
+    class telemetry_sampler
+    {
+    public:
+        /// Opens the destination and starts sampling. Throws if the
+        /// destination can not be opened.
+        PIKA_EXPORT telemetry_sampler(
+            std::vector<threads::detail::thread_pool_base*> pools, telemetry_params const& params);
+        PIKA_EXPORT ~telemetry_sampler();
+
+        telemetry_sampler(telemetry_sampler const&) = delete;
+        telemetry_sampler& operator=(telemetry_sampler const&) = delete;
+
+        /// Stops sampling and writes all buffered samples. Called by the
+        /// destructor if it hasn't been called before.
+        PIKA_EXPORT void stop();
+
+        std::uint64_t get_sample_count() const noexcept
+        {
+            return sample_count_.load(std::memory_order_relaxed);
+        }
+
+        std::uint64_t get_dropped_sample_count() const noexcept
+        {
+            return dropped_sample_count_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        void open_destination();
+        void close_destination();
+        bool write(void const* data, std::size_t size);
+        bool flush();
+        void report_write_error(int error);
+        void write_header();
+        void write_samples(telemetry_sample const* samples, std::size_t count);
+        void take_samples(std::uint64_t timestamp);
+        void sampler_loop();
+        void writer_loop();
+
+        std::vector<threads::detail::thread_pool_base*> pools_;
+        telemetry_params params_;
+        // Files are written with stdio, Unix domain sockets with send so
+        // that a disconnected reader does not raise SIGPIPE
+        std::FILE* destination_ = nullptr;
+        int socket_ = -1;
+        // Set by the writer once writing failed, nothing is written after that
+        bool write_failed_ = false;
+        std::string buffer_;
+
+        pika::concurrency::detail::spsc_ring_buffer<telemetry_sample> samples_;
+        std::atomic<std::uint64_t> sample_count_{0};
+        std::atomic<std::uint64_t> dropped_sample_count_{0};
+
+        std::mutex mtx_;
+        std::condition_variable cond_;
+        bool stop_sampler_ = false;
+        bool stop_writer_ = false;
+        std::thread sampler_thread_;
+        std::thread writer_thread_;
+    };
+}    // namespace pika::detail
+
+#include <pika/config/warnings_suffix.hpp>
@@ -49,6 +49,8 @@ namespace pika {
         extern std::list<startup_function_type> global_startup_functions;
         extern std::list<shutdown_function_type> global_pre_shutdown_functions;
         extern std::list<shutdown_function_type> global_shutdown_functions;
+
+        class telemetry_sampler;
     }    // namespace detail
 
     ///////////////////////////////////////////////////////////////////////////
@@ -380,6 +382,8 @@ namespace pika {
 
         void wait_helper(std::mutex& mtx, std::condition_variable& cond, bool& running);
 
+        void start_telemetry_sampler();
+
         // list of functions to call on exit
         using on_exit_type = std::vector<util::detail::function<void()>>;
         on_exit_type on_exit_functions_;
@@ -411,6 +415,9 @@ namespace pika {
         notification_policy_type notifier_;
         std::unique_ptr<pika::threads::detail::thread_manager> thread_manager_;
 
+        // samples the thread pool counters if enabled by pika.telemetry
+        std::unique_ptr<pika::detail::telemetry_sampler> telemetry_sampler_;
+
     private:
         /// \brief Helper function to stop the runtime.
         ///
@@ -10,6 +10,7 @@
 #include <pika/command_line_handling/late_command_line_handling.hpp>
 #include <pika/command_line_handling/parse_command_line.hpp>
 #include <pika/coroutines/coroutine.hpp>
+#include <pika/debugging/attach_debugger.hpp>
 #include <pika/debugging/backtrace.hpp>
 #include <pika/execution_base/this_thread.hpp>
 #include <pika/functional/bind.hpp>
@@ -21,6 +22,7 @@
 #include <pika/runtime/config_entry.hpp>
 #include <pika/runtime/custom_exception_info.hpp>
 #include <pika/runtime/debugging.hpp>
+#include <pika/runtime/detail/telemetry.hpp>
 #include <pika/runtime/os_thread_type.hpp>
 #include <pika/runtime/runtime.hpp>
 #include <pika/runtime/runtime_fwd.hpp>
@@ -374,6 +376,7 @@ namespace pika {
         LRT_(debug).format("~runtime(entering)");
 
         // stop all services
+        telemetry_sampler_.reset();
         thread_manager_->stop();
         LRT_(debug).format("~runtime(finished)");
 
@@ -1274,6 +1277,8 @@ namespace pika {
         // start the thread manager
         thread_manager_->run();
         lbt_ << "(1st stage) runtime::start: started thread_manager";
+
+        start_telemetry_sampler();
         // }}}
 
         // {{{ launch main
@@ -1306,6 +1311,38 @@ namespace pika {
         return 0;    // return zero as we don't know the outcome of pika_main yet
     }
 
+    void runtime::start_telemetry_sampler()
+    {
+        // Telemetry is not essential for the application, so invalid
+        // parameters or failing to open the destination are reported but do
+        // not stop the runtime
+        try
+        {
+            pika::detail::telemetry_params const params =
+                pika::detail::get_telemetry_params(get_config());
+            if (!params.enabled)
+            {
+                return;
+            }
+
+            auto& rp = resource::get_partitioner();
+            std::vector<threads::detail::thread_pool_base*> pools;
+            for (std::size_t i = 0; i != rp.get_num_pools(); ++i)
+            {
+                pools.push_back(&thread_manager_->get_pool(rp.get_pool_name(i)));
+            }
+
+            telemetry_sampler_ =
+                std::make_unique<pika::detail::telemetry_sampler>(PIKA_MOVE(pools), params);
+            lbt_ << "(1st stage) runtime::start: started telemetry_sampler";
+        }
+        catch (pika::exception const& e)
+        {
+            LRT_(error).format("runtime::start: could not start telemetry_sampler: {}",
+                pika::get_error_what(e));
+        }
+    }
+
     int runtime::start(bool blocking)
     {
         util::detail::function<pika_main_function_type> empty_main;
@@ -1399,6 +1436,9 @@ namespace pika {
         // execute all on_exit functions whenever the first thread calls this
         this->runtime::stopping();
 
+        // stop sampling the thread pools before they are stopped
+        telemetry_sampler_.reset();
+
         // stop runtime services (threads)
         thread_manager_->stop(false);    // just initiate shutdown
 
@@ -0,0 +1,437 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#include <pika/modules/errors.hpp>
+#include <pika/modules/logging.hpp>
+#include <pika/runtime/detail/telemetry.hpp>
+#include <pika/util/get_entry_as.hpp>
+
+#include <fmt/format.h>
+
+#if !defined(PIKA_WINDOWS)
+# include <sys/socket.h>
+# include <sys/un.h>
+# include <unistd.h>
+#endif
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pika::detail {
+    telemetry_params get_telemetry_params(util::runtime_configuration const& rtcfg)
+    {
+        telemetry_params params;
+
+        params.enabled = get_entry_as<int>(rtcfg, "pika.telemetry.enabled", 0) != 0;
+        params.interval = std::chrono::milliseconds(
+            get_entry_as<std::int64_t>(rtcfg, "pika.telemetry.interval", 100));
+        if (params.interval.count() <= 0)
+        {
+            params.interval = std::chrono::milliseconds(1);
+        }
+        params.destination = rtcfg.get_entry("pika.telemetry.destination", params.destination);
+        params.buffer_size =
+            get_entry_as<std::size_t>(rtcfg, "pika.telemetry.buffer_size", params.buffer_size);
+
+        std::string const format = rtcfg.get_entry("pika.telemetry.format", "csv");
+        if (format == "binary")
+        {
+            params.format = telemetry_format::binary;
+        }
+        else if (format != "csv")
+        {
+            PIKA_THROW_EXCEPTION(pika::error::bad_parameter, "get_telemetry_params",
+                "unknown telemetry format \"{}\", expected \"csv\" or \"binary\"", format);
+        }
+
+        return params;
+    }
+
+    ///////////////////////////////////////////////////////////////////////////
+    telemetry_sampler::telemetry_sampler(
+        std::vector<threads::detail::thread_pool_base*> pools, telemetry_params const& params)
+      : pools_(PIKA_MOVE(pools))
+      , params_(params)
+      , samples_(params.buffer_size)
+    {
+        open_destination();
+        write_header();
+        if (write_failed_)
+        {
+            close_destination();
+            PIKA_THROW_EXCEPTION(pika::error::kernel_error, "telemetry_sampler::telemetry_sampler",
+                "could not write to \"{}\"", params_.destination);
+        }
+
+        writer_thread_ = std::thread(&telemetry_sampler::writer_loop, this);
+        sampler_thread_ = std::thread(&telemetry_sampler::sampler_loop, this);
+    }
+
+    telemetry_sampler::~telemetry_sampler()
+    {
+        stop();
+    }
+
+    void telemetry_sampler::stop()
+    {
+        // The writer is stopped only after the sampler has exited so that it
+        // sees all samples
+        {
+            std::lock_guard<std::mutex> l(mtx_);
+            stop_sampler_ = true;
+        }
+        cond_.notify_all();
+        if (sampler_thread_.joinable())
+        {
+            sampler_thread_.join();
+        }
+
+        {
+            std::lock_guard<std::mutex> l(mtx_);
+            stop_writer_ = true;
+        }
+        cond_.notify_all();
+        if (writer_thread_.joinable())
+        {
+            writer_thread_.join();
+        }
+
+        if (destination_ != nullptr || socket_ != -1)
+        {
+            close_destination();
+
+            LRT_(info).format("telemetry_sampler: wrote {} samples to {}, dropped {} samples",
+                get_sample_count() - get_dropped_sample_count(), params_.destination,
+                get_dropped_sample_count());
+        }
+    }
+
+    void telemetry_sampler::open_destination()
+    {
+        constexpr char const unix_prefix[] = "unix:";
+        constexpr std::size_t unix_prefix_length = sizeof(unix_prefix) - 1;
+
+        if (params_.destination.compare(0, unix_prefix_length, unix_prefix) != 0)
+        {
+            destination_ = std::fopen(params_.destination.c_str(), "wb");
+            if (destination_ == nullptr)
+            {
+                PIKA_THROW_EXCEPTION(pika::error::bad_parameter,
+                    "telemetry_sampler::open_destination", "could not open \"{}\": {}",
+                    params_.destination, std::strerror(errno));
+            }
+            return;
+        }
+
+#if !defined(PIKA_WINDOWS)
+        std::string const path = params_.destination.substr(unix_prefix_length);
+
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        if (path.empty() || path.size() >= sizeof(addr.sun_path))
+        {
+            PIKA_THROW_EXCEPTION(pika::error::bad_parameter, "telemetry_sampler::open_destination",
+                "invalid Unix domain socket path \"{}\"", path);
+        }
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+
+        int const fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        if (fd == -1 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == -1)
+        {
+            int const error = errno;
+            if (fd != -1)
+            {
+                ::close(fd);
+            }
+            PIKA_THROW_EXCEPTION(pika::error::kernel_error, "telemetry_sampler::open_destination",
+                "could not connect to Unix domain socket \"{}\": {}", path, std::strerror(error));
+        }
+# if !defined(MSG_NOSIGNAL) && defined(SO_NOSIGPIPE)
+        int const no_sigpipe = 1;
+        ::setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &no_sigpipe, sizeof(no_sigpipe));
+# endif
+        socket_ = fd;
+#else
+        PIKA_THROW_EXCEPTION(pika::error::bad_parameter, "telemetry_sampler::open_destination",
+            "Unix domain sockets are not supported on this platform");
+#endif
+    }
+
+    void telemetry_sampler::close_destination()
+    {
+        if (destination_ != nullptr)
+        {
+            if (std::fclose(destination_) != 0)
+            {
+                report_write_error(errno);
+            }
+            destination_ = nullptr;
+        }
+#if !defined(PIKA_WINDOWS)
+        if (socket_ != -1)
+        {
+            ::close(socket_);
+            socket_ = -1;
+        }
+#endif
+    }
+
+    bool telemetry_sampler::write(void const* data, std::size_t size)
+    {
+        if (write_failed_)
+        {
+            return false;
+        }
+
+#if !defined(PIKA_WINDOWS)
+        if (socket_ != -1)
+        {
+# if defined(MSG_NOSIGNAL)
+            constexpr int flags = MSG_NOSIGNAL;
+# else
+            constexpr int flags = 0;
+# endif
+            char const* p = static_cast<char const*>(data);
+            while (size != 0)
+            {
+                ssize_t const written = ::send(socket_, p, size, flags);
+                if (written == -1)
+                {
+                    if (errno == EINTR)
+                    {
+                        continue;
+                    }
+                    report_write_error(errno);
+                    return false;
+                }
+                p += written;
+                size -= static_cast<std::size_t>(written);
+            }
+            return true;
+        }
+#endif
+
+        if (std::fwrite(data, 1, size, destination_) != size)
+        {
+            report_write_error(errno);
+            return false;
+        }
+        return true;
+    }
+
+    bool telemetry_sampler::flush()
+    {
+        if (write_failed_)
+        {
+            return false;
+        }
+
+        if (destination_ != nullptr && std::fflush(destination_) != 0)
+        {
+            report_write_error(errno);
+            return false;
+        }
+        return true;
+    }
+
+    void telemetry_sampler::report_write_error(int error)
+    {
+        if (!write_failed_)
+        {
+            LRT_(error).format("telemetry_sampler: could not write to {}: {}, stopping sampling",
+                params_.destination, std::strerror(error));
+        }
+        write_failed_ = true;
+    }
+
+    // The CSV header lists the columns. The binary header consists of the
+    // magic "PIKATEL1", the size of a sample, the number of pools, and for
+    // each pool its number of worker threads and its name, prefixed by the
+    // length of the name. All integers are 32 bit in native byte order.
+    void telemetry_sampler::write_header()
+    {
+        buffer_.clear();
+        if (params_.format == telemetry_format::csv)
+        {
+            buffer_ = "timestamp_ns,pool,worker_thread,queue_length,thread_count,"
+                      "staged_thread_count,executed_threads,cumulative_duration_ns,"
+                      "idle_rate,idle_loop_count,busy_loop_count\n";
+        }
+        else
+        {
+            auto append = [&](std::uint32_t value) {
+                buffer_.append(reinterpret_cast<char const*>(&value), sizeof(value));
+            };
+
+            buffer_.append("PIKATEL1");
+            append(sizeof(telemetry_sample));
+            append(static_cast<std::uint32_t>(pools_.size()));
+            for (auto const* pool : pools_)
+            {
+                std::string const& name = pool->get_pool_name();
+                append(static_cast<std::uint32_t>(pool->get_os_thread_count()));
+                append(static_cast<std::uint32_t>(name.size()));
+                buffer_.append(name);
+            }
+        }
+
+        if (write(buffer_.data(), buffer_.size()))
+        {
+            flush();
+        }
+    }
+
+    void telemetry_sampler::write_samples(telemetry_sample const* samples, std::size_t count)
+    {
+        if (params_.format == telemetry_format::binary)
+        {
+            write(samples, count * sizeof(telemetry_sample));
+            return;
+        }
+
+        buffer_.clear();
+        auto out = std::back_inserter(buffer_);
+        for (std::size_t i = 0; i != count; ++i)
+        {
+            telemetry_sample const& s = samples[i];
+            fmt::format_to(out, "{},{},", s.timestamp, pools_[s.pool_index]->get_pool_name());
+            if (s.worker_thread == telemetry_sample::all_worker_threads)
+            {
+                buffer_.append("all,");
+            }
+            else
+            {
+                fmt::format_to(out, "{},", s.worker_thread);
+            }
+            fmt::format_to(out, "{},{},{},{},{},{},{},{}\n", s.queue_length, s.thread_count,
+                s.staged_thread_count, s.executed_threads, s.cumulative_duration, s.idle_rate,
+                s.idle_loop_count, s.busy_loop_count);
+        }
+        write(buffer_.data(), buffer_.size());
+    }
+
+    void telemetry_sampler::take_samples(std::uint64_t timestamp)
+    {
+        auto sample = [&](threads::detail::thread_pool_base& pool, std::uint32_t pool_index,
+                          std::size_t num_thread) {
+            telemetry_sample s;
+            s.timestamp = timestamp;
+            s.pool_index = pool_index;
+            if (num_thread != std::size_t(-1))
+            {
+                s.worker_thread = static_cast<std::uint32_t>(num_thread);
+            }
+
+            s.queue_length = pool.get_queue_length(num_thread, false);
+            s.thread_count = pool.get_thread_count_unknown(num_thread, false);
+            s.staged_thread_count = pool.get_thread_count_staged(num_thread, false);
+#if defined(PIKA_HAVE_THREAD_CUMULATIVE_COUNTS)
+            s.executed_threads = pool.get_executed_threads(num_thread, false);
+            s.cumulative_duration = pool.get_cumulative_duration(num_thread, false);
+#endif
+#if defined(PIKA_HAVE_THREAD_IDLE_RATES)
+            s.idle_rate = pool.avg_idle_rate(num_thread, false);
+#endif
+            s.idle_loop_count = pool.get_idle_loop_count(num_thread, false);
+            s.busy_loop_count = pool.get_busy_loop_count(num_thread, false);
+
+            ++sample_count_;
+            if (!samples_.push(s))
+            {
+                ++dropped_sample_count_;
+            }
+        };
+
+        for (std::uint32_t pool_index = 0; pool_index != pools_.size(); ++pool_index)
+        {
+            auto& pool = *pools_[pool_index];
+            std::size_t const num_threads = pool.get_os_thread_count();
+            for (std::size_t num_thread = 0; num_thread != num_threads; ++num_thread)
+            {
+                sample(pool, pool_index, num_thread);
+            }
+            sample(pool, pool_index, std::size_t(-1));
+        }
+    }
+
+    void telemetry_sampler::sampler_loop()
+    {
+        auto const start = std::chrono::steady_clock::now();
+        auto next = start;
+
+        std::unique_lock<std::mutex> l(mtx_);
+        while (!stop_sampler_)
+        {
+            l.unlock();
+            auto const now = std::chrono::steady_clock::now();
+            take_samples(static_cast<std::uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count()));
+
+            // Skip intervals that have been missed instead of sampling
+            // repeatedly to catch up
+            next += params_.interval;
+            if (next < now)
+            {
+                next = now + params_.interval;
+            }
+
+            // The writer checks for samples with mtx_ held, notifying it with
+            // mtx_ held makes sure that it doesn't miss the new samples
+            l.lock();
+            cond_.notify_all();
+            cond_.wait_until(l, next, [this] { return stop_sampler_; });
+        }
+    }
+
+    void telemetry_sampler::writer_loop()
+    {
+        std::vector<telemetry_sample> batch(256);
+
+        std::unique_lock<std::mutex> l(mtx_);
+        while (true)
+        {
+            cond_.wait(l, [this] { return stop_writer_ || !samples_.empty(); });
+            bool const stopping = stop_writer_;
+            l.unlock();
+
+            // Samples are still taken out of the buffer after writing
+            // failed, they are discarded
+            while (std::size_t const count = samples_.pop_n(batch.data(), batch.size()))
+            {
+                if (!write_failed_)
+                {
+                    write_samples(batch.data(), count);
+                }
+            }
+            flush();
+
+            if (stopping)
+            {
+                return;
+            }
+            l.lock();
+
+            // Stop sampling if the destination can't be written to anymore,
+            // for example because the reader of the socket disconnected
+            if (write_failed_ && !stop_sampler_)
+            {
+                stop_sampler_ = true;
+                cond_.notify_all();
+            }
+        }
+    }
+}    // namespace pika::detail
@@ -69,6 +69,12 @@ namespace pika::util {
 
 #if defined(__linux) || defined(linux) || defined(__linux__) || defined(__FreeBSD__)
         bool use_stack_guard_pages() const;
+
+        // Settings for the arena based coroutine stack allocation
+        bool use_stack_arena() const;
+        std::size_t get_stack_arena_size() const;
+        int get_stack_arena_huge_pages() const;
+        std::size_t get_stack_arena_cache_size() const;
 #endif
 
         // return trace_depth for stack-backtraces
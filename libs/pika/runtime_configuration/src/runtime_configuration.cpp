@@ -146,6 +146,7 @@ namespace pika::util {
             "max_idle_backoff_time = "
             "${PIKA_MAX_IDLE_BACKOFF_TIME:" PIKA_PP_STRINGIZE(
                 PIKA_PP_EXPAND(PIKA_IDLE_BACKOFF_TIME_MAX)) "}",
+            "adaptive_idle_backoff = ${PIKA_ADAPTIVE_IDLE_BACKOFF:1}",
 #endif
             "default_scheduler_mode = ${PIKA_DEFAULT_SCHEDULER_MODE}",
 
@@ -168,6 +169,10 @@ namespace pika::util {
 #if defined(__linux) || defined(linux) || defined(__linux__) ||                \
     defined(__FreeBSD__)
             "use_guard_pages = ${PIKA_USE_GUARD_PAGES:1}",
+            "use_arena = ${PIKA_USE_STACK_ARENA:0}",
+            "arena_size = ${PIKA_STACK_ARENA_SIZE:0x1000000}",
+            "arena_huge_pages = ${PIKA_STACK_ARENA_HUGE_PAGES:0}",
+            "arena_cache_size = ${PIKA_STACK_ARENA_CACHE_SIZE:256}",
 #endif
 
             "[pika.thread_queue]",
@@ -198,6 +203,13 @@ namespace pika::util {
             "${PIKA_THREAD_QUEUE_INIT_THREADS_COUNT:" PIKA_PP_STRINGIZE(
                 PIKA_PP_EXPAND(PIKA_THREAD_QUEUE_INIT_THREADS_COUNT)) "}",
 
+            "[pika.telemetry]",
+            "enabled = ${PIKA_TELEMETRY:0}",
+            "interval = ${PIKA_TELEMETRY_INTERVAL:100}",
+            "destination = ${PIKA_TELEMETRY_DESTINATION:pika-telemetry.csv}",
+            "format = ${PIKA_TELEMETRY_FORMAT:csv}",
+            "buffer_size = ${PIKA_TELEMETRY_BUFFER_SIZE:4096}",
+
             "[pika.commandline]",
             // enable aliasing
             "aliasing = ${PIKA_COMMANDLINE_ALIASING:1}",
@@ -335,7 +347,13 @@ namespace pika::util {
             "destination = ${PIKA_CONSOLE_DEB_LOGDESTINATION:"
                 "file(pika.debuglog.$[system.pid].log)}",
 #endif
-            "format = ${PIKA_CONSOLE_DEB_LOGFORMAT:|}"
+            "format = ${PIKA_CONSOLE_DEB_LOGFORMAT:|}",
+
+            // settings of the async_file destination
+            "[pika.logging.async]",
+            "buffer_size = ${PIKA_LOG_ASYNC_BUFFER_SIZE:1048576}",
+            "overflow = ${PIKA_LOG_ASYNC_OVERFLOW:drop}",
+            "flush_interval = ${PIKA_LOG_ASYNC_FLUSH_INTERVAL:10}"
 
 #undef PIKA_TIMEFORMAT
 #undef PIKA_LOGFORMAT
@@ -578,6 +596,38 @@ namespace pika::util {
         }
         return true;    // default is true
     }
+
+    bool runtime_configuration::use_stack_arena() const
+    {
+        if (util::section const* sec = get_section("pika.stacks"); nullptr != sec)
+        {
+            return pika::detail::get_entry_as<int>(*sec, "use_arena", 0) != 0;
+        }
+        return false;    // default is false
+    }
+
+    std::size_t runtime_configuration::get_stack_arena_size() const
+    {
+        return static_cast<std::size_t>(init_stack_size("arena_size", "0x1000000", 0x1000000));
+    }
+
+    int runtime_configuration::get_stack_arena_huge_pages() const
+    {
+        if (util::section const* sec = get_section("pika.stacks"); nullptr != sec)
+        {
+            return pika::detail::get_entry_as<int>(*sec, "arena_huge_pages", 0);
+        }
+        return 0;
+    }
+
+    std::size_t runtime_configuration::get_stack_arena_cache_size() const
+    {
+        if (util::section const* sec = get_section("pika.stacks"); nullptr != sec)
+        {
+            return pika::detail::get_entry_as<std::size_t>(*sec, "arena_cache_size", 256);
+        }
+        return 256;
+    }
 #endif
 
     std::ptrdiff_t runtime_configuration::init_small_stack_size() const
@@ -0,0 +1,379 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+#include <pika/assert.hpp>
+#include <pika/concurrency/cache_line_data.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace pika::threads::detail {
+    struct slab_pool_statistics
+    {
+        // Number of slabs taken from the global allocator
+        std::uint64_t slabs = 0;
+        // Number of blocks handed out
+        std::uint64_t allocations = 0;
+        // Number of blocks freed by the thread owning them
+        std::uint64_t local_frees = 0;
+        // Number of blocks freed by a thread not owning them
+        std::uint64_t remote_frees = 0;
+        // Number of batches of remote frees returned to the owning threads
+        std::uint64_t remote_batches = 0;
+    };
+
+    // A pool of fixed-size blocks for objects of type T. Every thread
+    // allocates from its own pool, which takes slabs of BlocksPerSlab blocks
+    // from the global allocator only when it has no free blocks left. Slabs
+    // are never returned to the global allocator.
+    //
+    // Blocks freed by the thread owning them go to a free list that is only
+    // accessed by that thread. Blocks freed by other threads are collected in
+    // batches of up to RemoteBatchSize blocks, which are pushed to a lock-free
+    // list of the owning pool with a single compare-exchange. The owner takes
+    // all blocks from that list at once when its own free list is empty.
+    //
+    // The pool of a thread that exits is handed to the next thread that needs
+    // a pool, so that blocks are not lost when threads come and go.
+    template <typename T, std::size_t BlocksPerSlab = 64, std::size_t RemoteBatchSize = 32>
+    class slab_pool
+    {
+        static_assert(BlocksPerSlab > 0 && RemoteBatchSize > 0);
+
+        struct local_pool;
+
+        struct block
+        {
+            local_pool* owner;
+            union
+            {
+                block* next;
+                alignas(T) unsigned char storage[sizeof(T)];
+            };
+        };
+
+        struct local_pool
+        {
+            // The members up to remote_free are only accessed by the thread
+            // using the pool
+            block* free_list = nullptr;
+
+            // The batch of blocks freed by this thread that belong to the pool
+            // batch_owner
+            local_pool* batch_owner = nullptr;
+            block* batch_head = nullptr;
+            block* batch_tail = nullptr;
+            std::size_t batch_size = 0;
+
+            // Protected by the mutex of the registry
+            bool in_use = false;
+
+            // Blocks freed by other threads
+            pika::concurrency::detail::cache_line_data<std::atomic<block*>> remote_free;
+
+            // Only written by the thread using the pool, but read by
+            // get_statistics
+            std::atomic<std::uint64_t> slabs{0};
+            std::atomic<std::uint64_t> allocations{0};
+            std::atomic<std::uint64_t> local_frees{0};
+            std::atomic<std::uint64_t> remote_frees{0};
+            std::atomic<std::uint64_t> remote_batches{0};
+        };
+
+        struct registry
+        {
+            std::mutex mtx;
+            std::vector<local_pool*> pools;
+        };
+
+        // The thread-local state is constant initialized and trivially
+        // destructible so that blocks can still be allocated and freed while
+        // other thread-local objects are destroyed during thread exit, after
+        // the pool of the thread has been released.
+        struct thread_state
+        {
+            local_pool* pool;
+            bool released;
+        };
+
+        struct thread_state_release
+        {
+            ~thread_state_release()
+            {
+                thread_state& state = get_thread_state();
+                if (state.pool != nullptr)
+                {
+                    release_pool(state.pool);
+                    state.pool = nullptr;
+                }
+                state.released = true;
+            }
+        };
+
+        static registry& get_registry()
+        {
+            // The registry and the pools are never destroyed since blocks can
+            // be freed until the very end of the program
+            static registry* r = new registry();
+            return *r;
+        }
+
+        static thread_state& get_thread_state() noexcept
+        {
+            static thread_local thread_state state{nullptr, false};
+            return state;
+        }
+
+        static void increment(std::atomic<std::uint64_t>& counter) noexcept
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        static block* get_block(void* p) noexcept
+        {
+            return reinterpret_cast<block*>(
+                static_cast<unsigned char*>(p) - offsetof(block, storage));
+        }
+
+        static local_pool* acquire_pool()
+        {
+            registry& r = get_registry();
+            std::lock_guard<std::mutex> l(r.mtx);
+            for (local_pool* pool : r.pools)
+            {
+                if (!pool->in_use)
+                {
+                    pool->in_use = true;
+                    return pool;
+                }
+            }
+
+            r.pools.reserve(r.pools.size() + 1);
+            local_pool* pool = new local_pool();
+            pool->in_use = true;
+            r.pools.push_back(pool);
+            return pool;
+        }
+
+        static void release_pool(local_pool* pool) noexcept
+        {
+            flush_batch(pool);
+
+            registry& r = get_registry();
+            std::lock_guard<std::mutex> l(r.mtx);
+            pool->in_use = false;
+        }
+
+        static local_pool* acquire_thread_pool()
+        {
+            // Releases the pool on thread exit
+            static thread_local thread_state_release release;
+            (void) release;
+
+            thread_state& state = get_thread_state();
+            PIKA_ASSERT(state.pool == nullptr && !state.released);
+            state.pool = acquire_pool();
+            return state.pool;
+        }
+
+        static void push_remote(local_pool* owner, block* head, block* tail) noexcept
+        {
+            std::atomic<block*>& remote_free = owner->remote_free.data_;
+            block* old_head = remote_free.load(std::memory_order_relaxed);
+            do
+            {
+                tail->next = old_head;
+            } while (!remote_free.compare_exchange_weak(
+                old_head, head, std::memory_order_release, std::memory_order_relaxed));
+        }
+
+        static void flush_batch(local_pool* pool) noexcept
+        {
+            if (pool->batch_size == 0)
+            {
+                return;
+            }
+
+            push_remote(pool->batch_owner, pool->batch_head, pool->batch_tail);
+            increment(pool->remote_batches);
+
+            pool->batch_owner = nullptr;
+            pool->batch_head = nullptr;
+            pool->batch_tail = nullptr;
+            pool->batch_size = 0;
+        }
+
+        static block* allocate_slab(local_pool* pool)
+        {
+            block* slab = std::allocator<block>().allocate(BlocksPerSlab);
+            for (std::size_t i = 0; i != BlocksPerSlab; ++i)
+            {
+                slab[i].owner = pool;
+                slab[i].next = i + 1 != BlocksPerSlab ? &slab[i + 1] : nullptr;
+            }
+            increment(pool->slabs);
+            return slab;
+        }
+
+        static void* allocate(local_pool* pool)
+        {
+            block* b = pool->free_list;
+            if (b == nullptr)
+            {
+                b = pool->remote_free.data_.exchange(nullptr, std::memory_order_acquire);
+                if (b == nullptr)
+                {
+                    b = allocate_slab(pool);
+                }
+            }
+
+            pool->free_list = b->next;
+            increment(pool->allocations);
+            return b->storage;
+        }
+
+    public:
+        // Allocate uninitialized storage for a T
+        static void* allocate()
+        {
+            thread_state& state = get_thread_state();
+            if (PIKA_LIKELY(state.pool != nullptr))
+            {
+                return allocate(state.pool);
+            }
+
+            if (!state.released)
+            {
+                return allocate(acquire_thread_pool());
+            }
+
+            // The thread is exiting and has released its pool already. The
+            // block is taken from a pool that is handed back right away.
+            local_pool* pool = acquire_pool();
+            void* p = allocate(pool);
+            release_pool(pool);
+            return p;
+        }
+
+        // Free storage allocated with allocate, which can be called on any
+        // thread
+        static void deallocate(void* p) noexcept
+        {
+            block* b = get_block(p);
+            thread_state& state = get_thread_state();
+            local_pool* pool = state.pool;
+
+            if (pool == b->owner)
+            {
+                b->next = pool->free_list;
+                pool->free_list = b;
+                increment(pool->local_frees);
+                return;
+            }
+
+            if (pool == nullptr)
+            {
+                if (state.released)
+                {
+                    // The thread is exiting, return the block on its own
+                    b->next = nullptr;
+                    push_remote(b->owner, b, b);
+                    return;
+                }
+
+                // Acquiring a pool can't fail other than by running out of
+                // memory, in which case the block is returned on its own
+                try
+                {
+                    pool = acquire_thread_pool();
+                }
+                catch (...)
+                {
+                    b->next = nullptr;
+                    push_remote(b->owner, b, b);
+                    return;
+                }
+
+                if (pool == b->owner)
+                {
+                    b->next = pool->free_list;
+                    pool->free_list = b;
+                    increment(pool->local_frees);
+                    return;
+                }
+            }
+
+            if (pool->batch_owner != b->owner)
+            {
+                flush_batch(pool);
+                pool->batch_owner = b->owner;
+            }
+
+            b->next = pool->batch_head;
+            pool->batch_head = b;
+            if (pool->batch_tail == nullptr)
+            {
+                pool->batch_tail = b;
+            }
+            increment(pool->remote_frees);
+
+            if (++pool->batch_size == RemoteBatchSize)
+            {
+                flush_batch(pool);
+            }
+        }
+
+        template <typename... Ts>
+        static T* construct(Ts&&... ts)
+        {
+            void* p = allocate();
+            try
+            {
+                return new (p) T{PIKA_FORWARD(Ts, ts)...};
+            }
+            catch (...)
+            {
+                deallocate(p);
+                throw;
+            }
+        }
+
+        static void destroy(T* p) noexcept
+        {
+            p->~T();
+            deallocate(p);
+        }
+
+        // Return the sums of the counters of all pools. The counters are read
+        // without synchronizing with the threads using the pools.
+        static slab_pool_statistics get_statistics()
+        {
+            slab_pool_statistics statistics;
+
+            registry& r = get_registry();
+            std::lock_guard<std::mutex> l(r.mtx);
+            for (local_pool const* pool : r.pools)
+            {
+                statistics.slabs += pool->slabs.load(std::memory_order_relaxed);
+                statistics.allocations += pool->allocations.load(std::memory_order_relaxed);
+                statistics.local_frees += pool->local_frees.load(std::memory_order_relaxed);
+                statistics.remote_frees += pool->remote_frees.load(std::memory_order_relaxed);
+                statistics.remote_batches += pool->remote_batches.load(std::memory_order_relaxed);
+            }
+
+            return statistics;
+        }
+    };
+}    // namespace pika::threads::detail
@@ -25,6 +25,7 @@
 
 #include <fmt/format.h>
 
+#include <algorithm>
 #include <atomic>
 #include <cmath>
 #include <cstddef>
@@ -528,6 +529,60 @@ namespace pika::threads {
                 ;
         }
 
+        /// Create count threads at once. Batches of normal priority threads
+        /// without a hint are distributed round-robin over the queues,
+        /// reserving the queue positions with a single update of the
+        /// round-robin counter, and each queue registers its share of the
+        /// batch in one go. Other batches fall back to the default
+        /// implementation.
+        void create_thread_batch(threads::detail::thread_init_data* data, std::size_t count,
+            error_code& ec) override
+        {
+            bool const round_robin =
+                !this->has_scheduler_mode(scheduler_mode::enable_elasticity) &&
+                std::all_of(data, data + count, [](threads::detail::thread_init_data const& d) {
+                    return !d.run_now && d.priority == execution::thread_priority::normal &&
+                        d.schedulehint.mode != execution::thread_schedule_hint_mode::thread;
+                });
+
+            if (!round_robin)
+            {
+                scheduler_base::create_thread_batch(data, count, ec);
+                return;
+            }
+
+            std::size_t const first_queue = curr_queue_.fetch_add(count) % num_queues_;
+            std::size_t const num_queues_used = (std::min)(count, num_queues_);
+            for (std::size_t offset = 0; offset != num_queues_used; ++offset)
+            {
+                std::size_t const num_thread = (first_queue + offset) % num_queues_;
+                std::size_t const num_tasks = (count - offset + num_queues_ - 1) / num_queues_;
+
+                for (std::size_t i = 0; i != num_tasks; ++i)
+                {
+                    auto& schedulehint = data[offset + i * num_queues_].schedulehint;
+                    schedulehint.mode = execution::thread_schedule_hint_mode::thread;
+                    schedulehint.hint = static_cast<std::int16_t>(num_thread);
+                }
+
+                queues_[num_thread].data_->create_threads_staged(
+                    data + offset, num_tasks, num_queues_, ec);
+                if (ec)
+                {
+                    return;
+                }
+
+                LTM_(debug).format("local_priority_queue_scheduler::create_thread_batch: "
+                                   "pool({}), scheduler({}), worker_thread({}), threads({})",
+                    *this->get_parent_pool(), *this, num_thread, num_tasks);
+            }
+
+            for (std::size_t offset = 0; offset != num_queues_used; ++offset)
+            {
+                this->do_some_work((first_queue + offset) % num_queues_);
+            }
+        }
+
         /// Return the next thread to be executed, return false if none is
         /// available
         bool get_next_thread(std::size_t num_thread, bool running,
@@ -21,7 +21,9 @@
 
 // Does not rely on CXX11_STD_ATOMIC_128BIT
 #include <pika/concurrency/concurrentqueue.hpp>
+#include <pika/concurrency/detail/chase_lev_deque.hpp>
 
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
 #include <utility>
@@ -151,6 +153,117 @@ namespace pika::threads {
         };
     };
 
+    ////////////////////////////////////////////////////////////////////////////
+    // LIFO for the owner + stealing at opposite end, using a Chase-Lev
+    // work-stealing deque.
+    //
+    // The deque only supports pushing and popping at the bottom from a single
+    // owner thread. The owner is the first thread that pops from the queue
+    // without stealing. Elements pushed by any other thread, and elements
+    // pushed to the other end, go to a separate FIFO injection queue which is
+    // used when the deque is empty. Threads other than the owner always steal
+    // from the top of the deque.
+    struct chase_lev_lifo;
+
+    namespace detail {
+        // Returns an address that is unique for the calling thread
+        inline void const* chase_lev_thread_token() noexcept
+        {
+            static thread_local char token = 0;
+            return &token;
+        }
+    }    // namespace detail
+
+    template <typename T>
+    struct chase_lev_lifo_backend
+    {
+        using container_type = pika::concurrency::detail::chase_lev_deque<T>;
+        using injection_container_type = pika::concurrency::detail::ConcurrentQueue<T>;
+
+        using value_type = T;
+        using reference = T&;
+        using const_reference = T const&;
+        using rvalue_reference = T&&;
+        using size_type = std::uint64_t;
+
+        chase_lev_lifo_backend(
+            size_type initial_size = 0, size_type /* num_thread */ = size_type(-1))
+          : queue_(std::size_t(initial_size))
+          , injection_queue_(std::size_t(initial_size))
+        {
+        }
+
+        bool push(const_reference val, bool other_end = false)
+        {
+            if (!other_end && is_owner())
+            {
+                queue_.push_bottom(val);
+                return true;
+            }
+            return injection_queue_.enqueue(val);
+        }
+
+        bool push(rvalue_reference val, bool other_end = false)
+        {
+            if (!other_end && is_owner())
+            {
+                queue_.push_bottom(PIKA_MOVE(val));
+                return true;
+            }
+            return injection_queue_.enqueue(PIKA_MOVE(val));
+        }
+
+        bool pop(reference val, bool steal = true)
+        {
+            if (!steal && claim_ownership())
+            {
+                if (queue_.pop_bottom(val))
+                    return true;
+            }
+            else if (queue_.steal(val))
+            {
+                return true;
+            }
+            return injection_queue_.try_dequeue(val);
+        }
+
+        bool empty()
+        {
+            return queue_.empty() && injection_queue_.size_approx() == 0;
+        }
+
+    private:
+        bool is_owner() const noexcept
+        {
+            return owner_.load(std::memory_order_relaxed) == detail::chase_lev_thread_token();
+        }
+
+        bool claim_ownership() noexcept
+        {
+            void const* const token = detail::chase_lev_thread_token();
+            void const* owner = owner_.load(std::memory_order_relaxed);
+            if (owner == nullptr)
+            {
+                owner_.compare_exchange_strong(owner, token, std::memory_order_relaxed);
+                return owner == nullptr;
+            }
+            return owner == token;
+        }
+
+        container_type queue_;
+        injection_container_type injection_queue_;
+        std::atomic<void const*> owner_{nullptr};
+    };
+
+    struct chase_lev_lifo
+    {
+        template <typename T>
+        struct apply
+        {
+            using type = chase_lev_lifo_backend<T>;
+        };
+    };
+
     // LIFO
 #if defined(PIKA_HAVE_CXX11_STD_ATOMIC_128BIT)
     struct lockfree_lifo;
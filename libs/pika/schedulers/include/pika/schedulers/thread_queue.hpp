@@ -14,6 +14,7 @@
 #include <pika/functional/function.hpp>
 #include <pika/modules/errors.hpp>
 #include <pika/schedulers/deadlock_detection.hpp>
+#include <pika/schedulers/detail/slab_pool.hpp>
 #include <pika/schedulers/lockfree_queue_backends.hpp>
 #include <pika/schedulers/maintain_queue_wait_times.hpp>
 #include <pika/schedulers/queue_helpers.hpp>
@@ -22,6 +23,7 @@
 #include <pika/threading_base/thread_data.hpp>
 #include <pika/threading_base/thread_data_stackful.hpp>
 #include <pika/threading_base/thread_data_stackless.hpp>
+#include <pika/threading_base/thread_init_data.hpp>
 #include <pika/threading_base/thread_queue_init_parameters.hpp>
 #include <pika/util/get_and_reset_value.hpp>
 
@@ -29,8 +31,10 @@
 # include <pika/timing/tick_counter.hpp>
 #endif
 
+#include <boost/lockfree/stack.hpp>
 #include <fmt/format.h>
 
+#include <array>
 #include <atomic>
 #include <chrono>
 #include <cstddef>
@@ -46,6 +50,38 @@
 #include <vector>
 
 ///////////////////////////////////////////////////////////////////////////////
+namespace pika::threads::detail {
+    // A task registered with a queue for which no thread object has been
+    // created yet
+    struct task_description
+    {
+        thread_init_data data;
+#ifdef PIKA_HAVE_THREAD_QUEUE_WAITTIME
+        std::uint64_t waittime;
+#endif
+    };
+
+    // Task descriptions are allocated by the thread creating a task and freed
+    // by the worker thread converting it to a thread object
+    using task_description_pool = slab_pool<task_description>;
+
+    // Return the counters of the task description pool of the pika library
+    PIKA_EXPORT slab_pool_statistics get_task_description_pool_statistics();
+
+#ifdef PIKA_HAVE_THREAD_QUEUE_WAITTIME
+    struct thread_description
+    {
+        thread_id_ref_type data;
+        std::uint64_t waittime;
+    };
+
+    using thread_description_pool = slab_pool<thread_description>;
+
+    // Return the counters of the thread description pool of the pika library
+    PIKA_EXPORT slab_pool_statistics get_thread_description_pool_statistics();
+#endif
+}    // namespace pika::threads::detail
+
 namespace pika::threads {
     ///////////////////////////////////////////////////////////////////////////
     // // Queue back-end interface:
@@ -93,23 +129,30 @@ namespace pika::threads {
             std::equal_to<threads::detail::thread_id_type>,
             pika::detail::internal_allocator<threads::detail::thread_id_type>>;
 
-        using thread_heap_type = std::vector<threads::detail::thread_id_type,
-            pika::detail::internal_allocator<threads::detail::thread_id_type>>;
-
-        struct task_description
+        // The thread map is split into shards, each protected by its own
+        // mutex. Creating and cleaning up threads only locks the shard of
+        // the thread, never mtx_.
+        struct thread_map_shard
         {
-            threads::detail::thread_init_data data;
-#ifdef PIKA_HAVE_THREAD_QUEUE_WAITTIME
-            std::uint64_t waittime;
-#endif
+            mutable mutex_type mtx;
+            thread_map_type map;
         };
 
+        static constexpr std::size_t thread_map_shard_count = 16;
+
+        // Unused thread objects of a single stack size. Thread objects are
+        // pushed when terminated threads are cleaned up and popped when new
+        // threads are created, neither of which requires holding mtx_.
+        using thread_heap_type = boost::lockfree::stack<threads::detail::thread_data*>;
+
+        // Maximum number of tasks converted to threads or terminated threads
+        // cleaned up at once
+        static constexpr std::size_t batch_size = 32;
+
+        using task_description = threads::detail::task_description;
+
 #ifdef PIKA_HAVE_THREAD_QUEUE_WAITTIME
-        struct thread_description
-        {
-            threads::detail::thread_id_ref_type data;
-            std::uint64_t waittime;
-        };
+        using thread_description = threads::detail::thread_description;
         using thread_description_ptr = thread_description*;
 #else
         using thread_description_ptr = typename threads::detail::thread_id_ref_type::thread_repr*;
@@ -124,37 +167,85 @@ namespace pika::threads {
             typename TerminatedQueuing::template apply<threads::detail::thread_data*>::type;
 
     protected:
-        template <typename Lock>
-        void create_thread_object(threads::detail::thread_id_ref_type& thrd,
-            threads::detail::thread_init_data& data, Lock& lk)
+        thread_heap_type* get_thread_heap(std::ptrdiff_t stacksize) noexcept
         {
-            PIKA_ASSERT(lk.owns_lock());
-
-            std::ptrdiff_t const stacksize = data.scheduler_base->get_stack_size(data.stacksize);
-
-            thread_heap_type* heap = nullptr;
-
             if (stacksize == parameters_.small_stacksize_)
             {
-                heap = &thread_heap_small_;
+                return &thread_heap_small_;
             }
             else if (stacksize == parameters_.medium_stacksize_)
             {
-                heap = &thread_heap_medium_;
+                return &thread_heap_medium_;
             }
             else if (stacksize == parameters_.large_stacksize_)
             {
-                heap = &thread_heap_large_;
+                return &thread_heap_large_;
             }
             else if (stacksize == parameters_.huge_stacksize_)
             {
-                heap = &thread_heap_huge_;
+                return &thread_heap_huge_;
             }
             else if (stacksize == parameters_.nostack_stacksize_)
             {
-                heap = &thread_heap_nostack_;
+                return &thread_heap_nostack_;
             }
-            PIKA_ASSERT(heap);
+            return nullptr;
+        }
+
+        thread_map_shard& get_thread_map_shard(threads::detail::thread_id_type tid) noexcept
+        {
+            // Thread objects are larger than 64 bytes, the lowest bits of
+            // their addresses are the same for many threads
+            return thread_map_[(reinterpret_cast<std::uintptr_t>(tid.get()) >> 6) %
+                thread_map_shard_count];
+        }
+
+        // Add a thread to the thread map. Returns false if the thread is
+        // already in the map.
+        bool insert_into_thread_map(threads::detail::thread_id_type tid)
+        {
+            thread_map_shard& shard = get_thread_map_shard(tid);
+            {
+                std::lock_guard<mutex_type> lk(shard.mtx);
+                if (!shard.map.insert(tid).second)
+                {
+                    return false;
+                }
+            }
+            ++thread_map_count_;
+            return true;
+        }
+
+        // Remove a thread from the thread map. Returns false if the thread is
+        // not in the map.
+        bool erase_from_thread_map(threads::detail::thread_id_type tid)
+        {
+            thread_map_shard& shard = get_thread_map_shard(tid);
+            {
+                std::lock_guard<mutex_type> lk(shard.mtx);
+
+                // this thread has to be in this map
+                PIKA_ASSERT(shard.map.find(tid) != shard.map.end());
+
+                if (shard.map.erase(tid) == 0)
+                {
+                    return false;
+                }
+            }
+            --thread_map_count_;
+            PIKA_ASSERT(thread_map_count_ >= 0);
+            return true;
+        }
+
+        // Create a new thread object or reuse an unused one. This does not
+        // require holding mtx_. If no unused thread object is available in
+        // this queue the thread objects of the queue given as donor (the
+        // queue tasks are being stolen from, if any) are used, which allows
+        // rebalancing the recycled thread objects between queues.
+        void create_thread_object(threads::detail::thread_id_ref_type& thrd,
+            threads::detail::thread_init_data& data, thread_queue* donor = nullptr)
+        {
+            std::ptrdiff_t const stacksize = data.scheduler_base->get_stack_size(data.stacksize);
 
             if (data.initial_state ==
                     threads::detail::thread_schedule_state::pending_do_not_schedule ||
@@ -163,39 +254,45 @@ namespace pika::threads {
                 data.initial_state = threads::detail::thread_schedule_state::pending;
             }
 
+            threads::detail::thread_data* p = nullptr;
+
             // ASAN gets confused by reusing threads/stacks
 #if !defined(PIKA_HAVE_ADDRESS_SANITIZER)
+            thread_heap_type* heap = get_thread_heap(stacksize);
+            PIKA_ASSERT(heap);
 
             // Check for an unused thread object.
-            if (!heap->empty())
+            if (heap->pop(p))
             {
                 // Take ownership of the thread object and rebind it.
-                thrd = heap->back();
-                heap->pop_back();
-                threads::detail::get_thread_id_data(thrd)->rebind(data);
+                thrd = threads::detail::thread_id_ref_type(p);
+                p->rebind(data);
+                return;
             }
-            else
-#endif
+
+            if (donor != nullptr && donor != this && donor->get_thread_heap(stacksize)->pop(p))
             {
-                pika::detail::unlock_guard<Lock> ull(lk);
+                // The thread object will be returned to this queue once the
+                // thread has terminated.
+                p->set_queue(*this);
+                thrd = threads::detail::thread_id_ref_type(p);
+                p->rebind(data);
+                return;
+            }
+#endif
 
-                // Allocate a new thread object.
-                threads::detail::thread_data* p = nullptr;
-                if (stacksize == parameters_.nostack_stacksize_)
-                {
-                    p = threads::detail::thread_data_stackless::create(data, this, stacksize);
-                }
-                else
-                {
-                    p = threads::detail::thread_data_stackful::create(data, this, stacksize);
-                }
-                thrd =
-                    threads::detail::thread_id_ref_type(p, threads::detail::thread_id_addref::no);
+            // Allocate a new thread object.
+            if (stacksize == parameters_.nostack_stacksize_)
+            {
+                p = threads::detail::thread_data_stackless::create(data, this, stacksize);
             }
+            else
+            {
+                p = threads::detail::thread_data_stackful::create(data, this, stacksize);
+            }
+            thrd = threads::detail::thread_id_ref_type(p, threads::detail::thread_id_addref::no);
         }
 
-        static pika::detail::internal_allocator<task_description> task_description_alloc_;
-
         ///////////////////////////////////////////////////////////////////////
         // add new threads if there is some amount of work available
         std::size_t add_new(std::int64_t add_count, thread_queue* addfrom,
@@ -206,59 +303,69 @@ namespace pika::threads {
             if (PIKA_UNLIKELY(0 == add_count))
                 return 0;
 
+            // mtx_ is only used to let one worker thread at a time decide how
+            // many tasks to convert. The thread objects are created (or
+            // rebound) and added to the thread map without holding it.
+            pika::detail::unlock_guard<std::unique_lock<mutex_type>> ull(lk);
+
+            std::array<threads::detail::thread_id_ref_type, batch_size> threads;
             std::size_t added = 0;
-            task_description* task = nullptr;
-            while (add_count-- && addfrom->new_tasks_.pop(task, steal))
+            while (add_count != 0)
             {
-#ifdef PIKA_HAVE_THREAD_QUEUE_WAITTIME
-                if (get_maintain_queue_wait_times_enabled())
+                std::size_t count = 0;
+                task_description* task = nullptr;
+                while (count != batch_size && add_count != 0 &&
+                    addfrom->new_tasks_.pop(task, steal))
                 {
-                    using namespace std::chrono;
-                    addfrom->new_tasks_wait_ += duration<std::uint64_t, std::nano>(
-                                                    high_resolution_clock::now().time_since_epoch())
-                                                    .count() -
-                        task->waittime;
-                    ++addfrom->new_tasks_wait_count_;
-                }
+                    --add_count;
+#ifdef PIKA_HAVE_THREAD_QUEUE_WAITTIME
+                    if (get_maintain_queue_wait_times_enabled())
+                    {
+                        using namespace std::chrono;
+                        addfrom->new_tasks_wait_.fetch_add(
+                            duration<std::uint64_t, std::nano>(
+                                high_resolution_clock::now().time_since_epoch())
+                                    .count() -
+                                task->waittime,
+                            std::memory_order_relaxed);
+                        addfrom->new_tasks_wait_count_.fetch_add(1, std::memory_order_relaxed);
+                    }
 #endif
-                // create the new thread
-                threads::detail::thread_init_data& data = task->data;
-
-                bool schedule_now =
-                    data.initial_state == threads::detail::thread_schedule_state::pending;
-                (void) schedule_now;
-
-                threads::detail::thread_id_ref_type thrd;
-                create_thread_object(thrd, data, lk);
-
-                task->~task_description();
-                task_description_alloc_.deallocate(task, 1);
+                    // create the new thread, reusing thread objects of the
+                    // queue we steal from if necessary
+                    threads::detail::thread_init_data& data = task->data;
+                    PIKA_ASSERT(
+                        data.initial_state == threads::detail::thread_schedule_state::pending);
 
-                // add the new entry to the map of all threads
-                std::pair<thread_map_type::iterator, bool> p = thread_map_.insert(thrd.noref());
+                    create_thread_object(threads[count++], data, addfrom);
 
-                if (PIKA_UNLIKELY(!p.second))
-                {
-                    --addfrom->new_tasks_count_.data_;
-                    lk.unlock();
-                    PIKA_THROW_EXCEPTION(pika::error::out_of_memory, "thread_queue::add_new",
-                        "Couldn't add new thread to the thread map");
-                    return 0;
+                    threads::detail::task_description_pool::destroy(task);
                 }
 
-                ++thread_map_count_;
+                for (std::size_t i = 0; i != count; ++i)
+                {
+                    // add the new entry to the map of all threads
+                    if (PIKA_UNLIKELY(!insert_into_thread_map(threads[i].noref())))
+                    {
+                        addfrom->new_tasks_count_.data_ -= static_cast<std::int64_t>(count - i);
+                        PIKA_THROW_EXCEPTION(pika::error::out_of_memory, "thread_queue::add_new",
+                            "Couldn't add new thread to the thread map");
+                        return 0;
+                    }
 
-                // Decrement only after thread_map_count_ has been incremented
-                --addfrom->new_tasks_count_.data_;
+                    // Decrement only after thread_map_count_ has been incremented
+                    --addfrom->new_tasks_count_.data_;
 
-                // insert the thread into the work-items queue assuming it is
-                // in pending state, thread would go out of scope otherwise
-                PIKA_ASSERT(schedule_now);
+                    // pushing the new thread into the pending queue of the
+                    // specified thread_queue
+                    ++added;
+                    schedule_thread(PIKA_MOVE(threads[i]));
+                }
 
-                // pushing the new thread into the pending queue of the
-                // specified thread_queue
-                ++added;
-                schedule_thread(PIKA_MOVE(thrd));
+                if (count != batch_size)
+                {
+                    break;
+                }
             }
 
             if (added)
@@ -285,7 +392,7 @@ namespace pika::threads {
             // map holds more than max_thread_count
             if (PIKA_LIKELY(parameters_.max_thread_count_))
             {
-                std::int64_t count = static_cast<std::int64_t>(thread_map_.size());
+                std::int64_t count = thread_map_count_.load(std::memory_order_relaxed);
                 if (parameters_.max_thread_count_ >= count + parameters_.min_add_new_count_)
                 {    //-V104
                     PIKA_ASSERT(parameters_.max_thread_count_ - count <
@@ -315,126 +422,94 @@ namespace pika::threads {
             return addednew != 0;
         }
 
-        void recycle_thread(threads::detail::thread_id_type thrd)
+        void recycle_thread(threads::detail::thread_data* thrd)
         {
-            std::ptrdiff_t stacksize = threads::detail::get_thread_id_data(thrd)->get_stack_size();
+            PIKA_ASSERT(&thrd->get_queue<thread_queue>() == this);
 
-            if (stacksize == parameters_.small_stacksize_)
-            {
-                thread_heap_small_.push_back(thrd);
-            }
-            else if (stacksize == parameters_.medium_stacksize_)
-            {
-                thread_heap_medium_.push_back(thrd);
-            }
-            else if (stacksize == parameters_.large_stacksize_)
-            {
-                thread_heap_large_.push_back(thrd);
-            }
-            else if (stacksize == parameters_.huge_stacksize_)
-            {
-                thread_heap_huge_.push_back(thrd);
-            }
-            else if (stacksize == parameters_.nostack_stacksize_)
-            {
-                thread_heap_nostack_.push_back(thrd);
-            }
-            else
+            std::ptrdiff_t stacksize = thrd->get_stack_size();
+            thread_heap_type* heap = get_thread_heap(stacksize);
+            if (heap == nullptr)
             {
                 PIKA_ASSERT_MSG(false, fmt::format("Invalid stack size {}", stacksize));
+                return;
             }
+            heap->push(thrd);
         }
 
-    public:
-        /// This function makes sure all threads which are marked for deletion
-        /// (state is terminated) are properly destroyed.
-        ///
-        /// This returns 'true' if there are no more terminated threads waiting
-        /// to be deleted.
-        bool cleanup_terminated_locked(bool delete_all = false)
+        std::int64_t get_delete_count() const
         {
-#ifdef PIKA_HAVE_THREAD_CREATION_AND_CLEANUP_RATES
-            chrono::detail::tick_counter tc(cleanup_terminated_time_);
-#endif
-
-            if (terminated_items_count_.load(std::memory_order_acquire) == 0)
-                return true;
+            // delete only this many threads
+            std::int64_t delete_count =
+                (std::min)(static_cast<std::int64_t>(terminated_items_count_ / 10),
+                    static_cast<std::int64_t>(parameters_.max_delete_count_));
+
+            // delete at least this many threads
+            return (std::max)(
+                delete_count, static_cast<std::int64_t>(parameters_.min_delete_count_));
+        }
 
-            if (delete_all)
+        // Remove the given terminated threads from the thread map. Returns the
+        // number of threads which have been removed, those are moved to the
+        // beginning of the array.
+        std::size_t erase_terminated(
+            std::array<threads::detail::thread_data*, batch_size>& terminated, std::size_t count)
+        {
+            std::size_t erased = 0;
+            for (std::size_t i = 0; i != count; ++i)
             {
-                // delete all threads
-                threads::detail::thread_data* todelete;
-                while (terminated_items_.pop(todelete))
+                if (erase_from_thread_map(threads::detail::thread_id_type(terminated[i])))
                 {
-                    threads::detail::thread_id_type tid(todelete);
-                    --terminated_items_count_;
-
-                    // this thread has to be in this map
-                    PIKA_ASSERT(thread_map_.find(tid) != thread_map_.end());
-
-                    if (thread_map_.erase(tid) != 0)
-                    {
-                        recycle_thread(tid);
-                        --thread_map_count_;
-                        PIKA_ASSERT(thread_map_count_ >= 0);
-                    }
+                    terminated[erased++] = terminated[i];
                 }
             }
-            else
-            {
-                // delete only this many threads
-                std::int64_t delete_count =
-                    (std::min)(static_cast<std::int64_t>(terminated_items_count_ / 10),
-                        static_cast<std::int64_t>(parameters_.max_delete_count_));
-
-                // delete at least this many threads
-                delete_count = (std::max)(
-                    delete_count, static_cast<std::int64_t>(parameters_.min_delete_count_));
-
-                threads::detail::thread_data* todelete;
-                while (delete_count && terminated_items_.pop(todelete))
-                {
-                    threads::detail::thread_id_type tid(todelete);
-                    --terminated_items_count_;
-
-                    // this thread has to be in this map, except if it has changed
-                    // its priority, then it could be elsewhere
-                    PIKA_ASSERT(thread_map_.find(tid) != thread_map_.end());
+            return erased;
+        }
 
-                    if (thread_map_.erase(tid) != 0)
-                    {
-                        recycle_thread(tid);
-                        --thread_map_count_;
-                        PIKA_ASSERT(thread_map_count_ >= 0);
-                    }
-                    --delete_count;
-                }
+        std::size_t pop_terminated(std::array<threads::detail::thread_data*, batch_size>& terminated,
+            std::int64_t& delete_count)
+        {
+            std::size_t count = 0;
+            while (count != batch_size && delete_count != 0 &&
+                terminated_items_.pop(terminated[count]))
+            {
+                --terminated_items_count_;
+                --delete_count;
+                ++count;
             }
-            return terminated_items_count_.load(std::memory_order_acquire) == 0;
+            return count;
         }
 
     public:
+        /// This function makes sure all threads which are marked for deletion
+        /// (state is terminated) are properly destroyed. Neither removing the
+        /// threads from the thread map nor recycling the thread objects
+        /// requires holding the queue mutex.
+        ///
+        /// This returns 'true' if there are no more terminated threads waiting
+        /// to be deleted.
         bool cleanup_terminated(bool delete_all = false)
         {
             if (terminated_items_count_.load(std::memory_order_acquire) == 0)
                 return true;
 
-            if (delete_all)
+#ifdef PIKA_HAVE_THREAD_CREATION_AND_CLEANUP_RATES
+            chrono::detail::tick_counter tc(cleanup_terminated_time_);
+#endif
+
+            // delete_count is negative (unlimited) if all threads should be
+            // deleted
+            std::int64_t delete_count = delete_all ? -1 : get_delete_count();
+
+            std::array<threads::detail::thread_data*, batch_size> terminated;
+            while (std::size_t count = pop_terminated(terminated, delete_count))
             {
-                // do not lock mutex while deleting all threads, do it piece-wise
-                while (true)
+                std::size_t const erased = erase_terminated(terminated, count);
+                for (std::size_t i = 0; i != erased; ++i)
                 {
-                    std::lock_guard<mutex_type> lk(mtx_);
-                    if (cleanup_terminated_locked(false))
-                    {
-                        return true;
-                    }
+                    recycle_thread(terminated[i]);
                 }
-                return false;
             }
-
-            std::lock_guard<mutex_type> lk(mtx_);
-            return cleanup_terminated_locked(false);
+            return terminated_items_count_.load(std::memory_order_acquire) == 0;
         }
 
         thread_queue(std::size_t queue_num = std::size_t(-1),
@@ -453,11 +528,11 @@ namespace pika::threads {
           , new_tasks_wait_(0)
           , new_tasks_wait_count_(0)
 #endif
-          , thread_heap_small_()
-          , thread_heap_medium_()
-          , thread_heap_large_()
-          , thread_heap_huge_()
-          , thread_heap_nostack_()
+          , thread_heap_small_(std::size_t(parameters.init_threads_count_))
+          , thread_heap_medium_(0)
+          , thread_heap_large_(0)
+          , thread_heap_huge_(0)
+          , thread_heap_nostack_(0)
 #ifdef PIKA_HAVE_THREAD_CREATION_AND_CLEANUP_RATES
           , add_new_time_(0)
           , cleanup_terminated_time_(0)
@@ -482,20 +557,11 @@ namespace pika::threads {
 
         ~thread_queue()
         {
-            for (auto t : thread_heap_small_)
-                deallocate(threads::detail::get_thread_id_data(t));
-
-            for (auto t : thread_heap_medium_)
-                deallocate(threads::detail::get_thread_id_data(t));
-
-            for (auto t : thread_heap_large_)
-                deallocate(threads::detail::get_thread_id_data(t));
-
-            for (auto t : thread_heap_huge_)
-                deallocate(threads::detail::get_thread_id_data(t));
-
-            for (auto t : thread_heap_nostack_)
-                deallocate(threads::detail::get_thread_id_data(t));
+            for (thread_heap_type* heap : {&thread_heap_small_, &thread_heap_medium_,
+                     &thread_heap_large_, &thread_heap_huge_, &thread_heap_nostack_})
+            {
+                heap->consume_all(&deallocate);
+            }
         }
 
 #ifdef PIKA_HAVE_THREAD_CREATION_AND_CLEANUP_RATES
@@ -639,59 +705,47 @@ namespace pika::threads {
             {
                 threads::detail::thread_id_ref_type thrd;
 
+                bool schedule_now =
+                    data.initial_state == threads::detail::thread_schedule_state::pending;
+
                 // The mutex can not be locked while a new thread is getting
                 // created, as it might have that the current pika thread gets
                 // suspended.
-                {
-                    std::unique_lock<mutex_type> lk(mtx_);
-
-                    bool schedule_now =
-                        data.initial_state == threads::detail::thread_schedule_state::pending;
+                create_thread_object(thrd, data);
 
-                    create_thread_object(thrd, data, lk);
-
-                    // add a new entry in the map for this thread
-                    std::pair<thread_map_type::iterator, bool> p = thread_map_.insert(thrd.noref());
-
-                    if (PIKA_UNLIKELY(!p.second))
-                    {
-                        lk.unlock();
-                        PIKA_THROWS_IF(ec, pika::error::out_of_memory,
-                            "thread_queue::create_thread",
-                            "Couldn't add new thread to the map of threads");
-                        return;
-                    }
-                    ++thread_map_count_;
+                // add a new entry in the map for this thread
+                if (PIKA_UNLIKELY(!insert_into_thread_map(thrd.noref())))
+                {
+                    PIKA_THROWS_IF(ec, pika::error::out_of_memory, "thread_queue::create_thread",
+                        "Couldn't add new thread to the map of threads");
+                    return;
+                }
 
-                    // this thread has to be in the map now
-                    PIKA_ASSERT(thread_map_.find(thrd.noref()) != thread_map_.end());
-                    PIKA_ASSERT(
-                        &threads::detail::get_thread_id_data(thrd)->get_queue<thread_queue>() ==
-                        this);
+                PIKA_ASSERT(
+                    &threads::detail::get_thread_id_data(thrd)->get_queue<thread_queue>() == this);
 
-                    // push the new thread in the pending thread queue
-                    if (schedule_now)
-                    {
-                        // return the thread_id_ref of the newly created thread
-                        if (id)
-                        {
-                            *id = thrd;
-                        }
-                        schedule_thread(PIKA_MOVE(thrd));
-                    }
-                    else
+                // push the new thread in the pending thread queue
+                if (schedule_now)
+                {
+                    // return the thread_id_ref of the newly created thread
+                    if (id)
                     {
-                        // if the thread should not be scheduled the id must be
-                        // returned to the caller as otherwise the thread would
-                        // go out of scope right away.
-                        PIKA_ASSERT(id != nullptr);
-                        *id = PIKA_MOVE(thrd);
+                        *id = thrd;
                     }
-
-                    if (&ec != &throws)
-                        ec = make_success_code();
-                    return;
+                    schedule_thread(PIKA_MOVE(thrd));
                 }
+                else
+                {
+                    // if the thread should not be scheduled the id must be
+                    // returned to the caller as otherwise the thread would
+                    // go out of scope right away.
+                    PIKA_ASSERT(id != nullptr);
+                    *id = PIKA_MOVE(thrd);
+                }
+
+                if (&ec != &throws)
+                    ec = make_success_code();
+                return;
             }
 
             // if the initial state is not pending, delayed creation will
@@ -707,16 +761,62 @@ namespace pika::threads {
             // later thread creation
             ++new_tasks_count_.data_;
 
-            task_description* td = task_description_alloc_.allocate(1);
 #ifdef PIKA_HAVE_THREAD_QUEUE_WAITTIME
             using namespace std::chrono;
-            new (td) task_description{PIKA_MOVE(data),
+            new_tasks_.push(threads::detail::task_description_pool::construct(PIKA_MOVE(data),
                 duration<std::uint64_t, std::nano>(high_resolution_clock::now().time_since_epoch())
-                    .count()};
+                    .count()));
 #else
-            new (td) task_description{PIKA_MOVE(data)};    //-V106
+            new_tasks_.push(threads::detail::task_description_pool::construct(PIKA_MOVE(data)));
 #endif
-            new_tasks_.push(td);
+            if (&ec != &throws)
+                ec = make_success_code();
+        }
+
+        // Register task descriptions for count staged threads at once. The
+        // init data are taken from data, data + stride, data + 2 * stride,
+        // and so on, so that a scheduler can hand each queue its share of a
+        // batch that is distributed round-robin over the queues. The count of
+        // staged tasks is only updated once.
+        void create_threads_staged(threads::detail::thread_init_data* data, std::size_t count,
+            std::size_t stride, error_code& ec)
+        {
+            for (std::size_t i = 0; i != count; ++i)
+            {
+                threads::detail::thread_init_data& d = data[i * stride];
+                PIKA_ASSERT(!d.run_now);
+
+                if (d.initial_state != threads::detail::thread_schedule_state::pending)
+                {
+                    PIKA_THROWS_IF(ec, pika::error::bad_parameter,
+                        "thread_queue::create_threads_staged",
+                        "staged tasks must have 'pending' as their initial state");
+                    return;
+                }
+
+                if (d.stacksize == execution::thread_stacksize::current)
+                {
+                    d.stacksize = threads::detail::get_self_stacksize_enum();
+                }
+            }
+
+            new_tasks_count_.data_ += static_cast<std::int64_t>(count);
+
+            for (std::size_t i = 0; i != count; ++i)
+            {
+#ifdef PIKA_HAVE_THREAD_QUEUE_WAITTIME
+                using namespace std::chrono;
+                new_tasks_.push(threads::detail::task_description_pool::construct(
+                    PIKA_MOVE(data[i * stride]),
+                    duration<std::uint64_t, std::nano>(
+                        high_resolution_clock::now().time_since_epoch())
+                        .count()));
+#else
+                new_tasks_.push(
+                    threads::detail::task_description_pool::construct(PIKA_MOVE(data[i * stride])));
+#endif
+            }
+
             if (&ec != &throws)
                 ec = make_success_code();
         }
@@ -807,7 +907,7 @@ namespace pika::threads {
                 }
 
                 thrd = PIKA_MOVE(tdesc->data);
-                delete tdesc;
+                threads::detail::thread_description_pool::destroy(tdesc);
 
                 return true;
             }
@@ -829,10 +929,10 @@ namespace pika::threads {
             ++work_items_count_.data_;
 #ifdef PIKA_HAVE_THREAD_QUEUE_WAITTIME
             using namespace std::chrono;
-            work_items_.push(new thread_description{PIKA_MOVE(thrd),
+            work_items_.push(threads::detail::thread_description_pool::construct(PIKA_MOVE(thrd),
                                  duration<std::uint64_t, std::nano>(
                                      high_resolution_clock::now().time_since_epoch())
-                                     .count()},
+                                     .count()),
                 other_end);
 #else
             // detach the thread from the id_ref without decrementing
@@ -871,15 +971,16 @@ namespace pika::threads {
                 return thread_map_count_ + new_tasks_count_.data_ - terminated_items_count_;
             }
 
-            // acquire lock only if absolutely necessary
-            std::lock_guard<mutex_type> lk(mtx_);
-
+            // acquire locks only if absolutely necessary
             std::int64_t num_threads = 0;
-            thread_map_type::const_iterator end = thread_map_.end();
-            for (thread_map_type::const_iterator it = thread_map_.begin(); it != end; ++it)
+            for (thread_map_shard const& shard : thread_map_)
             {
-                if (threads::detail::get_thread_id_data(*it)->get_state().state() == state)
-                    ++num_threads;
+                std::lock_guard<mutex_type> lk(shard.mtx);
+                for (threads::detail::thread_id_type const& id : shard.map)
+                {
+                    if (threads::detail::get_thread_id_data(id)->get_state().state() == state)
+                        ++num_threads;
+                }
             }
             return num_threads;
         }
@@ -887,19 +988,22 @@ namespace pika::threads {
         ///////////////////////////////////////////////////////////////////////
         void abort_all_suspended_threads()
         {
-            std::lock_guard<mutex_type> lk(mtx_);
-            thread_map_type::iterator end = thread_map_.end();
-            for (thread_map_type::iterator it = thread_map_.begin(); it != end; ++it)
+            for (thread_map_shard& shard : thread_map_)
             {
-                auto thrd = threads::detail::get_thread_id_data(*it);
-                if (thrd->get_state().state() == threads::detail::thread_schedule_state::suspended)
+                std::lock_guard<mutex_type> lk(shard.mtx);
+                for (threads::detail::thread_id_type const& id : shard.map)
                 {
-                    thrd->set_state(threads::detail::thread_schedule_state::pending,
-                        threads::detail::thread_restart_state::abort);
+                    auto thrd = threads::detail::get_thread_id_data(id);
+                    if (thrd->get_state().state() ==
+                        threads::detail::thread_schedule_state::suspended)
+                    {
+                        thrd->set_state(threads::detail::thread_schedule_state::pending,
+                            threads::detail::thread_restart_state::abort);
 
-                    // thread holds self-reference
-                    PIKA_ASSERT(thrd->count_ > 1);
-                    schedule_thread(threads::detail::thread_id_ref_type(thrd));
+                        // thread holds self-reference
+                        PIKA_ASSERT(thrd->count_ > 1);
+                        schedule_thread(threads::detail::thread_id_ref_type(thrd));
+                    }
                 }
             }
         }
@@ -924,23 +1028,16 @@ namespace pika::threads {
             std::vector<threads::detail::thread_id_type> ids;
             ids.reserve(static_cast<std::size_t>(count));
 
-            if (state == threads::detail::thread_schedule_state::unknown)
+            for (thread_map_shard const& shard : thread_map_)
             {
-                std::lock_guard<mutex_type> lk(mtx_);
-                thread_map_type::const_iterator end = thread_map_.end();
-                for (thread_map_type::const_iterator it = thread_map_.begin(); it != end; ++it)
+                std::lock_guard<mutex_type> lk(shard.mtx);
+                for (threads::detail::thread_id_type const& id : shard.map)
                 {
-                    ids.push_back(*it);
-                }
-            }
-            else
-            {
-                std::lock_guard<mutex_type> lk(mtx_);
-                thread_map_type::const_iterator end = thread_map_.end();
-                for (thread_map_type::const_iterator it = thread_map_.begin(); it != end; ++it)
-                {
-                    if (threads::detail::get_thread_id_data(*it)->get_state().state() == state)
-                        ids.push_back(*it);
+                    if (state == threads::detail::thread_schedule_state::unknown ||
+                        threads::detail::get_thread_id_data(id)->get_state().state() == state)
+                    {
+                        ids.push_back(id);
+                    }
                 }
             }
 
@@ -1031,7 +1128,7 @@ namespace pika::threads {
                     // Before exiting each of the OS threads deletes the
                     // remaining terminated pika threads
                     // REVIEW: Should we be doing this if we are stealing?
-                    bool canexit = cleanup_terminated_locked(true);
+                    bool canexit = cleanup_terminated(true);
                     if (!running && canexit)
                     {
                         // we don't have any registered work items anymore
@@ -1042,7 +1139,7 @@ namespace pika::threads {
                 }
                 else
                 {
-                    cleanup_terminated_locked();
+                    cleanup_terminated();
                     return false;
                 }
             }
@@ -1069,9 +1166,16 @@ namespace pika::threads {
 #else
             if (get_minimal_deadlock_detection_enabled())
             {
-                std::lock_guard<mutex_type> lk(mtx_);
-                return detail::dump_suspended_threads(
-                    num_thread, thread_map_, idle_loop_count, running);
+                // The threads of all shards are listed together, they are
+                // only looked at for logging
+                std::vector<threads::detail::thread_id_type> ids;
+                ids.reserve(static_cast<std::size_t>(thread_map_count_.load()));
+                for (thread_map_shard const& shard : thread_map_)
+                {
+                    std::lock_guard<mutex_type> lk(shard.mtx);
+                    ids.insert(ids.end(), shard.map.begin(), shard.map.end());
+                }
+                return detail::dump_suspended_threads(num_thread, ids, idle_loop_count, running);
             }
             return false;
 #endif
@@ -1080,10 +1184,9 @@ namespace pika::threads {
         ///////////////////////////////////////////////////////////////////////
         void on_start_thread(std::size_t /* num_thread */)
         {
-            thread_heap_small_.reserve(parameters_.init_threads_count_);
-            thread_heap_medium_.reserve(parameters_.init_threads_count_);
-            thread_heap_large_.reserve(parameters_.init_threads_count_);
-            thread_heap_huge_.reserve(parameters_.init_threads_count_);
+            thread_heap_medium_.reserve(std::size_t(parameters_.init_threads_count_));
+            thread_heap_large_.reserve(std::size_t(parameters_.init_threads_count_));
+            thread_heap_huge_.reserve(std::size_t(parameters_.init_threads_count_));
 
             // Pre-allocate init_threads_count threads, with accompanying stack,
             // with the default stack size
@@ -1093,7 +1196,6 @@ namespace pika::threads {
                 "should this code. If this static_assert fails you've most likely changed the "
                 "default without changing the code here.");
 
-            std::lock_guard<mutex_type> lk(mtx_);
             for (std::int64_t i = 0; i < parameters_.init_threads_count_; ++i)
             {
                 // We don't care about the init parameters since this thread
@@ -1111,7 +1213,7 @@ namespace pika::threads {
                 p->init();
 
                 // Finally, store the thread for later use
-                thread_heap_small_.emplace_back(p);
+                thread_heap_small_.push(p);
             }
         }
         void on_stop_thread(std::size_t /* num_thread */) {}
@@ -1120,9 +1222,15 @@ namespace pika::threads {
     private:
         detail::thread_queue_init_parameters parameters_;
 
-        mutable mutex_type mtx_;    // mutex protecting the members
+        // mutex taken by worker threads which look for staged tasks to
+        // convert, see wait_or_add_new. add_new releases it while it pops
+        // and converts the staged tasks.
+        mutable mutex_type mtx_;
 
-        thread_map_type thread_map_;    // mapping of thread id's to pika-threads
+        // mapping of thread id's to pika-threads
+        std::array<pika::concurrency::detail::cache_aligned_data_derived<thread_map_shard>,
+            thread_map_shard_count>
+            thread_map_;
 
         // overall count of work items
         std::atomic<std::int64_t> thread_map_count_;
@@ -1183,12 +1291,4 @@ namespace pika::threads {
         // count of active work items
         pika::concurrency::detail::cache_line_data<std::atomic<std::int64_t>> work_items_count_;
     };
-
-    ///////////////////////////////////////////////////////////////////////////
-    template <typename Mutex, typename PendingQueuing, typename StagedQueuing,
-        typename TerminatedQueuing>
-    pika::detail::internal_allocator<typename thread_queue<Mutex, PendingQueuing, StagedQueuing,
-        TerminatedQueuing>::task_description>
-        thread_queue<Mutex, PendingQueuing, StagedQueuing,
-            TerminatedQueuing>::task_description_alloc_;
 }    // namespace pika::threads
@@ -0,0 +1,23 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#include <pika/schedulers/detail/slab_pool.hpp>
+#include <pika/schedulers/thread_queue.hpp>
+
+namespace pika::threads::detail {
+    slab_pool_statistics get_task_description_pool_statistics()
+    {
+        return task_description_pool::get_statistics();
+    }
+
+#ifdef PIKA_HAVE_THREAD_QUEUE_WAITTIME
+    slab_pool_statistics get_thread_description_pool_statistics()
+    {
+        return thread_description_pool::get_statistics();
+    }
+#endif
+}    // namespace pika::threads::detail
@@ -83,6 +83,12 @@ int main(int argc, char* argv[])
         test_scheduler<scheduler_type>(argc, argv);
     }
 
+    {
+        using scheduler_type = pika::threads::local_priority_queue_scheduler<std::mutex,
+            pika::threads::chase_lev_lifo>;
+        test_scheduler<scheduler_type>(argc, argv);
+    }
+
 #if defined(PIKA_HAVE_CXX11_STD_ATOMIC_128BIT)
     {
         using scheduler_type = pika::threads::local_priority_queue_scheduler<std::mutex,
@@ -0,0 +1,198 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#include <pika/schedulers/detail/slab_pool.hpp>
+#include <pika/testing.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <set>
+#include <thread>
+#include <vector>
+
+using pika::threads::detail::slab_pool;
+using pika::threads::detail::slab_pool_statistics;
+
+constexpr std::size_t blocks_per_slab = 16;
+constexpr std::size_t remote_batch_size = 4;
+
+// Every test uses its own type so that the counters of the pools are
+// independent of the other tests
+template <int I>
+struct element
+{
+    static std::atomic<std::int64_t> count;
+
+    std::uint64_t value;
+
+    explicit element(std::uint64_t v)
+      : value(v)
+    {
+        ++count;
+    }
+
+    ~element() { --count; }
+};
+
+template <int I>
+std::atomic<std::int64_t> element<I>::count{0};
+
+template <int I>
+using pool = slab_pool<element<I>, blocks_per_slab, remote_batch_size>;
+
+void test_local()
+{
+    using pool_type = pool<0>;
+    constexpr std::size_t num_elements = 3 * blocks_per_slab + 1;
+
+    for (int round = 0; round != 3; ++round)
+    {
+        std::vector<element<0>*> elements;
+        std::set<element<0>*> unique_elements;
+        for (std::size_t i = 0; i != num_elements; ++i)
+        {
+            element<0>* e = pool_type::construct(i);
+            PIKA_TEST_EQ(reinterpret_cast<std::uintptr_t>(e) % alignof(element<0>),
+                std::uintptr_t(0));
+            elements.push_back(e);
+            unique_elements.insert(e);
+        }
+        PIKA_TEST_EQ(unique_elements.size(), num_elements);
+        PIKA_TEST_EQ(element<0>::count.load(), std::int64_t(num_elements));
+
+        for (std::size_t i = 0; i != num_elements; ++i)
+        {
+            PIKA_TEST_EQ(elements[i]->value, i);
+            pool_type::destroy(elements[i]);
+        }
+        PIKA_TEST_EQ(element<0>::count.load(), std::int64_t(0));
+    }
+
+    // Blocks are reused after the first round
+    slab_pool_statistics const statistics = pool_type::get_statistics();
+    PIKA_TEST_EQ(statistics.slabs, std::uint64_t(4));
+    PIKA_TEST_EQ(statistics.allocations, std::uint64_t(3 * num_elements));
+    PIKA_TEST_EQ(statistics.local_frees, std::uint64_t(3 * num_elements));
+    PIKA_TEST_EQ(statistics.remote_frees, std::uint64_t(0));
+    PIKA_TEST_EQ(statistics.remote_batches, std::uint64_t(0));
+}
+
+void test_remote(std::size_t num_consumers)
+{
+    using pool_type = pool<1>;
+    constexpr std::size_t num_elements = 8 * blocks_per_slab;
+
+    // The producer allocates all elements while the consumers free them
+    // concurrently. The batches of the consumers are returned at the latest
+    // when they exit, after which the producer allocates the same number of
+    // elements again without needing new slabs.
+    slab_pool_statistics const before = pool_type::get_statistics();
+
+    std::vector<std::atomic<element<1>*>> elements(num_elements);
+    std::thread producer([&]() {
+        for (int round = 0; round != 2; ++round)
+        {
+            std::uint64_t const slabs_before = pool_type::get_statistics().slabs;
+            for (std::size_t i = 0; i != num_elements; ++i)
+            {
+                elements[i].store(pool_type::construct(i), std::memory_order_release);
+            }
+            if (round == 1)
+            {
+                PIKA_TEST_EQ(pool_type::get_statistics().slabs, slabs_before);
+            }
+
+            std::vector<std::thread> consumers;
+            for (std::size_t c = 0; c != num_consumers; ++c)
+            {
+                consumers.emplace_back([&, c]() {
+                    for (std::size_t i = c; i < num_elements; i += num_consumers)
+                    {
+                        element<1>* e = elements[i].exchange(nullptr, std::memory_order_acquire);
+                        PIKA_TEST(e != nullptr);
+                        PIKA_TEST_EQ(e->value, i);
+                        pool_type::destroy(e);
+                    }
+                });
+            }
+
+            for (auto& consumer : consumers)
+            {
+                consumer.join();
+            }
+        }
+    });
+    producer.join();
+
+    PIKA_TEST_EQ(element<1>::count.load(), std::int64_t(0));
+
+    slab_pool_statistics const after = pool_type::get_statistics();
+    PIKA_TEST_EQ(after.allocations - before.allocations, std::uint64_t(2 * num_elements));
+    PIKA_TEST_EQ(after.local_frees - before.local_frees, std::uint64_t(0));
+    PIKA_TEST_EQ(after.remote_frees - before.remote_frees, std::uint64_t(2 * num_elements));
+    PIKA_TEST_LTE(after.remote_batches - before.remote_batches,
+        std::uint64_t(2 * (num_elements / remote_batch_size + num_consumers)));
+
+    // The producers of all calls use the same pool since they never run
+    // concurrently
+    PIKA_TEST_EQ(after.slabs, std::uint64_t(num_elements / blocks_per_slab));
+}
+
+void test_thread_exit()
+{
+    using pool_type = pool<2>;
+    constexpr std::size_t num_elements = 4 * blocks_per_slab;
+
+    // The pool of a thread that has exited is adopted by the next thread that
+    // needs a pool. The blocks allocated by the first thread are freed by the
+    // second, which frees them to its own pool, and reused by the third.
+    std::vector<element<2>*> elements;
+    std::thread([&]() {
+        for (std::size_t i = 0; i != num_elements; ++i)
+        {
+            elements.push_back(pool_type::construct(i));
+        }
+    }).join();
+
+    std::thread([&]() {
+        for (element<2>* e : elements)
+        {
+            pool_type::destroy(e);
+        }
+    }).join();
+    PIKA_TEST_EQ(pool_type::get_statistics().local_frees, std::uint64_t(num_elements));
+
+    std::uint64_t const slabs_before = pool_type::get_statistics().slabs;
+
+    std::thread([&]() {
+        std::vector<element<2>*> new_elements;
+        for (std::size_t i = 0; i != num_elements; ++i)
+        {
+            new_elements.push_back(pool_type::construct(i));
+        }
+        for (element<2>* e : new_elements)
+        {
+            pool_type::destroy(e);
+        }
+    }).join();
+
+    PIKA_TEST_EQ(element<2>::count.load(), std::int64_t(0));
+    PIKA_TEST_EQ(pool_type::get_statistics().slabs, slabs_before);
+}
+
+int main()
+{
+    test_local();
+    for (std::size_t num_consumers : {1, 2, 7})
+    {
+        test_remote(num_consumers);
+    }
+    test_thread_exit();
+
+    return pika::detail::report_errors();
+}
@@ -8,18 +8,16 @@
 
 #include <pika/allocator_support/internal_allocator.hpp>
 #include <pika/assert.hpp>
-#include <pika/datastructures/detail/small_vector.hpp>
+#include <pika/execution_base/any_sender.hpp>
 #include <pika/execution_base/operation_state.hpp>
 #include <pika/execution_base/receiver.hpp>
 #include <pika/execution_base/sender.hpp>
-#include <pika/execution_base/this_thread.hpp>
-#include <pika/functional/unique_function.hpp>
-#include <pika/synchronization/mutex.hpp>
+#include <pika/memory/intrusive_ptr.hpp>
 
 #include <atomic>
+#include <cstddef>
 #include <exception>
 #include <memory>
-#include <mutex>
 #include <optional>
 #include <type_traits>
 #include <utility>
@@ -32,45 +30,100 @@ namespace pika::execution::experimental {
             readwrite
         };
 
+        // An operation waiting for access to a shared state. The nodes are
+        // embedded in the operation states of the senders so that waiting
+        // for access does not allocate.
+        struct async_rw_mutex_waiter
+        {
+            async_rw_mutex_waiter* next = nullptr;
+            void (*resume)(async_rw_mutex_waiter*) noexcept = nullptr;
+        };
+
+        // Reference counting and the list of waiting operations common to all
+        // shared states. A shared state is ready once all accesses to the
+        // previous shared state have been released. Before that, operations
+        // are pushed onto a lock-free list of waiters. Making the state ready
+        // swaps the list for a marker, after which operations are resumed
+        // immediately.
+        struct async_rw_mutex_shared_state_base
+        {
+            std::atomic<std::size_t> ref_count{0};
+            std::atomic<void*> waiters{nullptr};
+
+            // Destroys and deallocates the most derived shared state
+            void (*deallocate)(async_rw_mutex_shared_state_base*) noexcept = nullptr;
+
+            async_rw_mutex_shared_state_base() = default;
+            async_rw_mutex_shared_state_base(async_rw_mutex_shared_state_base&&) = delete;
+            async_rw_mutex_shared_state_base& operator=(
+                async_rw_mutex_shared_state_base&&) = delete;
+            async_rw_mutex_shared_state_base(async_rw_mutex_shared_state_base const&) = delete;
+            async_rw_mutex_shared_state_base& operator=(
+                async_rw_mutex_shared_state_base const&) = delete;
+
+            // The state itself is never a waiter, so its address is used to
+            // mark the state as ready.
+            void* ready_marker() noexcept
+            {
+                return this;
+            }
+
+            bool is_ready() noexcept
+            {
+                return waiters.load(std::memory_order_acquire) == ready_marker();
+            }
+
+            void add_waiter(async_rw_mutex_waiter* waiter) noexcept
+            {
+                void* head = waiters.load(std::memory_order_acquire);
+                do
+                {
+                    // The common case of an access that starts after the
+                    // previous accesses have been released does not need to
+                    // touch the list.
+                    if (head == ready_marker())
+                    {
+                        waiter->resume(waiter);
+                        return;
+                    }
+
+                    waiter->next = static_cast<async_rw_mutex_waiter*>(head);
+                } while (!waiters.compare_exchange_weak(
+                    head, waiter, std::memory_order_release, std::memory_order_acquire));
+
+                // The waiter may already have been resumed and destroyed
+                // here by the thread that made the state ready.
+            }
+
+            void set_ready() noexcept
+            {
+                PIKA_ASSERT(!is_ready());
+
+                auto* waiter = static_cast<async_rw_mutex_waiter*>(
+                    waiters.exchange(ready_marker(), std::memory_order_acq_rel));
+                while (waiter != nullptr)
+                {
+                    // Resuming the waiter may destroy it
+                    auto* next = waiter->next;
+                    waiter->resume(waiter);
+                    waiter = next;
+                }
+            }
+        };
+
         template <typename T>
-        struct async_rw_mutex_shared_state
+        struct async_rw_mutex_shared_state : async_rw_mutex_shared_state_base
         {
-            using shared_state_ptr_type = std::shared_ptr<async_rw_mutex_shared_state>;
-            std::atomic<bool> value_set{false};
+            using shared_state_ptr_type = pika::intrusive_ptr<async_rw_mutex_shared_state>;
             std::optional<T> value{std::nullopt};
             shared_state_ptr_type next_state{nullptr};
-            pika::mutex mtx{};
-            pika::detail::small_vector<
-                pika::util::detail::unique_function<void(shared_state_ptr_type)>, 1>
-                continuations{};
-
-            async_rw_mutex_shared_state() = default;
-            async_rw_mutex_shared_state(async_rw_mutex_shared_state&&) = delete;
-            async_rw_mutex_shared_state& operator=(async_rw_mutex_shared_state&&) = delete;
-            async_rw_mutex_shared_state(async_rw_mutex_shared_state const&) = delete;
-            async_rw_mutex_shared_state& operator=(async_rw_mutex_shared_state const&) = delete;
 
             ~async_rw_mutex_shared_state()
             {
-                // If there is no next state the continuations must be empty.
-                PIKA_ASSERT(next_state || continuations.empty());
-
                 // This state must always have the value set by the time it is
                 // destructed. If there is no next state the value is destructed
                 // with this state.
                 PIKA_ASSERT(value);
-
-                if (PIKA_LIKELY(next_state))
-                {
-                    // The current state has now finished all accesses to the
-                    // wrapped value, so we move the value to the next state.
-                    next_state->set_value(PIKA_MOVE(value.value()));
-
-                    for (auto& continuation : continuations)
-                    {
-                        continuation(next_state);
-                    }
-                }
             }
 
             template <typename U>
@@ -78,18 +131,16 @@ namespace pika::execution::experimental {
             {
                 PIKA_ASSERT(!value);
                 value.emplace(PIKA_FORWARD(U, u));
-                value_set.store(true, std::memory_order_release);
             }
 
             T& get_value()
             {
-                pika::util::yield_while(
-                    [this]() { return !value_set.load(std::memory_order_acquire); });
+                PIKA_ASSERT(is_ready());
                 PIKA_ASSERT(value);
                 return value.value();
             }
 
-            void set_next_state(std::shared_ptr<async_rw_mutex_shared_state> state)
+            void set_next_state(shared_state_ptr_type state)
             {
                 // The next state should only be set once
                 PIKA_ASSERT(!next_state);
@@ -97,56 +148,118 @@ namespace pika::execution::experimental {
                 next_state = PIKA_MOVE(state);
             }
 
-            template <typename F>
-            void add_continuation(F&& continuation)
+            friend void intrusive_ptr_add_ref(async_rw_mutex_shared_state* p) noexcept
             {
-                std::lock_guard<pika::mutex> l(mtx);
-                continuations.emplace_back(PIKA_FORWARD(F, continuation));
+                p->ref_count.fetch_add(1, std::memory_order_relaxed);
+            }
+
+            friend void intrusive_ptr_release(async_rw_mutex_shared_state* p) noexcept
+            {
+                if (p->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
+                {
+                    if (PIKA_LIKELY(p->next_state))
+                    {
+                        // The current state has now finished all accesses to
+                        // the wrapped value, so we move the value to the next
+                        // state and let the accesses waiting for it proceed.
+                        p->next_state->set_value(PIKA_MOVE(p->value.value()));
+                        p->next_state->set_ready();
+                    }
+
+                    p->deallocate(p);
+                }
             }
         };
 
         template <>
-        struct async_rw_mutex_shared_state<void>
+        struct async_rw_mutex_shared_state<void> : async_rw_mutex_shared_state_base
         {
-            using shared_state_ptr_type = std::shared_ptr<async_rw_mutex_shared_state>;
+            using shared_state_ptr_type = pika::intrusive_ptr<async_rw_mutex_shared_state>;
             shared_state_ptr_type next_state{nullptr};
-            pika::mutex mtx{};
-            pika::detail::small_vector<
-                pika::util::detail::unique_function<void(shared_state_ptr_type)>, 1>
-                continuations{};
 
-            async_rw_mutex_shared_state() = default;
-            async_rw_mutex_shared_state(async_rw_mutex_shared_state&&) = delete;
-            async_rw_mutex_shared_state& operator=(async_rw_mutex_shared_state&&) = delete;
-            async_rw_mutex_shared_state(async_rw_mutex_shared_state const&) = delete;
-            async_rw_mutex_shared_state& operator=(async_rw_mutex_shared_state const&) = delete;
+            void set_next_state(shared_state_ptr_type state)
+            {
+                // The next state should only be set once
+                PIKA_ASSERT(!next_state);
+                PIKA_ASSERT(state);
+                next_state = PIKA_MOVE(state);
+            }
 
-            ~async_rw_mutex_shared_state()
+            friend void intrusive_ptr_add_ref(async_rw_mutex_shared_state* p) noexcept
             {
-                // If there is no next state the continuations must be empty.
-                PIKA_ASSERT(next_state || continuations.empty());
+                p->ref_count.fetch_add(1, std::memory_order_relaxed);
+            }
 
-                for (auto& continuation : continuations)
+            friend void intrusive_ptr_release(async_rw_mutex_shared_state* p) noexcept
+            {
+                if (p->ref_count.fetch_sub(1, std::memory_order_acq_rel) == 1)
                 {
-                    continuation(next_state);
+                    if (PIKA_LIKELY(p->next_state))
+                    {
+                        p->next_state->set_ready();
+                    }
+
+                    p->deallocate(p);
                 }
             }
+        };
 
-            void set_next_state(std::shared_ptr<async_rw_mutex_shared_state> state)
+        // Shared states are created for every read-write access and for the
+        // first read-only access after a read-write access. With the default
+        // allocator they are taken from the thread-local pool that is also
+        // used for the heap storage of type-erased senders, so that
+        // consecutive accesses reuse the memory of released shared states.
+        // Other allocators are stored alongside the shared state.
+        template <typename SharedState, typename Allocator>
+        pika::intrusive_ptr<SharedState> make_async_rw_mutex_shared_state(Allocator const& alloc)
+        {
+            SharedState* p = nullptr;
+            if constexpr (std::is_same_v<Allocator, pika::detail::internal_allocator<>>)
             {
-                // The next state should only be set once
-                PIKA_ASSERT(!next_state);
-                PIKA_ASSERT(state);
-                next_state = PIKA_MOVE(state);
+                p = pika::detail::sbo_heap_construct<SharedState>();
+                p->deallocate = [](async_rw_mutex_shared_state_base* p) noexcept {
+                    pika::detail::sbo_heap_destroy(static_cast<SharedState*>(p));
+                };
             }
-
-            template <typename F>
-            void add_continuation(F&& continuation)
+            else
             {
-                std::lock_guard<pika::mutex> l(mtx);
-                continuations.emplace_back(PIKA_FORWARD(F, continuation));
+                struct allocated_shared_state final : SharedState
+                {
+                    PIKA_NO_UNIQUE_ADDRESS Allocator alloc;
+
+                    explicit allocated_shared_state(Allocator const& alloc)
+                      : alloc(alloc)
+                    {
+                    }
+                };
+
+                using allocator_type = typename std::allocator_traits<
+                    Allocator>::template rebind_alloc<allocated_shared_state>;
+                using traits = std::allocator_traits<allocator_type>;
+
+                allocator_type a(alloc);
+                allocated_shared_state* s = traits::allocate(a, 1);
+                try
+                {
+                    traits::construct(a, s, alloc);
+                }
+                catch (...)
+                {
+                    traits::deallocate(a, s, 1);
+                    throw;
+                }
+
+                p = s;
+                p->deallocate = [](async_rw_mutex_shared_state_base* p) noexcept {
+                    auto* s = static_cast<allocated_shared_state*>(static_cast<SharedState*>(p));
+                    allocator_type a(s->alloc);
+                    traits::destroy(a, s);
+                    traits::deallocate(a, s, 1);
+                };
             }
-        };
+
+            return pika::intrusive_ptr<SharedState>(p);
+        }
 
         template <typename ReadWriteT, typename ReadT, async_rw_mutex_access_type AccessType>
         struct async_rw_mutex_access_wrapper;
@@ -155,7 +268,8 @@ namespace pika::execution::experimental {
         struct async_rw_mutex_access_wrapper<ReadWriteT, ReadT, async_rw_mutex_access_type::read>
         {
         private:
-            using shared_state_type = std::shared_ptr<async_rw_mutex_shared_state<ReadWriteT>>;
+            using shared_state_type =
+                pika::intrusive_ptr<async_rw_mutex_shared_state<ReadWriteT>>;
             shared_state_type state;
 
         public:
@@ -189,7 +303,8 @@ namespace pika::execution::experimental {
                 "Cannot mix void and non-void type in async_rw_mutex_access_wrapper wrapper (ReadT "
                 "is void, ReadWriteT is non-void)");
 
-            using shared_state_type = std::shared_ptr<async_rw_mutex_shared_state<ReadWriteT>>;
+            using shared_state_type =
+                pika::intrusive_ptr<async_rw_mutex_shared_state<ReadWriteT>>;
             shared_state_type state;
 
         public:
@@ -217,7 +332,7 @@ namespace pika::execution::experimental {
         struct async_rw_mutex_access_wrapper<void, void, async_rw_mutex_access_type::read>
         {
         private:
-            using shared_state_type = std::shared_ptr<async_rw_mutex_shared_state<void>>;
+            using shared_state_type = pika::intrusive_ptr<async_rw_mutex_shared_state<void>>;
             shared_state_type state;
 
         public:
@@ -237,7 +352,7 @@ namespace pika::execution::experimental {
         struct async_rw_mutex_access_wrapper<void, void, async_rw_mutex_access_type::readwrite>
         {
         private:
-            using shared_state_type = std::shared_ptr<async_rw_mutex_shared_state<void>>;
+            using shared_state_type = pika::intrusive_ptr<async_rw_mutex_shared_state<void>>;
             shared_state_type state;
 
         public:
@@ -251,6 +366,98 @@ namespace pika::execution::experimental {
             async_rw_mutex_access_wrapper(async_rw_mutex_access_wrapper const&) = delete;
             async_rw_mutex_access_wrapper& operator=(async_rw_mutex_access_wrapper const&) = delete;
         };
+
+        template <typename ReadWriteT, typename ReadT, async_rw_mutex_access_type AccessType>
+        struct async_rw_mutex_sender
+        {
+            using shared_state_ptr_type =
+                pika::intrusive_ptr<async_rw_mutex_shared_state<ReadWriteT>>;
+            shared_state_ptr_type state;
+
+            using access_type = async_rw_mutex_access_wrapper<ReadWriteT, ReadT, AccessType>;
+            template <template <typename...> class Tuple, template <typename...> class Variant>
+            using value_types = Variant<Tuple<access_type>>;
+
+            template <template <typename...> class Variant>
+            using error_types = Variant<std::exception_ptr>;
+
+            static constexpr bool sends_done = false;
+
+            using completion_signatures = pika::execution::experimental::completion_signatures<
+                pika::execution::experimental::set_value_t(access_type),
+                pika::execution::experimental::set_error_t(std::exception_ptr)>;
+
+            template <typename R>
+            struct operation_state : async_rw_mutex_waiter
+            {
+                std::decay_t<R> r;
+                shared_state_ptr_type state;
+
+                template <typename R_>
+                operation_state(R_&& r, shared_state_ptr_type state)
+                  : r(PIKA_FORWARD(R_, r))
+                  , state(PIKA_MOVE(state))
+                {
+                    this->resume = &operation_state::resume_impl;
+                }
+
+                operation_state(operation_state&&) = delete;
+                operation_state& operator=(operation_state&&) = delete;
+                operation_state(operation_state const&) = delete;
+                operation_state& operator=(operation_state const&) = delete;
+
+                static void resume_impl(async_rw_mutex_waiter* waiter) noexcept
+                {
+                    auto& os = *static_cast<operation_state*>(waiter);
+                    try
+                    {
+                        pika::execution::experimental::set_value(
+                            PIKA_MOVE(os.r), access_type{PIKA_MOVE(os.state)});
+                    }
+                    catch (...)
+                    {
+                        pika::execution::experimental::set_error(
+                            PIKA_MOVE(os.r), std::current_exception());
+                    }
+                }
+
+                friend void tag_invoke(
+                    pika::execution::experimental::start_t, operation_state& os) noexcept
+                {
+                    PIKA_ASSERT_MSG(os.state,
+                        "async_rw_lock::sender::operation_state state is empty, was the sender "
+                        "already started?");
+
+                    // If all accesses to the previous state have already been
+                    // released the receiver is signaled immediately, otherwise
+                    // it is signaled by the thread releasing the last access.
+                    // The operation state keeps the state alive until then.
+                    auto* state = os.state.get();
+                    state->add_waiter(&os);
+                }
+            };
+
+            template <typename R>
+            friend auto tag_invoke(
+                pika::execution::experimental::connect_t, async_rw_mutex_sender&& s, R&& r)
+            {
+                return operation_state<R>{PIKA_FORWARD(R, r), PIKA_MOVE(s.state)};
+            }
+
+            template <typename R>
+            friend auto tag_invoke(
+                pika::execution::experimental::connect_t, async_rw_mutex_sender const& s, R&& r)
+            {
+                if constexpr (AccessType == async_rw_mutex_access_type::readwrite)
+                {
+                    static_assert(sizeof(R) == 0,
+                        "senders returned from async_rw_mutex::readwrite are not l-lvalue "
+                        "connectable");
+                }
+
+                return operation_state<R>{PIKA_FORWARD(R, r), s.state};
+            }
+        };
     }    // namespace detail
 
     /// Read-write mutex where access is granted to a value through senders.
@@ -284,26 +491,32 @@ namespace pika::execution::experimental {
 
     // Implementation details:
     //
-    // The async_rw_mutex protects access to a given resource using two
-    // reference counted shared states, the current and the previous state. Each
-    // shared state guards access to the next stage; when the shared state goes
-    // out of scope it triggers continuations for the next stage.
+    // The async_rw_mutex protects access to a given resource using a chain of
+    // intrusively reference counted shared states. Each shared state guards
+    // access to the resource for one stage, i.e. one read-write access or a
+    // sequence of consecutive read-only accesses, and holds on to the shared
+    // state of the next stage. When the last reference to a shared state goes
+    // out of scope it moves the protected value to the next shared state and
+    // makes the next shared state ready.
     //
-    // When read-write access is required a sender is created which holds on to
-    // the newly created shared state for the read-write access and the previous
-    // state. When the sender is connected to a receiver, a callback is added to
-    // the previous shared state's destructor. The callback holds the new state,
-    // and passes a wrapper holding the shared state to set_value. Once the
-    // receiver which receives the wrapper has let the wrapper go out of scope
-    // (and all other references to the shared state are out of scope), the new
-    // shared state will again trigger its continuations.
+    // When access is required a sender is created which holds on to the
+    // shared state of its stage. When the sender is started, the operation
+    // state pushes itself onto the lock-free list of waiters of the shared
+    // state, or calls set_value immediately if the shared state is already
+    // ready. Making a shared state ready resumes all waiters, which pass a
+    // wrapper holding the shared state to set_value. Once the receiver which
+    // receives the wrapper has let the wrapper go out of scope (and all other
+    // references to the shared state are out of scope), the next shared state
+    // becomes ready. The async_rw_mutex itself only holds a reference to the
+    // shared state of the latest stage. Senders never refer to the shared
+    // state of the previous stage, so unstarted senders do not delay earlier
+    // accesses.
     //
-    // When read-only access is required and the previous access was read-only
-    // the procedure is the same as for read-write access. When read-only access
-    // follows a previous read-only access the shared state is reused between
-    // all consecutive read-only accesses, such that multiple read-only accesses
-    // can run concurrently, and the next access (which must be read-write) is
-    // triggered once all instances of that shared state have gone out of scope.
+    // When read-only access follows a previous read-only access the shared
+    // state is reused between all consecutive read-only accesses, such that
+    // multiple read-only accesses can run concurrently, and the next access
+    // (which must be read-write) is triggered once all instances of that
+    // shared state have gone out of scope.
     //
     // The protected value is moved from state to state and is released when the
     // last shared state is destroyed.
@@ -313,11 +526,10 @@ namespace pika::execution::experimental {
     {
     private:
         template <detail::async_rw_mutex_access_type AccessType>
-        struct sender;
+        using sender = detail::async_rw_mutex_sender<void, void, AccessType>;
 
         using shared_state_type = detail::async_rw_mutex_shared_state<void>;
-        using shared_state_ptr_type = std::shared_ptr<shared_state_type>;
-        using shared_state_weak_ptr_type = std::weak_ptr<shared_state_type>;
+        using shared_state_ptr_type = pika::intrusive_ptr<shared_state_type>;
 
     public:
         using read_type = void;
@@ -343,136 +555,46 @@ namespace pika::execution::experimental {
         {
             if (prev_access == detail::async_rw_mutex_access_type::readwrite)
             {
-                auto shared_prev_state = PIKA_MOVE(state);
-                state = std::allocate_shared<shared_state_type, allocator_type>(alloc);
+                next_state();
                 prev_access = detail::async_rw_mutex_access_type::read;
-
-                // Only the first access has no previous shared state. When
-                // there is a previous state we set the next state so that the
-                // value can be passed from the previous state to the next
-                // state.
-                if (PIKA_LIKELY(shared_prev_state))
-                {
-                    shared_prev_state->set_next_state(state);
-                    prev_state = shared_prev_state;
-                }
             }
 
-            return {prev_state, state};
+            return {state};
         }
 
         sender<detail::async_rw_mutex_access_type::readwrite> readwrite()
         {
-            auto shared_prev_state = PIKA_MOVE(state);
-            state = std::allocate_shared<shared_state_type, allocator_type>(alloc);
+            next_state();
             prev_access = detail::async_rw_mutex_access_type::readwrite;
 
-            // Only the first access has no previous shared state. When there is
-            // a previous state we set the next state so that the value can be
-            // passed from the previous state to the next state.
-            if (PIKA_LIKELY(shared_prev_state))
-            {
-                shared_prev_state->set_next_state(state);
-                prev_state = shared_prev_state;
-            }
-
-            return {prev_state, state};
+            return {state};
         }
 
     private:
-        template <detail::async_rw_mutex_access_type AccessType>
-        struct sender
+        void next_state()
         {
-            shared_state_weak_ptr_type prev_state;
-            shared_state_ptr_type state;
-
-            using access_type =
-                detail::async_rw_mutex_access_wrapper<readwrite_type, read_type, AccessType>;
-            template <template <typename...> class Tuple, template <typename...> class Variant>
-            using value_types = Variant<Tuple<access_type>>;
-
-            template <template <typename...> class Variant>
-            using error_types = Variant<std::exception_ptr>;
-
-            static constexpr bool sends_done = false;
-
-            using completion_signatures = pika::execution::experimental::completion_signatures<
-                pika::execution::experimental::set_value_t(access_type),
-                pika::execution::experimental::set_error_t(std::exception_ptr)>;
-
-            template <typename R>
-            struct operation_state
+            auto prev_state = PIKA_MOVE(state);
+            state = detail::make_async_rw_mutex_shared_state<shared_state_type>(alloc);
+
+            // Only the first access has no previous shared state. The first
+            // state is ready immediately. Otherwise the previous state makes
+            // the next state ready once all accesses to it have been released,
+            // which may be when prev_state goes out of scope here.
+            if (PIKA_LIKELY(prev_state))
             {
-                std::decay_t<R> r;
-                shared_state_weak_ptr_type prev_state;
-                shared_state_ptr_type state;
-
-                template <typename R_>
-                operation_state(
-                    R_&& r, shared_state_weak_ptr_type prev_state, shared_state_ptr_type state)
-                  : r(PIKA_FORWARD(R_, r))
-                  , prev_state(PIKA_MOVE(prev_state))
-                  , state(PIKA_MOVE(state))
-                {
-                }
-
-                operation_state(operation_state&&) = delete;
-                operation_state& operator=(operation_state&&) = delete;
-                operation_state(operation_state const&) = delete;
-                operation_state& operator=(operation_state const&) = delete;
-
-                friend void tag_invoke(
-                    pika::execution::experimental::start_t, operation_state& os) noexcept
-                {
-                    PIKA_ASSERT_MSG(os.state,
-                        "async_rw_lock::sender::operation_state state is empty, was the sender "
-                        "already started?");
-
-                    auto continuation = [r = PIKA_MOVE(os.r)](shared_state_ptr_type state) mutable {
-                        try
-                        {
-                            pika::execution::experimental::set_value(
-                                PIKA_MOVE(r), access_type{PIKA_MOVE(state)});
-                        }
-                        catch (...)
-                        {
-                            pika::execution::experimental::set_error(
-                                PIKA_MOVE(r), std::current_exception());
-                        }
-                    };
-
-                    if (auto p = os.prev_state.lock())
-                    {
-                        // If the previous state is set and it's still alive,
-                        // add a continuation to be triggered when the previous
-                        // state is released.
-                        p->add_continuation(PIKA_MOVE(continuation));
-                        os.prev_state.reset();
-                    }
-                    else
-                    {
-                        // There is no previous state on the first access or the
-                        // previous state has already been released. We can run
-                        // the continuation immediately.
-                        continuation(PIKA_MOVE(os.state));
-                    }
-                }
-            };
-
-            template <typename R>
-            friend auto tag_invoke(pika::execution::experimental::connect_t, sender&& s, R&& r)
+                prev_state->set_next_state(state);
+            }
+            else
             {
-                return operation_state<R>{
-                    PIKA_FORWARD(R, r), PIKA_MOVE(s.prev_state), PIKA_MOVE(s.state)};
+                state->set_ready();
             }
-        };
+        }
 
         PIKA_NO_UNIQUE_ADDRESS allocator_type alloc;
 
         detail::async_rw_mutex_access_type prev_access =
             detail::async_rw_mutex_access_type::readwrite;
 
-        shared_state_weak_ptr_type prev_state;
         shared_state_ptr_type state;
     };
 
@@ -487,9 +609,6 @@ namespace pika::execution::experimental {
             "Cannot mix void and non-void type in async_rw_mutex (ReadT is void, ReadWriteT is "
             "non-void)");
 
-        template <detail::async_rw_mutex_access_type AccessType>
-        struct sender;
-
     public:
         using read_type = std::decay_t<ReadT> const;
         using readwrite_type = std::decay_t<ReadWriteT>;
@@ -502,6 +621,14 @@ namespace pika::execution::experimental {
 
         using allocator_type = Allocator;
 
+    private:
+        template <detail::async_rw_mutex_access_type AccessType>
+        using sender = detail::async_rw_mutex_sender<readwrite_type, read_type, AccessType>;
+
+        using shared_state_type = detail::async_rw_mutex_shared_state<value_type>;
+        using shared_state_ptr_type = pika::intrusive_ptr<shared_state_type>;
+
+    public:
         async_rw_mutex() = delete;
         template <typename U,
             typename = std::enable_if_t<!std::is_same<std::decay_t<U>, async_rw_mutex>::value>>
@@ -519,156 +646,43 @@ namespace pika::execution::experimental {
         {
             if (prev_access == detail::async_rw_mutex_access_type::readwrite)
             {
-                auto shared_prev_state = PIKA_MOVE(state);
-                state = std::allocate_shared<shared_state_type, allocator_type>(alloc);
+                next_state();
                 prev_access = detail::async_rw_mutex_access_type::read;
-
-                // Only the first access has no previous shared state. When
-                // there is a previous state we set the next state so that the
-                // value can be passed from the previous state to the next
-                // state. When there is no previous state we need to move the
-                // value to the first state.
-                if (PIKA_LIKELY(shared_prev_state))
-                {
-                    shared_prev_state->set_next_state(state);
-                    prev_state = shared_prev_state;
-                }
-                else
-                {
-                    state->set_value(PIKA_MOVE(value));
-                }
             }
 
-            return {prev_state, state};
+            return {state};
         }
 
         sender<detail::async_rw_mutex_access_type::readwrite> readwrite()
         {
-            auto shared_prev_state = PIKA_MOVE(state);
-            state = std::allocate_shared<shared_state_type, allocator_type>(alloc);
+            next_state();
             prev_access = detail::async_rw_mutex_access_type::readwrite;
 
-            // Only the first access has no previous shared state. When there is
-            // a previous state we set the next state so that the value can be
-            // passed from the previous state to the next state. When there is
-            // no previous state we need to move the value to the first state.
-            if (PIKA_LIKELY(shared_prev_state))
-            {
-                shared_prev_state->set_next_state(state);
-                prev_state = shared_prev_state;
-            }
-            else
-            {
-                state->set_value(PIKA_MOVE(value));
-            }
-
-            return {prev_state, state};
+            return {state};
         }
 
     private:
-        using shared_state_type = detail::async_rw_mutex_shared_state<value_type>;
-        using shared_state_ptr_type = std::shared_ptr<shared_state_type>;
-        using shared_state_weak_ptr_type = std::weak_ptr<shared_state_type>;
-
-        template <detail::async_rw_mutex_access_type AccessType>
-        struct sender
+        void next_state()
         {
-            shared_state_weak_ptr_type prev_state;
-            shared_state_ptr_type state;
-
-            using access_type =
-                detail::async_rw_mutex_access_wrapper<readwrite_type, read_type, AccessType>;
-            template <template <typename...> class Tuple, template <typename...> class Variant>
-            using value_types = Variant<Tuple<access_type>>;
-
-            template <template <typename...> class Variant>
-            using error_types = Variant<std::exception_ptr>;
-
-            static constexpr bool sends_done = false;
-
-            using completion_signatures = pika::execution::experimental::completion_signatures<
-                pika::execution::experimental::set_value_t(access_type),
-                pika::execution::experimental::set_error_t(std::exception_ptr)>;
-
-            template <typename R>
-            struct operation_state
-            {
-                std::decay_t<R> r;
-                shared_state_weak_ptr_type prev_state;
-                shared_state_ptr_type state;
-
-                template <typename R_>
-                operation_state(
-                    R_&& r, shared_state_weak_ptr_type prev_state, shared_state_ptr_type state)
-                  : r(PIKA_FORWARD(R_, r))
-                  , prev_state(PIKA_MOVE(prev_state))
-                  , state(PIKA_MOVE(state))
-                {
-                }
-
-                operation_state(operation_state&&) = delete;
-                operation_state& operator=(operation_state&&) = delete;
-                operation_state(operation_state const&) = delete;
-                operation_state& operator=(operation_state const&) = delete;
-
-                friend void tag_invoke(
-                    pika::execution::experimental::start_t, operation_state& os) noexcept
-                {
-                    PIKA_ASSERT_MSG(os.state,
-                        "async_rw_lock::sender::operation_state state is empty, was the sender "
-                        "already started?");
-
-                    auto continuation = [r = PIKA_MOVE(os.r)](shared_state_ptr_type state) mutable {
-                        try
-                        {
-                            pika::execution::experimental::set_value(
-                                PIKA_MOVE(r), access_type{PIKA_MOVE(state)});
-                        }
-                        catch (...)
-                        {
-                            pika::execution::experimental::set_error(
-                                PIKA_MOVE(r), std::current_exception());
-                        }
-                    };
-
-                    if (auto p = os.prev_state.lock())
-                    {
-                        // If the previous state is set and it's still alive,
-                        // add a continuation to be triggered when the previous
-                        // state is released.
-                        p->add_continuation(PIKA_MOVE(continuation));
-                        os.prev_state.reset();
-                    }
-                    else
-                    {
-                        // There is no previous state on the first access or the
-                        // previous state has already been released. We can run
-                        // the continuation immediately.
-                        continuation(PIKA_MOVE(os.state));
-                    }
-                }
-            };
-
-            template <typename R>
-            friend auto tag_invoke(pika::execution::experimental::connect_t, sender&& s, R&& r)
+            auto prev_state = PIKA_MOVE(state);
+            state = detail::make_async_rw_mutex_shared_state<shared_state_type>(alloc);
+
+            // Only the first access has no previous shared state. When there
+            // is a previous state it passes the value to the next state and
+            // makes it ready once all accesses to it have been released, which
+            // may be when prev_state goes out of scope here. When there is no
+            // previous state we need to move the value to the first state,
+            // which is ready immediately.
+            if (PIKA_LIKELY(prev_state))
             {
-                return operation_state<R>{
-                    PIKA_FORWARD(R, r), PIKA_MOVE(s.prev_state), PIKA_MOVE(s.state)};
+                prev_state->set_next_state(state);
             }
-
-            template <typename R>
-            friend auto tag_invoke(pika::execution::experimental::connect_t, sender const& s, R&& r)
+            else
             {
-                if constexpr (AccessType == detail::async_rw_mutex_access_type::readwrite)
-                {
-                    static_assert(sizeof(R) == 0,
-                        "senders returned from async_rw_mutex::readwrite are not l-lvalue "
-                        "connectable");
-                }
-
-                return operation_state<R>{PIKA_FORWARD(R, r), s.prev_state, s.state};
+                state->set_value(PIKA_MOVE(value));
+                state->set_ready();
             }
-        };
+        }
 
         PIKA_NO_UNIQUE_ADDRESS value_type value;
         PIKA_NO_UNIQUE_ADDRESS allocator_type alloc;
@@ -676,7 +690,6 @@ namespace pika::execution::experimental {
         detail::async_rw_mutex_access_type prev_access =
             detail::async_rw_mutex_access_type::readwrite;
 
-        shared_state_weak_ptr_type prev_state;
         shared_state_ptr_type state;
     };
 }    // namespace pika::execution::experimental
@@ -13,8 +13,10 @@
 #include <pika/modules/concurrency.hpp>
 #include <pika/modules/errors.hpp>
 #include <pika/modules/thread_support.hpp>
+#include <pika/synchronization/condition_variable.hpp>
 #include <pika/synchronization/spinlock.hpp>
 
+#include <atomic>
 #include <cstddef>
 #include <memory>
 #include <mutex>
@@ -26,191 +28,365 @@ namespace pika::experimental {
     // A simple but very high performance implementation of the channel concept.
     // This channel is bounded to a size given at construction time and supports
     // multiple producers and multiple consumers. The data is stored in a
-    // ring-buffer.
+    // ring-buffer in which every slot carries a sequence number. This allows
+    // producers and consumers to claim slots with a single compare-and-swap on
+    // the tail or head position instead of taking a lock (see
+    // https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue).
+    //
+    // get and set never block and return false if the channel is empty, full,
+    // or closed. get_blocking and set_blocking suspend the calling thread until
+    // an element or a free slot is available, or until the channel is closed.
+    // The Mutex is used only to put such threads to sleep, it is never locked
+    // by get and set unless some thread is blocked on the channel.
     template <typename T, typename Mutex = pika::concurrency::detail::spinlock>
     class bounded_channel
     {
     private:
         using mutex_type = Mutex;
 
-        bool is_full(std::size_t tail) const noexcept
+        // The producer that claimed position pos may write to the slot once
+        // its sequence number is pos, the consumer that claimed position pos
+        // may read from the slot once its sequence number is pos + 1.
+        struct slot
         {
-            std::size_t numitems = size_ + tail - head_.data_;
-            if (numitems < size_)
+            std::atomic<std::size_t> sequence_;
+            T data_;
+        };
+
+        // Claims up to n consecutive slots, starting at position pos, whose
+        // sequence numbers are their position plus offset. Returns the first
+        // claimed position and the number of claimed slots.
+        std::pair<std::size_t, std::size_t> claim(
+            std::atomic<std::size_t>& pos, std::size_t offset, std::size_t n) const noexcept
+        {
+            std::size_t first = pos.load(std::memory_order_relaxed);
+            while (true)
+            {
+                std::size_t count = 0;
+                std::ptrdiff_t diff = 0;
+                for (/**/; count != n; ++count)
+                {
+                    std::size_t const sequence =
+                        buffer_[(first + count) % size_].sequence_.load(std::memory_order_acquire);
+                    diff = static_cast<std::ptrdiff_t>(sequence - (first + count + offset));
+                    if (diff != 0)
+                    {
+                        break;
+                    }
+                }
+
+                if (count == 0)
+                {
+                    // the channel is full (or empty)
+                    if (diff < 0)
+                    {
+                        return {first, 0};
+                    }
+
+                    // another thread has claimed the slot in the meantime
+                    first = pos.load(std::memory_order_relaxed);
+                }
+                else if (pos.compare_exchange_weak(
+                             first, first + count, std::memory_order_relaxed))
+                {
+                    return {first, count};
+                }
+            }
+        }
+
+        std::size_t get_n_impl(T* vals, std::size_t n) const noexcept
+        {
+            if (closed_.load(std::memory_order_relaxed))
+            {
+                return 0;
+            }
+
+            if (vals == nullptr)
+            {
+                std::size_t const head = head_.data_.load(std::memory_order_relaxed);
+                return buffer_[head % size_].sequence_.load(std::memory_order_acquire) ==
+                    head + 1;
+            }
+
+            auto const [first, count] = claim(head_.data_, 1, n);
+            for (std::size_t i = 0; i != count; ++i)
+            {
+                slot& s = buffer_[(first + i) % size_];
+                vals[i] = PIKA_MOVE(s.data_);
+                s.sequence_.store(first + i + size_, std::memory_order_release);
+            }
+            return count;
+        }
+
+        std::size_t set_n_impl(T* vals, std::size_t n) noexcept
+        {
+            if (closed_.load(std::memory_order_relaxed))
+            {
+                return 0;
+            }
+
+            auto const [first, count] = claim(tail_.data_, 0, n);
+            for (std::size_t i = 0; i != count; ++i)
+            {
+                slot& s = buffer_[(first + i) % size_];
+                s.data_ = PIKA_MOVE(vals[i]);
+                s.sequence_.store(first + i + 1, std::memory_order_release);
+            }
+            return count;
+        }
+
+        // Wake up threads blocked in get_blocking or set_blocking after count
+        // elements or slots have been made available. The fence orders the
+        // preceding sequence number update before reading the number of
+        // waiting threads, a waiting thread registers itself before checking
+        // the channel again (see wait).
+        void notify(pika::condition_variable& cond, std::atomic<std::size_t> const& waiting,
+            std::size_t count) const noexcept
+        {
+            if (count == 0)
+            {
+                return;
+            }
+
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (waiting.load(std::memory_order_relaxed) == 0)
+            {
+                return;
+            }
+
+            // A waiting thread holds the lock from checking the channel until
+            // it is queued on the condition variable, so it has either seen
+            // the update or is queued once the lock has been acquired here.
+            // The threads are woken up after releasing the lock as resuming a
+            // thread may yield.
+            {
+                std::lock_guard<mutex_type> l(wait_.data_.mtx_);
+            }
+            if (count == 1)
+            {
+                cond.notify_one();
+            }
+            else
             {
-                return numitems == size_ - 1;
+                cond.notify_all();
             }
-            return numitems - size_ == size_ - 1;
         }
 
-        bool is_empty(std::size_t head) const noexcept
+        template <typename F>
+        bool wait(pika::condition_variable& cond, std::atomic<std::size_t>& waiting, F&& f) const
         {
-            return head == tail_.data_;
+            std::unique_lock<mutex_type> l(wait_.data_.mtx_);
+            waiting.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            bool result = false;
+            while (!(result = f()) && !closed_.load(std::memory_order_relaxed))
+            {
+                cond.wait(l);
+            }
+
+            waiting.fetch_sub(1, std::memory_order_relaxed);
+            return result;
         }
 
     public:
         explicit bounded_channel(std::size_t size)
-          : size_(size + 1)
-          , buffer_(new T[size + 1])
+          : size_(size)
+          , buffer_(new slot[size])
           , closed_(false)
         {
             PIKA_ASSERT(size != 0);
 
-            // invoke constructors for allocated buffer
             for (std::size_t i = 0; i != size_; ++i)
             {
-                new (&buffer_[i]) T();
+                buffer_[i].sequence_.store(i, std::memory_order_relaxed);
             }
 
-            head_.data_ = 0;
-            tail_.data_ = 0;
+            head_.data_.store(0, std::memory_order_relaxed);
+            tail_.data_.store(0, std::memory_order_relaxed);
         }
 
         bounded_channel(bounded_channel&& rhs) noexcept
-          : head_(rhs.head_)
-          , tail_(rhs.tail_)
-          , size_(rhs.size_)
+          : size_(rhs.size_)
           , buffer_(PIKA_MOVE(rhs.buffer_))
-          , closed_(rhs.closed_)
         {
+            head_.data_.store(
+                rhs.head_.data_.load(std::memory_order_acquire), std::memory_order_relaxed);
+            tail_.data_.store(
+                rhs.tail_.data_.load(std::memory_order_acquire), std::memory_order_relaxed);
+
+            closed_.store(rhs.closed_.load(std::memory_order_acquire), std::memory_order_relaxed);
             rhs.size_ = 0;
-            rhs.closed_ = true;
+            rhs.closed_.store(true, std::memory_order_release);
         }
 
         bounded_channel& operator=(bounded_channel&& rhs) noexcept
         {
-            head_ = rhs.head_;
-            tail_ = rhs.tail_;
+            head_.data_.store(
+                rhs.head_.data_.load(std::memory_order_acquire), std::memory_order_relaxed);
+            tail_.data_.store(
+                rhs.tail_.data_.load(std::memory_order_acquire), std::memory_order_relaxed);
+
             size_ = rhs.size_;
             buffer_ = PIKA_MOVE(rhs.buffer_);
-            closed_ = rhs.closed_;
-            rhs.closed_ = true;
+
+            closed_.store(rhs.closed_.load(std::memory_order_acquire), std::memory_order_relaxed);
+            rhs.size_ = 0;
+            rhs.closed_.store(true, std::memory_order_release);
+
             return *this;
         }
 
         ~bounded_channel()
         {
-            std::unique_lock<mutex_type> l(mtx_.data_);
-
-            // invoke destructors for allocated buffer
-            for (std::size_t i = 0; i != size_; ++i)
+            if (!closed_.load(std::memory_order_relaxed))
             {
-                (&buffer_[i])->~T();
-            }
-
-            if (!closed_)
-            {
-                close(l);
+                close();
             }
         }
 
         bool get(T* val = nullptr) const noexcept
         {
-            std::unique_lock<mutex_type> l(mtx_.data_);
-            if (closed_)
+            if (get_n_impl(val, 1) == 0)
             {
                 return false;
             }
 
-            std::size_t head = head_.data_;
+            if (val != nullptr)
+            {
+                notify(wait_.data_.not_full_, wait_.data_.waiting_producers_, 1);
+            }
+            return true;
+        }
 
-            if (is_empty(head))
+        bool set(T&& t) noexcept
+        {
+            if (set_n_impl(&t, 1) == 0)
             {
                 return false;
             }
 
-            if (val == nullptr)
+            notify(wait_.data_.not_empty_, wait_.data_.waiting_consumers_, 1);
+            return true;
+        }
+
+        // Retrieve up to n elements from the channel, returns the number of
+        // retrieved elements
+        std::size_t get_n(T* vals, std::size_t n) const noexcept
+        {
+            PIKA_ASSERT(vals != nullptr);
+
+            std::size_t const count = get_n_impl(vals, n);
+            notify(wait_.data_.not_full_, wait_.data_.waiting_producers_, count);
+            return count;
+        }
+
+        // Store up to n elements in the channel, returns the number of
+        // elements that have been moved into the channel
+        std::size_t set_n(T* vals, std::size_t n) noexcept
+        {
+            std::size_t const count = set_n_impl(vals, n);
+            notify(wait_.data_.not_empty_, wait_.data_.waiting_consumers_, count);
+            return count;
+        }
+
+        // Same as get, but suspends the calling thread while the channel is
+        // empty. Returns false only if the channel has been closed.
+        bool get_blocking(T* val = nullptr) const
+        {
+            if (get(val))
             {
                 return true;
             }
 
-            *val = PIKA_MOVE(buffer_[head]);
-            if (++head >= size_)
+            if (!wait(wait_.data_.not_empty_, wait_.data_.waiting_consumers_,
+                    [&] { return get_n_impl(val, 1) != 0; }))
             {
-                head = 0;
+                return false;
             }
-            head_.data_ = head;
 
+            if (val != nullptr)
+            {
+                notify(wait_.data_.not_full_, wait_.data_.waiting_producers_, 1);
+            }
             return true;
         }
 
-        bool set(T&& t) noexcept
+        // Same as set, but suspends the calling thread while the channel is
+        // full. Returns false only if the channel has been closed.
+        bool set_blocking(T&& t)
         {
-            std::unique_lock<mutex_type> l(mtx_.data_);
-            if (closed_)
+            if (set(PIKA_MOVE(t)))
             {
-                return false;
+                return true;
             }
 
-            std::size_t tail = tail_.data_;
-
-            if (is_full(tail))
+            if (!wait(wait_.data_.not_full_, wait_.data_.waiting_producers_,
+                    [&] { return set_n_impl(&t, 1) != 0; }))
             {
                 return false;
             }
 
-            buffer_[tail] = PIKA_MOVE(t);
-            if (++tail >= size_)
-            {
-                tail = 0;
-            }
-            tail_.data_ = tail;
-
+            notify(wait_.data_.not_empty_, wait_.data_.waiting_consumers_, 1);
             return true;
         }
 
         std::size_t close()
         {
-            std::unique_lock<mutex_type> l(mtx_.data_);
-            return close(l);
-        }
-
-        std::size_t capacity() const
-        {
-            return size_ - 1;
-        }
-
-    protected:
-        std::size_t close(std::unique_lock<mutex_type>& l)
-        {
-            PIKA_ASSERT_OWNS_LOCK(l);
-
-            if (closed_)
+            bool expected = false;
+            if (!closed_.compare_exchange_strong(expected, true))
             {
-                l.unlock();
                 PIKA_THROW_EXCEPTION(pika::error::invalid_status,
                     "pika::experimental::bounded_channel::close",
                     "attempting to close an already closed channel");
             }
 
-            closed_ = true;
+            // wake up all blocked threads, they will observe the closed flag
+            {
+                std::lock_guard<mutex_type> l(wait_.data_.mtx_);
+            }
+            wait_.data_.not_empty_.notify_all();
+            wait_.data_.not_full_.notify_all();
+
             return 0;
         }
 
+        std::size_t capacity() const
+        {
+            return size_;
+        }
+
     private:
-        // keep the mutex, the head, and the tail pointer in separate cache
-        // lines
-        mutable pika::concurrency::detail::cache_aligned_data<mutex_type> mtx_;
-        mutable pika::concurrency::detail::cache_aligned_data<std::size_t> head_;
-        pika::concurrency::detail::cache_aligned_data<std::size_t> tail_;
+        // state needed only for suspending threads in get_blocking and
+        // set_blocking
+        struct wait_data
+        {
+            mutex_type mtx_;
+            pika::condition_variable not_empty_;
+            pika::condition_variable not_full_;
+            std::atomic<std::size_t> waiting_consumers_{0};
+            std::atomic<std::size_t> waiting_producers_{0};
+        };
+
+        // keep the head, the tail, and the wait data in separate cache lines
+        mutable pika::concurrency::detail::cache_aligned_data<std::atomic<std::size_t>> head_;
+        pika::concurrency::detail::cache_aligned_data<std::atomic<std::size_t>> tail_;
+        mutable pika::concurrency::detail::cache_aligned_data<wait_data> wait_;
 
-        // a channel of size n can buffer n-1 items
         std::size_t size_;
 
         // channel buffer
-        std::unique_ptr<T[]> buffer_;
+        std::unique_ptr<slot[]> buffer_;
 
         // this channel was closed, i.e. no further operations are possible
-        bool closed_;
+        std::atomic<bool> closed_;
     };
 
     ////////////////////////////////////////////////////////////////////////////
-    // For use with pika threads, the channel_mpmc defined here is the fastest
-    // (even faster than the channel_spsc). Using
-    // pika::concurrency::detail::spinlock as the means of synchronization
-    // enables the use of this channel with non-pika threads, however the
-    // performance degrades by a factor of ten compared to using
-    // pika::spinlock.
+    // Using pika::spinlock as the means of synchronization for blocked threads
+    // is the fastest option for use with pika threads. Using
+    // pika::concurrency::detail::spinlock enables the use of the blocking
+    // operations with non-pika threads.
     template <typename T>
     using channel_mpmc = bounded_channel<T, pika::spinlock>;
 
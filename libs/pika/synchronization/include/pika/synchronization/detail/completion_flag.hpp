@@ -0,0 +1,83 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+#include <pika/execution_base/agent_ref.hpp>
+
+#include <atomic>
+#include <cstdint>
+#if !defined(__linux__)
+# include <condition_variable>
+# include <mutex>
+#endif
+
+#if defined(PIKA_MSVC_WARNING_PRAGMA)
+# pragma warning(push)
+# pragma warning(disable : 4251)
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+namespace pika::detail {
+
+    /// A one-shot flag that can be waited for by a single thread and set by
+    /// any other thread. The flag is meant for signalling the completion of a
+    /// single operation, e.g. in sync_wait. Unlike a condition_variable it
+    /// does not take a lock on either side. The waiter first spins for a
+    /// bounded number of iterations. If the flag is still not set a pika
+    /// thread suspends itself and is resumed by set, while an OS thread
+    /// blocks in the kernel (using a futex on Linux, a condition variable
+    /// elsewhere) until woken by set.
+    class completion_flag
+    {
+    public:
+        completion_flag() = default;
+
+        completion_flag(completion_flag const&) = delete;
+        completion_flag(completion_flag&&) = delete;
+        completion_flag& operator=(completion_flag const&) = delete;
+        completion_flag& operator=(completion_flag&&) = delete;
+
+        bool is_set() const noexcept
+        {
+            return state_.load(std::memory_order_acquire) == state_set;
+        }
+
+        /// Sets the flag and wakes up the waiting thread, if any. Memory
+        /// operations before the call to set happen before wait returns.
+        /// set does not access the flag after marking it as set, so the
+        /// waiter may destroy the flag as soon as wait returns.
+        PIKA_EXPORT void set() noexcept;
+
+        /// Blocks until the flag is set. At most one thread may wait for the
+        /// flag. wait only returns once set has finished waking up the
+        /// waiter, also if the waiter is resumed spuriously.
+        PIKA_EXPORT void wait() noexcept;
+
+    private:
+        void wait_agent() noexcept;
+        void wait_os_thread() noexcept;
+
+        static constexpr std::uint32_t state_empty = 0;
+        static constexpr std::uint32_t state_set = 1;
+        static constexpr std::uint32_t state_waiting_agent = 2;
+        static constexpr std::uint32_t state_waiting_os_thread = 3;
+        // set is waking up the waiter and still accesses the flag
+        static constexpr std::uint32_t state_waking = 4;
+
+        std::atomic<std::uint32_t> state_{state_empty};
+        pika::execution::detail::agent_ref waiter_;
+#if !defined(__linux__)
+        std::mutex mtx_;
+        std::condition_variable cond_;
+#endif
+    };
+}    // namespace pika::detail
+
+#if defined(PIKA_MSVC_WARNING_PRAGMA)
+# pragma warning(pop)
+#endif
@@ -17,8 +17,20 @@
 #include <pika/threading_base/threading_base_fwd.hpp>
 #include <pika/timing/steady_clock.hpp>
 
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
 namespace pika {
     ///////////////////////////////////////////////////////////////////////////
+    // The state of the mutex is kept in a single atomic word so that locking
+    // and unlocking an uncontended mutex is a single compare-exchange. A
+    // thread that finds the mutex locked spins for a while, where the number
+    // of iterations adapts to how long the mutex is typically held, before
+    // suspending on the waiter list. A waiter that is woken up but loses the
+    // mutex to another thread marks the mutex as starving, in which case the
+    // next unlock hands the mutex directly to a waiter instead of releasing
+    // it.
     class mutex
     {
     public:
@@ -27,6 +39,15 @@ namespace pika {
     protected:
         using mutex_type = pika::spinlock;
 
+        // The bits of state_
+        static constexpr std::uint32_t state_locked = 0x1;
+        // There may be threads suspended on cond_
+        static constexpr std::uint32_t state_waiters = 0x2;
+        // A woken up waiter failed to acquire the mutex
+        static constexpr std::uint32_t state_starving = 0x4;
+        // The mutex has been handed to a woken up waiter and is still locked
+        static constexpr std::uint32_t state_handoff = 0x8;
+
     public:
         PIKA_EXPORT mutex(char const* const description = "");
 
@@ -49,8 +70,18 @@ namespace pika {
         PIKA_EXPORT void unlock(error_code& ec = throws);
 
     protected:
+        bool try_lock_fast(void* self_id) noexcept;
+        bool try_lock_spin(void* self_id) noexcept;
+        bool try_acquire_waiting(std::unique_lock<mutex_type>& l, void* self_id, bool woken);
+        void unlock_slow(error_code& ec);
+
+        std::atomic<std::uint32_t> state_;
+        std::atomic<std::uint32_t> spin_limit_;
+        std::atomic<void*> owner_id_;
+
+        // Protects the waiter list in cond_ and all modifications of the
+        // state_waiters, state_starving, and state_handoff bits
         mutable mutex_type mtx_;
-        threads::detail::thread_id_type owner_id_;
         pika::detail::condition_variable cond_;
     };
 
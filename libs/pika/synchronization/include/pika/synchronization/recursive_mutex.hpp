@@ -14,7 +14,7 @@
 #include <pika/assert.hpp>
 #include <pika/execution_base/agent_ref.hpp>
 #include <pika/execution_base/this_thread.hpp>
-#include <pika/synchronization/spinlock.hpp>
+#include <pika/synchronization/mutex.hpp>
 
 #include <atomic>
 #include <cstddef>
@@ -24,20 +24,27 @@
 namespace pika::detail {
     /// An exclusive-ownership recursive mutex which implements Boost.Thread's
     /// TimedLockable concept.
-    template <typename Mutex = pika::spinlock>
+    ///
+    /// Recursive acquisitions only compare the locking context and increment
+    /// the recursion count. The first acquisition locks the underlying
+    /// \a Mutex, which for the default \a pika::mutex is a single
+    /// compare-exchange when the mutex is not contended.
+    template <typename Mutex = pika::mutex>
     struct recursive_mutex_impl
     {
     public:
         PIKA_NON_COPYABLE(recursive_mutex_impl);
 
     private:
-        std::atomic<std::uint64_t> recursion_count;
+        // Only accessed by the thread owning the mutex
+        std::uint64_t recursion_count;
         std::atomic<pika::execution::detail::agent_ref> locking_context;
         Mutex mtx;
 
     public:
         recursive_mutex_impl(char const* const desc = "recursive_mutex_impl")
           : recursion_count(0)
+          , locking_context(pika::execution::detail::agent_ref())
           , mtx(desc)
         {
         }
@@ -71,10 +78,10 @@ namespace pika::detail {
             if (!try_recursive_lock(ctx))
             {
                 mtx.lock();
-                locking_context.exchange(ctx);
+                locking_context.store(ctx, std::memory_order_relaxed);
                 util::ignore_lock(&mtx);
                 util::register_lock(this);
-                recursion_count.store(1);
+                recursion_count = 1;
             }
         }
 
@@ -87,7 +94,8 @@ namespace pika::detail {
         {
             if (0 == --recursion_count)
             {
-                locking_context.exchange(pika::execution::detail::agent_ref());
+                locking_context.store(
+                    pika::execution::detail::agent_ref(), std::memory_order_relaxed);
                 util::unregister_lock(this);
                 util::reset_ignored(&mtx);
                 mtx.unlock();
@@ -97,7 +105,9 @@ namespace pika::detail {
     private:
         bool try_recursive_lock(pika::execution::detail::agent_ref current_context)
         {
-            if (locking_context.load(std::memory_order_acquire) == current_context)
+            // Only the owning thread can find its own context here, the
+            // context is only written while holding mtx
+            if (locking_context.load(std::memory_order_relaxed) == current_context)
             {
                 if (++recursion_count == 1)
                     util::register_lock(this);
@@ -110,13 +120,17 @@ namespace pika::detail {
         {
             if (mtx.try_lock())
             {
-                locking_context.exchange(current_context);
+                locking_context.store(current_context, std::memory_order_relaxed);
                 util::ignore_lock(&mtx);
                 util::register_lock(this);
-                recursion_count.store(1);
+                recursion_count = 1;
                 return true;
             }
             return false;
         }
     };
 }    // namespace pika::detail
+
+namespace pika {
+    using recursive_mutex = detail::recursive_mutex_impl<>;
+}    // namespace pika
@@ -175,6 +175,9 @@ namespace pika {
 
     }    // namespace detail
 
+    template <typename Callback>
+    class stop_callback;
+
     ///////////////////////////////////////////////////////////////////////////
     //
     // 32.3.3, class stop_token
@@ -188,6 +191,12 @@ namespace pika {
     class stop_token
     {
     public:
+        // The type of the stop callback that can be registered with a
+        // stop_token, used by sender operation states to react to stop
+        // requests
+        template <typename Callback>
+        using callback_type = stop_callback<Callback>;
+
         // 32.3.3.1 constructors, copy, and assignment
 
         // Postconditions: stop_possible() is false and stop_requested() is
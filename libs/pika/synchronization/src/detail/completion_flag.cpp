@@ -0,0 +1,159 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#include <pika/assert.hpp>
+#include <pika/execution_base/agent_ref.hpp>
+#include <pika/execution_base/this_thread.hpp>
+#include <pika/synchronization/detail/completion_flag.hpp>
+#include <pika/threading_base/thread_data.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__linux__)
+# include <linux/futex.h>
+# include <sys/syscall.h>
+# include <unistd.h>
+#else
+# include <mutex>
+#endif
+
+namespace pika::detail {
+    namespace {
+        // Number of iterations spent spinning on the flag before suspending
+        // or blocking. yield_k pauses for iterations 4 to 15 and yields after
+        // that. pika threads only spin briefly before suspending since
+        // yielding costs as much as suspending. OS threads also yield for 16
+        // iterations, which lets the thread setting the flag run when it
+        // shares a core with the waiter.
+        constexpr std::size_t agent_spin_limit = 8;
+        constexpr std::size_t os_thread_spin_limit = 32;
+
+#if defined(__linux__)
+        static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+
+        std::uint32_t* futex_address(std::atomic<std::uint32_t>& state) noexcept
+        {
+            return reinterpret_cast<std::uint32_t*>(&state);
+        }
+#endif
+    }    // namespace
+
+    void completion_flag::set() noexcept
+    {
+        std::uint32_t expected = state_empty;
+        if (state_.compare_exchange_strong(
+                expected, state_set, std::memory_order_release, std::memory_order_acquire))
+        {
+            // Nobody is waiting yet
+            return;
+        }
+
+        // A thread is waiting. It does not return before the state is
+        // state_set, so the flag stays alive until the last store below.
+        if (expected == state_waiting_agent)
+        {
+            state_.store(state_waking, std::memory_order_relaxed);
+            waiter_.resume("pika::detail::completion_flag::set");
+            state_.store(state_set, std::memory_order_release);
+        }
+        else
+        {
+            PIKA_ASSERT(expected == state_waiting_os_thread);
+#if defined(__linux__)
+            state_.store(state_waking, std::memory_order_relaxed);
+            syscall(SYS_futex, futex_address(state_), FUTEX_WAKE_PRIVATE, 1, nullptr, nullptr, 0);
+            state_.store(state_set, std::memory_order_release);
+#else
+            // The waiter returns only after acquiring mtx_, i.e. after the
+            // lock below has been released
+            std::lock_guard<std::mutex> l(mtx_);
+            state_.store(state_set, std::memory_order_release);
+            cond_.notify_one();
+#endif
+        }
+    }
+
+    void completion_flag::wait() noexcept
+    {
+        bool const is_agent = threads::detail::get_self_id() != threads::detail::invalid_thread_id;
+        std::size_t const spin_limit = is_agent ? agent_spin_limit : os_thread_spin_limit;
+        for (std::size_t k = 0; k != spin_limit; ++k)
+        {
+            if (is_set())
+            {
+                return;
+            }
+            pika::execution::this_thread::detail::yield_k(k, "pika::detail::completion_flag::wait");
+        }
+
+        if (is_agent)
+        {
+            wait_agent();
+        }
+        else
+        {
+            wait_os_thread();
+        }
+    }
+
+    void completion_flag::wait_agent() noexcept
+    {
+        waiter_ = pika::execution::this_thread::detail::agent();
+
+        std::uint32_t expected = state_empty;
+        if (!state_.compare_exchange_strong(expected, state_waiting_agent,
+                std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            // The flag was set in the meantime
+            return;
+        }
+
+        // Suspend again if the agent is resumed before set has started to
+        // wake it up. Resuming the agent before it has suspended is safe as
+        // the resume waits for the suspension to complete.
+        while (state_.load(std::memory_order_acquire) == state_waiting_agent)
+        {
+            waiter_.suspend("pika::detail::completion_flag::wait");
+        }
+
+        // set may still be resuming the agent, wait until it is done
+        for (std::size_t k = 0; !is_set(); ++k)
+        {
+            pika::execution::this_thread::detail::yield_k(k, "pika::detail::completion_flag::wait");
+        }
+    }
+
+    void completion_flag::wait_os_thread() noexcept
+    {
+        std::uint32_t expected = state_empty;
+        if (!state_.compare_exchange_strong(expected, state_waiting_os_thread,
+                std::memory_order_acq_rel, std::memory_order_acquire))
+        {
+            // The flag was set in the meantime
+            return;
+        }
+
+#if defined(__linux__)
+        while (state_.load(std::memory_order_acquire) == state_waiting_os_thread)
+        {
+            syscall(SYS_futex, futex_address(state_), FUTEX_WAIT_PRIVATE, state_waiting_os_thread,
+                nullptr, nullptr, 0);
+        }
+
+        // set may still be waking up the thread, wait until it is done
+        for (std::size_t k = 0; !is_set(); ++k)
+        {
+            pika::execution::this_thread::detail::yield_k(k, "pika::detail::completion_flag::wait");
+        }
+#else
+        std::unique_lock<std::mutex> l(mtx_);
+        cond_.wait(l, [this]() { return is_set(); });
+#endif
+    }
+}    // namespace pika::detail
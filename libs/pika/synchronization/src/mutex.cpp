@@ -18,13 +18,36 @@
 #include <pika/timing/steady_clock.hpp>
 #include <pika/type_support/unused.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
 #include <mutex>
 #include <utility>
 
 namespace pika {
+    namespace {
+        // Bounds of the number of iterations spent spinning on a locked mutex
+        // before suspending
+        constexpr std::uint32_t min_spin_limit = 8;
+        constexpr std::uint32_t max_spin_limit = 256;
+
+        // Move the spin limit an eighth of the way towards the number of
+        // iterations it took to acquire the mutex
+        std::uint32_t update_spin_limit(std::uint32_t spin_limit, std::uint32_t spins) noexcept
+        {
+            std::int64_t const updated = static_cast<std::int64_t>(spin_limit) +
+                (static_cast<std::int64_t>(spins) - static_cast<std::int64_t>(spin_limit)) / 8;
+            return static_cast<std::uint32_t>((std::clamp)(updated,
+                static_cast<std::int64_t>(min_spin_limit),
+                static_cast<std::int64_t>(max_spin_limit)));
+        }
+    }    // namespace
+
     ///////////////////////////////////////////////////////////////////////////
     mutex::mutex(char const* const description)
-      : owner_id_(threads::detail::invalid_thread_id)
+      : state_(0)
+      , spin_limit_(min_spin_limit)
+      , owner_id_(nullptr)
     {
         PIKA_ITT_SYNC_CREATE(this, "lcos::local::mutex", description);
         PIKA_ITT_SYNC_RENAME(this, "lcos::local::mutex");
@@ -35,36 +58,145 @@ namespace pika {
         PIKA_ITT_SYNC_DESTROY(this);
     }
 
+    // Note that the mutex itself is not registered with the lock verification
+    // as threads are allowed to suspend while holding it. Only the spinlock
+    // protecting the waiter list is registered while it is held.
+    bool mutex::try_lock_fast(void* self_id) noexcept
+    {
+        std::uint32_t s = state_.load(std::memory_order_relaxed);
+        while ((s & (state_locked | state_handoff)) == 0)
+        {
+            if (state_.compare_exchange_weak(
+                    s, s | state_locked, std::memory_order_acquire, std::memory_order_relaxed))
+            {
+                owner_id_.store(self_id, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool mutex::try_lock_spin(void* self_id) noexcept
+    {
+        // Spin for up to twice the number of iterations it took to acquire
+        // the mutex on average, unless waiters are starving in which case the
+        // mutex will be handed to them anyway
+        std::uint32_t const spin_limit = spin_limit_.load(std::memory_order_relaxed);
+        std::uint32_t const max_spins = (std::min)(2 * spin_limit, max_spin_limit);
+
+        std::uint32_t spins = 0;
+        for (; spins != max_spins; ++spins)
+        {
+            std::uint32_t const s = state_.load(std::memory_order_relaxed);
+            if (s & state_starving)
+            {
+                break;
+            }
+
+            if ((s & (state_locked | state_handoff)) == 0 && try_lock_fast(self_id))
+            {
+                spin_limit_.store(update_spin_limit(spin_limit, spins), std::memory_order_relaxed);
+                return true;
+            }
+
+            PIKA_SMT_PAUSE;
+        }
+
+        // Spinning didn't pay off, spin less next time
+        spin_limit_.store(update_spin_limit(spin_limit, 0), std::memory_order_relaxed);
+        return false;
+    }
+
+    // Try to acquire the mutex while holding mtx_, or mark the mutex as
+    // having waiters so that the unlocking thread wakes up a waiter. Returns
+    // true if the mutex was acquired, false if the calling thread has to
+    // suspend on cond_.
+    bool mutex::try_acquire_waiting(std::unique_lock<mutex_type>& l, void* self_id, bool woken)
+    {
+        PIKA_ASSERT(l.owns_lock());
+
+        std::uint32_t s = state_.load(std::memory_order_relaxed);
+        while (true)
+        {
+            if (woken && (s & state_handoff))
+            {
+                // The unlocking thread has handed the mutex to us
+                std::uint32_t clear = state_handoff;
+                if (cond_.empty(l))
+                {
+                    clear |= state_waiters;
+                }
+                state_.fetch_and(~clear, std::memory_order_acquire);
+                owner_id_.store(self_id, std::memory_order_relaxed);
+                return true;
+            }
+
+            if ((s & (state_locked | state_handoff)) == 0)
+            {
+                std::uint32_t desired = s | state_locked;
+                if (cond_.empty(l))
+                {
+                    desired &= ~(state_waiters | state_starving);
+                }
+                if (state_.compare_exchange_weak(
+                        s, desired, std::memory_order_acquire, std::memory_order_relaxed))
+                {
+                    owner_id_.store(self_id, std::memory_order_relaxed);
+                    return true;
+                }
+                continue;
+            }
+
+            // A waiter that was woken up but lost the mutex to another
+            // thread asks for the mutex to be handed over on the next unlock
+            std::uint32_t const desired = s | state_waiters | (woken ? state_starving : 0);
+            if (s == desired ||
+                state_.compare_exchange_weak(
+                    s, desired, std::memory_order_relaxed, std::memory_order_relaxed))
+            {
+                return false;
+            }
+        }
+    }
+
     void mutex::lock(char const* description, error_code& ec)
     {
         PIKA_ASSERT(threads::detail::get_self_ptr() != nullptr);
 
         PIKA_ITT_SYNC_PREPARE(this);
-        std::unique_lock<mutex_type> l(mtx_);
 
-        threads::detail::thread_id_type self_id = threads::detail::get_self_id();
-        if (owner_id_ == self_id)
+        void* const self_id = threads::detail::get_self_id().get();
+        if (PIKA_LIKELY(try_lock_fast(self_id)))
+        {
+            PIKA_ITT_SYNC_ACQUIRED(this);
+            return;
+        }
+
+        if (owner_id_.load(std::memory_order_relaxed) == self_id)
         {
             PIKA_ITT_SYNC_CANCEL(this);
-            l.unlock();
             PIKA_THROWS_IF(ec, pika::error::deadlock, description,
                 "The calling thread already owns the mutex");
             return;
         }
 
-        while (owner_id_ != threads::detail::invalid_thread_id)
+        if (!try_lock_spin(self_id))
         {
-            cond_.wait(l, ec);
-            if (ec)
+            std::unique_lock<mutex_type> l(mtx_);
+            bool woken = false;
+            while (!try_acquire_waiting(l, self_id, woken))
             {
-                PIKA_ITT_SYNC_CANCEL(this);
-                return;
+                cond_.wait(l, ec);
+                if (ec)
+                {
+                    PIKA_ITT_SYNC_CANCEL(this);
+                    return;
+                }
+                woken = true;
             }
         }
 
-        util::register_lock(this);
         PIKA_ITT_SYNC_ACQUIRED(this);
-        owner_id_ = self_id;
     }
 
     bool mutex::try_lock(char const* /* description */, error_code& /* ec */)
@@ -72,18 +204,14 @@ namespace pika {
         PIKA_ASSERT(threads::detail::get_self_ptr() != nullptr);
 
         PIKA_ITT_SYNC_PREPARE(this);
-        std::unique_lock<mutex_type> l(mtx_);
 
-        if (owner_id_ != threads::detail::invalid_thread_id)
+        if (!try_lock_fast(threads::detail::get_self_id().get()))
         {
             PIKA_ITT_SYNC_CANCEL(this);
             return false;
         }
 
-        threads::detail::thread_id_type self_id = threads::detail::get_self_id();
-        util::register_lock(this);
         PIKA_ITT_SYNC_ACQUIRED(this);
-        owner_id_ = self_id;
         return true;
     }
 
@@ -92,21 +220,56 @@ namespace pika {
         PIKA_ASSERT(threads::detail::get_self_ptr() != nullptr);
 
         PIKA_ITT_SYNC_RELEASING(this);
-        // Unregister lock early as the lock guard below may suspend.
-        util::unregister_lock(this);
-        std::unique_lock<mutex_type> l(mtx_);
 
-        threads::detail::thread_id_type self_id = threads::detail::get_self_id();
-        if (PIKA_UNLIKELY(owner_id_ != self_id))
+        void* const self_id = threads::detail::get_self_id().get();
+        if (PIKA_UNLIKELY(owner_id_.load(std::memory_order_relaxed) != self_id ||
+                !(state_.load(std::memory_order_relaxed) & state_locked)))
         {
-            l.unlock();
             PIKA_THROWS_IF(ec, pika::error::lock_error, "mutex::unlock",
                 "The calling thread does not own the mutex");
             return;
         }
 
         PIKA_ITT_SYNC_RELEASED(this);
-        owner_id_ = threads::detail::invalid_thread_id;
+        owner_id_.store(nullptr, std::memory_order_relaxed);
+
+        std::uint32_t expected = state_locked;
+        if (PIKA_LIKELY(state_.compare_exchange_strong(
+                expected, 0, std::memory_order_release, std::memory_order_relaxed)))
+        {
+            if (&ec != &throws)
+                ec = make_success_code();
+            return;
+        }
+
+        unlock_slow(ec);
+    }
+
+    void mutex::unlock_slow(error_code& ec)
+    {
+        std::unique_lock<mutex_type> l(mtx_);
+
+        if (cond_.empty(l))
+        {
+            // The waiters have been woken up already
+            state_.fetch_and(~(state_locked | state_waiters | state_starving),
+                std::memory_order_release);
+            l.unlock();
+
+            if (&ec != &throws)
+                ec = make_success_code();
+            return;
+        }
+
+        if (state_.load(std::memory_order_relaxed) & state_starving)
+        {
+            // Keep the mutex locked and hand it to the next waiter
+            state_.fetch_xor(state_starving | state_handoff, std::memory_order_release);
+        }
+        else
+        {
+            state_.fetch_and(~state_locked, std::memory_order_release);
+        }
 
         {
             util::ignore_while_checking il(&l);
@@ -130,34 +293,32 @@ namespace pika {
         PIKA_ASSERT(threads::detail::get_self_ptr() != nullptr);
 
         PIKA_ITT_SYNC_PREPARE(this);
-        std::unique_lock<mutex_type> l(mtx_);
 
-        threads::detail::thread_id_type self_id = threads::detail::get_self_id();
-        if (owner_id_ != threads::detail::invalid_thread_id)
+        void* const self_id = threads::detail::get_self_id().get();
+        if (!try_lock_fast(self_id) && !try_lock_spin(self_id))
         {
-            threads::detail::thread_restart_state const reason = cond_.wait_until(l, abs_time, ec);
-            if (ec)
+            std::unique_lock<mutex_type> l(mtx_);
+            bool woken = false;
+            while (!try_acquire_waiting(l, self_id, woken))
             {
-                PIKA_ITT_SYNC_CANCEL(this);
-                return false;
-            }
+                threads::detail::thread_restart_state const reason =
+                    cond_.wait_until(l, abs_time, ec);
+                if (ec)
+                {
+                    PIKA_ITT_SYNC_CANCEL(this);
+                    return false;
+                }
 
-            if (reason == threads::detail::thread_restart_state::timeout)    //-V110
-            {
-                PIKA_ITT_SYNC_CANCEL(this);
-                return false;
-            }
-
-            if (owner_id_ != threads::detail::invalid_thread_id)    //-V110
-            {
-                PIKA_ITT_SYNC_CANCEL(this);
-                return false;
+                if (reason == threads::detail::thread_restart_state::timeout)    //-V110
+                {
+                    PIKA_ITT_SYNC_CANCEL(this);
+                    return false;
+                }
+                woken = true;
             }
         }
 
-        util::register_lock(this);
         PIKA_ITT_SYNC_ACQUIRED(this);
-        owner_id_ = self_id;
         return true;
     }
 }    // namespace pika
@@ -6,39 +6,58 @@
 
 //  This work is inspired by https://github.com/aprell/tasking-2.0
 
+// This benchmark measures the throughput of channel_mpmc for all combinations
+// of the given numbers of producers and consumers. Elements are transferred
+// either one by one with set/get, retrying after a yield when the channel is
+// full or empty (mode "yield"), one by one with set_blocking/get_blocking
+// (mode "blocking"), or in batches with set_n/get_n (mode "batch").
+
 #include <pika/future.hpp>
 #include <pika/init.hpp>
 #include <pika/modules/timing.hpp>
 #include <pika/synchronization/channel_mpmc.hpp>
 #include <pika/thread.hpp>
 
+#include <fmt/ostream.h>
+#include <fmt/printf.h>
+
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <functional>
 #include <iostream>
+#include <string>
 #include <utility>
+#include <vector>
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
 
 ///////////////////////////////////////////////////////////////////////////////
 struct data
 {
     data() = default;
 
-    explicit data(int d)
+    explicit data(std::uint64_t d)
     {
         data_[0] = d;
     }
 
-    int data_[8];
+    std::uint64_t data_[4];
 };
 
-#if PIKA_DEBUG
-constexpr int NUM_TESTS = 1000000;
-#else
-constexpr int NUM_TESTS = 100000000;
-#endif
+using channel_type = pika::experimental::channel_mpmc<data>;
+
+enum class mode
+{
+    yield,
+    blocking,
+    batch
+};
 
 ///////////////////////////////////////////////////////////////////////////////
-inline data channel_get(pika::experimental::channel_mpmc<data> const& c)
+inline data channel_get(channel_type const& c)
 {
     data result;
     while (!c.get(&result))
@@ -48,7 +67,7 @@ inline data channel_get(pika::experimental::channel_mpmc<data> const& c)
     return result;
 }
 
-inline void channel_set(pika::experimental::channel_mpmc<data>& c, data&& val)
+inline void channel_set(channel_type& c, data&& val)
 {
     while (!c.set(std::move(val)))    // NOLINT
     {
@@ -57,59 +76,198 @@ inline void channel_set(pika::experimental::channel_mpmc<data>& c, data&& val)
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-// Produce
-double thread_func_0(pika::experimental::channel_mpmc<data>& c)
+// Produce the elements first, first + stride, ... up to count
+void produce(channel_type& c, mode m, std::size_t batch_size, std::uint64_t first,
+    std::uint64_t stride, std::uint64_t count)
 {
-    auto start = std::chrono::high_resolution_clock::now();
-
-    for (int i = 0; i != NUM_TESTS; ++i)
+    if (m == mode::batch)
     {
-        channel_set(c, data{i});
-    }
+        std::vector<data> batch(batch_size);
+        std::uint64_t i = first;
+        while (i < count)
+        {
+            std::size_t n = 0;
+            for (/**/; n != batch_size && i < count; ++n, i += stride)
+            {
+                batch[n] = data{i};
+            }
 
-    auto end = std::chrono::high_resolution_clock::now();
+            for (data* next = batch.data(); n != 0; /**/)
+            {
+                std::size_t const sent = c.set_n(next, n);
+                if (sent == 0)
+                {
+                    pika::this_thread::yield();
+                }
+                next += sent;
+                n -= sent;
+            }
+        }
+        return;
+    }
 
-    return std::chrono::duration<double>(end - start).count();
+    for (std::uint64_t i = first; i < count; i += stride)
+    {
+        if (m == mode::blocking)
+        {
+            c.set_blocking(data{i});
+        }
+        else
+        {
+            channel_set(c, data{i});
+        }
+    }
 }
 
-// Consume
-double thread_func_1(pika::experimental::channel_mpmc<data>& c)
+// Consume count elements, returns the sum of the received values
+std::uint64_t consume(channel_type& c, mode m, std::size_t batch_size, std::uint64_t count)
 {
-    auto start = std::chrono::high_resolution_clock::now();
+    std::uint64_t sum = 0;
+
+    if (m == mode::batch)
+    {
+        std::vector<data> batch(batch_size);
+        while (count != 0)
+        {
+            std::size_t const received =
+                c.get_n(batch.data(), std::min(std::uint64_t(batch_size), count));
+            if (received == 0)
+            {
+                pika::this_thread::yield();
+            }
+            for (std::size_t i = 0; i != received; ++i)
+            {
+                sum += batch[i].data_[0];
+            }
+            count -= received;
+        }
+        return sum;
+    }
 
-    for (int i = 0; i != NUM_TESTS; ++i)
+    for (/**/; count != 0; --count)
     {
-        data d = channel_get(c);
-        if (d.data_[0] != i)
+        data d;
+        if (m == mode::blocking)
         {
-            std::cout << "Error!\n";
+            c.get_blocking(&d);
         }
+        else
+        {
+            d = channel_get(c);
+        }
+        sum += d.data_[0];
+    }
+    return sum;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void bench(std::uint64_t num_items, std::size_t channel_size, std::size_t batch_size,
+    std::string const& mode_name, std::size_t num_producers, std::size_t num_consumers)
+{
+    mode const m = mode_name == "blocking" ? mode::blocking :
+        mode_name == "batch"               ? mode::batch :
+                                             mode::yield;
+    channel_type c(channel_size);
+
+    pika::chrono::detail::high_resolution_timer timer;
+
+    std::vector<pika::future<void>> producers;
+    producers.reserve(num_producers);
+    for (std::size_t i = 0; i != num_producers; ++i)
+    {
+        producers.push_back(
+            pika::async(&produce, std::ref(c), m, batch_size, i, num_producers, num_items));
     }
 
-    auto end = std::chrono::high_resolution_clock::now();
+    // the first consumers receive the remaining elements
+    std::vector<pika::future<std::uint64_t>> consumers;
+    consumers.reserve(num_consumers);
+    for (std::size_t i = 0; i != num_consumers; ++i)
+    {
+        std::uint64_t const count =
+            num_items / num_consumers + (i < num_items % num_consumers ? 1 : 0);
+        consumers.push_back(pika::async(&consume, std::ref(c), m, batch_size, count));
+    }
+
+    pika::wait_all(producers);
+    std::uint64_t sum = 0;
+    for (auto& f : consumers)
+    {
+        sum += f.get();
+    }
+
+    double const elapsed = timer.elapsed();
+
+    if (sum != num_items * (num_items - 1) / 2)
+    {
+        std::cout << "Error!\n";
+    }
 
-    return std::chrono::duration<double>(end - start).count();
+    fmt::print(std::cout, "{},{},{},{},{},{:.3f},{:.0f}\n", pika::get_num_worker_threads(),
+        num_producers, num_consumers, mode_name, num_items, elapsed,
+        static_cast<double>(num_items) / elapsed);
 }
 
-int pika_main()
+int pika_main(variables_map& vm)
 {
-    pika::experimental::channel_mpmc<data> c(10000);
+    std::uint64_t const num_items = vm["items"].as<std::uint64_t>();
+    std::size_t const channel_size = vm["channel-size"].as<std::size_t>();
+    std::size_t const batch_size = vm["batch-size"].as<std::size_t>();
+    std::string const mode_name = vm["mode"].as<std::string>();
 
-    pika::future<double> producer = pika::async(thread_func_0, std::ref(c));
-    pika::future<double> consumer = pika::async(thread_func_1, std::ref(c));
+    if (mode_name != "yield" && mode_name != "blocking" && mode_name != "batch")
+    {
+        std::cerr << "unknown mode \"" << mode_name
+                  << "\", expected \"yield\", \"blocking\", or \"batch\"\n";
+        return pika::finalize();
+    }
 
-    auto producer_time = producer.get();
-    std::cout << "Producer throughput: " << (NUM_TESTS / producer_time) << " [op/s] ("
-              << (producer_time / NUM_TESTS) << " [s/op])\n";
+    if (!vm.count("no-header"))
+    {
+        std::cout << "threads,producers,consumers,mode,items,time [s],throughput [op/s]\n";
+    }
 
-    auto consumer_time = consumer.get();
-    std::cout << "Consumer throughput: " << (NUM_TESTS / consumer_time) << " [op/s] ("
-              << (consumer_time / NUM_TESTS) << " [s/op])\n";
+    for (std::size_t num_producers : vm["producers"].as<std::vector<std::size_t>>())
+    {
+        for (std::size_t num_consumers : vm["consumers"].as<std::vector<std::size_t>>())
+        {
+            bench(num_items, channel_size, batch_size, mode_name, num_producers, num_consumers);
+        }
+    }
 
     return pika::finalize();
 }
 
 int main(int argc, char* argv[])
 {
-    return pika::init(pika_main, argc, argv);
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("items", value<std::uint64_t>()->default_value(
+#if PIKA_DEBUG
+            1000000
+#else
+            100000000
+#endif
+            ), "number of elements to transfer through the channel")
+        ("channel-size", value<std::size_t>()->default_value(10000),
+         "capacity of the channel")
+        ("producers", value<std::vector<std::size_t>>()->multitoken()->default_value(
+             std::vector<std::size_t>{1}, "1"),
+         "numbers of producers to benchmark")
+        ("consumers", value<std::vector<std::size_t>>()->multitoken()->default_value(
+             std::vector<std::size_t>{1}, "1"),
+         "numbers of consumers to benchmark")
+        ("mode", value<std::string>()->default_value("yield"),
+         "how to transfer elements (yield, blocking, or batch)")
+        ("batch-size", value<std::size_t>()->default_value(64),
+         "number of elements per set_n/get_n in batch mode")
+        ("no-header", "do not print out the csv header row");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
 }
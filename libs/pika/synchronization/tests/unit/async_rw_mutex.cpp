@@ -13,6 +13,7 @@
 
 #include <atomic>
 #include <cstddef>
+#include <memory>
 #include <random>
 #include <type_traits>
 #include <utility>
@@ -259,6 +260,97 @@ void test_read_sender_copyable(async_rw_mutex<ReadWriteT, ReadT> rwm)
     PIKA_TEST_EQ(read_accesses, std::size_t(4));
 }
 
+template <typename ReadWriteT, typename ReadT = ReadWriteT>
+void test_unstarted_read_sender(async_rw_mutex<ReadWriteT, ReadT> rwm)
+{
+    // A read-only sender that has not been started must not stop other
+    // read-only senders of the same stage, or the read-write access that
+    // precedes them, from completing.
+    std::size_t read_accesses = 0;
+    auto f = [&](auto) { ++read_accesses; };
+    auto rw = rwm.readwrite();
+    auto s1 = rwm.read();
+    auto s2 = rwm.read();
+    sync_wait(std::move(rw));
+    sync_wait(std::move(s2) | then(f));
+    sync_wait(std::move(s1) | then(f));
+    PIKA_TEST_EQ(read_accesses, std::size_t(2));
+}
+
+// Allocator which counts the number of live allocations, used for checking
+// that non-default allocators are used for the shared states.
+template <typename T>
+struct counting_allocator
+{
+    using value_type = T;
+
+    std::atomic<std::size_t>* count;
+
+    explicit counting_allocator(std::atomic<std::size_t>& count)
+      : count(&count)
+    {
+    }
+
+    template <typename U>
+    counting_allocator(counting_allocator<U> const& other)
+      : count(other.count)
+    {
+    }
+
+    T* allocate(std::size_t n)
+    {
+        ++*count;
+        return std::allocator<T>{}.allocate(n);
+    }
+
+    void deallocate(T* p, std::size_t n)
+    {
+        --*count;
+        std::allocator<T>{}.deallocate(p, n);
+    }
+
+    friend bool operator==(counting_allocator const& a, counting_allocator const& b)
+    {
+        return a.count == b.count;
+    }
+
+    friend bool operator!=(counting_allocator const& a, counting_allocator const& b)
+    {
+        return a.count != b.count;
+    }
+};
+
+void test_allocator()
+{
+    std::atomic<std::size_t> count{0};
+    counting_allocator<int> alloc{count};
+
+    {
+        async_rw_mutex<std::size_t, std::size_t, counting_allocator<int>> rwm{0, alloc};
+        sync_wait(rwm.readwrite() | then([](auto x) { ++x.get(); }));
+        PIKA_TEST_EQ(count.load(), std::size_t(1));
+
+        auto r1 = rwm.read();
+        auto r2 = rwm.read();
+        PIKA_TEST_EQ(count.load(), std::size_t(1));
+        sync_wait(std::move(r1) | then([](auto x) { PIKA_TEST_EQ(x.get(), std::size_t(1)); }));
+        sync_wait(std::move(r2) | then([](auto x) { PIKA_TEST_EQ(x.get(), std::size_t(1)); }));
+        sync_wait(rwm.readwrite());
+        PIKA_TEST_EQ(count.load(), std::size_t(1));
+    }
+
+    PIKA_TEST_EQ(count.load(), std::size_t(0));
+
+    {
+        async_rw_mutex<void, void, counting_allocator<int>> rwm{alloc};
+        sync_wait(rwm.readwrite());
+        sync_wait(rwm.read());
+        PIKA_TEST_EQ(count.load(), std::size_t(1));
+    }
+
+    PIKA_TEST_EQ(count.load(), std::size_t(0));
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 int pika_main(pika::program_options::variables_map& vm)
 {
@@ -292,6 +384,12 @@ int pika_main(pika::program_options::variables_map& vm)
     test_read_sender_copyable(async_rw_mutex<std::size_t>{0});
     test_read_sender_copyable(async_rw_mutex<mytype, mytype_base>{mytype{}});
 
+    test_unstarted_read_sender(async_rw_mutex<void>{});
+    test_unstarted_read_sender(async_rw_mutex<std::size_t>{0});
+    test_unstarted_read_sender(async_rw_mutex<mytype, mytype_base>{mytype{}});
+
+    test_allocator();
+
     return pika::finalize();
 }
 
@@ -0,0 +1,168 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/future.hpp>
+#include <pika/init.hpp>
+#include <pika/synchronization/channel_mpmc.hpp>
+#include <pika/testing.hpp>
+
+#include <cstddef>
+#include <functional>
+#include <numeric>
+#include <utility>
+#include <vector>
+
+constexpr int NUM_PRODUCERS = 4;
+constexpr int NUM_CONSUMERS = 4;
+constexpr int NUM_ITEMS = 10000;
+
+using channel_type = pika::experimental::channel_mpmc<int>;
+
+///////////////////////////////////////////////////////////////////////////////
+void test_capacity()
+{
+    channel_type c(3);
+    PIKA_TEST_EQ(c.capacity(), std::size_t(3));
+
+    PIKA_TEST(!c.get());
+    PIKA_TEST(c.set(1));
+    PIKA_TEST(c.set(2));
+    PIKA_TEST(c.set(3));
+    PIKA_TEST(!c.set(4));
+    PIKA_TEST(c.get());
+
+    int val = 0;
+    for (int i = 1; i != 4; ++i)
+    {
+        PIKA_TEST(c.get(&val));
+        PIKA_TEST_EQ(val, i);
+    }
+    PIKA_TEST(!c.get(&val));
+}
+
+void test_batch()
+{
+    channel_type c(5);
+
+    std::vector<int> in{0, 1, 2, 3, 4, 5, 6};
+    PIKA_TEST_EQ(c.set_n(in.data(), in.size()), std::size_t(5));
+    PIKA_TEST_EQ(c.set_n(in.data(), in.size()), std::size_t(0));
+
+    std::vector<int> out(3, -1);
+    PIKA_TEST_EQ(c.get_n(out.data(), out.size()), std::size_t(3));
+    PIKA_TEST(out == (std::vector<int>{0, 1, 2}));
+
+    // wraps around the end of the ring
+    PIKA_TEST_EQ(c.set_n(in.data() + 5, 2), std::size_t(2));
+    PIKA_TEST_EQ(c.get_n(out.data(), out.size()), std::size_t(3));
+    PIKA_TEST(out == (std::vector<int>{3, 4, 5}));
+    PIKA_TEST_EQ(c.get_n(out.data(), out.size()), std::size_t(1));
+    PIKA_TEST_EQ(out[0], 6);
+    PIKA_TEST_EQ(c.get_n(out.data(), out.size()), std::size_t(0));
+}
+
+void test_close()
+{
+    channel_type c(1);
+    PIKA_TEST(c.set(1));
+    c.close();
+
+    // a closed channel does not hand out the remaining elements
+    int val = 0;
+    PIKA_TEST(!c.get(&val));
+    PIKA_TEST(!c.set(2));
+    PIKA_TEST(!c.get_blocking(&val));
+    PIKA_TEST(!c.set_blocking(2));
+    PIKA_TEST_THROW(c.close(), pika::exception);
+}
+
+void test_close_wakes_blocked_threads()
+{
+    channel_type empty(1);
+    channel_type full(1);
+    PIKA_TEST(full.set(0));
+
+    pika::future<bool> consumer = pika::async([&] {
+        int val = 0;
+        return empty.get_blocking(&val);
+    });
+    pika::future<bool> producer = pika::async([&] { return full.set_blocking(1); });
+
+    empty.close();
+    full.close();
+
+    PIKA_TEST(!consumer.get());
+    PIKA_TEST(!producer.get());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void produce(channel_type& c, int first)
+{
+    for (int i = first; i < NUM_ITEMS; i += NUM_PRODUCERS)
+    {
+        PIKA_TEST(c.set_blocking(int(i)));
+    }
+}
+
+long long consume(channel_type& c, int count)
+{
+    long long sum = 0;
+    for (int i = 0; i != count; ++i)
+    {
+        int val = 0;
+        PIKA_TEST(c.get_blocking(&val));
+        sum += val;
+    }
+    return sum;
+}
+
+void test_blocking()
+{
+    // a small channel makes producers and consumers block frequently
+    channel_type c(4);
+
+    std::vector<pika::future<void>> producers;
+    for (int i = 0; i != NUM_PRODUCERS; ++i)
+    {
+        producers.push_back(pika::async(&produce, std::ref(c), i));
+    }
+
+    std::vector<pika::future<long long>> consumers;
+    for (int i = 0; i != NUM_CONSUMERS; ++i)
+    {
+        consumers.push_back(pika::async(&consume, std::ref(c), NUM_ITEMS / NUM_CONSUMERS));
+    }
+
+    pika::wait_all(producers);
+
+    long long sum = 0;
+    for (auto& f : consumers)
+    {
+        sum += f.get();
+    }
+
+    PIKA_TEST_EQ(sum, (long long)(NUM_ITEMS) * (NUM_ITEMS - 1) / 2);
+    PIKA_TEST(!c.get());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int pika_main()
+{
+    test_capacity();
+    test_batch();
+    test_close();
+    test_close_wakes_blocked_threads();
+    test_blocking();
+
+    pika::finalize();
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    PIKA_TEST_EQ(pika::init(pika_main, argc, argv), 0);
+    return 0;
+}
@@ -0,0 +1,177 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/execution_base/agent_ref.hpp>
+#include <pika/execution_base/this_thread.hpp>
+#include <pika/future.hpp>
+#include <pika/init.hpp>
+#include <pika/synchronization/detail/completion_flag.hpp>
+#include <pika/testing.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+using pika::detail::completion_flag;
+
+constexpr unsigned char destroyed_pattern = 0xa5;
+
+///////////////////////////////////////////////////////////////////////////////
+// The waiter destroys the flag as soon as wait returns and overwrites its
+// memory. set must not access the flag anymore after that, so the memory has
+// to be unchanged once the setter has finished.
+struct flag_storage
+{
+    flag_storage()
+      : flag(new(data) completion_flag)
+    {
+    }
+
+    void wait_and_destroy()
+    {
+        flag->wait();
+        flag->~completion_flag();
+        std::memset(data, destroyed_pattern, sizeof(data));
+    }
+
+    bool is_untouched() const
+    {
+        return std::all_of(std::begin(data), std::end(data),
+            [](unsigned char c) { return c == destroyed_pattern; });
+    }
+
+    alignas(completion_flag) unsigned char data[sizeof(completion_flag)];
+    completion_flag* flag;
+};
+
+// Give the waiter a chance to suspend or block before the flag is set
+void delay(std::size_t i)
+{
+    for (std::size_t k = 0; k != i % 64; ++k)
+    {
+        pika::execution::this_thread::detail::yield_k(k, "delay");
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void test_agent_waiter_agent_setter(std::size_t iterations)
+{
+    for (std::size_t i = 0; i != iterations; ++i)
+    {
+        flag_storage s;
+        auto f = pika::async([&s, i]() {
+            delay(i);
+            s.flag->set();
+        });
+        s.wait_and_destroy();
+        f.get();
+        PIKA_TEST(s.is_untouched());
+    }
+}
+
+void test_agent_waiter_os_thread_setter(std::size_t iterations)
+{
+    for (std::size_t i = 0; i != iterations; ++i)
+    {
+        flag_storage s;
+        std::thread t([&s, i]() {
+            delay(i);
+            s.flag->set();
+        });
+        s.wait_and_destroy();
+        t.join();
+        PIKA_TEST(s.is_untouched());
+    }
+}
+
+void test_os_thread_waiter_agent_setter(std::size_t iterations)
+{
+    for (std::size_t i = 0; i != iterations; ++i)
+    {
+        flag_storage s;
+        std::thread t([&s]() { s.wait_and_destroy(); });
+        delay(i);
+        s.flag->set();
+        t.join();
+        PIKA_TEST(s.is_untouched());
+    }
+}
+
+void test_os_thread_waiter_os_thread_setter(std::size_t iterations)
+{
+    for (std::size_t i = 0; i != iterations; ++i)
+    {
+        flag_storage s;
+        std::thread t([&s, i]() {
+            delay(i);
+            s.flag->set();
+        });
+        std::thread w([&s]() { s.wait_and_destroy(); });
+        w.join();
+        t.join();
+        PIKA_TEST(s.is_untouched());
+    }
+}
+
+// The waiting pika thread may be resumed by others than set. It must not
+// return from wait before the flag has been set.
+void test_spurious_resume(std::size_t iterations)
+{
+    for (std::size_t i = 0; i != iterations; ++i)
+    {
+        flag_storage s;
+        pika::execution::detail::agent_ref waiter = pika::execution::this_thread::detail::agent();
+        auto f = pika::async([&s, waiter, i]() mutable {
+            for (std::size_t k = 0; k != 3; ++k)
+            {
+                delay(i);
+                PIKA_TEST(!s.flag->is_set());
+                waiter.resume("test_spurious_resume");
+            }
+            s.flag->set();
+        });
+        s.wait_and_destroy();
+        f.get();
+        PIKA_TEST(s.is_untouched());
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int pika_main(variables_map& vm)
+{
+    std::size_t const iterations = vm["iterations"].as<std::size_t>();
+
+    test_agent_waiter_agent_setter(iterations);
+    test_agent_waiter_os_thread_setter(iterations);
+    test_os_thread_waiter_agent_setter(iterations);
+    test_os_thread_waiter_os_thread_setter(iterations);
+    test_spurious_resume(iterations);
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description desc_commandline("Usage: " PIKA_APPLICATION_STRING " [options]");
+
+    desc_commandline.add_options()("iterations", value<std::size_t>()->default_value(1000),
+        "the number of times to repeat each test");
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = desc_commandline;
+
+    PIKA_TEST_EQ_MSG(
+        pika::init(pika_main, argc, argv, init_args), 0, "pika main exited with non-zero status");
+    return 0;
+}
@@ -8,14 +8,18 @@
 //  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
 #include <pika/functional/bind.hpp>
+#include <pika/future.hpp>
 #include <pika/init.hpp>
+#include <pika/lock_registration/detail/register_locks.hpp>
 #include <pika/modules/thread_manager.hpp>
 #include <pika/modules/threading.hpp>
 #include <pika/synchronization/condition_variable.hpp>
 #include <pika/synchronization/mutex.hpp>
+#include <pika/synchronization/recursive_mutex.hpp>
 #include <pika/testing.hpp>
 
 #include <chrono>
+#include <cstddef>
 #include <mutex>
 #include <string>
 #include <vector>
@@ -271,10 +275,52 @@ struct test_recursive_lock
     }
 };
 
+template <typename M>
+struct test_contention
+{
+    using mutex_type = M;
+
+    void operator()()
+    {
+        // Threads occasionally yield while holding the mutex so that other
+        // threads have to wait for it, also with a single worker thread
+        constexpr std::size_t num_threads = 16;
+        constexpr std::size_t num_iterations = 1000;
+
+        mutex_type mtx;
+        std::size_t count = 0;
+
+        std::vector<pika::future<void>> futures;
+        for (std::size_t t = 0; t != num_threads; ++t)
+        {
+            futures.push_back(pika::async([&]() {
+                for (std::size_t i = 0; i != num_iterations; ++i)
+                {
+                    std::lock_guard<mutex_type> l(mtx);
+                    std::size_t const c = count;
+                    if (i % 7 == 0)
+                    {
+                        // recursive_mutex is registered as a held lock
+                        pika::util::ignore_all_while_checking il;
+                        pika::this_thread::yield();
+                    }
+                    count = c + 1;
+                }
+            }));
+        }
+        pika::wait_all(futures);
+
+        PIKA_TEST_EQ(count, num_threads * num_iterations);
+        PIKA_TEST(mtx.try_lock());
+        mtx.unlock();
+    }
+};
+
 void test_mutex()
 {
     test_lock<pika::mutex>()();
     test_trylock<pika::mutex>()();
+    test_contention<pika::mutex>()();
 }
 
 void test_timed_mutex()
@@ -282,15 +328,17 @@ void test_timed_mutex()
     test_lock<pika::timed_mutex>()();
     test_trylock<pika::timed_mutex>()();
     test_timedlock<pika::timed_mutex>()();
+    test_contention<pika::timed_mutex>()();
+}
+
+void test_recursive_mutex()
+{
+    test_lock<pika::recursive_mutex>()();
+    test_trylock<pika::recursive_mutex>()();
+    test_recursive_lock<pika::recursive_mutex>()();
+    test_contention<pika::recursive_mutex>()();
 }
 
-//void test_recursive_mutex()
-//{
-//    test_lock<pika::recursive_mutex>()();
-//    test_trylock<pika::recursive_mutex>()();
-//    test_recursive_lock<pika::recursive_mutex>()();
-//}
-//
 //void test_recursive_timed_mutex()
 //{
 //    test_lock<pika::lcos::local::recursive_timed_mutex()();
@@ -308,7 +356,7 @@ int pika_main(variables_map&)
     {
         test_mutex();
         test_timed_mutex();
-        //~ test_recursive_mutex();
+        test_recursive_mutex();
         //~ test_recursive_timed_mutex();
     }
 
@@ -113,6 +113,8 @@ namespace pika::threads::detail {
             rtcfg_, "pika.thread_queue.init_threads_count", PIKA_THREAD_QUEUE_INIT_THREADS_COUNT);
         double const max_idle_backoff_time = pika::detail::get_entry_as<double>(
             rtcfg_, "pika.max_idle_backoff_time", PIKA_IDLE_BACKOFF_TIME_MAX);
+        bool const adaptive_idle_backoff =
+            pika::detail::get_entry_as<bool>(rtcfg_, "pika.adaptive_idle_backoff", true);
 
         std::ptrdiff_t small_stacksize = rtcfg_.get_stack_size(execution::thread_stacksize::small_);
         std::ptrdiff_t medium_stacksize =
@@ -123,7 +125,8 @@ namespace pika::threads::detail {
         thread_queue_init_parameters thread_queue_init(max_thread_count, min_tasks_to_steal_pending,
             min_tasks_to_steal_staged, min_add_new_count, max_add_new_count, min_delete_count,
             max_delete_count, max_terminated_threads, init_threads_count, max_idle_backoff_time,
-            small_stacksize, medium_stacksize, large_stacksize, huge_stacksize);
+            small_stacksize, medium_stacksize, large_stacksize, huge_stacksize,
+            adaptive_idle_backoff);
 
         // instantiate the pools
         for (size_t i = 0; i != num_pools; i++)
@@ -265,6 +268,39 @@ namespace pika::threads::detail {
                 break;
             }
 
+            case resource::local_priority_chase_lev:
+            {
+                // set parameters for scheduler and pool instantiation and
+                // perform compatibility checks
+                std::size_t num_high_priority_queues =
+                    pika::detail::get_entry_as<std::size_t>(rtcfg_,
+                        "pika.thread_queue.high_priority_queues", thread_pool_init.num_threads_);
+                check_num_high_priority_queues(
+                    thread_pool_init.num_threads_, num_high_priority_queues);
+
+                // instantiate the scheduler
+                using local_sched_type = pika::threads::local_priority_queue_scheduler<std::mutex,
+                    pika::threads::chase_lev_lifo>;
+
+                local_sched_type::init_parameter_type init(thread_pool_init.num_threads_,
+                    thread_pool_init.affinity_data_, num_high_priority_queues, thread_queue_init,
+                    "core-local_priority_queue_scheduler");
+
+                std::unique_ptr<local_sched_type> sched(new local_sched_type(init));
+
+                // set the default scheduler flags
+                sched->set_scheduler_mode(thread_pool_init.mode_);
+                // conditionally set/unset this flag
+                sched->update_scheduler_mode(scheduler_mode::enable_stealing_numa, !numa_sensitive);
+
+                // instantiate the pool
+                std::unique_ptr<thread_pool_base> pool(
+                    new pika::threads::detail::scheduled_thread_pool<local_sched_type>(
+                        PIKA_MOVE(sched), thread_pool_init));
+                pools_.push_back(PIKA_MOVE(pool));
+                break;
+            }
+
             case resource::static_:
             {
                 // instantiate the scheduler
@@ -0,0 +1,128 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+#include <pika/threading_base/thread_pool_base.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <pika/config/warnings_prefix.hpp>
+
+namespace pika::threads::detail {
+    /// A thread pool managed by an elastic_pool_controller, together with
+    /// the bounds on its number of active worker threads.
+    struct elastic_pool
+    {
+        thread_pool_base* pool = nullptr;
+        std::size_t min_threads = 1;
+        std::size_t max_threads = std::size_t(-1);
+    };
+
+    struct elastic_pool_controller_params
+    {
+        // How often the counters of the pools are read
+        std::chrono::milliseconds interval{10};
+        // The number of consecutive intervals a pool has to be overloaded,
+        // and another pool underloaded, before a processing unit is moved
+        // between them
+        std::size_t hysteresis = 3;
+        // A pool is overloaded if it has more queued tasks per active
+        // worker thread than this
+        double grow_queue_length = 2.0;
+        // A pool is underloaded if it is not overloaded and on average at
+        // least this fraction of its active worker threads is not running a
+        // task
+        double shrink_idle_fraction = 0.5;
+    };
+
+    /// Moves processing units between thread pools depending on their load.
+    ///
+    /// The managed pools are expected to share processing units, i.e. the
+    /// processing units have been added to several pools with
+    /// pika::resource::mode_allow_oversubscription, and to have
+    /// scheduler_mode::enable_elasticity set. The controller makes sure that
+    /// each shared processing unit runs the worker threads of only one pool
+    /// at a time by suspending the worker threads of the other pools. The
+    /// processing units are handed out to the pools in the given order, first
+    /// up to the minimum size of each pool and then up to the maximum size.
+    ///
+    /// A dedicated OS thread applies this distribution and then periodically
+    /// reads the queue lengths and the utilization of the pools.
+    /// When a pool has been overloaded for the configured number of intervals
+    /// while another pool has been underloaded for as long, a worker thread
+    /// of the underloaded pool is suspended and a worker thread of the
+    /// overloaded pool on the same processing unit is resumed. At most one
+    /// processing unit is moved per interval, and the minimum and maximum
+    /// sizes of the pools are respected.
+    class elastic_pool_controller
+    {
+    public:
+        /// Distributes the processing units and starts the controller.
+        /// Throws if fewer than two pools are given, if a pool does not
+        /// support suspending processing units, if the bounds of a pool are
+        /// invalid, or if the shared processing units are not enough to give
+        /// every pool its minimum size.
+        PIKA_EXPORT explicit elastic_pool_controller(std::vector<elastic_pool> pools,
+            elastic_pool_controller_params const& params = {});
+        PIKA_EXPORT ~elastic_pool_controller();
+
+        elastic_pool_controller(elastic_pool_controller const&) = delete;
+        elastic_pool_controller& operator=(elastic_pool_controller const&) = delete;
+
+        /// Stops the controller. The processing units stay with the pools
+        /// they are currently assigned to. Must be called before the runtime
+        /// is stopped. Called by the destructor if it hasn't been called
+        /// before.
+        PIKA_EXPORT void stop();
+
+        /// The number of processing units that have been moved between pools
+        std::uint64_t get_move_count() const noexcept
+        {
+            return move_count_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        struct pool_state
+        {
+            elastic_pool config;
+            // The processing unit of each worker thread and whether the
+            // worker thread is running
+            std::vector<std::size_t> pu_nums;
+            std::vector<bool> active;
+            std::size_t num_active = 0;
+
+            std::size_t overloaded_intervals = 0;
+            std::size_t underloaded_intervals = 0;
+            // Smoothed fraction of active worker threads not running a task
+            double idle_fraction = 0.0;
+        };
+
+        void distribute();
+        void update_load(pool_state& s);
+        bool move_processing_unit(pool_state& from, pool_state& to);
+        void control_loop();
+
+        std::vector<pool_state> pools_;
+        elastic_pool_controller_params params_;
+        std::atomic<std::uint64_t> move_count_{0};
+
+        std::mutex mtx_;
+        std::condition_variable cond_;
+        bool stop_ = false;
+        std::thread thread_;
+    };
+}    // namespace pika::threads::detail
+
+#include <pika/config/warnings_suffix.hpp>
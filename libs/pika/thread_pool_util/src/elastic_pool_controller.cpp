@@ -0,0 +1,343 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#include <pika/modules/errors.hpp>
+#include <pika/modules/logging.hpp>
+#include <pika/thread_pool_util/elastic_pool_controller.hpp>
+#include <pika/threading_base/scheduler_base.hpp>
+#include <pika/threading_base/scheduler_mode.hpp>
+#include <pika/threading_base/thread_pool_base.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pika::threads::detail {
+    elastic_pool_controller::elastic_pool_controller(
+        std::vector<elastic_pool> pools, elastic_pool_controller_params const& params)
+      : params_(params)
+    {
+        if (pools.size() < 2)
+        {
+            PIKA_THROW_EXCEPTION(pika::error::bad_parameter,
+                "elastic_pool_controller::elastic_pool_controller",
+                "at least two thread pools are needed, {} given", pools.size());
+        }
+
+        for (elastic_pool const& p : pools)
+        {
+            if (p.pool == nullptr)
+            {
+                PIKA_THROW_EXCEPTION(pika::error::bad_parameter,
+                    "elastic_pool_controller::elastic_pool_controller", "invalid thread pool");
+            }
+
+            if (!p.pool->get_scheduler()->has_scheduler_mode(scheduler_mode::enable_elasticity))
+            {
+                PIKA_THROW_EXCEPTION(pika::error::invalid_status,
+                    "elastic_pool_controller::elastic_pool_controller",
+                    "thread pool \"{}\" does not support suspending processing units",
+                    p.pool->get_pool_name());
+            }
+
+            if (p.min_threads == 0 || p.min_threads > p.max_threads)
+            {
+                PIKA_THROW_EXCEPTION(pika::error::bad_parameter,
+                    "elastic_pool_controller::elastic_pool_controller",
+                    "invalid bounds for thread pool \"{}\": minimum {}, maximum {}",
+                    p.pool->get_pool_name(), p.min_threads, p.max_threads);
+            }
+
+            pool_state s;
+            s.config = p;
+            std::size_t const num_threads = p.pool->get_os_thread_count();
+            for (std::size_t thread_num = 0; thread_num != num_threads; ++thread_num)
+            {
+                s.pu_nums.push_back(p.pool->get_pu_num(thread_num));
+            }
+            s.active.resize(num_threads, false);
+            pools_.push_back(PIKA_MOVE(s));
+        }
+
+        distribute();
+
+        thread_ = std::thread(&elastic_pool_controller::control_loop, this);
+    }
+
+    elastic_pool_controller::~elastic_pool_controller()
+    {
+        stop();
+    }
+
+    void elastic_pool_controller::stop()
+    {
+        {
+            std::lock_guard<std::mutex> l(mtx_);
+            stop_ = true;
+        }
+        cond_.notify_all();
+        if (thread_.joinable())
+        {
+            thread_.join();
+
+            LTM_(info).format("elastic_pool_controller: stopped after moving {} processing units",
+                get_move_count());
+        }
+    }
+
+    // Decides which worker threads are active initially. A processing unit
+    // can run as many worker threads at a time as the pool with the most
+    // worker threads on it has.
+    void elastic_pool_controller::distribute()
+    {
+        std::map<std::size_t, std::size_t> free_slots;
+        for (pool_state const& s : pools_)
+        {
+            std::map<std::size_t, std::size_t> slots;
+            for (std::size_t pu_num : s.pu_nums)
+            {
+                ++slots[pu_num];
+            }
+            for (auto const& [pu_num, count] : slots)
+            {
+                free_slots[pu_num] = (std::max)(free_slots[pu_num], count);
+            }
+        }
+
+        auto claim = [&](pool_state& s, std::size_t limit) {
+            for (std::size_t thread_num = 0;
+                 thread_num != s.pu_nums.size() && s.num_active < limit; ++thread_num)
+            {
+                std::size_t& slots = free_slots[s.pu_nums[thread_num]];
+                if (!s.active[thread_num] && slots != 0)
+                {
+                    --slots;
+                    s.active[thread_num] = true;
+                    ++s.num_active;
+                }
+            }
+        };
+
+        for (pool_state& s : pools_)
+        {
+            claim(s, s.config.min_threads);
+            if (s.num_active < s.config.min_threads)
+            {
+                PIKA_THROW_EXCEPTION(pika::error::bad_parameter,
+                    "elastic_pool_controller::distribute",
+                    "not enough processing units to give thread pool \"{}\" its minimum of {} "
+                    "worker threads",
+                    s.config.pool->get_pool_name(), s.config.min_threads);
+            }
+        }
+
+        for (pool_state& s : pools_)
+        {
+            claim(s, s.config.max_threads);
+        }
+    }
+
+    void elastic_pool_controller::update_load(pool_state& s)
+    {
+        thread_pool_base& pool = *s.config.pool;
+
+        std::int64_t const queue_length = pool.get_queue_length(std::size_t(-1), false);
+
+        // The utilization is the percentage of all worker threads of the pool,
+        // suspended ones included, that are running a task at this moment.
+        // The samples are smoothed to avoid reacting to single bursts.
+        double const busy_threads = static_cast<double>(pool.get_scheduler_utilization()) *
+            static_cast<double>(pool.get_os_thread_count()) / 100.0;
+        double const num_active = static_cast<double>(s.num_active);
+        double const idle_fraction =
+            1.0 - (std::min)(busy_threads, num_active) / (std::max)(num_active, 1.0);
+        s.idle_fraction = 0.5 * (s.idle_fraction + idle_fraction);
+
+        bool const overloaded =
+            static_cast<double>(queue_length) > params_.grow_queue_length * num_active;
+        bool const underloaded = !overloaded && s.idle_fraction >= params_.shrink_idle_fraction;
+
+        s.overloaded_intervals = overloaded ? s.overloaded_intervals + 1 : 0;
+        s.underloaded_intervals = underloaded ? s.underloaded_intervals + 1 : 0;
+    }
+
+    // Suspends a worker thread of from and resumes a worker thread of to
+    // that is bound to the same processing unit
+    bool elastic_pool_controller::move_processing_unit(pool_state& from, pool_state& to)
+    {
+        for (std::size_t to_thread = 0; to_thread != to.pu_nums.size(); ++to_thread)
+        {
+            if (to.active[to_thread])
+            {
+                continue;
+            }
+
+            for (std::size_t from_thread = from.pu_nums.size(); from_thread-- != 0;)
+            {
+                if (!from.active[from_thread] ||
+                    from.pu_nums[from_thread] != to.pu_nums[to_thread])
+                {
+                    continue;
+                }
+
+                error_code ec(throwmode::lightweight);
+                from.config.pool->suspend_processing_unit_direct(from_thread, ec);
+                if (ec)
+                {
+                    LTM_(warning).format("elastic_pool_controller: suspending worker thread {} "
+                                         "of thread pool {} failed: {}",
+                        from_thread, from.config.pool->get_pool_name(), ec.get_message());
+                    return false;
+                }
+                from.active[from_thread] = false;
+                --from.num_active;
+
+                to.config.pool->resume_processing_unit_direct(to_thread, ec);
+                if (ec)
+                {
+                    LTM_(warning).format("elastic_pool_controller: resuming worker thread {} "
+                                         "of thread pool {} failed: {}",
+                        to_thread, to.config.pool->get_pool_name(), ec.get_message());
+
+                    // Give the processing unit back to the pool it was taken
+                    // from
+                    error_code rollback_ec(throwmode::lightweight);
+                    from.config.pool->resume_processing_unit_direct(from_thread, rollback_ec);
+                    if (rollback_ec)
+                    {
+                        LTM_(warning).format("elastic_pool_controller: resuming worker thread "
+                                             "{} of thread pool {} failed: {}",
+                            from_thread, from.config.pool->get_pool_name(),
+                            rollback_ec.get_message());
+                        return false;
+                    }
+                    from.active[from_thread] = true;
+                    ++from.num_active;
+                    return false;
+                }
+                to.active[to_thread] = true;
+                ++to.num_active;
+
+                LTM_(info).format("elastic_pool_controller: moved processing unit {} from "
+                                  "thread pool {} ({} threads) to thread pool {} ({} threads)",
+                    to.pu_nums[to_thread], from.config.pool->get_pool_name(), from.num_active,
+                    to.config.pool->get_pool_name(), to.num_active);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void elastic_pool_controller::control_loop()
+    {
+        // Apply the initial distribution. The pools are resumed first so
+        // that no pool ever runs out of active worker threads. Worker threads
+        // that can't be resumed or suspended keep their current state.
+        for (pool_state& s : pools_)
+        {
+            for (std::size_t thread_num = 0; thread_num != s.active.size(); ++thread_num)
+            {
+                if (!s.active[thread_num])
+                {
+                    continue;
+                }
+
+                error_code ec(throwmode::lightweight);
+                s.config.pool->resume_processing_unit_direct(thread_num, ec);
+                if (ec)
+                {
+                    LTM_(warning).format("elastic_pool_controller: resuming worker thread {} "
+                                         "of thread pool {} failed: {}",
+                        thread_num, s.config.pool->get_pool_name(), ec.get_message());
+                    s.active[thread_num] = false;
+                    --s.num_active;
+                }
+            }
+        }
+        for (pool_state& s : pools_)
+        {
+            for (std::size_t thread_num = 0; thread_num != s.active.size(); ++thread_num)
+            {
+                if (s.active[thread_num])
+                {
+                    continue;
+                }
+
+                error_code ec(throwmode::lightweight);
+                s.config.pool->suspend_processing_unit_direct(thread_num, ec);
+                if (ec)
+                {
+                    LTM_(warning).format("elastic_pool_controller: suspending worker thread {} "
+                                         "of thread pool {} failed: {}",
+                        thread_num, s.config.pool->get_pool_name(), ec.get_message());
+                    s.active[thread_num] = true;
+                    ++s.num_active;
+                }
+            }
+            update_load(s);
+        }
+
+        std::unique_lock<std::mutex> l(mtx_);
+        while (!cond_.wait_for(l, params_.interval, [this] { return stop_; }))
+        {
+            l.unlock();
+
+            for (pool_state& s : pools_)
+            {
+                update_load(s);
+            }
+
+            // Give a processing unit to the pool that has been overloaded
+            // the longest, taking it from the most idle pool
+            pool_state* to = nullptr;
+            for (pool_state& s : pools_)
+            {
+                if (s.overloaded_intervals >= params_.hysteresis &&
+                    s.num_active < s.config.max_threads &&
+                    (to == nullptr || s.overloaded_intervals > to->overloaded_intervals))
+                {
+                    to = &s;
+                }
+            }
+
+            if (to != nullptr)
+            {
+                std::vector<pool_state*> donors;
+                for (pool_state& s : pools_)
+                {
+                    if (s.underloaded_intervals >= params_.hysteresis &&
+                        s.num_active > s.config.min_threads)
+                    {
+                        donors.push_back(&s);
+                    }
+                }
+                std::sort(donors.begin(), donors.end(),
+                    [](pool_state const* lhs, pool_state const* rhs) {
+                        return lhs->idle_fraction > rhs->idle_fraction;
+                    });
+
+                for (pool_state* from : donors)
+                {
+                    if (move_processing_unit(*from, *to))
+                    {
+                        move_count_.fetch_add(1, std::memory_order_relaxed);
+                        from->underloaded_intervals = 0;
+                        to->overloaded_intervals = 0;
+                        break;
+                    }
+                }
+            }
+
+            l.lock();
+        }
+    }
+}    // namespace pika::threads::detail
@@ -0,0 +1,154 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// Two pools share the same processing unit. Loading one pool while the other
+// one is idle must make the controller move worker threads to the loaded
+// pool, and back when the load is reversed.
+
+#include <pika/execution.hpp>
+#include <pika/execution_base/this_thread.hpp>
+#include <pika/init.hpp>
+#include <pika/modules/resource_partitioner.hpp>
+#include <pika/modules/timing.hpp>
+#include <pika/testing.hpp>
+#include <pika/thread.hpp>
+#include <pika/thread_pool_util/elastic_pool_controller.hpp>
+#include <pika/threading_base/scheduler_mode.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ex = pika::execution::experimental;
+
+using pika::threads::detail::elastic_pool;
+using pika::threads::detail::elastic_pool_controller;
+using pika::threads::detail::elastic_pool_controller_params;
+using pika::threads::detail::thread_pool_base;
+
+constexpr std::size_t num_pool_threads = 3;
+
+///////////////////////////////////////////////////////////////////////////////
+void test_invalid_parameters(thread_pool_base& a, thread_pool_base& b)
+{
+    PIKA_TEST_THROW(elastic_pool_controller({{&a}}), pika::exception);
+    PIKA_TEST_THROW(elastic_pool_controller({{&a}, {&pika::resource::get_thread_pool("default")}}),
+        pika::exception);
+    PIKA_TEST_THROW(elastic_pool_controller({{&a, 0}, {&b}}), pika::exception);
+    PIKA_TEST_THROW(elastic_pool_controller({{&a, 2, 1}, {&b}}), pika::exception);
+
+    // there are only num_pool_threads slots to share
+    PIKA_TEST_THROW(elastic_pool_controller({{&a, 2}, {&b, 2}}), pika::exception);
+}
+
+// Keeps the given pool busy until done is set
+void load(thread_pool_base& pool, std::atomic<bool>& done, std::atomic<std::size_t>& running)
+{
+    for (std::size_t i = 0; i != 20 * num_pool_threads; ++i)
+    {
+        ++running;
+        ex::start_detached(ex::schedule(ex::thread_pool_scheduler{&pool}) | ex::then([&] {
+            while (!done)
+            {
+                pika::chrono::detail::high_resolution_timer t;
+                while (t.elapsed() < 1e-3)
+                {
+                }
+                pika::this_thread::yield();
+            }
+            --running;
+        }));
+    }
+}
+
+bool wait_for_threads(thread_pool_base& pool, std::size_t num_threads)
+{
+    pika::chrono::detail::high_resolution_timer t;
+    while (pool.get_active_os_thread_count() != num_threads)
+    {
+        if (t.elapsed() > 30.0)
+        {
+            return false;
+        }
+        pika::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return true;
+}
+
+void test_move(thread_pool_base& a, thread_pool_base& b)
+{
+    elastic_pool_controller_params params;
+    params.interval = std::chrono::milliseconds(5);
+    params.hysteresis = 2;
+    elastic_pool_controller controller({{&a}, {&b}}, params);
+
+    // a is listed first and gets the threads that are left after both pools
+    // have their minimum
+    PIKA_TEST(wait_for_threads(a, num_pool_threads - 1));
+    PIKA_TEST(wait_for_threads(b, 1));
+
+    std::atomic<std::size_t> running(0);
+    {
+        std::atomic<bool> done(false);
+        load(b, done, running);
+        PIKA_TEST(wait_for_threads(b, num_pool_threads - 1));
+        PIKA_TEST(wait_for_threads(a, 1));
+        done = true;
+        pika::util::yield_while([&] { return running != 0; });
+    }
+
+    std::size_t const move_count = controller.get_move_count();
+    PIKA_TEST_EQ(move_count, num_pool_threads - 2);
+
+    {
+        std::atomic<bool> done(false);
+        load(a, done, running);
+        PIKA_TEST(wait_for_threads(a, num_pool_threads - 1));
+        PIKA_TEST(wait_for_threads(b, 1));
+        done = true;
+        pika::util::yield_while([&] { return running != 0; });
+    }
+
+    PIKA_TEST_EQ(controller.get_move_count(), 2 * move_count);
+
+    controller.stop();
+}
+
+int pika_main()
+{
+    thread_pool_base& a = pika::resource::get_thread_pool("a");
+    thread_pool_base& b = pika::resource::get_thread_pool("b");
+
+    test_invalid_parameters(a, b);
+    test_move(a, b);
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    using pika::threads::scheduler_mode;
+
+    pika::init_params init_args;
+    init_args.cfg = {"pika.os_threads=1"};
+    init_args.rp_mode = pika::resource::mode_allow_oversubscription;
+    init_args.rp_callback = [](auto& rp, pika::program_options::variables_map const&) {
+        pika::resource::pu const& p = rp.numa_domains()[0].cores()[0].pus()[0];
+        rp.add_resource(p, "default");
+
+        for (std::string const pool_name : {"a", "b"})
+        {
+            rp.create_thread_pool(pool_name, pika::resource::scheduling_policy::local_priority_fifo,
+                scheduler_mode::default_mode | scheduler_mode::enable_elasticity);
+            rp.add_resource(p, pool_name, num_pool_threads);
+        }
+    };
+
+    PIKA_TEST_EQ(pika::init(pika_main, argc, argv, init_args), 0);
+    return 0;
+}
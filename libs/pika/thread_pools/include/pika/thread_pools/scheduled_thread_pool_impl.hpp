@@ -124,6 +124,10 @@ namespace pika::threads::detail {
             }
             threads_.clear();
         }
+
+        // Cancelled timers release their threads, which needs the queues of
+        // the scheduler
+        sched_->Scheduler::stop_timer_wheel();
     }
 
     template <typename Scheduler>
@@ -226,7 +230,7 @@ namespace pika::threads::detail {
             sched_->Scheduler::set_all_states_at_least(runtime_state::stopping);
 
             // make sure we're not waiting
-            sched_->Scheduler::do_some_work(std::size_t(-1));
+            sched_->Scheduler::wake_all_idle_threads();
 
             if (blocking)
             {
@@ -239,7 +243,7 @@ namespace pika::threads::detail {
                     // make sure no OS thread is waiting
                     LTM_(info).format("stop: {} notify_all", id_.name());
 
-                    sched_->Scheduler::do_some_work(std::size_t(-1));
+                    sched_->Scheduler::wake_all_idle_threads();
 
                     LTM_(info).format("stop: {} join:{}", id_.name(), i);
 
@@ -583,6 +587,28 @@ namespace pika::threads::detail {
         return id;
     }
 
+    template <typename Scheduler>
+    void scheduled_thread_pool<Scheduler>::create_work_batch(
+        thread_init_data* data, std::size_t count, error_code& ec)
+    {
+        // verify state
+        if (thread_count_ == 0 && !sched_->Scheduler::is_state(runtime_state::running))
+        {
+            // thread-manager is not currently running
+            PIKA_THROWS_IF(ec, pika::error::invalid_status,
+                "thread_pool<Scheduler>::create_work_batch",
+                "invalid state: thread pool is not running");
+            return;
+        }
+
+        threads::detail::create_work_batch(sched_.get(), data, count, ec);
+        if (ec)
+            return;
+
+        // update statistics
+        tasks_scheduled_ += static_cast<std::int64_t>(count);
+    }
+
     ///////////////////////////////////////////////////////////////////////////
     template <typename Scheduler>
     thread_state scheduled_thread_pool<Scheduler>::set_state(thread_id_type const& id,
@@ -1447,11 +1473,16 @@ namespace pika::threads::detail {
 
         l.unlock();
 
+        // make sure the virtual core is not parked
+        sched_->Scheduler::do_some_work(virt_core);
+
         PIKA_ASSERT(expected == runtime_state::running || expected == runtime_state::pre_sleep ||
             expected == runtime_state::sleeping);
 
         util::yield_while([&state]() { return state.load() == runtime_state::pre_sleep; },
             "scheduled_thread_pool::suspend_processing_unit_direct");
+
+        this->invalidate_steal_order();
     }
 
     template <typename Scheduler>
@@ -1484,5 +1515,7 @@ namespace pika::threads::detail {
                 return state.load() == runtime_state::sleeping;
             },
             "scheduled_thread_pool::resume_processing_unit_direct");
+
+        this->invalidate_steal_order();
     }
 }    // namespace pika::threads::detail
@@ -915,9 +915,12 @@ namespace pika::threads::detail {
                             idle_loop_count);
                 }
             }
-            else if (idle_loop_count > params.max_idle_loop_count_ || may_exit)
+            else if (idle_loop_count > scheduler.SchedulingPolicy::get_idle_loop_limit(
+                                           num_thread, params.max_idle_loop_count_) ||
+                may_exit)
             {
-                if (idle_loop_count > params.max_idle_loop_count_)
+                if (idle_loop_count > scheduler.SchedulingPolicy::get_idle_loop_limit(
+                                          num_thread, params.max_idle_loop_count_))
                     idle_loop_count = 0;
 
                 // call back into invoking context
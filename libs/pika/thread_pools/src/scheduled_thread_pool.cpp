@@ -27,6 +27,11 @@ template class PIKA_EXPORT pika::threads::local_priority_queue_scheduler<>;
 template class PIKA_EXPORT pika::threads::detail::scheduled_thread_pool<
     pika::threads::local_priority_queue_scheduler<std::mutex, pika::threads::lockfree_fifo>>;
 
+template class PIKA_EXPORT
+    pika::threads::local_priority_queue_scheduler<std::mutex, pika::threads::chase_lev_lifo>;
+template class PIKA_EXPORT pika::threads::detail::scheduled_thread_pool<
+    pika::threads::local_priority_queue_scheduler<std::mutex, pika::threads::chase_lev_lifo>>;
+
 template class PIKA_EXPORT pika::threads::static_priority_queue_scheduler<>;
 template class PIKA_EXPORT
     pika::threads::detail::scheduled_thread_pool<pika::threads::static_priority_queue_scheduler<>>;
@@ -20,6 +20,7 @@
 #include <pika/threading_base/thread_pool_base.hpp>
 #include <pika/timing/steady_clock.hpp>
 
+#include <chrono>
 #include <cstddef>
 #include <exception>
 #include <functional>
@@ -385,7 +386,11 @@ namespace pika {
 
         void sleep_until(pika::chrono::steady_time_point const& abs_time)
         {
-            this_thread::suspend(abs_time, "this_thread::sleep_until");
+            // the thread may be resumed before the timer fires
+            do
+            {
+                this_thread::suspend(abs_time, "this_thread::sleep_until");
+            } while (std::chrono::steady_clock::now() < abs_time.value());
         }
 
         std::size_t get_thread_data()
@@ -11,7 +11,15 @@
 #include <pika/threading_base/thread_init_data.hpp>
 #include <pika/threading_base/threading_base_fwd.hpp>
 
+#include <cstddef>
+
 namespace pika::threads::detail {
     PIKA_EXPORT thread_id_ref_type create_work(
         scheduler_base* scheduler, thread_init_data& data, error_code& ec = throws);
+
+    // Create count work items at once. All work items must have a pending
+    // initial state. Each worker thread that receives work is woken up at
+    // most once for the whole batch.
+    PIKA_EXPORT void create_work_batch(scheduler_base* scheduler, thread_init_data* data,
+        std::size_t count, error_code& ec = throws);
 }    // namespace pika::threads::detail
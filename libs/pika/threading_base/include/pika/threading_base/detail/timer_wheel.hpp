@@ -0,0 +1,161 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+#include <pika/assert.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+namespace pika::threads::detail {
+    class timer_wheel;
+
+    // A timer scheduled on a timer_wheel. Entries are intrusive and owned by
+    // the code scheduling them, e.g. they live on the stack of a suspended
+    // thread. An entry has to stay alive until its callback has returned or
+    // until it has been cancelled.
+    class timer_wheel_entry
+    {
+    public:
+        // The callback is called on the timer thread of the wheel with fired
+        // set to true once the deadline has passed, or with fired set to
+        // false when the wheel is destroyed while the entry is still
+        // scheduled.
+        using callback_type = void (*)(timer_wheel_entry&, bool fired) noexcept;
+
+        // The wheel doesn't access detached entries anymore once their
+        // callback has been called, which allows the callback to destroy the
+        // entry. Cancelling a detached entry doesn't wait for its callback.
+        explicit timer_wheel_entry(callback_type callback, bool detached = false) noexcept
+          : callback_(callback)
+          , detached_(detached)
+        {
+        }
+
+        timer_wheel_entry(timer_wheel_entry const&) = delete;
+        timer_wheel_entry(timer_wheel_entry&&) = delete;
+        timer_wheel_entry& operator=(timer_wheel_entry const&) = delete;
+        timer_wheel_entry& operator=(timer_wheel_entry&&) = delete;
+
+        ~timer_wheel_entry()
+        {
+            PIKA_ASSERT(detached_ || state_.load(std::memory_order_relaxed) == state_idle);
+        }
+
+    private:
+        friend class timer_wheel;
+
+        static constexpr int state_idle = 0;
+        static constexpr int state_scheduled = 1;
+        static constexpr int state_firing = 2;
+
+        callback_type callback_;
+        bool detached_;
+
+        // Protected by the mutex of the wheel while the entry is scheduled
+        std::uint64_t expiry_ = 0;
+        timer_wheel_entry** slot_ = nullptr;
+        timer_wheel_entry* prev_ = nullptr;
+        timer_wheel_entry* next_ = nullptr;
+
+        std::atomic<int> state_{state_idle};
+    };
+
+    // A hierarchical timer wheel with num_levels levels of num_slots slots
+    // each. Deadlines are rounded up to the resolution of the wheel, so that
+    // timers never fire early. The slots of the first level cover one tick
+    // each, the slots of every further level cover all slots of the level
+    // below, and entries are moved to the level below when the time covered
+    // by their slot begins. Scheduling and cancelling a timer are constant
+    // time operations.
+    //
+    // A dedicated timer thread sleeps until the next tick that has expired
+    // entries or entries that need to be moved to a lower level, and calls
+    // the callbacks of the expired entries without holding the lock of the
+    // wheel.
+    class timer_wheel
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+        static constexpr std::size_t slot_bits = 6;
+        static constexpr std::size_t num_slots = std::size_t(1) << slot_bits;
+        static constexpr std::size_t num_levels = 6;
+
+        PIKA_EXPORT explicit timer_wheel(
+            std::chrono::nanoseconds resolution = std::chrono::microseconds(100));
+        PIKA_EXPORT ~timer_wheel();
+
+        timer_wheel(timer_wheel const&) = delete;
+        timer_wheel(timer_wheel&&) = delete;
+        timer_wheel& operator=(timer_wheel const&) = delete;
+        timer_wheel& operator=(timer_wheel&&) = delete;
+
+        // Schedule the callback of the entry to be called once the deadline
+        // has passed. The entry must not be scheduled already. Deadlines that
+        // have passed already fire on the next tick.
+        PIKA_EXPORT void schedule(timer_wheel_entry& entry, clock::time_point deadline);
+
+        // Cancel the entry. Returns true if the entry was removed before its
+        // callback was called. Otherwise waits for a concurrently running
+        // callback to return and returns false. The entry can be destroyed or
+        // scheduled again once cancel has returned. Cancelling a detached
+        // entry returns false without waiting if the callback is called or
+        // has been called, in which case the entry may be gone already when
+        // cancel returns.
+        PIKA_EXPORT bool cancel(timer_wheel_entry& entry) noexcept;
+
+        // The number of entries currently scheduled
+        PIKA_EXPORT std::size_t size() const;
+
+        std::chrono::nanoseconds resolution() const noexcept
+        {
+            return resolution_;
+        }
+
+    private:
+        static constexpr std::uint64_t no_tick = ~std::uint64_t(0);
+
+        static constexpr std::uint64_t level_span(std::size_t level) noexcept
+        {
+            return std::uint64_t(1) << (slot_bits * level);
+        }
+
+        static void call_callback(timer_wheel_entry& entry, bool fired) noexcept;
+
+        std::uint64_t to_tick(clock::time_point t, bool round_up) const noexcept;
+        clock::time_point to_time_point(std::uint64_t tick) const noexcept;
+
+        void insert(timer_wheel_entry& entry) noexcept;
+        void unlink(timer_wheel_entry& entry) noexcept;
+        std::uint64_t next_tick() const noexcept;
+        timer_wheel_entry* advance(std::uint64_t now) noexcept;
+        void run();
+
+        clock::time_point const start_;
+        std::chrono::nanoseconds const resolution_;
+
+        mutable std::mutex mtx_;
+        std::condition_variable cond_;
+        bool stop_ = false;
+
+        // The first tick that has not been processed yet
+        std::uint64_t current_ = 0;
+        // The tick until which the timer thread sleeps
+        std::uint64_t wakeup_ = no_tick;
+        std::size_t size_ = 0;
+        timer_wheel_entry* slots_[num_levels][num_slots] = {};
+
+        std::thread thread_;
+    };
+}    // namespace pika::threads::detail
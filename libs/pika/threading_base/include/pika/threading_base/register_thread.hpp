@@ -18,10 +18,12 @@
 #include <pika/threading_base/thread_data.hpp>
 #include <pika/threading_base/thread_pool_base.hpp>
 
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace pika::threads::detail {
     ///////////////////////////////////////////////////////////////////////////
@@ -196,6 +198,72 @@ namespace pika::threads::detail {
     {
         return register_work(data, get_self_or_default_pool(), ec);
     }
+
+    /// \brief Create multiple new work items at once using the given data.
+    ///
+    /// \param data       [in] Pointer to the first element of the data to use
+    ///                   for creating the work items. The work items must
+    ///                   have a pending initial state.
+    /// \param count      [in] The number of work items to create.
+    /// \param pool       [in] The thread pool to use for launching the work.
+    /// \param ec         [in,out] This represents the error status on exit,
+    ///                   if this is pre-initialized to \a pika#throws
+    ///                   the function will throw on error instead.
+    ///
+    /// Compared to calling register_work for each work item, the scheduler
+    /// can distribute the work items over its queues in one go and wakes up
+    /// each worker thread at most once.
+    ///
+    /// \throws invalid_status if the runtime system has not been started yet.
+    inline void register_work_batch(thread_init_data* data, std::size_t count,
+        thread_pool_base* pool, error_code& ec = throws)
+    {
+        PIKA_ASSERT(pool);
+        for (std::size_t i = 0; i != count; ++i)
+        {
+            data[i].run_now = false;
+        }
+        pool->create_work_batch(data, count, ec);
+    }
+
+    /// \brief Create count new work items at once using data returned by the
+    ///        given generator.
+    ///
+    /// \param count      [in] The number of work items to create.
+    /// \param generator  [in] Callable returning the \a thread_init_data of
+    ///                   the i-th work item when called with i.
+    /// \param pool       [in] The thread pool to use for launching the work.
+    /// \param ec         [in,out] This represents the error status on exit,
+    ///                   if this is pre-initialized to \a pika#throws
+    ///                   the function will throw on error instead.
+    ///
+    /// The work items are handed to the thread pool in batches of up to 256.
+    template <typename Generator>
+    void register_work_batch(std::size_t count, Generator&& generator, thread_pool_base* pool,
+        error_code& ec = throws)
+    {
+        constexpr std::size_t max_batch_size = 256;
+
+        std::vector<thread_init_data> data;
+        data.reserve((std::min)(count, max_batch_size));
+
+        for (std::size_t first = 0; first < count; first += max_batch_size)
+        {
+            std::size_t const last = (std::min)(count, first + max_batch_size);
+
+            data.clear();
+            for (std::size_t i = first; i != last; ++i)
+            {
+                data.push_back(generator(i));
+            }
+
+            register_work_batch(data.data(), data.size(), pool, ec);
+            if (ec)
+            {
+                return;
+            }
+        }
+    }
 }    // namespace pika::threads::detail
 
 /// \endcond
@@ -11,6 +11,7 @@
 #include <pika/concurrency/cache_line_data.hpp>
 #include <pika/functional/function.hpp>
 #include <pika/modules/errors.hpp>
+#include <pika/threading_base/detail/timer_wheel.hpp>
 #include <pika/threading_base/scheduler_mode.hpp>
 #include <pika/threading_base/scheduler_state.hpp>
 #include <pika/threading_base/thread_data.hpp>
@@ -97,9 +98,37 @@ namespace pika::threads::detail {
 
         /// This function gets called by the thread-manager whenever new work
         /// has been added, allowing the scheduler to reactivate one or more of
-        /// possibly idling OS threads
+        /// possibly idling OS threads. If the given thread is parked it is
+        /// woken up, otherwise the parked thread closest to it is woken up.
         void do_some_work(std::size_t);
 
+        /// Wake up all parked OS threads, e.g. when the scheduler is being
+        /// stopped
+        void wake_all_idle_threads();
+
+        /// Returns the number of idle loop iterations after which the given
+        /// OS thread calls idle_callback. With adaptive idle backoff this is
+        /// adjusted depending on how soon new work arrives after a thread
+        /// was parked, and is at most max_idle_loop_count.
+        std::int64_t get_idle_loop_limit(
+            std::size_t num_thread, std::int64_t max_idle_loop_count) const noexcept
+        {
+#if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF)
+            return max_idle_loop_count >> wait_counts_[num_thread].data_.idle_loop_shift_;
+#else
+            (void) num_thread;
+            return max_idle_loop_count;
+#endif
+        }
+
+        // Statistics about parking idle OS threads. All latencies are in
+        // nanoseconds. Passing std::size_t(-1) as num_thread accumulates the
+        // values of all OS threads.
+        std::int64_t get_idle_park_count(std::size_t num_thread, bool reset);
+        std::int64_t get_idle_wakeup_count(std::size_t num_thread, bool reset);
+        std::int64_t get_average_idle_wake_latency(std::size_t num_thread, bool reset);
+        std::int64_t get_max_idle_wake_latency(std::size_t num_thread, bool reset);
+
         virtual void suspend(std::size_t num_thread);
         virtual void resume(std::size_t num_thread);
 
@@ -209,6 +238,14 @@ namespace pika::threads::detail {
         virtual void create_thread(threads::detail::thread_init_data& data,
             threads::detail::thread_id_ref_type* id, error_code& ec) = 0;
 
+        /// Create count threads at once. The threads are always scheduled
+        /// right away, i.e. no ids are returned. After creating all threads
+        /// each OS thread that received one of the threads is woken up once.
+        /// The default implementation creates the threads one at a time with
+        /// create_thread.
+        virtual void create_thread_batch(
+            threads::detail::thread_init_data* data, std::size_t count, error_code& ec);
+
         virtual bool get_next_thread(std::size_t num_thread, bool running,
             threads::detail::thread_id_ref_type& thrd, bool enable_stealing) = 0;
 
@@ -344,20 +381,61 @@ namespace pika::threads::detail {
             return work_count;
         }
 
+        /// Returns the timer wheel used to resume the suspended threads of
+        /// this scheduler at a given time. The wheel and its timer thread are
+        /// created on first use.
+        timer_wheel& get_timer_wheel();
+
+        /// Destroys the timer wheel, the timers that did not expire yet are
+        /// cancelled. Called by the thread pool while the scheduler is still
+        /// alive, once no thread of the pool is running anymore.
+        void stop_timer_wheel() noexcept;
+
     protected:
         // the scheduler mode, protected from false sharing
         pika::concurrency::detail::cache_line_data<std::atomic<scheduler_mode>> mode_;
 
 #if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF)
-        // support for suspension on idle queues
-        pu_mutex_type mtx_;
-        std::condition_variable cond_;
+        // support for parking OS threads on idle queues
         struct idle_backoff_data
         {
-            std::uint32_t wait_count_;
-            double max_idle_backoff_time_;
+            // Incremented by a notifier to wake up the parked thread, this
+            // is the word the thread waits on.
+            std::atomic<std::uint32_t> epoch_{0};
+            // Set while the thread is parked, reset by whoever wakes it.
+            std::atomic<bool> parked_{false};
+            // Time at which a notifier requested the thread to wake up.
+            std::atomic<std::int64_t> wake_request_time_{0};
+
+            std::uint32_t wait_count_ = 0;
+            double max_idle_backoff_time_ = 0.0;
+
+            // The number of idle loop iterations before parking is reduced by
+            // this many powers of two, adapted using the moving averages of
+            // the time spent parked and of the wake latency.
+            std::int64_t idle_loop_shift_ = 0;
+            std::int64_t average_idle_time_ = 0;
+            std::int64_t average_wake_latency_ = 0;
+
+            std::atomic<std::int64_t> park_count_{0};
+            std::atomic<std::int64_t> wakeup_count_{0};
+            // The number of wake latencies summed up in total_wake_latency_,
+            // reset together with it independently of wakeup_count_
+            std::atomic<std::int64_t> wake_latency_count_{0};
+            std::atomic<std::int64_t> total_wake_latency_{0};
+            std::atomic<std::int64_t> max_wake_latency_{0};
+
+# if !defined(__linux__)
+            pu_mutex_type mtx_;
+            std::condition_variable cond_;
+# endif
         };
+
+        bool wake_idle_thread(std::size_t num_thread);
+
         std::vector<pika::concurrency::detail::cache_line_data<idle_backoff_data>> wait_counts_;
+        std::atomic<std::size_t> parked_count_{0};
+        std::atomic<std::size_t> next_wakeup_{0};
 #endif
 
         // support for suspension of pus
@@ -381,6 +459,10 @@ namespace pika::threads::detail {
         std::atomic<polling_work_count_function_ptr> polling_work_count_function_mpi_;
         std::atomic<polling_work_count_function_ptr> polling_work_count_function_cuda_;
 
+        // support for timed suspension of threads
+        std::once_flag timer_wheel_init_;
+        std::unique_ptr<timer_wheel> timer_wheel_;
+
 #if defined(PIKA_HAVE_SCHEDULER_LOCAL_STORAGE)
     public:
         // manage scheduler-local data
@@ -10,16 +10,47 @@
 #include <pika/coroutines/coroutine.hpp>
 #include <pika/modules/errors.hpp>
 #include <pika/modules/timing.hpp>
+#include <pika/threading_base/detail/timer_wheel.hpp>
 #include <pika/threading_base/scheduler_base.hpp>
 #include <pika/threading_base/set_thread_state.hpp>
 #include <pika/threading_base/threading_base_fwd.hpp>
 
 #include <atomic>
+#include <cstdint>
 
 namespace pika::threads::detail {
+    // Resumes a suspended thread with thread_restart_state::timeout once the
+    // given time has passed, unless the thread has been resumed for another
+    // reason before. The thread_timeout has to be created by the thread it
+    // refers to right before suspending and lives on the stack of the thread.
+    // The timer is registered with the timer wheel of the scheduler of the
+    // thread and cancelled when the thread_timeout is destroyed.
+    class thread_timeout : private timer_wheel_entry
+    {
+    public:
+        PIKA_EXPORT thread_timeout(
+            thread_id_type const& id, pika::chrono::steady_time_point const& abs_time);
+        PIKA_EXPORT ~thread_timeout();
+
+        thread_timeout(thread_timeout const&) = delete;
+        thread_timeout(thread_timeout&&) = delete;
+        thread_timeout& operator=(thread_timeout const&) = delete;
+        thread_timeout& operator=(thread_timeout&&) = delete;
+
+    private:
+        static void on_expired(timer_wheel_entry& entry, bool fired) noexcept;
+
+        thread_data* thrd_;
+        timer_wheel& wheel_;
+        // The tag of the state of the thread once it has suspended
+        std::int64_t suspended_tag_;
+        execution::thread_schedule_hint hint_;
+    };
 
     /// Set a timer to set the state of the given \a thread to the given
-    /// new value after it expired (at the given time)
+    /// new value after it expired (at the given time). The timer can't be
+    /// cancelled and no thread is created for it, the returned id is always
+    /// invalid.
     PIKA_EXPORT thread_id_ref_type set_thread_state_timed(scheduler_base* scheduler,
         pika::chrono::steady_time_point const& abs_time, thread_id_type const& thrd,
         thread_schedule_state newstate, thread_restart_state newstate_ex,
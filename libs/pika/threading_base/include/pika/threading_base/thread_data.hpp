@@ -497,6 +497,14 @@ namespace pika::threads::detail {
             return *static_cast<ThreadQueue*>(queue_);
         }
 
+        // Transfer a recycled (unused) thread object to another queue of the
+        // same scheduler
+        template <typename ThreadQueue>
+        void set_queue(ThreadQueue& queue) noexcept
+        {
+            queue_ = &queue;
+        }
+
         /// \brief Execute the thread function
         ///
         /// \returns        This function returns the thread state the thread
@@ -234,6 +234,8 @@ namespace pika::threads::detail {
         virtual void create_thread(
             thread_init_data& data, thread_id_ref_type& id, error_code& ec) = 0;
         virtual thread_id_ref_type create_work(thread_init_data& data, error_code& ec) = 0;
+        virtual void create_work_batch(
+            thread_init_data* data, std::size_t count, error_code& ec) = 0;
 
         virtual thread_state set_state(thread_id_type const& id, thread_schedule_state new_state,
             thread_restart_state new_state_ex, execution::thread_priority priority,
@@ -260,6 +262,25 @@ namespace pika::threads::detail {
         mask_type get_used_processing_units() const;
         hwloc_bitmap_ptr get_numa_domain_bitmap() const;
 
+        /// Return the index of the processing unit the worker thread
+        /// thread_num of this pool is bound to.
+        std::size_t get_pu_num(std::size_t thread_num) const
+        {
+            return affinity_data_.get_pu_num(thread_num + thread_offset_);
+        }
+
+        /// Return, for each worker thread of this pool, the other worker
+        /// threads ordered by their distance in the machine topology. Worker
+        /// threads on the same core come first, followed by worker threads
+        /// sharing the L3 cache, the NUMA domain, the socket, and finally all
+        /// remaining worker threads. Within the same distance, suspended
+        /// worker threads come first since they don't work on their own
+        /// queues, followed by the others by increasing offset. The orders
+        /// are computed on first use and cached until processing units are
+        /// suspended or resumed. Callers should keep the returned orders for
+        /// the duration of an operation instead of calling this repeatedly.
+        std::shared_ptr<std::vector<std::vector<std::size_t>> const> get_steal_orders() const;
+
         // performance counters
 #if defined(PIKA_HAVE_THREAD_CUMULATIVE_COUNTS)
         virtual std::int64_t get_executed_threads(std::size_t /*thread_num*/, bool /*reset*/)
@@ -477,6 +498,15 @@ namespace pika::threads::detail {
 
         pika::detail::affinity_data const& affinity_data_;
 
+        // Discards the cached steal orders, has to be called whenever worker
+        // threads have been suspended or resumed
+        void invalidate_steal_order();
+
+        // Cached result of get_steal_orders for all worker threads, nullptr
+        // if it has to be recomputed
+        mutable std::mutex steal_order_mtx_;
+        mutable std::shared_ptr<std::vector<std::vector<std::size_t>> const> steal_order_;
+
         // scale timestamps to nanoseconds
         double timestamp_scale_;
 
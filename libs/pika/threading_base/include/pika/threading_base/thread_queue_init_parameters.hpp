@@ -34,7 +34,8 @@ namespace pika::threads::detail {
             std::ptrdiff_t small_stacksize = PIKA_SMALL_STACK_SIZE,
             std::ptrdiff_t medium_stacksize = PIKA_MEDIUM_STACK_SIZE,
             std::ptrdiff_t large_stacksize = PIKA_LARGE_STACK_SIZE,
-            std::ptrdiff_t huge_stacksize = PIKA_HUGE_STACK_SIZE)
+            std::ptrdiff_t huge_stacksize = PIKA_HUGE_STACK_SIZE,
+            bool adaptive_idle_backoff = true)
           // NOLINTEND(bugprone-easily-swappable-parameters)
           : max_thread_count_(max_thread_count)
           , min_tasks_to_steal_pending_(min_tasks_to_steal_pending)
@@ -51,6 +52,7 @@ namespace pika::threads::detail {
           , large_stacksize_(large_stacksize)
           , huge_stacksize_(huge_stacksize)
           , nostack_stacksize_((std::numeric_limits<std::ptrdiff_t>::max)())
+          , adaptive_idle_backoff_(adaptive_idle_backoff)
         {
         }
 
@@ -69,5 +71,9 @@ namespace pika::threads::detail {
         std::ptrdiff_t const large_stacksize_;
         std::ptrdiff_t const huge_stacksize_;
         std::ptrdiff_t const nostack_stacksize_;
+        // Wake up a single idle thread close to where new work has been
+        // scheduled and adapt the time spent spinning before parking, instead
+        // of waking up all idle threads
+        bool adaptive_idle_backoff_;
     };
 }    // namespace pika::threads::detail
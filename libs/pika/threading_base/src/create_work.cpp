@@ -13,82 +13,98 @@
 #include <pika/threading_base/thread_data.hpp>
 #include <pika/threading_base/thread_init_data.hpp>
 
+#include <cstddef>
+
 namespace pika::threads::detail {
-    thread_id_ref_type create_work(
-        scheduler_base* scheduler, thread_init_data& data, error_code& ec)
-    {
-        // verify parameters
-        switch (data.initial_state)
+    namespace {
+        // Validates the given data and fills in the defaults that depend on
+        // the calling thread. Returns false if the data is invalid.
+        bool prepare_work(
+            scheduler_base* scheduler, thread_init_data& data, thread_self* self, error_code& ec)
         {
-        case thread_schedule_state::pending:
-        case thread_schedule_state::pending_do_not_schedule:
-        case thread_schedule_state::pending_boost:
-        case thread_schedule_state::suspended:
-            break;
+            // verify parameters
+            switch (data.initial_state)
+            {
+            case thread_schedule_state::pending:
+            case thread_schedule_state::pending_do_not_schedule:
+            case thread_schedule_state::pending_boost:
+            case thread_schedule_state::suspended:
+                break;
 
-        default:
-        {
-            PIKA_THROWS_IF(ec, pika::error::bad_parameter, "thread::detail::create_work",
-                "invalid initial state: {}", data.initial_state);
-            return invalid_thread_id;
-        }
-        }
+            default:
+            {
+                PIKA_THROWS_IF(ec, pika::error::bad_parameter, "thread::detail::create_work",
+                    "invalid initial state: {}", data.initial_state);
+                return false;
+            }
+            }
 
 #ifdef PIKA_HAVE_THREAD_DESCRIPTION
-        if (!data.description)
-        {
-            PIKA_THROWS_IF(ec, pika::error::bad_parameter, "thread::detail::create_work",
-                "description is nullptr");
-            return invalid_thread_id;
-        }
+            if (!data.description)
+            {
+                PIKA_THROWS_IF(ec, pika::error::bad_parameter, "thread::detail::create_work",
+                    "description is nullptr");
+                return false;
+            }
 #endif
 
-        LTM_(info)
-            .format("create_work: pool({}), scheduler({}), initial_state({}), thread_priority({})",
-                *scheduler->get_parent_pool(), *scheduler,
-                get_thread_state_name(data.initial_state),
-                execution::detail::get_thread_priority_name(data.priority))
+            LTM_(info)
+                .format("create_work: pool({}), scheduler({}), initial_state({}), "
+                        "thread_priority({})",
+                    *scheduler->get_parent_pool(), *scheduler,
+                    get_thread_state_name(data.initial_state),
+                    execution::detail::get_thread_priority_name(data.priority))
 #ifdef PIKA_HAVE_THREAD_DESCRIPTION
-            .format(", description({})", data.description)
+                .format(", description({})", data.description)
 #endif
-            ;
-
-        thread_self* self = get_self_ptr();
+                ;
 
 #ifdef PIKA_HAVE_THREAD_PARENT_REFERENCE
-        if (nullptr == data.parent_id)
-        {
-            if (self)
+            if (nullptr == data.parent_id)
             {
-                data.parent_id = get_thread_id_data(self->get_thread_id());
-                data.parent_phase = self->get_thread_phase();
+                if (self)
+                {
+                    data.parent_id = get_thread_id_data(self->get_thread_id());
+                    data.parent_phase = self->get_thread_phase();
+                }
             }
-        }
-        if (0 == data.parent_locality_id)
-            data.parent_locality_id = get_locality_id(pika::throws);
+            if (0 == data.parent_locality_id)
+                data.parent_locality_id = get_locality_id(pika::throws);
 #endif
 
-        if (nullptr == data.scheduler_base)
-            data.scheduler_base = scheduler;
+            if (nullptr == data.scheduler_base)
+                data.scheduler_base = scheduler;
 
-        // Pass critical priority from parent to child.
-        if (self)
-        {
-            if (data.priority == execution::thread_priority::default_ &&
-                execution::thread_priority::high_recursive ==
-                    get_thread_id_data(self->get_thread_id())->get_priority())
+            // Pass critical priority from parent to child.
+            if (self)
             {
-                data.priority = execution::thread_priority::high_recursive;
+                if (data.priority == execution::thread_priority::default_ &&
+                    execution::thread_priority::high_recursive ==
+                        get_thread_id_data(self->get_thread_id())->get_priority())
+                {
+                    data.priority = execution::thread_priority::high_recursive;
+                }
             }
-        }
 
-        // create the new thread
-        if (data.priority == execution::thread_priority::default_)
-            data.priority = execution::thread_priority::normal;
+            // create the new thread
+            if (data.priority == execution::thread_priority::default_)
+                data.priority = execution::thread_priority::normal;
+
+            data.run_now = (execution::thread_priority::high == data.priority ||
+                execution::thread_priority::high_recursive == data.priority ||
+                execution::thread_priority::boost == data.priority);
 
-        data.run_now = (execution::thread_priority::high == data.priority ||
-            execution::thread_priority::high_recursive == data.priority ||
-            execution::thread_priority::boost == data.priority);
+            return true;
+        }
+    }    // namespace
+
+    thread_id_ref_type create_work(
+        scheduler_base* scheduler, thread_init_data& data, error_code& ec)
+    {
+        if (!prepare_work(scheduler, data, get_self_ptr(), ec))
+        {
+            return invalid_thread_id;
+        }
 
         thread_id_ref_type id = invalid_thread_id;
         scheduler->create_thread(data, data.run_now ? &id : nullptr, ec);
@@ -99,4 +115,31 @@ namespace pika::threads::detail {
 
         return id;
     }
+
+    void create_work_batch(
+        scheduler_base* scheduler, thread_init_data* data, std::size_t count, error_code& ec)
+    {
+        thread_self* self = get_self_ptr();
+        for (std::size_t i = 0; i != count; ++i)
+        {
+            // Work is always scheduled and added to the queues as normal
+            // work, other initial states are not supported
+            if (data[i].initial_state != thread_schedule_state::pending)
+            {
+                PIKA_THROWS_IF(ec, pika::error::bad_parameter,
+                    "thread::detail::create_work_batch",
+                    "work created in batches must have a pending initial state, got: {}",
+                    data[i].initial_state);
+                return;
+            }
+
+            if (!prepare_work(scheduler, data[i], self, ec))
+            {
+                return;
+            }
+        }
+
+        // The scheduler takes care of waking up worker threads
+        scheduler->create_thread_batch(data, count, ec);
+    }
 }    // namespace pika::threads::detail
@@ -17,6 +17,7 @@
 #include <pika/threading_base/execution_agent.hpp>
 #include <pika/threading_base/scheduler_base.hpp>
 #include <pika/threading_base/set_thread_state.hpp>
+#include <pika/threading_base/set_thread_state_timed.hpp>
 #include <pika/threading_base/thread_description.hpp>
 
 #ifdef PIKA_HAVE_THREAD_BACKTRACE_ON_SUSPENSION
@@ -26,6 +27,7 @@
 
 #include <fmt/format.h>
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <memory>
@@ -98,26 +100,19 @@ namespace pika::threads::detail {
     void execution_agent::sleep_until(
         pika::chrono::steady_time_point const& sleep_time, const char* desc)
     {
-        // Just yield until time has passed by...
-        auto now = std::chrono::steady_clock::now();
-
-        // Note: we yield at least once to allow for other threads to
-        // make progress in any case. We also use yield instead of yield_k
-        // for the same reason.
-        std::size_t k = 0;
-        do
+        // Note: we yield at least once to allow for other threads to make
+        // progress in any case.
+        if (std::chrono::steady_clock::now() >= sleep_time.value())
         {
-            if (k < 32 || k & 1)
-            {
-                do_yield(desc, thread_schedule_state::pending_boost);
-            }
-            else
-            {
-                do_yield(desc, thread_schedule_state::pending);
-            }
-            ++k;
-            now = std::chrono::steady_clock::now();
-        } while (now < sleep_time.value());
+            do_yield(desc, thread_schedule_state::pending);
+            return;
+        }
+
+        // Suspend until the timer wheel of the scheduler resumes the thread.
+        // The thread may also be resumed before the deadline, e.g. by a
+        // condition variable that it waits on.
+        thread_timeout timeout(self_.get_thread_id(), sleep_time);
+        do_yield(desc, thread_schedule_state::suspended);
     }
 
 #if defined(PIKA_HAVE_VERIFY_LOCKS)
@@ -7,6 +7,7 @@
 #include <pika/config.hpp>
 #include <pika/assert.hpp>
 #include <pika/execution_base/this_thread.hpp>
+#include <pika/threading_base/detail/timer_wheel.hpp>
 #include <pika/threading_base/scheduler_base.hpp>
 #include <pika/threading_base/scheduler_mode.hpp>
 #include <pika/threading_base/scheduler_state.hpp>
@@ -16,6 +17,13 @@
 # include <pika/coroutines/detail/tss.hpp>
 #endif
 
+#if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF) && defined(__linux__)
+# include <linux/futex.h>
+# include <sys/syscall.h>
+# include <time.h>
+# include <unistd.h>
+#endif
+
 #include <algorithm>
 #include <atomic>
 #include <chrono>
@@ -35,6 +43,85 @@
 
 ///////////////////////////////////////////////////////////////////////////////
 namespace pika::threads::detail {
+#if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF)
+    namespace {
+        // Parked threads spin at most max_idle_loop_count >> this many idle
+        // loop iterations before parking
+        constexpr std::int64_t max_idle_loop_shift = 8;
+
+        // Lower bound for the estimated cost of waking up a parked thread,
+        // used before any wake latency has been measured
+        constexpr std::int64_t min_wake_cost = 10000;
+
+        std::int64_t idle_backoff_now() noexcept
+        {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+        }
+
+        void update_average(std::int64_t& average, std::int64_t value) noexcept
+        {
+            average += (value - average) / 8;
+        }
+
+        void update_maximum(std::atomic<std::int64_t>& maximum, std::int64_t value) noexcept
+        {
+            std::int64_t current = maximum.load(std::memory_order_relaxed);
+            while (current < value &&
+                !maximum.compare_exchange_weak(current, value, std::memory_order_relaxed))
+            {
+            }
+        }
+
+        std::int64_t get_and_reset(std::atomic<std::int64_t>& value, bool reset) noexcept
+        {
+            return reset ? value.exchange(0, std::memory_order_relaxed) :
+                           value.load(std::memory_order_relaxed);
+        }
+
+        template <typename WaitCounts, typename F>
+        std::int64_t accumulate_idle_statistics(
+            WaitCounts& wait_counts, std::size_t num_thread, F&& f)
+        {
+            if (num_thread != std::size_t(-1))
+            {
+                PIKA_ASSERT(num_thread < wait_counts.size());
+                return f(wait_counts[num_thread].data_);
+            }
+
+            std::int64_t result = 0;
+            for (auto& data : wait_counts)
+            {
+                result += f(data.data_);
+            }
+            return result;
+        }
+
+# if defined(__linux__)
+        static_assert(sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t));
+
+        // Block until the value of epoch differs from expected or the timeout
+        // expires. Spurious wakeups are handled by the caller.
+        void wait_on_epoch(std::atomic<std::uint32_t>& epoch, std::uint32_t expected,
+            std::chrono::milliseconds timeout) noexcept
+        {
+            timespec ts{};
+            ts.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+            ts.tv_nsec = static_cast<long>((timeout.count() % 1000) * 1000000);
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&epoch), FUTEX_WAIT_PRIVATE,
+                expected, &ts, nullptr, 0);
+        }
+
+        void wake_epoch(std::atomic<std::uint32_t>& epoch) noexcept
+        {
+            syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(&epoch), FUTEX_WAKE_PRIVATE, 1,
+                nullptr, nullptr, 0);
+        }
+# endif
+    }    // namespace
+#endif
+
     scheduler_base::scheduler_base(std::size_t num_threads, char const* description,
         thread_queue_init_parameters thread_queue_init, scheduler_mode mode)
       : suspend_mtxs_(num_threads)
@@ -55,7 +142,8 @@ namespace pika::threads::detail {
 #if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF)
         double max_time = thread_queue_init.max_idle_backoff_time_;
 
-        wait_counts_.resize(num_threads);
+        wait_counts_ =
+            std::vector<pika::concurrency::detail::cache_line_data<idle_backoff_data>>(num_threads);
         for (auto&& data : wait_counts_)
         {
             data.data_.wait_count_ = 0;
@@ -86,28 +174,293 @@ namespace pika::threads::detail {
 
             ++data.wait_count_;
 
-            std::unique_lock<pu_mutex_type> l(mtx_);
-            if (cond_.wait_for(l, period) == std::cv_status::no_timeout)
+            // Threads which are being stopped or suspended don't park
+            if (states_[num_thread].load(std::memory_order_relaxed) >= runtime_state::pre_sleep)
+            {
+                return;
+            }
+
+            std::uint32_t const epoch = data.epoch_.load(std::memory_order_acquire);
+            data.parked_.store(true, std::memory_order_seq_cst);
+            parked_count_.fetch_add(1, std::memory_order_seq_cst);
+
+            // Work added before the parked flag became visible does not wake
+            // up this thread, this pairs with the fence in do_some_work.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+
+            std::int64_t const park_time = idle_backoff_now();
+            if (get_queue_length() == 0)
             {
+# if defined(__linux__)
+                wait_on_epoch(data.epoch_, epoch, period);
+# else
+                std::unique_lock<pu_mutex_type> l(data.mtx_);
+                data.cond_.wait_for(l, period,
+                    [&] { return data.epoch_.load(std::memory_order_acquire) != epoch; });
+# endif
+            }
+
+            // If the parked flag has already been reset some notifier has
+            // taken responsibility for waking up this thread
+            bool const woken = !data.parked_.exchange(false, std::memory_order_acq_rel);
+            std::int64_t wake_latency = 0;
+            if (woken)
+            {
+                // The wake request time is published before the epoch
+                // is incremented
+                while (data.epoch_.load(std::memory_order_acquire) == epoch)
+                {
+                    pika::execution::this_thread::detail::yield_k(4, nullptr);
+                }
+
+                wake_latency = (std::max)(std::int64_t(0),
+                    idle_backoff_now() -
+                        data.wake_request_time_.load(std::memory_order_relaxed));
+
+                ++data.wakeup_count_;
+                ++data.wake_latency_count_;
+                data.total_wake_latency_.fetch_add(wake_latency, std::memory_order_relaxed);
+                update_maximum(data.max_wake_latency_, wake_latency);
+
                 // reset counter if thread was woken up
                 data.wait_count_ = 0;
             }
+            else
+            {
+                parked_count_.fetch_sub(1, std::memory_order_relaxed);
+            }
+            ++data.park_count_;
+
+            if (thread_queue_init_.adaptive_idle_backoff_)
+            {
+                // Adapt the time spent spinning before parking to the rate
+                // at which new work arrives. If new work typically arrives
+                // soon after parking, compared to the time it takes to wake
+                // up a parked thread, spinning longer is cheaper. If it
+                // arrives much later, spinning is wasted.
+                update_average(data.average_idle_time_, idle_backoff_now() - park_time);
+                if (woken)
+                {
+                    update_average(data.average_wake_latency_, wake_latency);
+                }
+
+                std::int64_t const wake_cost =
+                    (std::max)(data.average_wake_latency_, min_wake_cost);
+                if (woken && data.average_idle_time_ < 4 * wake_cost)
+                {
+                    if (data.idle_loop_shift_ > 0)
+                        --data.idle_loop_shift_;
+                }
+                else if (!woken || data.average_idle_time_ > 64 * wake_cost)
+                {
+                    if (data.idle_loop_shift_ < max_idle_loop_shift)
+                        ++data.idle_loop_shift_;
+                }
+            }
         }
 #else
         (void) num_thread;
 #endif
     }
 
+#if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF)
+    bool scheduler_base::wake_idle_thread(std::size_t num_thread)
+    {
+        idle_backoff_data& data = wait_counts_[num_thread].data_;
+
+        // Make sure only one notifier wakes up the thread
+        bool expected = true;
+        if (!data.parked_.load(std::memory_order_relaxed) ||
+            !data.parked_.compare_exchange_strong(expected, false, std::memory_order_acq_rel))
+        {
+            return false;
+        }
+        parked_count_.fetch_sub(1, std::memory_order_relaxed);
+
+        data.wake_request_time_.store(idle_backoff_now(), std::memory_order_relaxed);
+        data.epoch_.fetch_add(1, std::memory_order_release);
+
+# if defined(__linux__)
+        wake_epoch(data.epoch_);
+# else
+        {
+            std::lock_guard<pu_mutex_type> l(data.mtx_);
+        }
+        data.cond_.notify_one();
+# endif
+        return true;
+    }
+#endif
+
     /// This function gets called by the thread-manager whenever new work
     /// has been added, allowing the scheduler to reactivate one or more of
     /// possibly idling OS threads
-    void scheduler_base::do_some_work(std::size_t)
+    void scheduler_base::do_some_work(std::size_t num_thread)
     {
 #if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF)
         if (has_scheduler_mode(scheduler_mode::enable_idle_backoff))
         {
-            cond_.notify_all();
+            // The new work has to be visible before checking for parked
+            // threads, this pairs with the fence in idle_callback.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (parked_count_.load(std::memory_order_relaxed) == 0)
+            {
+                return;
+            }
+
+            if (!thread_queue_init_.adaptive_idle_backoff_)
+            {
+                wake_all_idle_threads();
+                return;
+            }
+
+            // Wake up the given thread if it is parked, otherwise the closest
+            // parked thread. Without a given thread the search starts at
+            // alternating threads.
+            std::size_t const num_threads = wait_counts_.size();
+            if (num_thread >= num_threads)
+            {
+                num_thread =
+                    next_wakeup_.fetch_add(1, std::memory_order_relaxed) % num_threads;
+            }
+
+            if (wake_idle_thread(num_thread))
+            {
+                return;
+            }
+
+            for (std::size_t offset = 1; offset != num_threads; ++offset)
+            {
+                std::size_t const distance = (offset + 1) / 2;
+                std::size_t const candidate = (offset % 2 != 0) ?
+                    (num_thread + distance) % num_threads :
+                    (num_thread + num_threads - distance) % num_threads;
+                if (wake_idle_thread(candidate))
+                {
+                    return;
+                }
+            }
+        }
+#else
+        (void) num_thread;
+#endif
+    }
+
+    void scheduler_base::create_thread_batch(
+        threads::detail::thread_init_data* data, std::size_t count, error_code& ec)
+    {
+        // Remember which OS threads received work so that each of them is
+        // woken up only once. Threads without a hint have been placed on a
+        // queue chosen by the scheduler.
+        std::size_t const num_threads = states_.size();
+        std::vector<bool> received_work(num_threads, false);
+        std::size_t num_without_hint = 0;
+
+        for (std::size_t i = 0; i != count; ++i)
+        {
+            create_thread(data[i], nullptr, ec);
+            if (ec)
+            {
+                return;
+            }
+
+            if (data[i].schedulehint.mode == execution::thread_schedule_hint_mode::thread &&
+                std::size_t(data[i].schedulehint.hint) < num_threads)
+            {
+                received_work[data[i].schedulehint.hint] = true;
+            }
+            else
+            {
+                ++num_without_hint;
+            }
+        }
+
+        for (std::size_t num_thread = 0; num_thread != num_threads; ++num_thread)
+        {
+            if (received_work[num_thread])
+            {
+                do_some_work(num_thread);
+            }
+        }
+
+        for (std::size_t i = 0; i != (std::min)(num_without_hint, num_threads); ++i)
+        {
+            do_some_work(std::size_t(-1));
         }
+    }
+
+    void scheduler_base::wake_all_idle_threads()
+    {
+#if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF)
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked_count_.load(std::memory_order_relaxed) == 0)
+        {
+            return;
+        }
+
+        for (std::size_t i = 0; i != wait_counts_.size(); ++i)
+        {
+            wake_idle_thread(i);
+        }
+#endif
+    }
+
+    std::int64_t scheduler_base::get_idle_park_count(std::size_t num_thread, bool reset)
+    {
+#if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF)
+        return accumulate_idle_statistics(wait_counts_, num_thread,
+            [reset](idle_backoff_data& data) { return get_and_reset(data.park_count_, reset); });
+#else
+        (void) num_thread;
+        (void) reset;
+        return 0;
+#endif
+    }
+
+    std::int64_t scheduler_base::get_idle_wakeup_count(std::size_t num_thread, bool reset)
+    {
+#if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF)
+        return accumulate_idle_statistics(wait_counts_, num_thread,
+            [reset](idle_backoff_data& data) { return get_and_reset(data.wakeup_count_, reset); });
+#else
+        (void) num_thread;
+        (void) reset;
+        return 0;
+#endif
+    }
+
+    std::int64_t scheduler_base::get_average_idle_wake_latency(std::size_t num_thread, bool reset)
+    {
+#if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF)
+        std::int64_t const count = accumulate_idle_statistics(
+            wait_counts_, num_thread, [reset](idle_backoff_data& data) {
+                return get_and_reset(data.wake_latency_count_, reset);
+            });
+        std::int64_t const total = accumulate_idle_statistics(
+            wait_counts_, num_thread, [reset](idle_backoff_data& data) {
+                return get_and_reset(data.total_wake_latency_, reset);
+            });
+        return count == 0 ? 0 : total / count;
+#else
+        (void) num_thread;
+        (void) reset;
+        return 0;
+#endif
+    }
+
+    std::int64_t scheduler_base::get_max_idle_wake_latency(std::size_t num_thread, bool reset)
+    {
+#if defined(PIKA_HAVE_THREAD_MANAGER_IDLE_BACKOFF)
+        std::int64_t result = 0;
+        accumulate_idle_statistics(wait_counts_, num_thread, [&](idle_backoff_data& data) {
+            result = (std::max)(result, get_and_reset(data.max_wake_latency_, reset));
+            return std::int64_t(0);
+        });
+        return result;
+#else
+        (void) num_thread;
+        (void) reset;
+        return 0;
 #endif
     }
 
@@ -351,6 +704,18 @@ namespace pika::threads::detail {
         --background_thread_count_;
     }
 
+    timer_wheel& scheduler_base::get_timer_wheel()
+    {
+        std::call_once(
+            timer_wheel_init_, [this]() { timer_wheel_ = std::make_unique<timer_wheel>(); });
+        return *timer_wheel_;
+    }
+
+    void scheduler_base::stop_timer_wheel() noexcept
+    {
+        timer_wheel_.reset();
+    }
+
 #if defined(PIKA_HAVE_SCHEDULER_LOCAL_STORAGE)
     coroutines::detail::tss_data_node* scheduler_base::find_tss_data(void const* key)
     {
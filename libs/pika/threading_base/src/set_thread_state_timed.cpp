@@ -7,145 +7,140 @@
 #include <pika/config.hpp>
 #include <pika/assert.hpp>
 #include <pika/coroutines/coroutine.hpp>
-#include <pika/functional/bind.hpp>
-#include <pika/functional/bind_front.hpp>
 #include <pika/modules/errors.hpp>
-#include <pika/threading_base/create_thread.hpp>
+#include <pika/threading_base/detail/timer_wheel.hpp>
 #include <pika/threading_base/set_thread_state_timed.hpp>
+#include <pika/threading_base/thread_num_tss.hpp>
 #include <pika/threading_base/threading_base_fwd.hpp>
 
 #include <atomic>
-#include <chrono>
-#include <functional>
+#include <cstddef>
+#include <cstdint>
 #include <memory>
-#include <system_error>
+#include <thread>
 #include <utility>
 
 namespace pika::threads::detail {
-    /// This thread function is used by the at_timer thread below to trigger
-    /// the required action.
-    thread_result_type wake_timer_thread(thread_id_ref_type const& thrd,
-        thread_schedule_state /*newstate*/, thread_restart_state /*newstate_ex*/,
-        execution::thread_priority /*priority*/, thread_id_type timer_id,
-        std::shared_ptr<std::atomic<bool>> const& triggered, bool retry_on_active,
-        thread_restart_state my_statex)
-    {
-        if (PIKA_UNLIKELY(!thrd))
+    namespace {
+        execution::thread_schedule_hint get_current_worker_hint() noexcept
         {
-            PIKA_THROW_EXCEPTION(pika::error::null_thread_id, "threads::detail::wake_timer_thread",
-                "null thread id encountered (id)");
-            return thread_result_type(thread_schedule_state::terminated, invalid_thread_id);
+            std::size_t const num_thread = pika::get_local_worker_thread_num();
+            return num_thread == std::size_t(-1) ?
+                execution::thread_schedule_hint() :
+                execution::thread_schedule_hint(static_cast<std::int16_t>(num_thread));
         }
+    }    // namespace
+
+    thread_timeout::thread_timeout(
+        thread_id_type const& id, pika::chrono::steady_time_point const& abs_time)
+      : timer_wheel_entry(&thread_timeout::on_expired)
+      , thrd_(get_thread_id_data(id))
+      , wheel_(thrd_->get_scheduler_base()->get_timer_wheel())
+      , suspended_tag_(0)
+      , hint_(get_current_worker_hint())
+    {
+        // The thread is still running, the scheduling loop increments the
+        // tag once more when the thread suspends
+        thread_state const state = thrd_->get_state();
+        PIKA_ASSERT(state.state() == thread_schedule_state::active);
+        suspended_tag_ = state.tag() + 1;
 
-        if (PIKA_UNLIKELY(!timer_id))
-        {
-            PIKA_THROW_EXCEPTION(pika::error::null_thread_id, "threads::detail::wake_timer_thread",
-                "null thread id encountered (timer_id)");
-            return thread_result_type(thread_schedule_state::terminated, invalid_thread_id);
-        }
+        wheel_.schedule(*this, abs_time.value());
+    }
 
-        PIKA_ASSERT(
-            my_statex == thread_restart_state::abort || my_statex == thread_restart_state::timeout);
+    thread_timeout::~thread_timeout()
+    {
+        wheel_.cancel(*this);
+    }
 
-        if (!triggered->load())
+    void thread_timeout::on_expired(timer_wheel_entry& entry, bool fired) noexcept
+    {
+        if (!fired)
         {
-            error_code ec(throwmode::lightweight);    // do not throw
-            set_thread_state(timer_id, thread_schedule_state::pending, my_statex,
-                execution::thread_priority::boost, execution::thread_schedule_hint(),
-                retry_on_active, ec);
+            return;
         }
 
-        return thread_result_type(thread_schedule_state::terminated, invalid_thread_id);
-    }
+        auto& timeout = static_cast<thread_timeout&>(entry);
+        thread_data* thrd = timeout.thrd_;
 
-    /// This thread function initiates the required set_state action (on
-    /// behalf of one of the threads#detail#set_thread_state functions).
-    thread_result_type at_timer(scheduler_base* scheduler,
-        std::chrono::steady_clock::time_point& /*abs_time*/, thread_id_ref_type const& thrd,
-        thread_schedule_state newstate, thread_restart_state newstate_ex,
-        execution::thread_priority priority, std::atomic<bool>* /*started*/, bool retry_on_active)
-    {
-        if (PIKA_UNLIKELY(!thrd))
+        // Only the suspension for which the timer was registered is ended,
+        // the tag changes whenever the thread is resumed
+        for (;;)
         {
-            PIKA_THROW_EXCEPTION(pika::error::null_thread_id, "threads::detail::at_timer",
-                "null thread id encountered");
-            return thread_result_type(thread_schedule_state::terminated, invalid_thread_id);
+            thread_state const state = thrd->get_state();
+            if (state.state() == thread_schedule_state::suspended &&
+                state.tag() == timeout.suspended_tag_)
+            {
+                if (thrd->restore_state(
+                        thread_schedule_state::pending, thread_restart_state::timeout, state))
+                {
+                    break;
+                }
+                continue;
+            }
+
+            // The deadline passed before the thread finished suspending
+            if (state.state() == thread_schedule_state::active &&
+                state.tag() + 1 == timeout.suspended_tag_)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            return;
         }
 
-        // create a new thread in suspended state, which will execute the
-        // requested set_state when timer fires and will re-awaken this thread,
-        // allowing the deadline_timer to go out of scope gracefully
-        thread_id_ref_type self_id = get_self_id();    // keep alive
-
-        std::shared_ptr<std::atomic<bool>> triggered(std::make_shared<std::atomic<bool>>(false));
-
-        thread_init_data data(
-            util::detail::bind_front(&wake_timer_thread, thrd, newstate, newstate_ex, priority,
-                self_id.noref(), triggered, retry_on_active),
-            "wake_timer", priority, execution::thread_schedule_hint(),
-            execution::thread_stacksize::small_, thread_schedule_state::suspended, true);
-
-        thread_id_ref_type wake_id = invalid_thread_id;
-        create_thread(scheduler, data, wake_id);
-
-        PIKA_THROW_EXCEPTION(
-            pika::error::invalid_status, "at_timer", "Timed suspension is currently not supported");
-        // // create timer firing in correspondence with given time
-        // using deadline_timer =
-        //     asio::basic_waitable_timer<std::chrono::steady_clock>;
-
-        // asio::io_context* s = get_default_timer_service();
-        // PIKA_ASSERT(s);
-        // deadline_timer t(*s, abs_time);
-
-        // // let the timer invoke the set_state on the new (suspended) thread
-        // t.async_wait([wake_id = PIKA_MOVE(wake_id), priority, retry_on_active](
-        //                  std::error_code const& ec) {
-        //     if (ec == std::make_error_code(std::errc::operation_canceled))
-        //     {
-        //            set_thread_state(wake_id.noref(), thread_schedule_state::pending,
-        //                thread_restart_state::abort, priority,
-        //                execution::thread_schedule_hint(), retry_on_active, throws);
-        //     }
-        //     else
-        //     {
-        //         set_thread_state(wake_id.noref(),
-        //             thread_schedule_state::pending,
-        //             thread_restart_state::timeout, priority,
-        //             execution::thread_schedule_hint(), retry_on_active, throws);
-        //     }
-        // });
-
-        // if (started != nullptr)
-        // {
-        //     started->store(true);
-        // }
-
-        // // this waits for the thread to be reactivated when the timer fired
-        // // if it returns signaled the timer has been canceled, otherwise
-        // // the timer fired and the wake_timer_thread above has been executed
-        // thread_restart_state statex = get_self().yield(thread_result_type(
-        //     thread_schedule_state::suspended, invalid_thread_id));
-
-        // PIKA_ASSERT(statex == thread_restart_state::abort ||
-        //     statex == thread_restart_state::timeout);
-
-        // // NOLINTNEXTLINE(bugprone-branch-clone)
-        // if (thread_restart_state::timeout != statex)    //-V601
-        // {
-        //     triggered->store(true);
-        //     // wake_timer_thread has not been executed yet, cancel timer
-        //     t.cancel();
-        // }
-        // else
-        // {
-        //     set_thread_state(
-        //         thrd.noref(), newstate, newstate_ex, priority);
-        // }
-
-        return thread_result_type(thread_schedule_state::terminated, invalid_thread_id);
+        scheduler_base* scheduler = thrd->get_scheduler_base();
+        scheduler->schedule_thread(thread_id_ref_type(thrd->get_thread_id()), timeout.hint_, false,
+            execution::thread_priority::boost);
+        scheduler->do_some_work(timeout.hint_.hint);
     }
 
+    namespace {
+        // A timer owned by the timer wheel, which sets the state of a thread
+        // when it expires
+        struct timed_state_change : timer_wheel_entry
+        {
+            timed_state_change(thread_id_type const& thrd, thread_schedule_state newstate,
+                thread_restart_state newstate_ex, execution::thread_priority priority,
+                execution::thread_schedule_hint schedulehint, bool retry_on_active)
+              : timer_wheel_entry(&timed_state_change::on_expired, true)
+              , thrd_(thrd)
+              , newstate_(newstate)
+              , newstate_ex_(newstate_ex)
+              , priority_(priority)
+              , schedulehint_(schedulehint)
+              , retry_on_active_(retry_on_active)
+            {
+            }
+
+            static void on_expired(timer_wheel_entry& entry, bool fired) noexcept
+            {
+                std::unique_ptr<timed_state_change> change(
+                    static_cast<timed_state_change*>(&entry));
+
+                // The timer wheel is stopped before the scheduler of the
+                // thread is destroyed, the thread will not run anymore
+                if (!fired)
+                {
+                    change->thrd_.reset();
+                    return;
+                }
+
+                error_code ec(throwmode::lightweight);    // do not throw
+                set_thread_state(change->thrd_.noref(), change->newstate_, change->newstate_ex_,
+                    change->priority_, change->schedulehint_, change->retry_on_active_, ec);
+            }
+
+            thread_id_ref_type thrd_;
+            thread_schedule_state newstate_;
+            thread_restart_state newstate_ex_;
+            execution::thread_priority priority_;
+            execution::thread_schedule_hint schedulehint_;
+            bool retry_on_active_;
+        };
+    }    // namespace
+
     /// Set a timer to set the state of the given \a thread to the given
     /// new value after it expired (at the given time)
     thread_id_ref_type set_thread_state_timed(scheduler_base* scheduler,
@@ -161,16 +156,19 @@ namespace pika::threads::detail {
             return invalid_thread_id;
         }
 
-        // this creates a new thread which creates the timer and handles the
-        // requested actions
-        thread_init_data data(
-            util::detail::bind(&at_timer, scheduler, abs_time.value(), thread_id_ref_type(thrd),
-                newstate, newstate_ex, priority, started, retry_on_active),
-            "at_timer (expire at)", priority, schedulehint, execution::thread_stacksize::small_,
-            thread_schedule_state::pending, true);
-
-        thread_id_ref_type newid = invalid_thread_id;
-        create_thread(scheduler, data, newid, ec);    //-V601
-        return newid;
+        auto change = std::make_unique<timed_state_change>(
+            thrd, newstate, newstate_ex, priority, schedulehint, retry_on_active);
+        scheduler->get_timer_wheel().schedule(*change, abs_time.value());
+        change.release();
+
+        if (started != nullptr)
+        {
+            started->store(true);
+        }
+
+        if (&ec != &throws)
+            ec = make_success_code();
+
+        return invalid_thread_id;
     }
 }    // namespace pika::threads::detail
@@ -424,14 +424,9 @@ namespace pika::this_thread {
 #ifdef PIKA_HAVE_THREAD_BACKTRACE_ON_SUSPENSION
             threads::detail::reset_backtrace bt(id, ec);
 #endif
-            std::atomic<bool> timer_started(false);
-            threads::detail::thread_id_ref_type timer_id =
-                threads::detail::set_thread_state(id.noref(), abs_time, &timer_started,
-                    threads::detail::thread_schedule_state::pending,
-                    threads::detail::thread_restart_state::timeout,
-                    execution::thread_priority::boost, true, ec);
-            if (ec)
-                return threads::detail::thread_restart_state::unknown;
+            // resume this thread once abs_time has passed, the timer is
+            // cancelled if the thread is resumed before
+            threads::detail::thread_timeout timeout(id.noref(), abs_time);
 
             // We might need to dispatch 'nextid' to it's correct scheduler
             // only if our current scheduler is the same, we should yield the id
@@ -450,19 +445,6 @@ namespace pika::this_thread {
                 statex = self.yield(threads::detail::thread_result_type(
                     threads::detail::thread_schedule_state::suspended, PIKA_MOVE(nextid)));
             }
-
-            if (statex != threads::detail::thread_restart_state::timeout)
-            {
-                PIKA_ASSERT(statex == threads::detail::thread_restart_state::abort ||
-                    statex == threads::detail::thread_restart_state::signaled);
-                error_code ec1(throwmode::lightweight);    // do not throw
-                pika::util::yield_while(
-                    [&timer_started]() { return !timer_started.load(); }, "set_thread_state_timed");
-                threads::detail::set_thread_state(timer_id.noref(),
-                    threads::detail::thread_schedule_state::pending,
-                    threads::detail::thread_restart_state::abort, execution::thread_priority::boost,
-                    true, ec1);
-            }
         }
 
         // handle interruption, if needed
@@ -15,6 +15,7 @@
 #include <pika/timing/detail/timestamp.hpp>
 #include <pika/topology/topology.hpp>
 
+#include <algorithm>
 #include <chrono>
 #include <cstddef>
 #include <cstdint>
@@ -23,6 +24,7 @@
 #include <ostream>
 #include <string>
 #include <thread>
+#include <vector>
 
 namespace pika::threads::detail {
     ///////////////////////////////////////////////////////////////////////////
@@ -56,6 +58,72 @@ namespace pika::threads::detail {
         return used_processing_units;
     }
 
+    std::shared_ptr<std::vector<std::vector<std::size_t>> const>
+    thread_pool_base::get_steal_orders() const
+    {
+        std::lock_guard<std::mutex> l(steal_order_mtx_);
+        if (!steal_order_)
+        {
+            auto const& topo = create_topology();
+            std::size_t const num_threads = get_os_thread_count();
+
+            std::vector<std::size_t> pu_nums(num_threads);
+            std::vector<bool> suspended(num_threads);
+            for (std::size_t i = 0; i != num_threads; ++i)
+            {
+                pu_nums[i] = affinity_data_.get_pu_num(i + get_thread_offset());
+                suspended[i] = get_scheduler()->get_state(i).load() > runtime_state::suspended;
+            }
+
+            // Smaller values mean that the worker threads share more of the
+            // memory hierarchy
+            auto distance = [&](std::size_t pu, std::size_t other_pu) {
+                if (topo.get_core_number(pu) == topo.get_core_number(other_pu))
+                    return 0;
+                if (topo.get_l3_cache_number(pu) == topo.get_l3_cache_number(other_pu))
+                    return 1;
+                if (topo.get_numa_node_number(pu) == topo.get_numa_node_number(other_pu))
+                    return 2;
+                if (topo.get_socket_number(pu) == topo.get_socket_number(other_pu))
+                    return 3;
+                return 4;
+            };
+
+            std::vector<std::vector<std::size_t>> steal_order(num_threads);
+            std::vector<int> distances(num_threads);
+            for (std::size_t i = 0; i != num_threads; ++i)
+            {
+                auto& order = steal_order[i];
+                order.reserve(num_threads - 1);
+                for (std::size_t offset = 1; offset < num_threads; ++offset)
+                {
+                    std::size_t const other = (i + offset) % num_threads;
+                    distances[other] = distance(pu_nums[i], pu_nums[other]);
+                    order.push_back(other);
+                }
+
+                // The order is initially by increasing offset, the stable sort
+                // keeps that order within the same distance
+                std::stable_sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) {
+                    if (distances[a] != distances[b])
+                        return distances[a] < distances[b];
+                    return suspended[a] && !suspended[b];
+                });
+            }
+
+            steal_order_ = std::make_shared<std::vector<std::vector<std::size_t>> const>(
+                PIKA_MOVE(steal_order));
+        }
+
+        return steal_order_;
+    }
+
+    void thread_pool_base::invalidate_steal_order()
+    {
+        std::lock_guard<std::mutex> l(steal_order_mtx_);
+        steal_order_.reset();
+    }
+
     hwloc_bitmap_ptr thread_pool_base::get_numa_domain_bitmap() const
     {
         auto const& topo = create_topology();
@@ -0,0 +1,324 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#include <pika/assert.hpp>
+#include <pika/execution_base/this_thread.hpp>
+#include <pika/threading_base/detail/timer_wheel.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <utility>
+
+namespace pika::threads::detail {
+    timer_wheel::timer_wheel(std::chrono::nanoseconds resolution)
+      : start_(clock::now())
+      , resolution_(resolution)
+      , thread_(&timer_wheel::run, this)
+    {
+        PIKA_ASSERT(resolution_.count() > 0);
+    }
+
+    timer_wheel::~timer_wheel()
+    {
+        {
+            std::lock_guard<std::mutex> l(mtx_);
+            stop_ = true;
+        }
+        cond_.notify_one();
+        thread_.join();
+
+        // Entries that are still scheduled never fire
+        for (auto& level : slots_)
+        {
+            for (timer_wheel_entry*& slot : level)
+            {
+                timer_wheel_entry* entry = std::exchange(slot, nullptr);
+                while (entry != nullptr)
+                {
+                    timer_wheel_entry* next = entry->next_;
+                    entry->slot_ = nullptr;
+                    entry->prev_ = nullptr;
+                    entry->next_ = nullptr;
+                    entry->state_.store(timer_wheel_entry::state_firing, std::memory_order_relaxed);
+                    call_callback(*entry, false);
+                    entry = next;
+                }
+            }
+        }
+        size_ = 0;
+    }
+
+    void timer_wheel::call_callback(timer_wheel_entry& entry, bool fired) noexcept
+    {
+        // Detached entries may be destroyed by their callback
+        if (entry.detached_)
+        {
+            entry.state_.store(timer_wheel_entry::state_idle, std::memory_order_relaxed);
+            entry.callback_(entry, fired);
+            return;
+        }
+
+        entry.callback_(entry, fired);
+        entry.state_.store(timer_wheel_entry::state_idle, std::memory_order_release);
+    }
+
+    std::uint64_t timer_wheel::to_tick(clock::time_point t, bool round_up) const noexcept
+    {
+        if (t <= start_)
+        {
+            return 0;
+        }
+
+        auto const elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(t - start_);
+        auto const tick = static_cast<std::uint64_t>(elapsed.count() / resolution_.count());
+        return round_up && elapsed.count() % resolution_.count() != 0 ? tick + 1 : tick;
+    }
+
+    timer_wheel::clock::time_point timer_wheel::to_time_point(std::uint64_t tick) const noexcept
+    {
+        return start_ +
+            std::chrono::duration_cast<clock::duration>(
+                resolution_ * static_cast<std::chrono::nanoseconds::rep>(tick));
+    }
+
+    void timer_wheel::insert(timer_wheel_entry& entry) noexcept
+    {
+        // Entries that are due already go to the slot of the current tick.
+        // Entries that are further away than the top level covers go to the
+        // last slot of the top level and are placed again from there.
+        std::uint64_t expiry = entry.expiry_ < current_ ? current_ : entry.expiry_;
+        std::uint64_t const delta = expiry - current_;
+        if (delta >= level_span(num_levels))
+        {
+            expiry = current_ + level_span(num_levels) - 1;
+        }
+
+        std::size_t level = 0;
+        while (level + 1 != num_levels && delta >= level_span(level + 1))
+        {
+            ++level;
+        }
+
+        timer_wheel_entry** slot =
+            &slots_[level][(expiry >> (slot_bits * level)) & (num_slots - 1)];
+        entry.slot_ = slot;
+        entry.prev_ = nullptr;
+        entry.next_ = *slot;
+        if (*slot != nullptr)
+        {
+            (*slot)->prev_ = &entry;
+        }
+        *slot = &entry;
+    }
+
+    void timer_wheel::unlink(timer_wheel_entry& entry) noexcept
+    {
+        if (entry.prev_ != nullptr)
+        {
+            entry.prev_->next_ = entry.next_;
+        }
+        else
+        {
+            *entry.slot_ = entry.next_;
+        }
+
+        if (entry.next_ != nullptr)
+        {
+            entry.next_->prev_ = entry.prev_;
+        }
+
+        entry.slot_ = nullptr;
+        entry.prev_ = nullptr;
+        entry.next_ = nullptr;
+    }
+
+    std::uint64_t timer_wheel::next_tick() const noexcept
+    {
+        if (size_ == 0)
+        {
+            return no_tick;
+        }
+
+        // The first tick at which the first level has expired entries or at
+        // which a non-empty slot of a higher level has to be moved down
+        std::uint64_t result = no_tick;
+        for (std::size_t level = 0; level != num_levels; ++level)
+        {
+            std::size_t const shift = slot_bits * level;
+            std::uint64_t first = current_ >> shift;
+            if (level != 0 && (current_ & (level_span(level) - 1)) != 0)
+            {
+                ++first;
+            }
+
+            for (std::size_t i = 0; i != num_slots; ++i)
+            {
+                std::uint64_t const tick = (first + i) << shift;
+                if (tick >= result)
+                {
+                    break;
+                }
+
+                if (slots_[level][(first + i) & (num_slots - 1)] != nullptr)
+                {
+                    result = tick;
+                    break;
+                }
+            }
+        }
+
+        return result;
+    }
+
+    timer_wheel_entry* timer_wheel::advance(std::uint64_t now) noexcept
+    {
+        timer_wheel_entry* expired = nullptr;
+
+        for (std::uint64_t tick = next_tick(); tick != no_tick && tick <= now; tick = next_tick())
+        {
+            current_ = tick;
+
+            // Move the entries of the slots beginning at this tick down,
+            // starting from the highest level
+            for (std::size_t level = num_levels - 1; level != 0; --level)
+            {
+                if ((tick & (level_span(level) - 1)) != 0)
+                {
+                    continue;
+                }
+
+                timer_wheel_entry* entry = std::exchange(
+                    slots_[level][(tick >> (slot_bits * level)) & (num_slots - 1)], nullptr);
+                while (entry != nullptr)
+                {
+                    timer_wheel_entry* next = entry->next_;
+                    insert(*entry);
+                    entry = next;
+                }
+            }
+
+            timer_wheel_entry* entry = std::exchange(slots_[0][tick & (num_slots - 1)], nullptr);
+            while (entry != nullptr)
+            {
+                timer_wheel_entry* next = entry->next_;
+                entry->slot_ = nullptr;
+                entry->prev_ = nullptr;
+                entry->next_ = expired;
+                entry->state_.store(timer_wheel_entry::state_firing, std::memory_order_relaxed);
+                expired = entry;
+                --size_;
+                entry = next;
+            }
+
+            current_ = tick + 1;
+        }
+
+        // Nothing happens until now
+        if (current_ <= now)
+        {
+            current_ = now + 1;
+        }
+
+        return expired;
+    }
+
+    void timer_wheel::run()
+    {
+        std::unique_lock<std::mutex> l(mtx_);
+        while (!stop_)
+        {
+            timer_wheel_entry* expired = advance(to_tick(clock::now(), false));
+            if (expired != nullptr)
+            {
+                // Entries scheduled while the callbacks are called don't need
+                // to wake up the timer thread
+                wakeup_ = 0;
+                l.unlock();
+
+                while (expired != nullptr)
+                {
+                    timer_wheel_entry* next = expired->next_;
+                    expired->next_ = nullptr;
+                    call_callback(*expired, true);
+                    expired = next;
+                }
+
+                l.lock();
+                continue;
+            }
+
+            wakeup_ = next_tick();
+            if (wakeup_ == no_tick)
+            {
+                cond_.wait(l);
+            }
+            else
+            {
+                cond_.wait_until(l, to_time_point(wakeup_));
+            }
+        }
+    }
+
+    void timer_wheel::schedule(timer_wheel_entry& entry, clock::time_point deadline)
+    {
+        PIKA_ASSERT(
+            entry.state_.load(std::memory_order_relaxed) == timer_wheel_entry::state_idle);
+
+        bool notify = false;
+        {
+            std::lock_guard<std::mutex> l(mtx_);
+            entry.expiry_ = to_tick(deadline, true);
+            entry.state_.store(timer_wheel_entry::state_scheduled, std::memory_order_relaxed);
+            insert(entry);
+            ++size_;
+            notify = entry.expiry_ < wakeup_;
+        }
+
+        if (notify)
+        {
+            cond_.notify_one();
+        }
+    }
+
+    bool timer_wheel::cancel(timer_wheel_entry& entry) noexcept
+    {
+        {
+            std::lock_guard<std::mutex> l(mtx_);
+            if (entry.state_.load(std::memory_order_relaxed) ==
+                timer_wheel_entry::state_scheduled)
+            {
+                unlink(entry);
+                --size_;
+                entry.state_.store(timer_wheel_entry::state_idle, std::memory_order_relaxed);
+                return true;
+            }
+        }
+
+        // The callback of a detached entry may destroy the entry
+        if (entry.detached_)
+        {
+            return false;
+        }
+
+        // The callback may be running, wait for it to return
+        pika::util::yield_while(
+            [&entry]() {
+                return entry.state_.load(std::memory_order_acquire) ==
+                    timer_wheel_entry::state_firing;
+            },
+            "timer_wheel::cancel", false);
+        return false;
+    }
+
+    std::size_t timer_wheel::size() const
+    {
+        std::lock_guard<std::mutex> l(mtx_);
+        return size_;
+    }
+}    // namespace pika::threads::detail
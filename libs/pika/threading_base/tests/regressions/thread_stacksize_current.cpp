@@ -61,7 +61,8 @@ int pika_main()
 int main(int argc, char** argv)
 {
     std::vector<std::string> schedulers = {"local", "local-priority-fifo", "local-priority-lifo",
-        "static", "static-priority", "abp-priority-fifo", "abp-priority-lifo", "shared-priority"};
+        "local-priority-chase-lev", "static", "static-priority", "abp-priority-fifo",
+        "abp-priority-lifo", "shared-priority"};
     for (auto const& scheduler : schedulers)
     {
         pika::init_params iparams;
@@ -0,0 +1,150 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/init.hpp>
+#include <pika/latch.hpp>
+#include <pika/runtime.hpp>
+#include <pika/testing.hpp>
+#include <pika/threading_base/register_thread.hpp>
+#include <pika/threading_base/thread_init_data.hpp>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+using pika::threads::detail::make_thread_function_nullary;
+using pika::threads::detail::register_work_batch;
+using pika::threads::detail::thread_init_data;
+
+thread_init_data make_task(pika::latch& l, std::atomic<std::size_t>& count,
+    pika::execution::thread_priority priority = pika::execution::thread_priority::default_,
+    pika::execution::thread_schedule_hint hint = pika::execution::thread_schedule_hint())
+{
+    return thread_init_data(make_thread_function_nullary([&l, &count]() {
+        ++count;
+        l.count_down(1);
+    }),
+        "register_work_batch", priority, hint);
+}
+
+void test_round_robin(std::size_t num_tasks)
+{
+    pika::latch l(static_cast<std::ptrdiff_t>(num_tasks + 1));
+    std::atomic<std::size_t> count{0};
+
+    std::vector<thread_init_data> data;
+    for (std::size_t i = 0; i != num_tasks; ++i)
+    {
+        data.push_back(make_task(l, count));
+    }
+
+    register_work_batch(
+        data.data(), data.size(), pika::threads::detail::get_self_or_default_pool());
+
+    l.arrive_and_wait();
+    PIKA_TEST_EQ(count.load(), num_tasks);
+}
+
+void test_mixed(std::size_t num_tasks)
+{
+    // Hints and priorities other than normal use the generic path of the
+    // scheduler
+    std::size_t const num_threads = pika::get_num_worker_threads();
+    pika::latch l(static_cast<std::ptrdiff_t>(num_tasks + 1));
+    std::atomic<std::size_t> count{0};
+
+    std::vector<thread_init_data> data;
+    for (std::size_t i = 0; i != num_tasks; ++i)
+    {
+        switch (i % 3)
+        {
+        case 0:
+            data.push_back(make_task(l, count));
+            break;
+        case 1:
+            data.push_back(make_task(l, count, pika::execution::thread_priority::high));
+            break;
+        default:
+            data.push_back(make_task(l, count, pika::execution::thread_priority::default_,
+                pika::execution::thread_schedule_hint(static_cast<std::int16_t>(i % num_threads))));
+            break;
+        }
+    }
+
+    register_work_batch(
+        data.data(), data.size(), pika::threads::detail::get_self_or_default_pool());
+
+    l.arrive_and_wait();
+    PIKA_TEST_EQ(count.load(), num_tasks);
+}
+
+void test_generator(std::size_t num_tasks)
+{
+    pika::latch l(static_cast<std::ptrdiff_t>(num_tasks + 1));
+    std::atomic<std::size_t> count{0};
+    std::vector<std::atomic<bool>> called(num_tasks);
+
+    register_work_batch(
+        num_tasks,
+        [&](std::size_t i) {
+            return thread_init_data(make_thread_function_nullary([&, i]() {
+                PIKA_TEST(!called[i].exchange(true));
+                ++count;
+                l.count_down(1);
+            }),
+                "register_work_batch_generator");
+        },
+        pika::threads::detail::get_self_or_default_pool());
+
+    l.arrive_and_wait();
+    PIKA_TEST_EQ(count.load(), num_tasks);
+    for (auto const& c : called)
+    {
+        PIKA_TEST(c.load());
+    }
+}
+
+void test_unsupported_initial_state(pika::threads::detail::thread_schedule_state state)
+{
+    std::vector<thread_init_data> data;
+    data.emplace_back(make_thread_function_nullary([]() { PIKA_TEST(false); }),
+        "register_work_batch_unsupported", pika::execution::thread_priority::default_,
+        pika::execution::thread_schedule_hint(), pika::execution::thread_stacksize::default_,
+        state);
+
+    pika::error_code ec(pika::throwmode::lightweight);
+    register_work_batch(
+        data.data(), data.size(), pika::threads::detail::get_self_or_default_pool(), ec);
+    PIKA_TEST(ec);
+    PIKA_TEST(ec.value() == static_cast<int>(pika::error::bad_parameter));
+}
+
+int pika_main()
+{
+    for (std::size_t num_tasks : {1, 3, 100, 1000})
+    {
+        test_round_robin(num_tasks);
+        test_mixed(num_tasks);
+        test_generator(num_tasks);
+    }
+
+    // More than one batch of the generator overload
+    test_generator(1000 + 7);
+
+    test_unsupported_initial_state(pika::threads::detail::thread_schedule_state::suspended);
+    test_unsupported_initial_state(
+        pika::threads::detail::thread_schedule_state::pending_do_not_schedule);
+    test_unsupported_initial_state(pika::threads::detail::thread_schedule_state::pending_boost);
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    PIKA_TEST_EQ(pika::init(pika_main, argc, argv), 0);
+    return 0;
+}
@@ -0,0 +1,216 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#include <pika/config.hpp>
+#include <pika/testing.hpp>
+#include <pika/threading_base/detail/timer_wheel.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <random>
+#include <thread>
+#include <vector>
+
+using pika::threads::detail::timer_wheel;
+using pika::threads::detail::timer_wheel_entry;
+using clock_type = timer_wheel::clock;
+
+struct test_entry : timer_wheel_entry
+{
+    test_entry()
+      : timer_wheel_entry(&test_entry::on_expired)
+    {
+    }
+
+    static void on_expired(timer_wheel_entry& entry, bool fired) noexcept
+    {
+        auto& e = static_cast<test_entry&>(entry);
+        e.fired_at = clock_type::now();
+        e.fired = fired;
+        ++e.count;
+    }
+
+    clock_type::time_point deadline;
+    clock_type::time_point fired_at;
+    bool fired = false;
+    std::atomic<int> count{0};
+};
+
+void wait_for_count(std::vector<test_entry>& entries)
+{
+    for (auto& e : entries)
+    {
+        while (e.count.load() == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+}
+
+void test_expiry()
+{
+    // With a resolution of one microsecond the deadlines span the first four
+    // levels of the wheel
+    timer_wheel wheel(std::chrono::microseconds(1));
+    std::mt19937 gen(42);
+    std::uniform_int_distribution<int> dist(-1000, 300000);
+
+    std::vector<test_entry> entries(500);
+    for (auto& e : entries)
+    {
+        e.deadline = clock_type::now() + std::chrono::microseconds(dist(gen));
+        wheel.schedule(e, e.deadline);
+    }
+
+    wait_for_count(entries);
+    PIKA_TEST_EQ(wheel.size(), std::size_t(0));
+
+    for (auto& e : entries)
+    {
+        PIKA_TEST_EQ(e.count.load(), 1);
+        PIKA_TEST(e.fired);
+        PIKA_TEST(e.fired_at >= e.deadline);
+        PIKA_TEST(!wheel.cancel(e));
+    }
+}
+
+void test_cancel()
+{
+    timer_wheel wheel;
+
+    std::vector<test_entry> entries(100);
+    for (std::size_t i = 0; i != entries.size(); ++i)
+    {
+        wheel.schedule(entries[i], clock_type::now() + std::chrono::seconds(10 + i));
+    }
+    PIKA_TEST_EQ(wheel.size(), entries.size());
+
+    // Cancel every other entry and schedule those again with a short deadline
+    for (std::size_t i = 0; i != entries.size(); i += 2)
+    {
+        PIKA_TEST(wheel.cancel(entries[i]));
+        wheel.schedule(entries[i], clock_type::now() + std::chrono::milliseconds(1));
+    }
+
+    for (std::size_t i = 0; i != entries.size(); i += 2)
+    {
+        while (entries[i].count.load() == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+
+    PIKA_TEST_EQ(wheel.size(), entries.size() / 2);
+    for (std::size_t i = 1; i < entries.size(); i += 2)
+    {
+        PIKA_TEST_EQ(entries[i].count.load(), 0);
+        PIKA_TEST(wheel.cancel(entries[i]));
+    }
+    PIKA_TEST_EQ(wheel.size(), std::size_t(0));
+}
+
+void test_cancel_concurrent()
+{
+    // Entries are either cancelled before their deadline or fire exactly once
+    timer_wheel wheel(std::chrono::microseconds(10));
+
+    for (int round = 0; round != 20; ++round)
+    {
+        std::vector<test_entry> entries(200);
+        for (std::size_t i = 0; i != entries.size(); ++i)
+        {
+            wheel.schedule(entries[i], clock_type::now() + std::chrono::microseconds(i * 5));
+        }
+
+        std::this_thread::sleep_for(std::chrono::microseconds(500));
+
+        for (auto& e : entries)
+        {
+            if (wheel.cancel(e))
+            {
+                PIKA_TEST_EQ(e.count.load(), 0);
+            }
+            else
+            {
+                PIKA_TEST_EQ(e.count.load(), 1);
+            }
+        }
+        PIKA_TEST_EQ(wheel.size(), std::size_t(0));
+    }
+}
+
+void test_destroy()
+{
+    // Entries still scheduled when the wheel is destroyed are called with
+    // fired set to false
+    std::vector<test_entry> entries(10);
+    {
+        timer_wheel wheel;
+        for (auto& e : entries)
+        {
+            wheel.schedule(e, clock_type::now() + std::chrono::hours(1));
+        }
+    }
+
+    for (auto& e : entries)
+    {
+        PIKA_TEST_EQ(e.count.load(), 1);
+        PIKA_TEST(!e.fired);
+    }
+}
+
+struct detached_entry : timer_wheel_entry
+{
+    explicit detached_entry(std::atomic<int>& count)
+      : timer_wheel_entry(&detached_entry::on_expired, true)
+      , count(count)
+    {
+    }
+
+    static void on_expired(timer_wheel_entry& entry, bool) noexcept
+    {
+        std::unique_ptr<detached_entry> e(static_cast<detached_entry*>(&entry));
+        ++e->count;
+    }
+
+    std::atomic<int>& count;
+};
+
+void test_detached()
+{
+    std::atomic<int> count{0};
+    {
+        timer_wheel wheel;
+        for (int i = 0; i != 10; ++i)
+        {
+            wheel.schedule(*new detached_entry(count), clock_type::now());
+        }
+        for (int i = 0; i != 10; ++i)
+        {
+            wheel.schedule(*new detached_entry(count), clock_type::now() + std::chrono::hours(1));
+        }
+
+        while (count.load() != 10)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+    PIKA_TEST_EQ(count.load(), 20);
+}
+
+int main()
+{
+    test_expiry();
+    test_cancel();
+    test_cancel_concurrent();
+    test_destroy();
+    test_detached();
+
+    return pika::detail::report_errors();
+}
@@ -18,6 +18,7 @@
 #include <cstddef>
 #include <iosfwd>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
 #include <vector>
@@ -95,9 +96,27 @@ namespace pika::threads::detail {
 
     struct PIKA_EXPORT topology
     {
+        /// \brief Discovers the topology of the machine, or loads it from the
+        ///        cache file given by the environment variable
+        ///        PIKA_TOPOLOGY_CACHE if it is set.
         topology();
+
+        /// \brief Discovers the topology of the machine, or loads it from
+        ///        the given cache file.
+        ///
+        /// The cache file contains the hwloc topology in XML form together
+        /// with the tables derived from it. It is only used if it was written
+        /// on the same host, for the same set of processing units the
+        /// process is allowed to run on, and by a compatible version of
+        /// hwloc and pika. Otherwise the topology is discovered and the cache
+        /// file is replaced. No cache is used if \a cache_file is empty.
+        explicit topology(std::string const& cache_file);
+
         ~topology();
 
+        topology(topology const&) = delete;
+        topology& operator=(topology const&) = delete;
+
         /// \brief Return the Socket number of the processing unit the
         ///        given thread is running on.
         ///
@@ -251,6 +270,14 @@ namespace pika::threads::detail {
             return core_numbers_[num_thread % num_of_pus_];
         }
 
+        /// \brief Return the number of the last level (L3) cache shared by the
+        ///        processing unit the given thread is running on. If the L3
+        ///        cache can't be determined this returns the socket number.
+        std::size_t get_l3_cache_number(std::size_t num_thread) const
+        {
+            return l3_cache_numbers_[num_thread % num_of_pus_];
+        }
+
         std::size_t get_pu_number(
             std::size_t num_core, std::size_t num_pu, error_code& ec = throws) const;
 
@@ -262,6 +289,12 @@ namespace pika::threads::detail {
 
         void write_to_log() const;
 
+        /// \brief Return whether the topology was loaded from a cache file
+        bool is_loaded_from_cache() const noexcept
+        {
+            return loaded_from_cache_;
+        }
+
         /// This is equivalent to malloc(), except that it tries to allocate
         /// page-aligned memory from the OS.
         void* allocate(std::size_t len) const;
@@ -314,6 +347,8 @@ namespace pika::threads::detail {
             return init_node_number(num_thread, use_pus_as_cores_ ? HWLOC_OBJ_PU : HWLOC_OBJ_CORE);
         }
 
+        std::size_t init_l3_cache_number(std::size_t num_thread);
+
         void extract_node_mask(hwloc_obj_t parent, mask_type& mask) const;
 
         std::size_t extract_node_count(
@@ -338,6 +373,15 @@ namespace pika::threads::detail {
 
         void init_num_of_pus();
 
+        void load_hwloc_topology(char const* xml, int xml_size);
+        void init_tables();
+        bool load_from_cache(std::string const& cache_file);
+        void save_to_cache(std::string const& cache_file) const;
+
+        // The socket affinity masks are rarely needed, they are computed on
+        // first use
+        std::vector<mask_type> const& get_socket_affinity_masks() const;
+
         hwloc_topology_t topo;
 
         static constexpr std::size_t pu_offset = 0;
@@ -345,6 +389,7 @@ namespace pika::threads::detail {
 
         std::size_t num_of_pus_;
         bool use_pus_as_cores_;
+        bool loaded_from_cache_;
 
         using mutex_type = pika::concurrency::detail::spinlock;
         mutable mutex_type topo_mtx;
@@ -357,6 +402,7 @@ namespace pika::threads::detail {
         std::vector<std::size_t> socket_numbers_;
         std::vector<std::size_t> numa_node_numbers_;
         std::vector<std::size_t> core_numbers_;
+        std::vector<std::size_t> l3_cache_numbers_;
 
         // Affinity masks: vectors of bitmasks
         // - Length of the vector: number of PUs of the machine
@@ -367,7 +413,8 @@ namespace pika::threads::detail {
         // elements = 1 indicate the PUs that belong to the core on which
         // PU #0 (zero-based index) lies.
         mask_type machine_affinity_mask_;
-        std::vector<mask_type> socket_affinity_masks_;
+        mutable std::once_flag socket_affinity_masks_initialized_;
+        mutable std::vector<mask_type> socket_affinity_masks_;
         std::vector<mask_type> numa_node_affinity_masks_;
         std::vector<mask_type> core_affinity_masks_;
         std::vector<mask_type> thread_affinity_masks_;
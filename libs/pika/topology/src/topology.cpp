@@ -18,10 +18,14 @@
 #include <pika/util/ios_flags_saver.hpp>
 
 #include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
 #include <iomanip>
 #include <iostream>
 #include <memory>
 #include <mutex>
+#include <sstream>
 #include <string>
 #include <thread>
 #include <vector>
@@ -51,6 +55,10 @@
 # include <unistd.h>
 #endif
 
+#if defined(__linux__) && !defined(__ANDROID__)
+# include <sched.h>
+#endif
+
 namespace pika::threads::detail {
     std::size_t hwloc_hardware_concurrency()
     {
@@ -193,10 +201,175 @@ namespace pika::threads::detail {
     mask_type topology::empty_mask = mask_type();
 #endif
 
+    ///////////////////////////////////////////////////////////////////////////
+    namespace {
+        constexpr char const* topology_cache_header = "pika-topology-cache 1";
+
+        std::string get_topology_cache_file()
+        {
+            char const* env = std::getenv("PIKA_TOPOLOGY_CACHE");
+            return env ? env : "";
+        }
+
+        // Identifies the machine and the processing units the process may run
+        // on. A cache file written with a different fingerprint is ignored.
+        std::string get_topology_cache_fingerprint()
+        {
+            std::ostringstream os;
+            os << "hwloc " << std::hex << hwloc_get_api_version() << std::dec << " mask_size "
+               << mask_size(mask_type());
+#if defined(PIKA_HAVE_ADDITIONAL_HWLOC_TESTING)
+            os << " no_cores";
+#endif
+#if defined(PIKA_HAVE_UNISTD_H)
+            char hostname[256] = {};
+            if (gethostname(hostname, sizeof(hostname) - 1) == 0)
+            {
+                os << " host " << hostname;
+            }
+#endif
+            os << " hardware_concurrency " << std::thread::hardware_concurrency();
+#if defined(__linux__) && !defined(__ANDROID__)
+            cpu_set_t cpuset;
+            CPU_ZERO(&cpuset);
+            if (sched_getaffinity(0, sizeof(cpuset), &cpuset) == 0)
+            {
+                os << " cpuset";
+                for (int i = 0; i != CPU_SETSIZE; ++i)
+                {
+                    if (CPU_ISSET(i, &cpuset))
+                        os << ' ' << i;
+                }
+            }
+#endif
+            return os.str();
+        }
+
+        void write_numbers(std::ostream& os, char const* name, std::vector<std::size_t> const& v)
+        {
+            os << name << ' ' << v.size();
+            for (std::size_t value : v)
+            {
+                os << ' ' << value;
+            }
+            os << '\n';
+        }
+
+        bool read_numbers(std::istream& is, char const* name, std::vector<std::size_t>& v)
+        {
+            std::string key;
+            std::size_t size = 0;
+            if (!(is >> key >> size) || key != name)
+                return false;
+
+            v.resize(size);
+            for (std::size_t& value : v)
+            {
+                if (!(is >> value))
+                    return false;
+            }
+            return true;
+        }
+
+        // Masks are stored as their size followed by the indices of the set
+        // bits, which is independent of the representation of mask_type
+        void write_mask(std::ostream& os, mask_cref_type mask)
+        {
+            os << mask_size(mask) << ' ' << count(mask);
+            for (std::size_t i = 0; i != mask_size(mask); ++i)
+            {
+                if (test(mask, i))
+                    os << ' ' << i;
+            }
+            os << '\n';
+        }
+
+        bool read_mask(std::istream& is, mask_type& mask)
+        {
+            std::size_t size = 0;
+            std::size_t num_bits = 0;
+            if (!(is >> size >> num_bits))
+                return false;
+
+            // fixed size masks can't be resized beyond their size
+            std::size_t const max_size = mask_size(mask_type());
+            if (max_size != 0 && size > max_size)
+                return false;
+
+            mask = mask_type();
+            resize(mask, size);
+            reset(mask);
+            for (std::size_t i = 0; i != num_bits; ++i)
+            {
+                std::size_t idx = 0;
+                if (!(is >> idx) || idx >= size || idx >= mask_size(mask))
+                    return false;
+                set(mask, idx);
+            }
+            return true;
+        }
+
+        void write_masks(std::ostream& os, char const* name, std::vector<mask_type> const& v)
+        {
+            os << name << ' ' << v.size() << '\n';
+            for (mask_cref_type mask : v)
+            {
+                write_mask(os, mask);
+            }
+        }
+
+        bool read_masks(std::istream& is, char const* name, std::vector<mask_type>& v)
+        {
+            std::string key;
+            std::size_t size = 0;
+            if (!(is >> key >> size) || key != name)
+                return false;
+
+            v.resize(size);
+            for (mask_type& mask : v)
+            {
+                if (!read_mask(is, mask))
+                    return false;
+            }
+            return true;
+        }
+    }    // namespace
+
     topology::topology()
+      : topology(get_topology_cache_file())
+    {
+    }
+
+    topology::topology(std::string const& cache_file)
       : topo(nullptr)
       , use_pus_as_cores_(false)
+      , loaded_from_cache_(false)
       , machine_affinity_mask_(0)
+    {
+        if (!cache_file.empty())
+        {
+            loaded_from_cache_ = load_from_cache(cache_file);
+            if (loaded_from_cache_)
+                return;
+
+            // discard whatever was loaded from an unusable cache file
+            if (topo)
+            {
+                hwloc_topology_destroy(topo);
+                topo = nullptr;
+            }
+        }
+
+        load_hwloc_topology(nullptr, 0);
+        init_tables();
+
+        if (!cache_file.empty())
+            save_to_cache(cache_file);
+    }
+
+    // Loads the topology of the machine, or the given XML topology if xml is
+    // not null
+    void topology::load_hwloc_topology(char const* xml, int xml_size)
     {    // {{{
         int err = hwloc_topology_init(&topo);
         if (err != 0)
@@ -219,18 +392,34 @@ namespace pika::threads::detail {
 # endif
 #endif
 
+        if (xml != nullptr)
+        {
+            // The XML topology describes this machine, which allows binding
+            // threads and memory with it
+            if (hwloc_topology_set_xmlbuffer(topo, xml, xml_size) != 0 ||
+                hwloc_topology_set_flags(topo, HWLOC_TOPOLOGY_FLAG_IS_THISSYSTEM) != 0)
+            {
+                PIKA_THROW_EXCEPTION(pika::error::no_success, "topology::topology",
+                    "Failed to set XML source of hwloc topology");
+            }
+        }
+
         err = hwloc_topology_load(topo);
         if (err != 0)
         {
             PIKA_THROW_EXCEPTION(
                 pika::error::no_success, "topology::topology", "Failed to load hwloc topology");
         }
+    }    // }}}
 
+    void topology::init_tables()
+    {    // {{{
         init_num_of_pus();
 
         socket_numbers_.reserve(num_of_pus_);
         numa_node_numbers_.reserve(num_of_pus_);
         core_numbers_.reserve(num_of_pus_);
+        l3_cache_numbers_.reserve(num_of_pus_);
 
         // Initialize each set of data entirely, as some of the initialization
         // routines rely on access to other pieces of topology data. The
@@ -269,17 +458,16 @@ namespace pika::threads::detail {
             core_numbers_.push_back(core_number);
         }
 
+        for (std::size_t i = 0; i < num_of_pus_; ++i)
+        {
+            l3_cache_numbers_.push_back(init_l3_cache_number(i));
+        }
+
         machine_affinity_mask_ = init_machine_affinity_mask();
-        socket_affinity_masks_.reserve(num_of_pus_);
         numa_node_affinity_masks_.reserve(num_of_pus_);
         core_affinity_masks_.reserve(num_of_pus_);
         thread_affinity_masks_.reserve(num_of_pus_);
 
-        for (std::size_t i = 0; i < num_of_pus_; ++i)
-        {
-            socket_affinity_masks_.push_back(init_socket_affinity_mask(i));
-        }
-
         for (std::size_t i = 0; i < num_of_pus_; ++i)
         {
             numa_node_affinity_masks_.push_back(init_numa_node_affinity_mask(i));
@@ -296,6 +484,155 @@ namespace pika::threads::detail {
         }
     }    // }}}
 
+
+    bool topology::load_from_cache(std::string const& cache_file)
+    {    // {{{
+        std::ifstream is(cache_file, std::ios::binary);
+        if (!is)
+            return false;
+
+        std::string header;
+        std::string fingerprint;
+        if (!std::getline(is, header) || header != topology_cache_header ||
+            !std::getline(is, fingerprint) || fingerprint != get_topology_cache_fingerprint())
+        {
+            return false;
+        }
+
+        std::string key;
+        std::size_t num_of_pus = 0;
+        bool use_pus_as_cores = false;
+        if (!(is >> key >> num_of_pus) || key != "num_of_pus" ||
+            !(is >> key >> use_pus_as_cores) || key != "use_pus_as_cores")
+        {
+            return false;
+        }
+
+        std::vector<std::size_t> socket_numbers, numa_node_numbers, core_numbers,
+            l3_cache_numbers;
+        mask_type machine_affinity_mask;
+        std::vector<mask_type> numa_node_affinity_masks, core_affinity_masks,
+            thread_affinity_masks;
+        if (!read_numbers(is, "socket_numbers", socket_numbers) ||
+            !read_numbers(is, "numa_node_numbers", numa_node_numbers) ||
+            !read_numbers(is, "core_numbers", core_numbers) ||
+            !read_numbers(is, "l3_cache_numbers", l3_cache_numbers) ||
+            !(is >> key) || key != "machine_affinity_mask" ||
+            !read_mask(is, machine_affinity_mask) ||
+            !read_masks(is, "numa_node_affinity_masks", numa_node_affinity_masks) ||
+            !read_masks(is, "core_affinity_masks", core_affinity_masks) ||
+            !read_masks(is, "thread_affinity_masks", thread_affinity_masks))
+        {
+            return false;
+        }
+
+        int xml_size = 0;
+        if (!(is >> key >> xml_size) || key != "xml" || xml_size <= 0 || is.get() != '\n')
+            return false;
+
+        std::string xml(static_cast<std::size_t>(xml_size), '\0');
+        if (!is.read(xml.data(), xml_size))
+            return false;
+
+        try
+        {
+            load_hwloc_topology(xml.data(), xml_size);
+        }
+        catch (...)
+        {
+            return false;
+        }
+
+        // The tables have to match the topology they were derived from
+        init_num_of_pus();
+        for (auto size : {socket_numbers.size(), numa_node_numbers.size(), core_numbers.size(),
+                 l3_cache_numbers.size(), numa_node_affinity_masks.size(),
+                 core_affinity_masks.size(), thread_affinity_masks.size()})
+        {
+            if (size != num_of_pus)
+                return false;
+        }
+        if (num_of_pus_ != num_of_pus || use_pus_as_cores_ != use_pus_as_cores)
+            return false;
+
+        socket_numbers_ = PIKA_MOVE(socket_numbers);
+        numa_node_numbers_ = PIKA_MOVE(numa_node_numbers);
+        core_numbers_ = PIKA_MOVE(core_numbers);
+        l3_cache_numbers_ = PIKA_MOVE(l3_cache_numbers);
+        machine_affinity_mask_ = PIKA_MOVE(machine_affinity_mask);
+        numa_node_affinity_masks_ = PIKA_MOVE(numa_node_affinity_masks);
+        core_affinity_masks_ = PIKA_MOVE(core_affinity_masks);
+        thread_affinity_masks_ = PIKA_MOVE(thread_affinity_masks);
+
+        return true;
+    }    // }}}
+
+    // Failing to write the cache is not an error, the topology is discovered
+    // again the next time. The file is written under a temporary name and
+    // renamed to make sure that concurrently starting processes never read a
+    // partially written cache file.
+    void topology::save_to_cache(std::string const& cache_file) const
+    {    // {{{
+        char* xml = nullptr;
+        int xml_size = 0;
+#if HWLOC_API_VERSION >= 0x00020000
+        if (hwloc_topology_export_xmlbuffer(topo, &xml, &xml_size, 0) != 0)
+#else
+        if (hwloc_topology_export_xmlbuffer(topo, &xml, &xml_size) != 0)
+#endif
+        {
+            return;
+        }
+
+        std::string tmp_file = cache_file + ".tmp";
+#if defined(PIKA_HAVE_UNISTD_H)
+        tmp_file += std::to_string(getpid());
+#endif
+
+        bool success = false;
+        {
+            std::ofstream os(tmp_file, std::ios::binary | std::ios::trunc);
+            if (os)
+            {
+                os << topology_cache_header << '\n'
+                   << get_topology_cache_fingerprint() << '\n'
+                   << "num_of_pus " << num_of_pus_ << '\n'
+                   << "use_pus_as_cores " << use_pus_as_cores_ << '\n';
+                write_numbers(os, "socket_numbers", socket_numbers_);
+                write_numbers(os, "numa_node_numbers", numa_node_numbers_);
+                write_numbers(os, "core_numbers", core_numbers_);
+                write_numbers(os, "l3_cache_numbers", l3_cache_numbers_);
+                os << "machine_affinity_mask ";
+                write_mask(os, machine_affinity_mask_);
+                write_masks(os, "numa_node_affinity_masks", numa_node_affinity_masks_);
+                write_masks(os, "core_affinity_masks", core_affinity_masks_);
+                write_masks(os, "thread_affinity_masks", thread_affinity_masks_);
+                os << "xml " << xml_size << '\n';
+                os.write(xml, xml_size);
+                os.close();
+                success = !os.fail();
+            }
+        }
+        hwloc_free_xmlbuffer(topo, xml);
+
+        if (!success || std::rename(tmp_file.c_str(), cache_file.c_str()) != 0)
+        {
+            std::remove(tmp_file.c_str());
+        }
+    }    // }}}
+
+    std::vector<mask_type> const& topology::get_socket_affinity_masks() const
+    {
+        std::call_once(socket_affinity_masks_initialized_, [this] {
+            socket_affinity_masks_.reserve(num_of_pus_);
+            for (std::size_t i = 0; i < num_of_pus_; ++i)
+            {
+                socket_affinity_masks_.push_back(init_socket_affinity_mask(i));
+            }
+        });
+        return socket_affinity_masks_;
+    }
+
     void topology::write_to_log() const
     {
         std::size_t num_of_sockets = get_number_of_sockets();
@@ -314,14 +651,16 @@ namespace pika::threads::detail {
         detail::write_to_log("num_of_cores", num_of_cores);
 
         detail::write_to_log("num_of_pus", num_of_pus_);
+        detail::write_to_log("loaded_from_cache", std::size_t(loaded_from_cache_));
 
         detail::write_to_log("socket_number", socket_numbers_);
         detail::write_to_log("numa_node_number", numa_node_numbers_);
         detail::write_to_log("core_number", core_numbers_);
+        detail::write_to_log("l3_cache_number", l3_cache_numbers_);
 
         detail::write_to_log_mask("machine_affinity_mask", machine_affinity_mask_);
 
-        detail::write_to_log_mask("socket_affinity_mask", socket_affinity_masks_);
+        detail::write_to_log_mask("socket_affinity_mask", get_socket_affinity_masks());
         detail::write_to_log_mask("numa_node_affinity_mask", numa_node_affinity_masks_);
         detail::write_to_log_mask("core_affinity_mask", core_affinity_masks_);
         detail::write_to_log_mask("thread_affinity_mask", thread_affinity_masks_);
@@ -388,12 +727,13 @@ namespace pika::threads::detail {
     {    // {{{
         std::size_t num_pu = num_thread % num_of_pus_;
 
-        if (num_pu < socket_affinity_masks_.size())
+        std::vector<mask_type> const& socket_affinity_masks = get_socket_affinity_masks();
+        if (num_pu < socket_affinity_masks.size())
         {
             if (&ec != &throws)
                 ec = make_success_code();
 
-            return socket_affinity_masks_[num_pu];
+            return socket_affinity_masks[num_pu];
         }
 
         PIKA_THROWS_IF(ec, pika::error::bad_parameter,
@@ -595,6 +935,17 @@ namespace pika::threads::detail {
 #endif
     }
 
+    std::size_t topology::init_l3_cache_number(std::size_t num_thread)
+    {
+#if HWLOC_API_VERSION >= 0x00020000
+        if (hwloc_get_nbobjs_by_type(topo, HWLOC_OBJ_L3CACHE) > 0)
+        {
+            return init_node_number(num_thread, HWLOC_OBJ_L3CACHE);
+        }
+#endif
+        return get_socket_number(num_thread);
+    }
+
     std::size_t topology::init_node_number(std::size_t num_thread, hwloc_obj_type_t type)
     {    // {{{
         if (std::size_t(-1) == num_thread)
@@ -1485,7 +1836,7 @@ namespace pika::threads::detail {
            << pika::threads::detail::to_string(machine_affinity_mask_) << "\n";
 
         os << "socket                : \n";
-        print_mask_vector(os, socket_affinity_masks_);
+        print_mask_vector(os, get_socket_affinity_masks());
         os << "numa node             : \n";
         print_mask_vector(os, numa_node_affinity_masks_);
         os << "core                  : \n";
@@ -1501,6 +1852,8 @@ namespace pika::threads::detail {
         print_vector(os, numa_node_numbers_);
         os << "core                  : \n";
         print_vector(os, core_numbers_);
+        os << "l3 cache              : \n";
+        print_vector(os, l3_cache_numbers_);
         //os << "PUs (/threads)        : \n";
         //print_vector(os, pu_numbers_);
     }
@@ -0,0 +1,92 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// A topology loaded from a cache file must be the same as the discovered
+// one, and unusable cache files must be replaced.
+
+#include <pika/config.hpp>
+#include <pika/testing.hpp>
+#include <pika/topology/cpu_mask.hpp>
+#include <pika/topology/topology.hpp>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using pika::threads::detail::topology;
+
+void check_equal(topology const& expected, topology const& t)
+{
+    using pika::threads::detail::equal;
+
+    PIKA_TEST_EQ(expected.get_number_of_pus(), t.get_number_of_pus());
+    PIKA_TEST_EQ(expected.get_number_of_cores(), t.get_number_of_cores());
+    PIKA_TEST_EQ(expected.get_number_of_numa_nodes(), t.get_number_of_numa_nodes());
+    PIKA_TEST_EQ(expected.get_number_of_sockets(), t.get_number_of_sockets());
+    PIKA_TEST(equal(expected.get_machine_affinity_mask(), t.get_machine_affinity_mask()));
+
+    for (std::size_t pu = 0; pu != expected.get_number_of_pus(); ++pu)
+    {
+        PIKA_TEST_EQ(expected.get_socket_number(pu), t.get_socket_number(pu));
+        PIKA_TEST_EQ(expected.get_numa_node_number(pu), t.get_numa_node_number(pu));
+        PIKA_TEST_EQ(expected.get_core_number(pu), t.get_core_number(pu));
+        PIKA_TEST_EQ(expected.get_l3_cache_number(pu), t.get_l3_cache_number(pu));
+        PIKA_TEST(
+            equal(expected.get_socket_affinity_mask(pu), t.get_socket_affinity_mask(pu)));
+        PIKA_TEST(equal(
+            expected.get_numa_node_affinity_mask(pu), t.get_numa_node_affinity_mask(pu)));
+        PIKA_TEST(equal(expected.get_core_affinity_mask(pu), t.get_core_affinity_mask(pu)));
+        PIKA_TEST(
+            equal(expected.get_thread_affinity_mask(pu), t.get_thread_affinity_mask(pu)));
+    }
+}
+
+int main()
+{
+    std::string const cache_file = (std::filesystem::temp_directory_path() /
+        ("pika_topology_cache_test_" +
+            std::to_string(std::chrono::steady_clock::now().time_since_epoch().count())))
+                                       .string();
+    std::remove(cache_file.c_str());
+
+    topology const discovered{std::string()};
+    PIKA_TEST(!discovered.is_loaded_from_cache());
+
+    // The first topology writes the cache file, the second one reads it
+    {
+        topology const t(cache_file);
+        PIKA_TEST(!t.is_loaded_from_cache());
+        check_equal(discovered, t);
+    }
+    {
+        topology const t(cache_file);
+        PIKA_TEST(t.is_loaded_from_cache());
+        check_equal(discovered, t);
+    }
+
+    // A cache file written on a different machine is ignored and replaced
+    {
+        std::ofstream os(cache_file, std::ios::trunc);
+        os << "pika-topology-cache 1\nhwloc 0 host elsewhere\n";
+    }
+    {
+        topology const t(cache_file);
+        PIKA_TEST(!t.is_loaded_from_cache());
+        check_equal(discovered, t);
+    }
+    {
+        topology const t(cache_file);
+        PIKA_TEST(t.is_loaded_from_cache());
+        check_equal(discovered, t);
+    }
+
+    std::remove(cache_file.c_str());
+
+    return pika::detail::report_errors();
+}
@@ -0,0 +1,226 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark compares ways of limiting the number of tasks in flight
+// while a single producer submits tasks as fast as it can:
+//
+// - limiting_executor: the producer spins in yield_while when the limit is
+//   reached, until the number of tasks in flight drops below the limit.
+// - acquire: the producer waits for admission with
+//   sync_wait(limiter.acquire()), which suspends it until a task releases
+//   its admission.
+// - limiting_scheduler: the producer never waits, tasks that are not
+//   admitted wait in the queue of the limiter.
+//
+// The benchmark reports the throughput, the admission latency of the tasks,
+// from their submission to the start of their execution, and the largest
+// number of tasks waiting in the queue of the limiter.
+
+#include <pika/execution.hpp>
+#include <pika/executors/admission_limiter.hpp>
+#include <pika/executors/limiting_executor.hpp>
+#include <pika/executors/limiting_scheduler.hpp>
+#include <pika/init.hpp>
+#include <pika/latch.hpp>
+#include <pika/modules/timing.hpp>
+
+#include <fmt/ostream.h>
+#include <fmt/printf.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace ex = pika::execution::experimental;
+namespace tt = pika::this_thread::experimental;
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+using clock_type = std::chrono::steady_clock;
+
+///////////////////////////////////////////////////////////////////////////////
+struct latency_statistics
+{
+    std::atomic<std::int64_t> total_ns{0};
+    std::atomic<std::int64_t> max_ns{0};
+
+    void record(clock_type::time_point submit_time)
+    {
+        std::int64_t const ns =
+            std::chrono::duration_cast<std::chrono::nanoseconds>(clock_type::now() - submit_time)
+                .count();
+        total_ns.fetch_add(ns, std::memory_order_relaxed);
+        std::int64_t m = max_ns.load(std::memory_order_relaxed);
+        while (ns > m && !max_ns.compare_exchange_weak(m, ns, std::memory_order_relaxed))
+        {
+        }
+    }
+};
+
+void busy_work(std::chrono::microseconds work)
+{
+    auto const end = clock_type::now() + work;
+    while (clock_type::now() < end)
+    {
+    }
+}
+
+struct result
+{
+    double elapsed = 0.0;
+    std::size_t max_queue_depth = 0;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+result bench_limiting_executor(std::size_t tasks, std::size_t limit,
+    std::chrono::microseconds work, latency_statistics& latency)
+{
+    pika::execution::parallel_executor exec;
+    pika::execution::experimental::limiting_executor<pika::execution::parallel_executor> lexec(
+        exec, limit, limit);
+    pika::latch l(static_cast<std::ptrdiff_t>(tasks + 1));
+
+    pika::chrono::detail::high_resolution_timer timer;
+    for (std::size_t i = 0; i != tasks; ++i)
+    {
+        // The submission time includes the time spent waiting in post
+        lexec.post([&, submit_time = clock_type::now()] {
+            latency.record(submit_time);
+            busy_work(work);
+            l.count_down(1);
+        });
+    }
+    l.arrive_and_wait();
+
+    return {timer.elapsed(), 0};
+}
+
+result bench_acquire(std::size_t tasks, std::size_t limit, std::chrono::microseconds work,
+    latency_statistics& latency)
+{
+    ex::thread_pool_scheduler sched{};
+    ex::admission_limiter limiter(limit);
+    pika::latch l(static_cast<std::ptrdiff_t>(tasks + 1));
+
+    pika::chrono::detail::high_resolution_timer timer;
+    for (std::size_t i = 0; i != tasks; ++i)
+    {
+        auto const submit_time = clock_type::now();
+        tt::sync_wait(limiter.acquire());
+        ex::start_detached(ex::schedule(sched) | ex::then([&, submit_time] {
+            latency.record(submit_time);
+            busy_work(work);
+            limiter.release();
+            l.count_down(1);
+        }));
+    }
+    l.arrive_and_wait();
+
+    return {timer.elapsed(), limiter.get_statistics().max_queue_depth};
+}
+
+result bench_limiting_scheduler(std::size_t tasks, std::size_t limit,
+    std::chrono::microseconds work, latency_statistics& latency)
+{
+    ex::admission_limiter limiter(limit);
+    ex::limiting_scheduler sched{ex::thread_pool_scheduler{}, limiter};
+    pika::latch l(static_cast<std::ptrdiff_t>(tasks + 1));
+
+    pika::chrono::detail::high_resolution_timer timer;
+    for (std::size_t i = 0; i != tasks; ++i)
+    {
+        ex::start_detached(ex::schedule(sched) | ex::then([&, submit_time = clock_type::now()] {
+            latency.record(submit_time);
+            busy_work(work);
+            l.count_down(1);
+        }));
+    }
+    l.arrive_and_wait();
+    double const elapsed = timer.elapsed();
+
+    // The last tasks are released after they count down the latch
+    while (limiter.get_statistics().in_flight != 0)
+    {
+        pika::this_thread::yield();
+    }
+
+    return {elapsed, limiter.get_statistics().max_queue_depth};
+}
+
+///////////////////////////////////////////////////////////////////////////////
+template <typename F>
+void bench(std::string const& name, F&& f, std::size_t tasks, std::size_t limit,
+    std::chrono::microseconds work, std::uint64_t repetitions)
+{
+    result total;
+    latency_statistics latency;
+
+    for (std::uint64_t r = 0; r != repetitions; ++r)
+    {
+        result const res = f(tasks, limit, work, latency);
+        total.elapsed += res.elapsed;
+        total.max_queue_depth = (std::max)(total.max_queue_depth, res.max_queue_depth);
+    }
+
+    double const n = static_cast<double>(tasks * repetitions);
+    fmt::print(std::cout, "{},{},{},{},{},{:.0f},{:.2f},{:.2f},{}\n", name,
+        pika::get_os_thread_count(), tasks, limit, work.count(), n / total.elapsed,
+        static_cast<double>(latency.total_ns.load()) / n / 1e3,
+        static_cast<double>(latency.max_ns.load()) / 1e3, total.max_queue_depth);
+}
+
+int pika_main(variables_map& vm)
+{
+    std::size_t const tasks = vm["tasks"].as<std::size_t>();
+    std::uint64_t const repetitions = vm["repetitions"].as<std::uint64_t>();
+    std::chrono::microseconds const work{vm["work"].as<std::uint64_t>()};
+
+    if (!vm.count("no-header"))
+    {
+        std::cout << "implementation,threads,tasks,limit,work per task [us],"
+                     "throughput [tasks/s],mean admission latency [us],"
+                     "max admission latency [us],max queue depth\n";
+    }
+
+    for (std::size_t limit : vm["limits"].as<std::vector<std::size_t>>())
+    {
+        bench("limiting_executor", bench_limiting_executor, tasks, limit, work, repetitions);
+        bench("acquire", bench_acquire, tasks, limit, work, repetitions);
+        bench("limiting_scheduler", bench_limiting_scheduler, tasks, limit, work, repetitions);
+    }
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("tasks", value<std::size_t>()->default_value(10000),
+         "number of tasks submitted per repetition")
+        ("limits", value<std::vector<std::size_t>>()->multitoken()->default_value(
+             std::vector<std::size_t>{4, 64}, "4 64"),
+         "maximum numbers of tasks in flight")
+        ("work", value<std::uint64_t>()->default_value(10),
+         "time spent busy waiting in each task in microseconds")
+        ("repetitions", value<std::uint64_t>()->default_value(3),
+         "number of times each measurement is repeated")
+        ("no-header", "do not print out the csv header row");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}
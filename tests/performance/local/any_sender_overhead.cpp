@@ -0,0 +1,179 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark measures the cost of building, connecting, and starting a
+// chain of then senders where every stage is type-erased with a
+// unique_any_sender, for a few sizes of the embedded storage of the
+// unique_any_sender. Besides the time per chain and per stage it reports the
+// number of calls to the global operator new per chain, which should be zero
+// once the size-class pool used for senders and operation states that don't
+// fit in the embedded storage has been filled. Everything runs inline on the
+// calling thread without the pika runtime.
+
+#include <pika/execution.hpp>
+#include <pika/modules/program_options.hpp>
+#include <pika/modules/timing.hpp>
+
+#include <fmt/ostream.h>
+#include <fmt/printf.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <iostream>
+#include <new>
+#include <utility>
+
+namespace ex = pika::execution::experimental;
+
+///////////////////////////////////////////////////////////////////////////////
+// Count all allocations made through the global operator new. GCC does not
+// recognize that the replacement operator delete matches the replacement
+// operator new when inlining them.
+#if defined(PIKA_GCC_VERSION) && PIKA_GCC_VERSION >= 110000
+# pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+std::atomic<std::uint64_t> num_allocations{0};
+
+void* operator new(std::size_t size)
+{
+    num_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+struct result_receiver
+{
+    int& result;
+
+    friend void tag_invoke(ex::set_error_t, result_receiver&&, std::exception_ptr) noexcept
+    {
+        std::terminate();
+    }
+
+    friend void tag_invoke(ex::set_stopped_t, result_receiver&&) noexcept
+    {
+        std::terminate();
+    }
+
+    friend void tag_invoke(ex::set_value_t, result_receiver&& r, int x) noexcept
+    {
+        r.result = x;
+    }
+
+    friend constexpr ex::empty_env tag_invoke(ex::get_env_t, result_receiver const&) noexcept
+    {
+        return {};
+    }
+};
+
+template <std::size_t EmbeddedStorageSize>
+int run_chain(std::uint64_t stages)
+{
+    using sender_type = ex::basic_unique_any_sender<EmbeddedStorageSize, int>;
+
+    sender_type s{ex::just(0)};
+    for (std::uint64_t i = 0; i != stages; ++i)
+    {
+        s = ex::then(std::move(s), [](int x) { return x + 1; });
+    }
+
+    int result = 0;
+    auto os = ex::connect(std::move(s), result_receiver{result});
+    ex::start(os);
+    return result;
+}
+
+template <std::size_t EmbeddedStorageSize>
+void bench_chain(std::uint64_t iterations, std::uint64_t stages)
+{
+    // Warmup, also fills the size-class pool
+    if (run_chain<EmbeddedStorageSize>(stages) != static_cast<int>(stages))
+    {
+        std::terminate();
+    }
+
+    std::uint64_t const allocations_before = num_allocations.load();
+    pika::chrono::detail::high_resolution_timer timer;
+
+    for (std::uint64_t i = 0; i != iterations; ++i)
+    {
+        run_chain<EmbeddedStorageSize>(stages);
+    }
+
+    double const elapsed = timer.elapsed();
+    std::uint64_t const allocations = num_allocations.load() - allocations_before;
+
+    fmt::print(std::cout, "{},{},{},{:.1f},{:.2f},{:.3f}\n", EmbeddedStorageSize, stages,
+        iterations, elapsed / iterations * 1e9, elapsed / (iterations * stages) * 1e9,
+        static_cast<double>(allocations) / iterations);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    using pika::program_options::command_line_parser;
+    using pika::program_options::notify;
+    using pika::program_options::options_description;
+    using pika::program_options::store;
+    using pika::program_options::value;
+    using pika::program_options::variables_map;
+
+    options_description cmdline("Usage: any_sender_overhead [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("help,h", "print out program usage (this message)")
+        ("iterations", value<std::uint64_t>()->default_value(100000),
+         "number of chains to build and run per embedded storage size")
+        ("stages", value<std::uint64_t>()->default_value(8),
+         "number of type-erased then stages per chain")
+        ("no-header", "do not print out the csv header row");
+    // clang-format on
+
+    variables_map vm;
+    store(command_line_parser(argc, argv).options(cmdline).run(), vm);
+    notify(vm);
+
+    if (vm.count("help"))
+    {
+        std::cout << cmdline;
+        return 0;
+    }
+
+    std::uint64_t const iterations = vm["iterations"].as<std::uint64_t>();
+    std::uint64_t const stages = vm["stages"].as<std::uint64_t>();
+
+    if (!vm.count("no-header"))
+    {
+        std::cout << "embedded storage [bytes],stages,iterations,time per chain [ns],time per "
+                     "stage [ns],allocations per chain\n";
+    }
+
+    bench_chain<ex::detail::default_any_sender_embedded_storage_size>(iterations, stages);
+    bench_chain<64>(iterations, stages);
+    bench_chain<128>(iterations, stages);
+    bench_chain<256>(iterations, stages);
+
+    return 0;
+}
@@ -0,0 +1,167 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark builds the task graph of a tiled right-looking Cholesky
+// factorization where every tile is protected by an async_rw_mutex. Each task
+// accesses its input tiles through read and its output tile through readwrite
+// and the tasks themselves only do a configurable amount of floating point
+// work, so that the benchmark measures the overhead of tracking dependencies
+// through async_rw_mutex. The number of accesses per second counts every
+// sender retrieved from the mutexes.
+
+#include <pika/execution.hpp>
+#include <pika/init.hpp>
+#include <pika/modules/timing.hpp>
+#include <pika/runtime.hpp>
+#include <pika/synchronization/async_rw_mutex.hpp>
+
+#include <fmt/ostream.h>
+#include <fmt/printf.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace ex = pika::execution::experimental;
+namespace tt = pika::this_thread::experimental;
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+using tile_mutex = ex::async_rw_mutex<double>;
+
+///////////////////////////////////////////////////////////////////////////////
+std::uint64_t work = 0;
+
+double kernel(double x)
+{
+    for (std::uint64_t i = 0; i != work; ++i)
+    {
+        x = std::fma(x, 0.999999, 1e-6);
+    }
+    return x;
+}
+
+template <typename... Senders>
+void spawn(ex::thread_pool_scheduler sched, Senders&&... senders)
+{
+    // The first sender is always the read-write access to the output tile
+    ex::start_detached(ex::when_all(PIKA_FORWARD(Senders, senders)...) | ex::transfer(sched) |
+        ex::then([](auto&& out, auto&&... in) {
+            out.get() = kernel((out.get() + ... + in.get()));
+        }));
+}
+
+std::uint64_t cholesky(ex::thread_pool_scheduler sched, std::vector<tile_mutex>& tiles,
+    std::size_t num_tiles)
+{
+    auto tile = [&](std::size_t i, std::size_t j) -> tile_mutex& {
+        return tiles[i * num_tiles + j];
+    };
+
+    std::uint64_t accesses = 0;
+    for (std::size_t k = 0; k != num_tiles; ++k)
+    {
+        // potrf
+        spawn(sched, tile(k, k).readwrite());
+        accesses += 1;
+
+        // trsm
+        for (std::size_t i = k + 1; i != num_tiles; ++i)
+        {
+            spawn(sched, tile(i, k).readwrite(), tile(k, k).read());
+            accesses += 2;
+        }
+
+        for (std::size_t i = k + 1; i != num_tiles; ++i)
+        {
+            // syrk
+            spawn(sched, tile(i, i).readwrite(), tile(i, k).read());
+            accesses += 2;
+
+            // gemm
+            for (std::size_t j = k + 1; j != i; ++j)
+            {
+                spawn(sched, tile(i, j).readwrite(), tile(i, k).read(), tile(j, k).read());
+                accesses += 3;
+            }
+        }
+    }
+
+    // Wait for the last access of all tiles
+    for (std::size_t i = 0; i != num_tiles; ++i)
+    {
+        for (std::size_t j = 0; j <= i; ++j)
+        {
+            tt::sync_wait(tile(i, j).readwrite());
+        }
+    }
+
+    return accesses;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int pika_main(variables_map& vm)
+{
+    std::size_t const num_tiles = vm["tiles"].as<std::size_t>();
+    std::uint64_t const repetitions = vm["repetitions"].as<std::uint64_t>();
+    work = vm["work"].as<std::uint64_t>();
+
+    if (!vm.count("no-header"))
+    {
+        std::cout << "threads,tiles,work,accesses,time [s],accesses/s\n";
+    }
+
+    ex::thread_pool_scheduler sched{};
+
+    for (std::uint64_t r = 0; r != repetitions + 1; ++r)
+    {
+        std::vector<tile_mutex> tiles;
+        tiles.reserve(num_tiles * num_tiles);
+        for (std::size_t i = 0; i != num_tiles * num_tiles; ++i)
+        {
+            tiles.emplace_back(1.0);
+        }
+
+        pika::chrono::detail::high_resolution_timer timer;
+        std::uint64_t const accesses = cholesky(sched, tiles, num_tiles);
+        double const elapsed = timer.elapsed();
+
+        // The first run is a warmup
+        if (r != 0)
+        {
+            fmt::print(std::cout, "{},{},{},{},{:.6f},{:.0f}\n", pika::get_num_worker_threads(),
+                num_tiles, work, accesses, elapsed, accesses / elapsed);
+        }
+    }
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("tiles", value<std::size_t>()->default_value(32),
+         "number of tiles in each dimension of the matrix")
+        ("work", value<std::uint64_t>()->default_value(0),
+         "number of floating point operations done by each task")
+        ("repetitions", value<std::uint64_t>()->default_value(5),
+         "number of times the task graph is built and run")
+        ("no-header", "do not print out the csv header row");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}
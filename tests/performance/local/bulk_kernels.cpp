@@ -0,0 +1,145 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark measures the time taken by bulk operations on the
+// thread_pool_scheduler for a memory-bound kernel (the STREAM triad) and a
+// compute-bound kernel (a fixed number of dependent floating point operations
+// per iteration). Each kernel is run with the chunk size chosen by the
+// scheduler and with a range of chunk sizes set with the with_bulk_chunk_size
+// property, or only with the chunk size given with --chunk-size.
+
+#include <pika/execution.hpp>
+#include <pika/init.hpp>
+#include <pika/modules/timing.hpp>
+#include <pika/runtime.hpp>
+
+#include <fmt/ostream.h>
+#include <fmt/printf.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace ex = pika::execution::experimental;
+namespace tt = pika::this_thread::experimental;
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+///////////////////////////////////////////////////////////////////////////////
+template <typename F>
+double time_bulk(ex::thread_pool_scheduler sched, std::size_t n, std::uint64_t repetitions, F f)
+{
+    // Warmup
+    tt::sync_wait(ex::schedule(sched) | ex::bulk(n, f));
+
+    pika::chrono::detail::high_resolution_timer t;
+    for (std::uint64_t i = 0; i != repetitions; ++i)
+    {
+        tt::sync_wait(ex::schedule(sched) | ex::bulk(n, f));
+    }
+    return t.elapsed() / repetitions;
+}
+
+void print_result(char const* kernel, std::size_t n, std::size_t chunk_size, double elapsed,
+    double bytes_per_iteration, double flops_per_iteration)
+{
+    std::string const chunk_size_str =
+        chunk_size == 0 ? std::string("auto") : std::to_string(chunk_size);
+    fmt::print(std::cout, "{},{},{},{},{:.3f},{:.3f},{:.3f}\n", kernel,
+        pika::get_num_worker_threads(), n, chunk_size_str, elapsed * 1e6,
+        n * bytes_per_iteration / elapsed * 1e-9, n * flops_per_iteration / elapsed * 1e-9);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+void bench_triad(ex::thread_pool_scheduler sched, std::size_t n, std::uint64_t repetitions)
+{
+    std::vector<double> a(n, 0.0);
+    std::vector<double> b(n, 1.0);
+    std::vector<double> c(n, 2.0);
+    double const s = 3.0;
+
+    double const elapsed = time_bulk(sched, n, repetitions,
+        [a = a.data(), b = b.data(), c = c.data(), s](std::size_t i) { a[i] = b[i] + s * c[i]; });
+
+    print_result("triad", n, ex::get_bulk_chunk_size(sched), elapsed, 3 * sizeof(double), 2);
+}
+
+void bench_compute(ex::thread_pool_scheduler sched, std::size_t n, std::uint64_t repetitions,
+    std::uint64_t flops)
+{
+    std::vector<double> a(n, 0.0);
+
+    double const elapsed = time_bulk(sched, n, repetitions, [a = a.data(), flops](std::size_t i) {
+        double x = static_cast<double>(i);
+        for (std::uint64_t j = 0; j != flops / 2; ++j)
+        {
+            x = std::fma(x, 0.999999, 1e-6);
+        }
+        a[i] = x;
+    });
+
+    print_result("compute", n, ex::get_bulk_chunk_size(sched), elapsed, sizeof(double),
+        static_cast<double>(flops));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int pika_main(variables_map& vm)
+{
+    std::size_t const triad_size = vm["triad-size"].as<std::size_t>();
+    std::size_t const compute_size = vm["compute-size"].as<std::size_t>();
+    std::uint64_t const flops = vm["flops"].as<std::uint64_t>();
+    std::uint64_t const repetitions = vm["repetitions"].as<std::uint64_t>();
+
+    std::vector<std::size_t> chunk_sizes = {0, 1, 16, 256, 4096, 65536};
+    if (vm.count("chunk-size"))
+    {
+        chunk_sizes = {vm["chunk-size"].as<std::size_t>()};
+    }
+
+    if (!vm.count("no-header"))
+    {
+        std::cout << "kernel,threads,n,chunk_size,time [us],bandwidth [GB/s],GFLOP/s\n";
+    }
+
+    for (std::size_t const chunk_size : chunk_sizes)
+    {
+        auto const sched = ex::with_bulk_chunk_size(ex::thread_pool_scheduler{}, chunk_size);
+        bench_triad(sched, triad_size, repetitions);
+        bench_compute(sched, compute_size, repetitions, flops);
+    }
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("triad-size", value<std::size_t>()->default_value(1 << 24),
+         "number of elements in the arrays of the triad kernel")
+        ("compute-size", value<std::size_t>()->default_value(1 << 16),
+         "number of iterations of the compute kernel")
+        ("flops", value<std::uint64_t>()->default_value(1000),
+         "number of floating point operations per iteration of the compute kernel")
+        ("repetitions", value<std::uint64_t>()->default_value(10),
+         "number of times each bulk operation is timed")
+        ("chunk-size", value<std::size_t>(),
+         "only use the given chunk size (0 lets the scheduler choose the chunk size)")
+        ("no-header", "do not print out the csv header row");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}
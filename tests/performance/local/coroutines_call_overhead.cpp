@@ -6,10 +6,13 @@
 //  Distributed under the Boost Software License, Version 1.0. (See accompanying
 //  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
 
-#include <pika/pika.hpp>
-#include <pika/pika_init.hpp>
-#include <pika/string_util/classification.hpp>
-#include <pika/string_util/split.hpp>
+#include <pika/chrono.hpp>
+#include <pika/coroutines/coroutine.hpp>
+#include <pika/coroutines/detail/coroutine_self.hpp>
+#include <pika/future.hpp>
+#include <pika/init.hpp>
+#include <pika/runtime.hpp>
+#include <pika/threading_base/threading_base_fwd.hpp>
 
 #include <fmt/printf.h>
 
@@ -19,16 +22,18 @@
 #include <iostream>
 #include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
+#include "stack_arena_report.hpp"
 #include "worker_timed.hpp"
 
 char const* benchmark_name = "Context Switching Overhead - pika";
 
 using namespace pika::program_options;
-using namespace pika::threads;
 
-using pika::threads::coroutine_type;
+using pika::threads::detail::coroutine_type;
+using pika::threads::detail::thread_restart_state;
 using std::cout;
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -51,7 +56,7 @@ std::string format_build_date()
 }
 
 ///////////////////////////////////////////////////////////////////////////////
-void print_results(double w_M)
+void print_results(double w_M, double w_S)
 {
     if (header)
     {
@@ -68,7 +73,11 @@ void print_results(double w_M)
                 "## 2:CTXS:# of Contexts - Independent Variable\n"
                 "## 3:ITER:# of Iterations - Independent Variable\n"
                 "## 4:SEED:PRNG seed - Independent Variable\n"
-                "## 5:WTIME_CS:Walltime/Context Switch [nano-seconds]\n";
+                "## 5:WTIME_CS:Walltime/Context Switch [nano-seconds]\n"
+                "## 6:WTIME_SPAWN:Walltime/Context Creation [nano-seconds]\n"
+                "## 7:PEAK_RSS:Peak Resident Set Size [kilo-bytes]\n";
+
+        print_stack_arena_report(cout, "# ");
     }
 
     std::uint64_t const os_thread_count = pika::get_os_thread_count();
@@ -77,8 +86,9 @@ void print_results(double w_M)
     //     double E = w_T/w_M;
     double O = w_M - w_T;
 
-    fmt::print(cout, "{} {} {} {} {} {:.14g}", payload, os_thread_count, contexts, iterations, seed,
-        (O / (2 * iterations * os_thread_count)) * 1e9);
+    fmt::print(cout, "{} {} {} {} {} {:.14g} {:.14g} {}", payload, os_thread_count, contexts,
+        iterations, seed, (O / (2 * iterations * os_thread_count)) * 1e9,
+        (w_S / (contexts * os_thread_count)) * 1e9, get_peak_resident_set_size());
 
     cout << "\n";
 }
@@ -86,22 +96,29 @@ void print_results(double w_M)
 ///////////////////////////////////////////////////////////////////////////////
 struct kernel
 {
-    pika::threads::detail::thread_result_type operator()(thread_restart_state) const
+    pika::threads::detail::thread_result_type operator()(thread_restart_state state) const
     {
-        worker_timed(payload * 1000);
+        auto* self = pika::threads::coroutines::detail::coroutine_self::get_self();
+
+        // Yield back to the caller until the coroutine is asked to terminate
+        while (state != thread_restart_state::terminate)
+        {
+            worker_timed(payload * 1000);
+
+            state = self->yield(pika::threads::detail::thread_result_type(
+                pika::threads::detail::thread_schedule_state::pending,
+                pika::threads::detail::invalid_thread_id));
+        }
 
         return pika::threads::detail::thread_result_type(
-            pika::threads::detail::thread_schedule_state::pending,
+            pika::threads::detail::thread_schedule_state::terminated,
             pika::threads::detail::invalid_thread_id);
     }
-
-    bool operator!() const
-    {
-        return true;
-    }
 };
 
-double perform_2n_iterations()
+// Returns the time spent switching contexts and the time spent creating the
+// contexts (including the allocation of their stacks)
+std::pair<double, double> perform_2n_iterations()
 {
     std::vector<coroutine_type*> coroutines;
     std::vector<std::uint64_t> indices;
@@ -114,12 +131,17 @@ double perform_2n_iterations()
 
     kernel k;
 
+    pika::chrono::detail::high_resolution_timer spawn_timer;
+
     for (std::uint64_t i = 0; i < contexts; ++i)
     {
         coroutine_type* c = new coroutine_type(k, pika::threads::detail::invalid_thread_id);
+        c->init();
         coroutines.push_back(c);
     }
 
+    double spawn_elapsed = spawn_timer.elapsed();
+
     for (std::uint64_t i = 0; i < iterations; ++i)
         indices.push_back(dist(prng));
 
@@ -127,26 +149,27 @@ double perform_2n_iterations()
     // Warmup
     for (std::uint64_t i = 0; i < iterations; ++i)
     {
-        (*coroutines[indices[i]])(wait_signaled);
+        (*coroutines[indices[i]])(thread_restart_state::signaled);
     }
 
     pika::chrono::detail::high_resolution_timer t;
 
     for (std::uint64_t i = 0; i < iterations; ++i)
     {
-        (*coroutines[indices[i]])(wait_signaled);
+        (*coroutines[indices[i]])(thread_restart_state::signaled);
     }
 
     double elapsed = t.elapsed();
 
     for (std::uint64_t i = 0; i < contexts; ++i)
     {
+        (*coroutines[i])(thread_restart_state::terminate);
         delete coroutines[i];
     }
 
     coroutines.clear();
 
-    return elapsed;
+    return {elapsed, spawn_elapsed};
 }
 
 int pika_main(variables_map& vm)
@@ -160,7 +183,7 @@ int pika_main(variables_map& vm)
 
         std::uint64_t const os_thread_count = pika::get_os_thread_count();
 
-        std::vector<pika::shared_future<double>> futures;
+        std::vector<pika::shared_future<std::pair<double, double>>> futures;
 
         std::uint64_t num_thread = pika::get_worker_thread_num();
 
@@ -172,12 +195,15 @@ int pika_main(variables_map& vm)
             futures.push_back(pika::async(&perform_2n_iterations));
         }
 
-        double total_elapsed = perform_2n_iterations();
+        auto [total_elapsed, total_spawn_elapsed] = perform_2n_iterations();
 
         for (std::uint64_t i = 0; i < futures.size(); ++i)
-            total_elapsed += futures[i].get();
+        {
+            total_elapsed += futures[i].get().first;
+            total_spawn_elapsed += futures[i].get().second;
+        }
 
-        print_results(total_elapsed);
+        print_results(total_elapsed, total_spawn_elapsed);
     }
 
     return pika::finalize();
@@ -208,5 +234,5 @@ int main(int argc, char* argv[])
     pika::init_params init_args;
     init_args.desc_cmdline = cmdline;
 
-    return pika::init(argc, argv, init_args);
+    return pika::init(pika_main, argc, argv, init_args);
 }
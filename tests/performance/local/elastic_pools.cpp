@@ -0,0 +1,295 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark co-locates a latency-critical pool and a batch pool on the
+// same processing units and alternates the load between them. Even phases
+// keep the batch pool saturated with long tasks while the latency pool
+// receives few short requests, odd phases flood the latency pool with
+// requests while only one batch task is in flight. For each phase the
+// benchmark reports the batch throughput, the latency of the requests from
+// submission to completion, and the number of worker threads of each pool at
+// the end of the phase.
+//
+// In the static mode the shared worker threads are split evenly between the
+// pools. In the elastic mode an elastic_pool_controller moves them to
+// whichever pool is overloaded. The default pool, which generates the load,
+// runs on the first processing unit. The two pools share the remaining
+// processing units, or the first one if there is only one.
+
+#include <pika/execution.hpp>
+#include <pika/execution_base/this_thread.hpp>
+#include <pika/init.hpp>
+#include <pika/modules/resource_partitioner.hpp>
+#include <pika/modules/timing.hpp>
+#include <pika/runtime.hpp>
+#include <pika/synchronization/spinlock.hpp>
+#include <pika/thread.hpp>
+#include <pika/thread_pool_util/elastic_pool_controller.hpp>
+#include <pika/threading_base/scheduler_mode.hpp>
+
+#include <fmt/ostream.h>
+#include <fmt/printf.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace ex = pika::execution::experimental;
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+using pika::threads::detail::elastic_pool;
+using pika::threads::detail::elastic_pool_controller;
+using pika::threads::detail::elastic_pool_controller_params;
+using pika::threads::detail::thread_pool_base;
+
+///////////////////////////////////////////////////////////////////////////////
+void spin(double seconds)
+{
+    pika::chrono::detail::high_resolution_timer t;
+    while (t.elapsed() < seconds)
+    {
+    }
+}
+
+struct load_state
+{
+    std::atomic<std::size_t> batch_in_flight{0};
+    std::atomic<std::uint64_t> batch_completed{0};
+    std::atomic<std::size_t> requests_in_flight{0};
+
+    pika::spinlock mtx;
+    std::vector<double> latencies;
+};
+
+double percentile(std::vector<double>& values, double p)
+{
+    if (values.empty())
+    {
+        return 0.0;
+    }
+    std::size_t const n = static_cast<std::size_t>(p * static_cast<double>(values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + n, values.end());
+    return values[n];
+}
+
+void run_phases(variables_map& vm, std::string const& mode, thread_pool_base& latency_pool,
+    thread_pool_base& batch_pool)
+{
+    int const num_phases = vm["phases"].as<int>();
+    double const phase_duration = vm["phase-duration"].as<double>() * 1e-3;
+    double const batch_task_duration = vm["batch-task-duration"].as<double>() * 1e-6;
+    double const request_duration = vm["request-duration"].as<double>() * 1e-6;
+    double const light_interval = vm["light-interval"].as<double>() * 1e-6;
+    double const heavy_interval = vm["heavy-interval"].as<double>() * 1e-6;
+
+    std::size_t const num_shared_threads = latency_pool.get_os_thread_count();
+    std::size_t const half = (std::max)(std::size_t(1), num_shared_threads / 2);
+
+    elastic_pool_controller_params params;
+    params.interval = std::chrono::milliseconds(vm["interval"].as<std::int64_t>());
+    params.hysteresis = vm["hysteresis"].as<std::size_t>();
+    std::unique_ptr<elastic_pool_controller> controller;
+    if (mode == "elastic")
+    {
+        controller = std::make_unique<elastic_pool_controller>(
+            std::vector<elastic_pool>{{&latency_pool}, {&batch_pool}}, params);
+    }
+    else
+    {
+        controller = std::make_unique<elastic_pool_controller>(
+            std::vector<elastic_pool>{{&latency_pool, half, half},
+                {&batch_pool, num_shared_threads - half, num_shared_threads - half}},
+            params);
+    }
+
+    ex::thread_pool_scheduler latency_sched{&latency_pool};
+    ex::thread_pool_scheduler batch_sched{&batch_pool};
+    load_state state;
+
+    for (int phase = 0; phase != num_phases; ++phase)
+    {
+        bool const batch_heavy = phase % 2 == 0;
+        std::size_t const batch_target = batch_heavy ? 4 * num_shared_threads : 1;
+        double const interval = batch_heavy ? light_interval : heavy_interval;
+
+        {
+            std::lock_guard<pika::spinlock> l(state.mtx);
+            state.latencies.clear();
+        }
+        std::uint64_t const batch_completed_start = state.batch_completed;
+
+        pika::chrono::detail::high_resolution_timer timer;
+        double next_request = 0.0;
+        double now = 0.0;
+        while ((now = timer.elapsed()) < phase_duration)
+        {
+            while (state.batch_in_flight < batch_target)
+            {
+                ++state.batch_in_flight;
+                ex::start_detached(ex::schedule(batch_sched) | ex::then([&] {
+                    spin(batch_task_duration);
+                    ++state.batch_completed;
+                    --state.batch_in_flight;
+                }));
+            }
+
+            for (/**/; next_request <= now; next_request += interval)
+            {
+                ++state.requests_in_flight;
+                pika::chrono::detail::high_resolution_timer request_timer;
+                ex::start_detached(ex::schedule(latency_sched) | ex::then([&, request_timer] {
+                    spin(request_duration);
+                    double const latency = request_timer.elapsed();
+                    {
+                        std::lock_guard<pika::spinlock> l(state.mtx);
+                        state.latencies.push_back(latency);
+                    }
+                    --state.requests_in_flight;
+                }));
+            }
+
+            pika::this_thread::yield();
+        }
+
+        double const elapsed = timer.elapsed();
+        std::uint64_t const batch_completed = state.batch_completed - batch_completed_start;
+
+        std::vector<double> latencies;
+        {
+            std::lock_guard<pika::spinlock> l(state.mtx);
+            latencies.swap(state.latencies);
+        }
+
+        fmt::print(std::cout, "{},{},{},{:.0f},{},{:.1f},{:.1f},{},{},{}\n", mode, phase,
+            batch_heavy ? "batch" : "latency", static_cast<double>(batch_completed) / elapsed,
+            latencies.size(), percentile(latencies, 0.5) * 1e6, percentile(latencies, 0.99) * 1e6,
+            latency_pool.get_active_os_thread_count(), batch_pool.get_active_os_thread_count(),
+            controller->get_move_count());
+    }
+
+    pika::util::yield_while(
+        [&] { return state.batch_in_flight != 0 || state.requests_in_flight != 0; });
+    controller->stop();
+}
+
+int pika_main(variables_map& vm)
+{
+    thread_pool_base& latency_pool = pika::resource::get_thread_pool("latency");
+    thread_pool_base& batch_pool = pika::resource::get_thread_pool("batch");
+
+    if (latency_pool.get_os_thread_count() < 2)
+    {
+        std::cerr << "the pools need at least two worker threads to share, use more processing "
+                     "units or --threads-per-pu\n";
+        return pika::finalize();
+    }
+
+    if (!vm.count("no-header"))
+    {
+        std::cout << "mode,phase,load,batch throughput [tasks/s],requests,p50 latency [us],"
+                     "p99 latency [us],latency threads,batch threads,moves\n";
+    }
+
+    for (std::string const& mode : vm["modes"].as<std::vector<std::string>>())
+    {
+        if (mode != "static" && mode != "elastic")
+        {
+            std::cerr << "unknown mode \"" << mode << "\", expected \"static\" or \"elastic\"\n";
+            continue;
+        }
+
+        run_phases(vm, mode, latency_pool, batch_pool);
+
+        // Leave all worker threads running for the next mode
+        for (thread_pool_base* pool : {&latency_pool, &batch_pool})
+        {
+            for (std::size_t i = 0; i != pool->get_os_thread_count(); ++i)
+            {
+                pool->resume_processing_unit_direct(i);
+            }
+        }
+    }
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("modes", value<std::vector<std::string>>()->multitoken()->default_value(
+             std::vector<std::string>{"static", "elastic"}, "static elastic"),
+         "modes to benchmark (static or elastic)")
+        ("phases", value<int>()->default_value(4),
+         "number of phases, alternating between batch and latency load")
+        ("phase-duration", value<double>()->default_value(1000),
+         "duration of a phase in milliseconds")
+        ("batch-task-duration", value<double>()->default_value(200),
+         "duration of a batch task in microseconds")
+        ("request-duration", value<double>()->default_value(20),
+         "duration of a latency request in microseconds")
+        ("light-interval", value<double>()->default_value(1000),
+         "interval between requests in batch phases in microseconds")
+        ("heavy-interval", value<double>()->default_value(20),
+         "interval between requests in latency phases in microseconds")
+        ("interval", value<std::int64_t>()->default_value(10),
+         "interval of the elastic pool controller in milliseconds")
+        ("hysteresis", value<std::size_t>()->default_value(3),
+         "intervals a pool has to be overloaded before it gets more threads")
+        ("threads-per-pu", value<std::size_t>()->default_value(1),
+         "worker threads per shared processing unit in each pool")
+        ("no-header", "do not print out the csv header row");
+    // clang-format on
+
+    using pika::threads::scheduler_mode;
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+    init_args.rp_mode = pika::resource::mode_allow_oversubscription;
+    init_args.rp_callback = [](auto& rp, variables_map const& vm) {
+        std::vector<pika::resource::pu const*> pus;
+        for (pika::resource::numa_domain const& d : rp.numa_domains())
+        {
+            for (pika::resource::core const& c : d.cores())
+            {
+                for (pika::resource::pu const& p : c.pus())
+                {
+                    pus.push_back(&p);
+                }
+            }
+        }
+
+        rp.add_resource(*pus[0], "default");
+        if (pus.size() > 1)
+        {
+            pus.erase(pus.begin());
+        }
+
+        std::size_t const threads_per_pu = vm["threads-per-pu"].as<std::size_t>();
+        for (std::string const pool_name : {"latency", "batch"})
+        {
+            rp.create_thread_pool(pool_name, pika::resource::scheduling_policy::local_priority_fifo,
+                scheduler_mode::default_mode | scheduler_mode::enable_elasticity);
+            for (pika::resource::pu const* p : pus)
+            {
+                rp.add_resource(*p, pool_name, threads_per_pu);
+            }
+        }
+    };
+
+    return pika::init(pika_main, argc, argv, init_args);
+}
@@ -9,6 +9,7 @@
 #include <pika/config.hpp>
 #include <pika/execution.hpp>
 #include <pika/future.hpp>
+#include <pika/futures/futures_factory.hpp>
 #include <pika/init.hpp>
 #include <pika/modules/synchronization.hpp>
 #include <pika/modules/timing.hpp>
@@ -47,23 +48,30 @@ static std::uint64_t num_threads = 1;
 static std::string info_string = "";
 
 ///////////////////////////////////////////////////////////////////////////////
+// The size in bytes of the shared state created by async for null_function.
+// This is zero for benchmarks that don't create shared states.
+double null_function() noexcept;
+constexpr std::size_t async_shared_state_bytes =
+    sizeof(pika::lcos::local::detail::task_object<double, decltype(&null_function), void>);
+
 void print_stats(const char* title, const char* wait, const char* exec, std::int64_t count,
-    double duration, bool csv)
+    double duration, bool csv, std::size_t shared_state_bytes = 0)
 {
     std::ostringstream temp;
     double us = 1e6 * duration / count;
     if (csv)
     {
-        fmt::print(temp, "{}, {:27}, {:15}, {:45}, {:8}, {:8}, {:20}, {:4}, {:4}, {:20}", count,
-            title, wait, exec, duration, us, queuing, numa_sensitive, num_threads, info_string);
+        fmt::print(temp, "{}, {:27}, {:15}, {:45}, {:8}, {:8}, {:4}, {:20}, {:4}, {:4}, {:20}",
+            count, title, wait, exec, duration, us, shared_state_bytes, queuing, numa_sensitive,
+            num_threads, info_string);
     }
     else
     {
         fmt::print(temp,
-            "invoked {:1}, futures {:27} {:15} {:18} in {:8} seconds : {:8} us/future, queue "
-            "{:20}, numa {:4}, threads {:4}, info {:20}",
-            count, title, wait, exec, duration, us, queuing, numa_sensitive, num_threads,
-            info_string);
+            "invoked {:1}, futures {:27} {:15} {:18} in {:8} seconds : {:8} us/future, {:4} "
+            "bytes/shared state, queue {:20}, numa {:4}, threads {:4}, info {:20}",
+            count, title, wait, exec, duration, us, shared_state_bytes, queuing, numa_sensitive,
+            num_threads, info_string);
     }
     std::cout << temp.str() << std::endl;
     // CDash graph plotting
@@ -128,7 +136,8 @@ void function_futures_wait_each(std::uint64_t count, bool csv, Executor& exec)
 
     // stop the clock
     const double duration = walltime.elapsed();
-    print_stats("async", "WaitEach", exec_name(exec), count, duration, csv);
+    print_stats(
+        "async", "WaitEach", exec_name(exec), count, duration, csv, async_shared_state_bytes);
 }
 
 template <typename Executor>
@@ -144,7 +153,8 @@ void function_futures_wait_all(std::uint64_t count, bool csv, Executor& exec)
     pika::wait_all(futures);
 
     const double duration = walltime.elapsed();
-    print_stats("async", "WaitAll", exec_name(exec), count, duration, csv);
+    print_stats(
+        "async", "WaitAll", exec_name(exec), count, duration, csv, async_shared_state_bytes);
 }
 
 template <typename Executor>
@@ -166,7 +176,8 @@ void function_futures_sliding_semaphore(std::uint64_t count, bool csv, Executor&
 
     // stop the clock
     const double duration = walltime.elapsed();
-    print_stats("apply", "Sliding-Sem", exec_name(exec), count, duration, csv);
+    print_stats("apply", "Sliding-Sem", exec_name(exec), count, duration, csv,
+        async_shared_state_bytes);
 }
 
 struct unlimited_number_of_chunks
@@ -396,7 +407,7 @@ int main(int argc, char* argv[])
         ("delay-iterations", value<std::uint64_t>()->default_value(0),
          "number of iterations in the delay loop")
 
-        ("csv", "output results as csv (format: count,duration)")
+        ("csv", "output results as csv (format: count,duration,bytes per shared state)")
         ("test-all", "run all benchmarks")
         ("repetitions", value<int>()->default_value(1),
          "number of repetitions of the full benchmark")
@@ -16,6 +16,7 @@
 # include <fmt/ostream.h>
 # include <fmt/printf.h>
 
+# include <algorithm>
 # include <cstdint>
 # include <functional>
 # include <iostream>
@@ -36,6 +37,7 @@ using pika::get_os_thread_count;
 
 using pika::threads::detail::make_thread_function_nullary;
 using pika::threads::detail::register_work;
+using pika::threads::detail::register_work_batch;
 using pika::threads::detail::thread_init_data;
 
 using pika::this_thread::suspend;
@@ -50,6 +52,7 @@ std::uint64_t min_delay = 0;
 std::uint64_t max_delay = 0;
 std::uint64_t total_delay = 0;
 std::uint64_t seed = 0;
+std::uint64_t batch_size = 0;
 bool header = true;
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -181,13 +184,33 @@ int pika_main(variables_map& vm)
         high_resolution_timer t;
 
         ///////////////////////////////////////////////////////////////////////
-        // Queue the tasks in a serial loop.
-        for (std::uint64_t i = 0; i < tasks; ++i)
+        // Queue the tasks in a serial loop, one at a time or in batches.
+        if (batch_size == 0)
+        {
+            for (std::uint64_t i = 0; i < tasks; ++i)
+            {
+                thread_init_data data(make_thread_function_nullary(pika::util::detail::bind(
+                                          &worker_timed, payloads[i] * 1000)),
+                    "worker_timed");
+                register_work(data);
+            }
+        }
+        else
         {
-            thread_init_data data(make_thread_function_nullary(
-                                      pika::util::detail::bind(&worker_timed, payloads[i] * 1000)),
-                "worker_timed");
-            register_work(data);
+            auto* pool = pika::threads::detail::get_self_or_default_pool();
+            std::vector<thread_init_data> data;
+            data.reserve(batch_size);
+            for (std::uint64_t i = 0; i < tasks; i += batch_size)
+            {
+                data.clear();
+                for (std::uint64_t j = i; j < (std::min)(tasks, i + batch_size); ++j)
+                {
+                    data.emplace_back(make_thread_function_nullary(pika::util::detail::bind(
+                                          &worker_timed, payloads[j] * 1000)),
+                        "worker_timed");
+                }
+                register_work_batch(data.data(), data.size(), pool);
+            }
         }
 
         ///////////////////////////////////////////////////////////////////////
@@ -238,6 +261,11 @@ int main(int argc, char* argv[])
         , "seed for the pseudo random number generator (if 0, a seed is "
           "chosen based on the current system time)")
 
+        ( "batch-size"
+        , value<std::uint64_t>(&batch_size)->default_value(0)
+        , "number of tasks queued at once with register_work_batch (if 0, tasks "
+          "are queued one at a time with register_work)")
+
         ( "no-header"
         , "do not print out the csv header row")
         ;
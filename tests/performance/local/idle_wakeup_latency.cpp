@@ -0,0 +1,124 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark measures how long it takes until a task starts running when
+// it is scheduled while all worker threads are idle. Tasks are scheduled from
+// the main thread with a delay between them that is long enough for the worker
+// threads to park. The latencies are reported as percentiles, together with
+// the parking statistics of the scheduler. Run with
+// --pika:ini=pika.adaptive_idle_backoff=0 to compare with waking up all parked
+// worker threads on new work and using a fixed spin time before parking.
+
+#include <pika/execution.hpp>
+#include <pika/init.hpp>
+#include <pika/runtime.hpp>
+#include <pika/thread.hpp>
+#include <pika/threading_base/scheduler_base.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ex = pika::execution::experimental;
+namespace tt = pika::this_thread::experimental;
+
+double percentile(std::vector<double> const& sorted, double p)
+{
+    std::size_t const index = static_cast<std::size_t>(p * double(sorted.size() - 1));
+    return sorted[index];
+}
+
+int main(int argc, char* argv[])
+{
+    pika::program_options::options_description desc_commandline;
+    // clang-format off
+    desc_commandline.add_options()
+        ("iterations",
+            pika::program_options::value<std::uint64_t>()->default_value(1000),
+            "number of tasks to schedule")
+        ("delay",
+            pika::program_options::value<std::uint64_t>()->default_value(2000),
+            "delay between scheduling tasks in microseconds")
+        ("hint",
+            pika::program_options::value<std::int16_t>()->default_value(-1),
+            "worker thread to schedule tasks on (-1 distributes tasks round robin)");
+    // clang-format on
+
+    pika::program_options::variables_map vm;
+    pika::program_options::store(pika::program_options::command_line_parser(argc, argv)
+                                     .allow_unregistered()
+                                     .options(desc_commandline)
+                                     .run(),
+        vm);
+
+    std::uint64_t const iterations = vm["iterations"].as<std::uint64_t>();
+    std::chrono::microseconds const delay(vm["delay"].as<std::uint64_t>());
+    std::int16_t const hint = vm["hint"].as<std::int16_t>();
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = desc_commandline;
+
+    pika::start(nullptr, argc, argv, init_args);
+
+    auto* scheduler = pika::resource::get_thread_pool("default").get_scheduler();
+    std::size_t const num_threads = pika::get_num_worker_threads();
+    bool const adaptive = pika::get_config_entry("pika.adaptive_idle_backoff", "1") != "0";
+
+    // Reset the parking statistics
+    scheduler->get_idle_park_count(std::size_t(-1), true);
+    scheduler->get_idle_wakeup_count(std::size_t(-1), true);
+    scheduler->get_average_idle_wake_latency(std::size_t(-1), true);
+    scheduler->get_max_idle_wake_latency(std::size_t(-1), true);
+
+    std::vector<double> latencies;
+    latencies.reserve(iterations);
+
+    for (std::uint64_t i = 0; i != iterations; ++i)
+    {
+        std::this_thread::sleep_for(delay);
+
+        auto sched = ex::thread_pool_scheduler{};
+        if (hint >= 0)
+        {
+            sched = ex::with_hint(sched, pika::execution::thread_schedule_hint(hint));
+        }
+
+        auto const start = std::chrono::steady_clock::now();
+        auto const started = tt::sync_wait(
+            ex::schedule(sched) | ex::then([] { return std::chrono::steady_clock::now(); }));
+        latencies.push_back(std::chrono::duration<double, std::micro>(started - start).count());
+    }
+
+    std::int64_t const parks = scheduler->get_idle_park_count(std::size_t(-1), false);
+    std::int64_t const wakeups = scheduler->get_idle_wakeup_count(std::size_t(-1), false);
+    std::int64_t const average_wake_latency =
+        scheduler->get_average_idle_wake_latency(std::size_t(-1), false);
+    std::int64_t const max_wake_latency =
+        scheduler->get_max_idle_wake_latency(std::size_t(-1), false);
+
+    pika::finalize();
+    pika::stop();
+
+    std::sort(latencies.begin(), latencies.end());
+
+    fmt::print(std::cout,
+        "threads: {}, adaptive idle backoff: {}, iterations: {}, delay: {} us\n"
+        "task start latency [us]: p50 {:.2f}, p90 {:.2f}, p99 {:.2f}, p99.9 {:.2f}, max "
+        "{:.2f}\n"
+        "parked: {}, woken up: {}, average wake latency: {} ns, max wake latency: {} ns\n",
+        num_threads, adaptive, iterations, delay.count(), percentile(latencies, 0.5),
+        percentile(latencies, 0.9), percentile(latencies, 0.99), percentile(latencies, 0.999),
+        latencies.back(), parks, wakeups, average_wake_latency, max_wake_latency);
+
+    return 0;
+}
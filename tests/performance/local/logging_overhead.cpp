@@ -0,0 +1,142 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark measures the cost of writing log messages from many tasks
+// concurrently. It spawns a given number of tasks that each write a given
+// number of messages to the application log and reports the time per message
+// for each of the given log destinations, e.g. the synchronous "file" and the
+// asynchronous "async_file" destinations. The reported time is the time the
+// tasks spend writing messages, it does not include the time it takes the
+// async_file destination to write out the messages in the background.
+// With the default settings async_file drops messages when its buffers are
+// full. Pass --pika:ini=pika.logging.async.overflow=block to make the tasks
+// wait instead, so that all destinations write the same messages.
+
+#include <pika/execution.hpp>
+#include <pika/init.hpp>
+#include <pika/init_runtime/detail/init_logging.hpp>
+#include <pika/modules/logging.hpp>
+#include <pika/modules/timing.hpp>
+#include <pika/runtime.hpp>
+
+#include <fmt/ostream.h>
+#include <fmt/printf.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ex = pika::execution::experimental;
+namespace tt = pika::this_thread::experimental;
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+///////////////////////////////////////////////////////////////////////////////
+auto make_task(ex::thread_pool_scheduler sched, std::uint64_t num_messages)
+{
+    return ex::schedule(sched) | ex::then([num_messages] {
+        for (std::uint64_t i = 0; i != num_messages; ++i)
+        {
+            LAPP_(info).format("logging_overhead: message {} of {}", i, num_messages);
+        }
+    });
+}
+
+double log_messages(std::uint64_t num_tasks, std::uint64_t num_messages)
+{
+    ex::thread_pool_scheduler sched{};
+    pika::chrono::detail::high_resolution_timer timer;
+
+    std::vector<decltype(make_task(sched, num_messages))> tasks;
+    tasks.reserve(num_tasks);
+    for (std::uint64_t i = 0; i != num_tasks; ++i)
+    {
+        tasks.push_back(make_task(sched, num_messages));
+    }
+    tt::sync_wait(ex::when_all_vector(std::move(tasks)));
+
+    return timer.elapsed();
+}
+
+void bench(std::uint64_t num_tasks, std::uint64_t num_messages, int repetitions,
+    std::string const& destination)
+{
+    if (destination == "off")
+    {
+        pika::util::disable_logging(pika::destination_app);
+    }
+    else
+    {
+        pika::util::enable_logging(pika::destination_app, "5", destination, "|\n");
+    }
+
+    double best = 0.0;
+    for (int i = 0; i != repetitions; ++i)
+    {
+        double const elapsed = log_messages(num_tasks, num_messages);
+        if (i == 0 || elapsed < best)
+        {
+            best = elapsed;
+        }
+    }
+
+    fmt::print(std::cout, "{},{},{},{},{:.3f}\n", pika::get_num_worker_threads(), destination,
+        num_tasks, num_messages, best / static_cast<double>(num_tasks * num_messages) * 1e9);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int pika_main(variables_map& vm)
+{
+    std::uint64_t const num_tasks = vm["tasks"].as<std::uint64_t>();
+    std::uint64_t const num_messages = vm["messages"].as<std::uint64_t>();
+    int const repetitions = vm["repetitions"].as<int>();
+    std::string const file_name = vm["file"].as<std::string>();
+
+    if (!vm.count("no-header"))
+    {
+        std::cout << "threads,destination,tasks,messages per task,time per message [ns]\n";
+    }
+
+    for (std::string const& destination : vm["destinations"].as<std::vector<std::string>>())
+    {
+        bench(num_tasks, num_messages, repetitions,
+            destination == "off" ? destination : destination + "(" + file_name + ")");
+    }
+    pika::util::disable_logging(pika::destination_app);
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("tasks", value<std::uint64_t>()->default_value(1000),
+         "number of tasks to spawn per repetition")
+        ("messages", value<std::uint64_t>()->default_value(100),
+         "number of messages to write per task")
+        ("repetitions", value<int>()->default_value(5),
+         "number of repetitions, the fastest one is reported")
+        ("destinations", value<std::vector<std::string>>()->multitoken()->default_value(
+             std::vector<std::string>{"off", "file", "async_file"}, "off file async_file"),
+         "log destinations to benchmark (off, file, or async_file)")
+        ("file", value<std::string>()->default_value("logging_overhead.log"),
+         "file to write the messages to")
+        ("no-header", "do not print out the csv header row");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}
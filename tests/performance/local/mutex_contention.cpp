@@ -0,0 +1,141 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark measures the cost of locking and unlocking pika::mutex,
+// pika::recursive_mutex, and pika::spinlock, with std::mutex as a baseline.
+// Each mutex is used by one task (uncontended), and by one task per worker
+// thread with a configurable amount of work outside of the critical section
+// (moderate contention) and with no work outside of the critical section
+// (heavy contention). All tasks do a small amount of work inside the critical
+// section. The time per acquisition is the total time divided by the total
+// number of acquisitions of all tasks.
+
+#include <pika/future.hpp>
+#include <pika/init.hpp>
+#include <pika/modules/timing.hpp>
+#include <pika/mutex.hpp>
+#include <pika/runtime.hpp>
+#include <pika/synchronization/spinlock.hpp>
+
+#include <fmt/ostream.h>
+#include <fmt/printf.h>
+
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+///////////////////////////////////////////////////////////////////////////////
+double work(double x, std::uint64_t n)
+{
+    for (std::uint64_t i = 0; i != n; ++i)
+    {
+        x = std::fma(x, 0.999999, 1e-6);
+    }
+    return x;
+}
+
+template <typename Mutex>
+void bench_mutex(char const* name, char const* contention, std::size_t num_tasks,
+    std::uint64_t iterations, std::uint64_t work_inside, std::uint64_t work_outside)
+{
+    Mutex mtx;
+    double shared = 2.0;
+    std::vector<double> results(num_tasks);
+
+    auto const run = [&]() {
+        std::vector<pika::future<void>> tasks;
+        tasks.reserve(num_tasks);
+        for (std::size_t t = 0; t != num_tasks; ++t)
+        {
+            tasks.push_back(pika::async([&, t]() {
+                double local = static_cast<double>(t) + 2.0;
+                for (std::uint64_t i = 0; i != iterations; ++i)
+                {
+                    {
+                        std::lock_guard<Mutex> l(mtx);
+                        shared = work(shared, work_inside);
+                    }
+                    local = work(local, work_outside);
+                }
+                results[t] = local;
+            }));
+        }
+        pika::wait_all(tasks);
+    };
+
+    // Warmup
+    run();
+
+    pika::chrono::detail::high_resolution_timer timer;
+    run();
+    double const elapsed = timer.elapsed();
+
+    fmt::print(std::cout, "{},{},{},{},{},{},{:.6f},{:.2f}\n", name, contention, num_tasks,
+        iterations, work_inside, work_outside, elapsed,
+        elapsed / static_cast<double>(num_tasks * iterations) * 1e9);
+}
+
+template <typename Mutex>
+void bench_contention(char const* name, std::uint64_t iterations, std::uint64_t work_inside,
+    std::uint64_t work_outside)
+{
+    std::size_t const num_threads = pika::get_num_worker_threads();
+
+    bench_mutex<Mutex>(name, "uncontended", 1, iterations, work_inside, work_outside);
+    bench_mutex<Mutex>(name, "moderate", num_threads, iterations, work_inside, work_outside);
+    bench_mutex<Mutex>(name, "heavy", num_threads, iterations, work_inside, 0);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int pika_main(variables_map& vm)
+{
+    std::uint64_t const iterations = vm["iterations"].as<std::uint64_t>();
+    std::uint64_t const work_inside = vm["work-inside"].as<std::uint64_t>();
+    std::uint64_t const work_outside = vm["work-outside"].as<std::uint64_t>();
+
+    if (!vm.count("no-header"))
+    {
+        std::cout << "mutex,contention,tasks,iterations,work inside,work outside,time [s],"
+                     "time per acquisition [ns]\n";
+    }
+
+    bench_contention<std::mutex>("std::mutex", iterations, work_inside, work_outside);
+    bench_contention<pika::mutex>("pika::mutex", iterations, work_inside, work_outside);
+    bench_contention<pika::recursive_mutex>(
+        "pika::recursive_mutex", iterations, work_inside, work_outside);
+    bench_contention<pika::spinlock>("pika::spinlock", iterations, work_inside, work_outside);
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("iterations", value<std::uint64_t>()->default_value(100000),
+         "number of times each task acquires the mutex")
+        ("work-inside", value<std::uint64_t>()->default_value(10),
+         "number of floating point operations done while holding the mutex")
+        ("work-outside", value<std::uint64_t>()->default_value(200),
+         "number of floating point operations done between acquisitions with moderate "
+         "contention")
+        ("no-header", "do not print out the csv header row");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}
@@ -6,11 +6,16 @@
 
 // This example benchmarks the time it takes to enter and exit an OpenMP
 // parallel region. This is meant to be compared to resume_suspend and
-// start_stop.
+// start_stop. For comparison the time it takes to run an empty parallel region
+// and a parallel region containing a barrier on a fork_join_executor is
+// measured after the OpenMP parallel regions.
 
+#include <pika/execution.hpp>
 #include <pika/execution_base/this_thread.hpp>
+#include <pika/init.hpp>
 #include <pika/modules/program_options.hpp>
 #include <pika/modules/timing.hpp>
+#include <pika/runtime.hpp>
 #include <pika/type_support/unused.hpp>
 
 #include <omp.h>
@@ -19,6 +24,43 @@
 #include <cstdint>
 #include <iostream>
 
+int pika_main(pika::program_options::variables_map& vm)
+{
+    using pika::execution::experimental::fork_join_executor;
+
+    std::uint64_t repetitions = vm["repetitions"].as<std::uint64_t>();
+    std::size_t threads = pika::get_num_worker_threads();
+
+    fork_join_executor exec{};
+
+    // Do one warmup iteration
+    exec.parallel_region([](fork_join_executor::region_context&) {});
+
+    pika::chrono::detail::high_resolution_timer timer;
+
+    for (std::size_t i = 0; i < repetitions; ++i)
+    {
+        timer.restart();
+        exec.parallel_region([](fork_join_executor::region_context&) {});
+        auto t_parallel = timer.elapsed();
+
+        std::cout << "fork_join, " << threads << ", " << t_parallel << std::endl;
+    }
+
+    for (std::size_t i = 0; i < repetitions; ++i)
+    {
+        timer.restart();
+        exec.parallel_region([](fork_join_executor::region_context& context) {
+            context.barrier();
+        });
+        auto t_parallel = timer.elapsed();
+
+        std::cout << "fork_join_barrier, " << threads << ", " << t_parallel << std::endl;
+    }
+
+    return pika::finalize();
+}
+
 int main(int argc, char** argv)
 {
     pika::program_options::options_description desc_commandline;
@@ -44,7 +86,7 @@ int main(int argc, char** argv)
 
     std::size_t threads = omp_get_max_threads();
 
-    std::cout << "threads, parallel region [s]" << std::endl;
+    std::cout << "runtime, threads, parallel region [s]" << std::endl;
 
     pika::chrono::detail::high_resolution_timer timer;
 
@@ -60,6 +102,11 @@ int main(int argc, char** argv)
 
         auto t_parallel = timer.elapsed();
 
-        std::cout << threads << ", " << t_parallel << std::endl;
+        std::cout << "openmp, " << threads << ", " << t_parallel << std::endl;
     }
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = desc_commandline;
+
+    return pika::init(pika_main, argc, argv, init_args);
 }
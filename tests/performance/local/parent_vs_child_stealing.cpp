@@ -10,6 +10,7 @@
 # include <pika/init.hpp>
 # include <pika/modules/program_options.hpp>
 # include <pika/modules/timing.hpp>
+# include <pika/runtime.hpp>
 
 # include <fmt/ostream.h>
 # include <fmt/printf.h>
@@ -18,6 +19,7 @@
 # include <cstdint>
 # include <iostream>
 # include <numeric>
+# include <string>
 # include <vector>
 
 # include "worker_timed.hpp"
@@ -86,14 +88,19 @@ int pika_main(pika::program_options::variables_map& vm)
     if (do_child)
         parent_stealing_time = measure(pika::launch::fork);
 
+    // Run with different values for --pika:queuing to compare the queue
+    // backends of the schedulers
+    std::string const scheduler = pika::get_config_entry("pika.scheduler", "");
+
     if (print_header)
     {
-        std::cout << "num_cores,num_threads,child_stealing_time[s],parent_stealing_time[s]"
+        std::cout << "scheduler,num_cores,num_threads,child_stealing_time[s],"
+                     "parent_stealing_time[s]"
                   << std::endl;
     }
 
-    fmt::print(std::cout, "{},{},{},{}\n", num_cores, iterations, child_stealing_time,
-        parent_stealing_time);
+    fmt::print(std::cout, "{},{},{},{},{}\n", scheduler, num_cores, iterations,
+        child_stealing_time, parent_stealing_time);
 
     return pika::finalize();
 }
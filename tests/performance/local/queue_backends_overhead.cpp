@@ -0,0 +1,186 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark measures the cost of pushing and popping elements on the
+// queue backends used for the pending queues of the schedulers, in the same
+// way as nonconcurrent_lifo_overhead. Every thread uses its own queue and
+// only pops from it without stealing, which is the common case for a worker
+// thread taking work from its own queue. With --steal the elements are
+// popped as a thief would pop them instead.
+
+#include <pika/modules/program_options.hpp>
+#include <pika/modules/timing.hpp>
+#include <pika/schedulers/lockfree_queue_backends.hpp>
+
+#include <fmt/ostream.h>
+#include <fmt/printf.h>
+
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using pika::program_options::command_line_parser;
+using pika::program_options::notify;
+using pika::program_options::options_description;
+using pika::program_options::store;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+using pika::chrono::detail::high_resolution_timer;
+
+///////////////////////////////////////////////////////////////////////////////
+std::uint64_t threads = 1;
+std::uint64_t blocksize = 10000;
+std::uint64_t iterations = 2000000;
+bool steal = false;
+bool header = true;
+
+///////////////////////////////////////////////////////////////////////////////
+template <typename Queue>
+std::pair<double, double> bench_queue(Queue& queue, std::uint64_t local_iterations)
+{
+    using value_type = typename Queue::value_type;
+
+    std::pair<double, double> elapsed(0.0, 0.0);
+    high_resolution_timer t;
+
+    for (std::uint64_t block = 0; block < (local_iterations / blocksize); ++block)
+    {
+        t.restart();
+        for (std::uint64_t i = 0; i < blocksize; ++i)
+        {
+            queue.push(value_type(i + 1));
+        }
+        elapsed.first += t.elapsed();
+
+        t.restart();
+        value_type val;
+        for (std::uint64_t i = 0; i < blocksize; ++i)
+        {
+            queue.pop(val, steal);
+        }
+        elapsed.second += t.elapsed();
+    }
+
+    return elapsed;
+}
+
+template <typename Policy>
+std::pair<double, double> perform_iterations()
+{
+    using queue_type = typename Policy::template apply<std::uint64_t*>::type;
+    queue_type queue(blocksize, 0);
+
+    // Make the calling thread the owner of queues that need one
+    std::uint64_t* val = nullptr;
+    queue.pop(val, false);
+
+    // Warmup.
+    bench_queue(queue, blocksize);
+
+    return bench_queue(queue, iterations);
+}
+
+template <typename Policy>
+void bench_policy(char const* name)
+{
+    std::vector<std::pair<double, double>> elapsed(threads, std::pair<double, double>(0.0, 0.0));
+    std::vector<std::thread> workers;
+
+    for (std::uint64_t i = 0; i != threads; ++i)
+    {
+        workers.push_back(
+            std::thread([&elapsed, i]() { elapsed[i] = perform_iterations<Policy>(); }));
+    }
+
+    for (std::thread& thread : workers)
+    {
+        if (thread.joinable())
+            thread.join();
+    }
+
+    std::pair<double, double> total_elapsed(0.0, 0.0);
+    for (auto const& e : elapsed)
+    {
+        total_elapsed.first += e.first;
+        total_elapsed.second += e.second;
+    }
+
+    fmt::print(std::cout, "{} {} {} {} {:.14g} {:.14g}\n", name, iterations, blocksize, threads,
+        (total_elapsed.first / (threads * iterations)) * 1e9,
+        (total_elapsed.second / (threads * iterations)) * 1e9);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int app_main()
+{
+    if (header)
+    {
+        std::cout << "## 0:BACKEND:Queue backend\n"
+                     "## 1:ITER:Iterations per OS-thread - Independent Variable\n"
+                     "## 2:BSIZE:Maximum Queue Depth - Independent Variable\n"
+                     "## 3:OSTHRDS:OS-thread - Independent Variable\n"
+                     "## 4:WTIME_PUSH:Total Walltime/Push [nanoseconds]\n"
+                     "## 5:WTIME_POP:Total Walltime/Pop [nanoseconds]\n";
+    }
+
+    bench_policy<pika::threads::lockfree_fifo>("lockfree_fifo");
+    bench_policy<pika::threads::concurrentqueue_fifo>("concurrentqueue_fifo");
+#if defined(PIKA_HAVE_CXX11_STD_ATOMIC_128BIT)
+    bench_policy<pika::threads::lockfree_lifo>("lockfree_lifo");
+    bench_policy<pika::threads::lockfree_abp_lifo>("lockfree_abp_lifo");
+#endif
+    bench_policy<pika::threads::chase_lev_lifo>("chase_lev_lifo");
+
+    return 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int main(int argc, char* argv[])
+{
+    variables_map vm;
+
+    options_description cmdline("Usage: queue_backends_overhead [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("help,h", "print out program usage (this message)")
+        ("threads,t", value<std::uint64_t>(&threads)->default_value(1),
+         "number of threads to use")
+        ("iterations", value<std::uint64_t>(&iterations)->default_value(2000000),
+         "number of iterations to perform (most be divisible by block size)")
+        ("blocksize", value<std::uint64_t>(&blocksize)->default_value(10000),
+         "size of each block")
+        ("steal", "pop elements as a thief instead of as the owner")
+        ("no-header", "do not print out the header");
+    // clang-format on
+
+    store(command_line_parser(argc, argv).options(cmdline).run(), vm);
+
+    notify(vm);
+
+    if (vm.count("help"))
+    {
+        std::cout << cmdline;
+        return 0;
+    }
+
+    if (iterations % blocksize)
+        throw std::invalid_argument("iterations must be cleanly divisible by blocksize\n");
+
+    if (vm.count("steal"))
+        steal = true;
+
+    if (vm.count("no-header"))
+        header = false;
+
+    return app_main();
+}
@@ -25,6 +25,8 @@
 #include <iostream>
 #include <vector>
 
+#include "stack_arena_report.hpp"
+
 ///////////////////////////////////////////////////////////////////////////////
 std::int64_t skynet(std::int64_t num, std::int64_t size, std::int64_t div)
 {
@@ -80,6 +82,28 @@ pika::future<std::int64_t> skynet_f(std::int64_t num, std::int64_t size, std::in
 }
 
 ///////////////////////////////////////////////////////////////////////////////
+// Total number of tasks spawned by a skynet run with the given size and divisor
+std::int64_t skynet_task_count(std::int64_t size, std::int64_t div)
+{
+    std::int64_t count = 1;
+    std::int64_t level = 1;
+    while (size != 1)
+    {
+        size /= div;
+        level *= div;
+        count += level;
+    }
+    return count;
+}
+
+void print_spawn_cost(std::chrono::nanoseconds dur)
+{
+    std::int64_t const tasks = skynet_task_count(1000000, 10);
+    std::cout << "  " << tasks << " tasks, " << dur.count() / tasks
+              << " ns per task, peak resident set size " << get_peak_resident_set_size()
+              << " kB\n";
+}
+
 int pika_main()
 {
     {
@@ -89,9 +113,11 @@ int pika_main()
         pika::future<std::int64_t> result = pika::async(skynet, 0, 1000000, 10);
         result.wait();
 
-        auto dur = duration_cast<milliseconds>(high_resolution_clock::now() - start);
+        auto dur = duration_cast<nanoseconds>(high_resolution_clock::now() - start);
 
-        std::cout << "Result 1: " << result.get() << " in " << dur.count() << " ms.\n";
+        std::cout << "Result 1: " << result.get() << " in "
+                  << duration_cast<milliseconds>(dur).count() << " ms.\n";
+        print_spawn_cost(dur);
     }
 
     {
@@ -101,10 +127,14 @@ int pika_main()
         pika::future<std::int64_t> result = pika::async(skynet_f, 0, 1000000, 10);
         result.wait();
 
-        auto dur = duration_cast<milliseconds>(high_resolution_clock::now() - start);
+        auto dur = duration_cast<nanoseconds>(high_resolution_clock::now() - start);
 
-        std::cout << "Result 2: " << result.get() << " in " << dur.count() << " ms.\n";
+        std::cout << "Result 2: " << result.get() << " in "
+                  << duration_cast<milliseconds>(dur).count() << " ms.\n";
+        print_spawn_cost(dur);
     }
+
+    print_stack_arena_report(std::cout);
     return 0;
 }
 
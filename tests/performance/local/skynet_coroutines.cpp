@@ -0,0 +1,185 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark runs the skynet micro benchmark (see skynet.cpp) with
+// stackful pika threads and with C++20 coroutine tasks. The stackful variant
+// spawns every actor as a pika thread with its own stack, which waits for its
+// children by suspending. The coroutine variant spawns every actor as a task
+// scheduled on a thread_pool_scheduler without stacks, which waits for its
+// children by awaiting when_all_vector.
+//
+// The benchmark reports the time per actor and the peak resident set size of
+// the process. The peak resident set size only grows during a run, to compare
+// the memory used by the variants run them in separate processes with
+// --variants.
+
+#include <pika/execution.hpp>
+#include <pika/future.hpp>
+#include <pika/init.hpp>
+
+#include <fmt/ostream.h>
+#include <fmt/printf.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "stack_arena_report.hpp"
+
+namespace ex = pika::execution::experimental;
+namespace tt = pika::this_thread::experimental;
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+///////////////////////////////////////////////////////////////////////////////
+std::int64_t skynet_stackful(std::int64_t num, std::int64_t size, std::int64_t div)
+{
+    if (size == 1)
+    {
+        return num;
+    }
+
+    size /= div;
+
+    std::vector<pika::future<std::int64_t>> results;
+    results.reserve(div);
+
+    for (std::int64_t i = 0; i != div; ++i)
+    {
+        results.push_back(pika::async(skynet_stackful, num + i * size, size, div));
+    }
+
+    pika::wait_all(results);
+
+    std::int64_t sum = 0;
+    for (auto& f : results)
+    {
+        sum += f.get();
+    }
+    return sum;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+ex::task<std::int64_t> skynet_task(
+    ex::thread_pool_scheduler sched, std::int64_t num, std::int64_t size, std::int64_t div);
+
+// Starts a new actor on sched
+auto spawn_skynet_task(
+    ex::thread_pool_scheduler sched, std::int64_t num, std::int64_t size, std::int64_t div)
+{
+    return ex::schedule(sched) |
+        ex::let_value([=]() { return skynet_task(sched, num, size, div); });
+}
+
+ex::task<std::int64_t> skynet_task(
+    ex::thread_pool_scheduler sched, std::int64_t num, std::int64_t size, std::int64_t div)
+{
+    if (size == 1)
+    {
+        co_return num;
+    }
+
+    size /= div;
+
+    std::vector<decltype(spawn_skynet_task(sched, num, size, div))> children;
+    children.reserve(div);
+
+    for (std::int64_t i = 0; i != div; ++i)
+    {
+        children.push_back(spawn_skynet_task(sched, num + i * size, size, div));
+    }
+
+    std::vector<std::int64_t> sums = co_await ex::when_all_vector(std::move(children));
+    co_return std::accumulate(sums.begin(), sums.end(), std::int64_t(0));
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Total number of actors spawned by a skynet run with the given size and divisor
+std::int64_t skynet_actor_count(std::int64_t size, std::int64_t div)
+{
+    std::int64_t count = 1;
+    std::int64_t level = 1;
+    while (size != 1)
+    {
+        size /= div;
+        level *= div;
+        count += level;
+    }
+    return count;
+}
+
+int pika_main(variables_map& vm)
+{
+    std::int64_t const size = vm["size"].as<std::int64_t>();
+    std::int64_t const div = vm["div"].as<std::int64_t>();
+    std::int64_t const actors = skynet_actor_count(size, div);
+
+    if (!vm.count("no-header"))
+    {
+        std::cout << "variant,threads,actors,result,time [ms],time per actor [ns],"
+                     "peak resident set size [kB]\n";
+    }
+
+    for (std::string const& variant : vm["variants"].as<std::vector<std::string>>())
+    {
+        std::int64_t result = 0;
+        auto const start = std::chrono::steady_clock::now();
+
+        if (variant == "stackful")
+        {
+            result = pika::async(skynet_stackful, 0, size, div).get();
+        }
+        else if (variant == "coroutine")
+        {
+            auto const sched = ex::with_stacksize(
+                ex::thread_pool_scheduler{}, pika::execution::thread_stacksize::nostack);
+            result = tt::sync_wait(spawn_skynet_task(sched, 0, size, div));
+        }
+        else
+        {
+            std::cerr << "unknown variant \"" << variant
+                      << "\", expected \"stackful\" or \"coroutine\"\n";
+            continue;
+        }
+
+        auto const elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start);
+
+        fmt::print(std::cout, "{},{},{},{},{},{},{}\n", variant, pika::get_os_thread_count(),
+            actors, result, elapsed.count() / 1000000, elapsed.count() / actors,
+            get_peak_resident_set_size());
+    }
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("size", value<std::int64_t>()->default_value(1000000),
+         "number of actors on the last level")
+        ("div", value<std::int64_t>()->default_value(10),
+         "number of children spawned by every actor")
+        ("variants", value<std::vector<std::string>>()->multitoken()->default_value(
+             std::vector<std::string>{"coroutine", "stackful"}, "coroutine stackful"),
+         "variants to run (stackful or coroutine)")
+        ("no-header", "do not print out the csv header row");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}
@@ -0,0 +1,198 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark counts the heap allocations made when spawning a task,
+// depending on the size of the closure of the task. Closures that fit into
+// the inline storage of the thread function are stored with the thread data
+// and the coroutine, larger closures are allocated on the heap. Tasks are
+// spawned on stackful and stackless threads, the thread data and the stacks
+// are reused after the first repetition. The benchmark reports the
+// allocations and the time per task, from spawning the task to its
+// completion.
+
+#include <pika/functional/detail/basic_function.hpp>
+#include <pika/init.hpp>
+#include <pika/latch.hpp>
+#include <pika/modules/timing.hpp>
+#include <pika/runtime.hpp>
+#include <pika/threading_base/register_thread.hpp>
+#include <pika/threading_base/thread_init_data.hpp>
+
+#include <fmt/ostream.h>
+#include <fmt/printf.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+using pika::threads::detail::make_thread_function_nullary;
+using pika::threads::detail::thread_init_data;
+
+///////////////////////////////////////////////////////////////////////////////
+std::atomic<std::uint64_t> num_allocations{0};
+
+void* operator new(std::size_t size)
+{
+    num_allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+    {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// The closure of the spawned tasks is a pointer to the latch and the payload.
+// The payload of closures that are not trivially copyable holds a shared_ptr.
+template <std::size_t CaptureSize, bool TriviallyCopyable>
+struct payload;
+
+template <std::size_t CaptureSize>
+struct payload<CaptureSize, true>
+{
+    std::array<unsigned char, CaptureSize - sizeof(void*)> data;
+};
+
+template <std::size_t CaptureSize>
+struct payload<CaptureSize, false>
+{
+    std::shared_ptr<int> ptr;
+    std::array<unsigned char, CaptureSize - sizeof(void*) - sizeof(std::shared_ptr<int>)> data;
+};
+
+template <std::size_t CaptureSize, bool TriviallyCopyable>
+void bench_spawn(pika::execution::thread_stacksize stacksize, std::size_t count,
+    std::uint64_t repetitions)
+{
+    auto* pool = pika::threads::detail::get_self_or_default_pool();
+    payload<CaptureSize, TriviallyCopyable> p{};
+    std::uint64_t allocations = 0;
+    double elapsed = 0.0;
+
+    for (std::uint64_t r = 0; r != repetitions + 1; ++r)
+    {
+        pika::latch l(static_cast<std::ptrdiff_t>(count + 1));
+
+        std::uint64_t const allocations_start = num_allocations.load(std::memory_order_relaxed);
+        pika::chrono::detail::high_resolution_timer timer;
+        for (std::size_t i = 0; i != count; ++i)
+        {
+            auto f = [&l, p]() {
+                l.count_down(static_cast<std::ptrdiff_t>(p.data[0]) + 1);
+            };
+            static_assert(sizeof(f) == CaptureSize);
+            static_assert(std::is_trivially_copyable_v<decltype(f)> == TriviallyCopyable);
+
+            thread_init_data data(make_thread_function_nullary(f), "spawn_allocations",
+                pika::execution::thread_priority::normal, pika::execution::thread_schedule_hint(),
+                stacksize);
+            pika::threads::detail::register_work(data, pool);
+        }
+        l.arrive_and_wait();
+
+        // The first run is a warmup
+        if (r != 0)
+        {
+            elapsed += timer.elapsed();
+            allocations += num_allocations.load(std::memory_order_relaxed) - allocations_start;
+        }
+    }
+
+    double const n = static_cast<double>(count * repetitions);
+    fmt::print(std::cout, "{},{},{},{},{:.2f},{:.1f}\n",
+        stacksize == pika::execution::thread_stacksize::nostack ? "stackless" : "stackful",
+        TriviallyCopyable ? "trivially copyable" : "non-trivially copyable", CaptureSize,
+        pika::util::detail::function_storage_size,
+        static_cast<double>(allocations) / n, elapsed / n * 1e9);
+}
+
+template <std::size_t... CaptureSizes>
+void bench_capture_sizes(pika::execution::thread_stacksize stacksize, std::size_t count,
+    std::uint64_t repetitions)
+{
+    (bench_spawn<CaptureSizes, true>(stacksize, count, repetitions), ...);
+    (bench_spawn<CaptureSizes, false>(stacksize, count, repetitions), ...);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int pika_main(variables_map& vm)
+{
+    std::size_t const count = vm["tasks"].as<std::size_t>();
+    std::uint64_t const repetitions = vm["repetitions"].as<std::uint64_t>();
+
+    if (!vm.count("no-header"))
+    {
+        std::cout << "thread type,closure,capture size [bytes],inline storage [bytes],"
+                     "allocations per task,time per task [ns]\n";
+    }
+
+    for (std::string const& type : vm["thread-types"].as<std::vector<std::string>>())
+    {
+        pika::execution::thread_stacksize stacksize;
+        if (type == "stackful")
+        {
+            stacksize = pika::execution::thread_stacksize::default_;
+        }
+        else if (type == "stackless")
+        {
+            stacksize = pika::execution::thread_stacksize::nostack;
+        }
+        else
+        {
+            std::cerr << "unknown thread type \"" << type
+                      << "\", expected \"stackful\" or \"stackless\"\n";
+            continue;
+        }
+
+        bench_capture_sizes<32, 64, 96, 128, 192, 256>(stacksize, count, repetitions);
+    }
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("tasks", value<std::size_t>()->default_value(10000),
+         "number of tasks spawned per repetition")
+        ("repetitions", value<std::uint64_t>()->default_value(5),
+         "number of times each measurement is repeated")
+        ("thread-types", value<std::vector<std::string>>()->multitoken()->default_value(
+             std::vector<std::string>{"stackful", "stackless"}, "stackful stackless"),
+         "types of threads to spawn (stackful or stackless)")
+        ("no-header", "do not print out the csv header row");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}
@@ -0,0 +1,115 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark measures the cost of sharing the result of a single sender
+// between many consumers with split. For each number of consumers, from 1 to
+// the given maximum in powers of two, a split sender is created from a sender
+// running on the thread pool. Each consumer is started from its own task so
+// that consumers attach to the split sender concurrently with each other and
+// with the completion of the predecessor. The time per fan-out is the total
+// time divided by the number of iterations, and the time per consumer is the
+// time per fan-out divided by the number of consumers.
+
+#include <pika/execution.hpp>
+#include <pika/init.hpp>
+#include <pika/modules/timing.hpp>
+#include <pika/runtime.hpp>
+
+#include <fmt/ostream.h>
+#include <fmt/printf.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <utility>
+#include <vector>
+
+namespace ex = pika::execution::experimental;
+namespace tt = pika::this_thread::experimental;
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+///////////////////////////////////////////////////////////////////////////////
+using split_sender_type =
+    decltype(ex::split(ex::just(std::uint64_t(0)) | ex::transfer(ex::thread_pool_scheduler{})));
+
+// Each consumer starts from a new task on the thread pool and then waits for
+// the split sender
+auto make_consumer(ex::thread_pool_scheduler sched, split_sender_type const& s)
+{
+    return ex::schedule(sched) | ex::let_value([s]() { return s; }) |
+        ex::then([](std::uint64_t const&) {});
+}
+
+void bench_fan_out(std::size_t num_consumers, std::uint64_t iterations)
+{
+    ex::thread_pool_scheduler sched{};
+    std::vector<decltype(make_consumer(sched, std::declval<split_sender_type const&>()))>
+        consumers;
+    consumers.reserve(num_consumers);
+
+    pika::chrono::detail::high_resolution_timer timer;
+
+    for (std::uint64_t i = 0; i != iterations; ++i)
+    {
+        auto s = ex::split(ex::just(std::uint64_t(i)) | ex::transfer(sched));
+
+        for (std::size_t c = 0; c != num_consumers; ++c)
+        {
+            consumers.push_back(make_consumer(sched, s));
+        }
+
+        tt::sync_wait(ex::when_all_vector(std::move(consumers)));
+        consumers.clear();
+    }
+
+    double const elapsed = timer.elapsed();
+    double const time_per_fan_out = elapsed / static_cast<double>(iterations);
+
+    fmt::print(std::cout, "{},{},{},{:.3f},{:.3f}\n", pika::get_num_worker_threads(),
+        num_consumers, iterations, time_per_fan_out * 1e6,
+        time_per_fan_out / static_cast<double>(num_consumers) * 1e9);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int pika_main(variables_map& vm)
+{
+    std::size_t const max_consumers = vm["max-consumers"].as<std::size_t>();
+    std::uint64_t const iterations = vm["iterations"].as<std::uint64_t>();
+
+    if (!vm.count("no-header"))
+    {
+        std::cout << "threads,consumers,iterations,time per fan-out [us],time per consumer [ns]\n";
+    }
+
+    for (std::size_t num_consumers = 1; num_consumers <= max_consumers; num_consumers *= 2)
+    {
+        bench_fan_out(num_consumers, iterations);
+    }
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("max-consumers", value<std::size_t>()->default_value(1024),
+         "maximum number of consumers of the split sender")
+        ("iterations", value<std::uint64_t>()->default_value(1000),
+         "number of split senders to create for each number of consumers")
+        ("no-header", "do not print out the csv header row");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}
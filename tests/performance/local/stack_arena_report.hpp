@@ -0,0 +1,63 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+#pragma once
+
+#include <pika/config.hpp>
+#include <pika/runtime.hpp>
+
+#if defined(PIKA_HAVE_UNISTD_H)
+# include <unistd.h>
+#endif
+
+#if defined(_POSIX_VERSION)
+# include <pika/coroutines/detail/stack_arena.hpp>
+
+# include <sys/resource.h>
+#endif
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+// Returns the peak resident set size of the process in kilobytes, or 0 if it
+// can't be determined on this platform.
+inline std::uint64_t get_peak_resident_set_size()
+{
+#if defined(_POSIX_VERSION)
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+    {
+# if defined(__APPLE__)
+        // ru_maxrss is reported in bytes on macOS
+        return static_cast<std::uint64_t>(usage.ru_maxrss) / 1024;
+# else
+        return static_cast<std::uint64_t>(usage.ru_maxrss);
+# endif
+    }
+#endif
+    return 0;
+}
+
+// Prints whether coroutine stacks are allocated from stack arenas (enabled with
+// --pika:ini=pika.stacks.use_arena=1) and the arena statistics.
+inline void print_stack_arena_report(std::ostream& os, char const* prefix = "")
+{
+    bool const enabled = pika::get_config_entry("pika.stacks.use_arena", "0") != "0";
+    os << prefix << "stack arena: " << (enabled ? "enabled" : "disabled") << "\n";
+
+#if defined(_POSIX_VERSION)
+    if (enabled)
+    {
+        auto const stats = pika::threads::coroutines::detail::posix::get_stack_arena_statistics();
+        os << prefix << "stack arena: " << stats.arenas_mapped << " arenas, "
+           << stats.bytes_mapped / 1024 << " kB mapped, " << stats.stacks_carved
+           << " stacks carved, " << stats.shared_pool_hits << " shared pool hits\n";
+    }
+#endif
+
+    os << prefix << "peak resident set size: " << get_peak_resident_set_size() << " kB\n";
+}
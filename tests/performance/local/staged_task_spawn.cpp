@@ -0,0 +1,229 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark measures the cost of the task descriptions that the
+// schedulers allocate for staged tasks. The first part compares the slab pool
+// used by the thread queues with the internal_allocator previously used for
+// task descriptions, with one thread allocating task descriptions and
+// --threads threads freeing them, which is the pattern of one thread spawning
+// tasks that are converted to threads by all worker threads. The second part
+// measures the throughput of spawning staged tasks from a single pika thread,
+// one at a time or in batches, and reports the counters of the task
+// description pool.
+
+#include <pika/allocator_support/internal_allocator.hpp>
+#include <pika/init.hpp>
+#include <pika/latch.hpp>
+#include <pika/modules/timing.hpp>
+#include <pika/runtime.hpp>
+#include <pika/schedulers/thread_queue.hpp>
+#include <pika/threading_base/register_thread.hpp>
+#include <pika/threading_base/thread_init_data.hpp>
+
+#include <fmt/ostream.h>
+#include <fmt/printf.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+using pika::threads::detail::get_task_description_pool_statistics;
+using pika::threads::detail::make_thread_function_nullary;
+using pika::threads::detail::slab_pool_statistics;
+using pika::threads::detail::task_description;
+using pika::threads::detail::task_description_pool;
+using pika::threads::detail::thread_init_data;
+
+///////////////////////////////////////////////////////////////////////////////
+struct internal_allocator_policy
+{
+    static constexpr char const* name = "internal_allocator";
+    static pika::detail::internal_allocator<task_description> alloc;
+
+    static void* allocate() { return alloc.allocate(1); }
+    static void deallocate(void* p) { alloc.deallocate(static_cast<task_description*>(p), 1); }
+};
+
+pika::detail::internal_allocator<task_description> internal_allocator_policy::alloc;
+
+struct slab_pool_policy
+{
+    static constexpr char const* name = "slab_pool";
+
+    static void* allocate() { return task_description_pool::allocate(); }
+    static void deallocate(void* p) { task_description_pool::deallocate(p); }
+};
+
+template <typename Allocator>
+void bench_allocator(std::size_t num_threads, std::size_t count, std::uint64_t repetitions)
+{
+    std::vector<void*> blocks(count);
+    double allocate_time = 0.0;
+    double deallocate_time = 0.0;
+
+    // The allocating thread is not a worker thread so that the pool is
+    // exercised as by a thread spawning tasks from outside the runtime
+    std::thread producer([&]() {
+        for (std::uint64_t r = 0; r != repetitions + 1; ++r)
+        {
+            pika::chrono::detail::high_resolution_timer timer;
+            for (std::size_t i = 0; i != count; ++i)
+            {
+                blocks[i] = Allocator::allocate();
+            }
+            double const elapsed_allocate = timer.elapsed();
+
+            timer.restart();
+            std::vector<std::thread> consumers;
+            for (std::size_t t = 0; t != num_threads; ++t)
+            {
+                consumers.emplace_back([&, t]() {
+                    for (std::size_t i = t; i < count; i += num_threads)
+                    {
+                        Allocator::deallocate(blocks[i]);
+                    }
+                });
+            }
+            for (auto& consumer : consumers)
+            {
+                consumer.join();
+            }
+            double const elapsed_deallocate = timer.elapsed();
+
+            // The first run is a warmup
+            if (r != 0)
+            {
+                allocate_time += elapsed_allocate;
+                deallocate_time += elapsed_deallocate;
+            }
+        }
+    });
+    producer.join();
+
+    double const n = static_cast<double>(count * repetitions);
+    fmt::print(std::cout, "allocator,{},{},{},{:.2f},{:.2f}\n", Allocator::name, num_threads,
+        count, allocate_time / n * 1e9, deallocate_time / n * 1e9);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+thread_init_data make_task(pika::latch& l)
+{
+    return thread_init_data(
+        make_thread_function_nullary([&l]() { l.count_down(1); }), "staged_task_spawn");
+}
+
+void bench_spawn(std::size_t count, std::size_t batch_size, std::uint64_t repetitions)
+{
+    auto* pool = pika::threads::detail::get_self_or_default_pool();
+    slab_pool_statistics const before = get_task_description_pool_statistics();
+    double elapsed = 0.0;
+
+    for (std::uint64_t r = 0; r != repetitions + 1; ++r)
+    {
+        pika::latch l(static_cast<std::ptrdiff_t>(count + 1));
+        std::vector<thread_init_data> data;
+        data.reserve(batch_size);
+
+        pika::chrono::detail::high_resolution_timer timer;
+        for (std::size_t i = 0; i != count; ++i)
+        {
+            if (batch_size <= 1)
+            {
+                thread_init_data d = make_task(l);
+                pika::threads::detail::register_work(d, pool);
+                continue;
+            }
+
+            data.push_back(make_task(l));
+            if (data.size() == batch_size || i + 1 == count)
+            {
+                pika::threads::detail::register_work_batch(data.data(), data.size(), pool);
+                data.clear();
+            }
+        }
+        l.arrive_and_wait();
+
+        // The first run is a warmup
+        if (r != 0)
+        {
+            elapsed += timer.elapsed();
+        }
+    }
+
+    slab_pool_statistics const after = get_task_description_pool_statistics();
+    std::uint64_t const remote_frees = after.remote_frees - before.remote_frees;
+    std::uint64_t const remote_batches = after.remote_batches - before.remote_batches;
+
+    fmt::print(std::cout, "spawn,{},{},{},{:.0f},{},{},{},{},{:.1f}\n",
+        pika::get_num_worker_threads(), count, batch_size, count * repetitions / elapsed,
+        after.slabs - before.slabs, after.allocations - before.allocations,
+        after.local_frees - before.local_frees, remote_frees,
+        remote_batches == 0 ? 0.0 : static_cast<double>(remote_frees) / remote_batches);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int pika_main(variables_map& vm)
+{
+    std::size_t const count = vm["tasks"].as<std::size_t>();
+    std::uint64_t const repetitions = vm["repetitions"].as<std::uint64_t>();
+    std::size_t const num_threads = pika::get_num_worker_threads();
+
+    if (!vm.count("no-header"))
+    {
+        std::cout << "allocator,name,freeing threads,count,time per allocation [ns],time per "
+                     "deallocation [ns]\n";
+    }
+
+    bench_allocator<internal_allocator_policy>(num_threads, count, repetitions);
+    bench_allocator<slab_pool_policy>(num_threads, count, repetitions);
+
+    if (!vm.count("no-header"))
+    {
+        std::cout << "spawn,threads,tasks,batch size,tasks/s,slabs,allocations,local frees,"
+                     "remote frees,remote frees per batch\n";
+    }
+
+    std::vector<std::size_t> batch_sizes = {1, 64};
+    if (vm.count("batch-size"))
+    {
+        batch_sizes = {vm["batch-size"].as<std::size_t>()};
+    }
+
+    for (std::size_t const batch_size : batch_sizes)
+    {
+        bench_spawn(count, batch_size, repetitions);
+    }
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("tasks", value<std::size_t>()->default_value(100000),
+         "number of task descriptions allocated or tasks spawned per repetition")
+        ("repetitions", value<std::uint64_t>()->default_value(5),
+         "number of times each measurement is repeated")
+        ("batch-size", value<std::size_t>(),
+         "only spawn tasks in batches of the given size (1 spawns tasks one at a time)")
+        ("no-header", "do not print out the csv header rows");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}
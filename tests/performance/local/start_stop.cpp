@@ -6,6 +6,12 @@
 
 // This example benchmarks the time it takes to start and stop the pika runtime.
 // This is meant to be compared to resume_suspend and openmp_parallel_region.
+//
+// The hardware topology is discovered only once per process, when the pika
+// library is loaded. To show what a freshly started process pays for it, each
+// repetition constructs a topology before starting the runtime, once without
+// and once with a topology cache file (see PIKA_TOPOLOGY_CACHE), and the start
+// time includes the construction of that topology.
 
 #include <pika/chrono.hpp>
 #include <pika/future.hpp>
@@ -13,10 +19,15 @@
 #include <pika/program_options.hpp>
 #include <pika/testing/performance.hpp>
 #include <pika/thread.hpp>
+#include <pika/topology/topology.hpp>
 
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
+#include <filesystem>
 #include <iostream>
+#include <memory>
+#include <string>
 
 int pika_main()
 {
@@ -26,8 +37,17 @@ int pika_main()
 int main(int argc, char** argv)
 {
     pika::program_options::options_description desc_commandline;
-    desc_commandline.add_options()("repetitions",
-        pika::program_options::value<std::uint64_t>()->default_value(100), "Number of repetitions");
+    // clang-format off
+    desc_commandline.add_options()
+        ("repetitions",
+         pika::program_options::value<std::uint64_t>()->default_value(100),
+         "Number of repetitions")
+        ("topology-cache",
+         pika::program_options::value<std::string>()->default_value(
+             (std::filesystem::temp_directory_path() / "pika_start_stop_topology_cache")
+                 .string()),
+         "Topology cache file to use, it is overwritten");
+    // clang-format on
 
     pika::program_options::variables_map vm;
     pika::program_options::store(pika::program_options::command_line_parser(argc, argv)
@@ -37,6 +57,7 @@ int main(int argc, char** argv)
         vm);
 
     std::uint64_t repetitions = vm["repetitions"].as<std::uint64_t>();
+    std::string const cache_file = vm["topology-cache"].as<std::string>();
 
     pika::init_params init_args;
     init_args.desc_cmdline = desc_commandline;
@@ -45,36 +66,54 @@ int main(int argc, char** argv)
     std::uint64_t threads = pika::resource::get_num_threads("default");
     pika::stop();
 
-    std::cout << "threads, resume [s], apply [s], suspend [s]" << std::endl;
+    std::cout << "threads, topology cache, topology [s], resume [s], apply [s], suspend [s]"
+              << std::endl;
+
+    // The first cached repetition writes the cache file
+    std::remove(cache_file.c_str());
 
-    double start_time = 0;
-    double stop_time = 0;
+    double start_time[2] = {0, 0};
+    double stop_time[2] = {0, 0};
     pika::chrono::detail::high_resolution_timer timer;
 
     for (std::size_t i = 0; i < repetitions; ++i)
     {
-        timer.restart();
+        for (bool cached : {false, true})
+        {
+            timer.restart();
 
-        pika::init_params init_args;
-        init_args.desc_cmdline = desc_commandline;
+            auto topo = std::make_unique<pika::threads::detail::topology>(
+                cached ? cache_file : std::string());
+            auto t_topology = timer.elapsed();
 
-        pika::start(pika_main, argc, argv, init_args);
-        auto t_start = timer.elapsed();
-        start_time += t_start;
+            pika::init_params init_args;
+            init_args.desc_cmdline = desc_commandline;
 
-        for (std::size_t thread = 0; thread < threads; ++thread)
-        {
-            pika::apply([]() {});
-        }
+            pika::start(pika_main, argc, argv, init_args);
+            auto t_start = timer.elapsed();
+            start_time[cached] += t_start;
 
-        auto t_apply = timer.elapsed();
+            for (std::size_t thread = 0; thread < threads; ++thread)
+            {
+                pika::apply([]() {});
+            }
 
-        pika::stop();
-        auto t_stop = timer.elapsed();
-        stop_time += t_stop;
+            auto t_apply = timer.elapsed();
 
-        std::cout << threads << ", " << t_start << ", " << t_apply << ", " << t_stop << std::endl;
+            pika::stop();
+            auto t_stop = timer.elapsed();
+            stop_time[cached] += t_stop;
+
+            topo.reset();
+
+            std::cout << threads << ", " << (cached ? "yes" : "no") << ", " << t_topology << ", "
+                      << t_start << ", " << t_apply << ", " << t_stop << std::endl;
+        }
     }
-    pika::util::print_cdash_timing("StartTime", start_time);
-    pika::util::print_cdash_timing("StopTime", stop_time);
+    std::remove(cache_file.c_str());
+
+    pika::util::print_cdash_timing("StartTime", start_time[0]);
+    pika::util::print_cdash_timing("StopTime", stop_time[0]);
+    pika::util::print_cdash_timing("StartTimeTopologyCache", start_time[1]);
+    pika::util::print_cdash_timing("StopTimeTopologyCache", stop_time[1]);
 }
@@ -0,0 +1,116 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark measures the round-trip latency of
+// sync_wait(just() | transfer(sched)), i.e. the time it takes to schedule a
+// task on a worker thread and for the waiting thread to notice that the task
+// has completed. The round trips are made from the main thread, which is not a
+// pika thread, and from a pika thread running on the default thread pool. The
+// latencies are reported as percentiles.
+
+#include <pika/execution.hpp>
+#include <pika/init.hpp>
+#include <pika/runtime.hpp>
+
+#include <fmt/format.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+namespace ex = pika::execution::experimental;
+namespace tt = pika::this_thread::experimental;
+
+double percentile(std::vector<double> const& sorted, double p)
+{
+    std::size_t const index = static_cast<std::size_t>(p * double(sorted.size() - 1));
+    return sorted[index];
+}
+
+std::vector<double> round_trips(std::uint64_t iterations)
+{
+    auto sched = ex::thread_pool_scheduler{};
+
+    std::vector<double> latencies;
+    latencies.reserve(iterations);
+
+    for (std::uint64_t i = 0; i != iterations; ++i)
+    {
+        auto const start = std::chrono::steady_clock::now();
+        tt::sync_wait(ex::just() | ex::transfer(sched));
+        latencies.push_back(std::chrono::duration<double, std::micro>(
+            std::chrono::steady_clock::now() - start)
+                                .count());
+    }
+
+    std::sort(latencies.begin(), latencies.end());
+    return latencies;
+}
+
+void print_latencies(char const* waiter, std::vector<double> const& latencies)
+{
+    double mean = 0.0;
+    for (double l : latencies)
+    {
+        mean += l;
+    }
+    mean /= double(latencies.size());
+
+    fmt::print(std::cout,
+        "{}: round-trip latency [us]: mean {:.2f}, p50 {:.2f}, p90 {:.2f}, p99 {:.2f}, p99.9 "
+        "{:.2f}, max {:.2f}\n",
+        waiter, mean, percentile(latencies, 0.5), percentile(latencies, 0.9),
+        percentile(latencies, 0.99), percentile(latencies, 0.999), latencies.back());
+}
+
+int main(int argc, char* argv[])
+{
+    pika::program_options::options_description desc_commandline;
+    // clang-format off
+    desc_commandline.add_options()
+        ("iterations",
+            pika::program_options::value<std::uint64_t>()->default_value(100000),
+            "number of round trips to measure")
+        ("warmup-iterations",
+            pika::program_options::value<std::uint64_t>()->default_value(1000),
+            "number of round trips to make before measuring");
+    // clang-format on
+
+    pika::program_options::variables_map vm;
+    pika::program_options::store(pika::program_options::command_line_parser(argc, argv)
+                                     .allow_unregistered()
+                                     .options(desc_commandline)
+                                     .run(),
+        vm);
+
+    std::uint64_t const iterations = vm["iterations"].as<std::uint64_t>();
+    std::uint64_t const warmup_iterations = vm["warmup-iterations"].as<std::uint64_t>();
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = desc_commandline;
+
+    pika::start(nullptr, argc, argv, init_args);
+
+    fmt::print(std::cout, "threads: {}, iterations: {}\n", pika::get_num_worker_threads(),
+        iterations);
+
+    round_trips(warmup_iterations);
+    print_latencies("main thread", round_trips(iterations));
+
+    print_latencies("pika thread",
+        tt::sync_wait(ex::schedule(ex::thread_pool_scheduler{}) | ex::then([&] {
+            round_trips(warmup_iterations);
+            return round_trips(iterations);
+        })));
+
+    pika::finalize();
+    pika::stop();
+
+    return 0;
+}
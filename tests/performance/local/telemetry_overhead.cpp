@@ -0,0 +1,146 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark measures the overhead of the telemetry sampler on the
+// scheduling loop. It spawns a given number of empty tasks, first without a
+// sampler and then with a sampler for each of the given sampling intervals,
+// and reports the time per task. Without a sampler no telemetry code runs, so
+// the first row is also the cost of a runtime with telemetry disabled.
+
+#include <pika/execution.hpp>
+#include <pika/init.hpp>
+#include <pika/modules/timing.hpp>
+#include <pika/runtime.hpp>
+#include <pika/runtime/detail/telemetry.hpp>
+#include <pika/runtime/thread_pool_helpers.hpp>
+
+#include <fmt/ostream.h>
+#include <fmt/printf.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace ex = pika::execution::experimental;
+namespace tt = pika::this_thread::experimental;
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+///////////////////////////////////////////////////////////////////////////////
+auto make_task(ex::thread_pool_scheduler sched)
+{
+    return ex::schedule(sched) | ex::then([] {});
+}
+
+double spawn_tasks(std::uint64_t num_tasks)
+{
+    ex::thread_pool_scheduler sched{};
+    pika::chrono::detail::high_resolution_timer timer;
+
+    std::vector<decltype(make_task(sched))> tasks;
+    tasks.reserve(num_tasks);
+    for (std::uint64_t i = 0; i != num_tasks; ++i)
+    {
+        tasks.push_back(make_task(sched));
+    }
+    tt::sync_wait(ex::when_all_vector(std::move(tasks)));
+
+    return timer.elapsed();
+}
+
+void bench(std::uint64_t num_tasks, int repetitions, std::string const& interval,
+    std::unique_ptr<pika::detail::telemetry_sampler> sampler)
+{
+    double best = 0.0;
+    for (int i = 0; i != repetitions; ++i)
+    {
+        double const elapsed = spawn_tasks(num_tasks);
+        if (i == 0 || elapsed < best)
+        {
+            best = elapsed;
+        }
+    }
+
+    std::uint64_t samples = 0;
+    std::uint64_t dropped = 0;
+    if (sampler)
+    {
+        sampler->stop();
+        samples = sampler->get_sample_count();
+        dropped = sampler->get_dropped_sample_count();
+    }
+
+    fmt::print(std::cout, "{},{},{},{:.3f},{},{}\n", pika::get_num_worker_threads(), interval,
+        num_tasks, best / static_cast<double>(num_tasks) * 1e9, samples, dropped);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int pika_main(variables_map& vm)
+{
+    std::uint64_t const num_tasks = vm["tasks"].as<std::uint64_t>();
+    int const repetitions = vm["repetitions"].as<int>();
+
+    pika::detail::telemetry_params params;
+    params.destination = vm["destination"].as<std::string>();
+    if (vm["format"].as<std::string>() == "binary")
+    {
+        params.format = pika::detail::telemetry_format::binary;
+    }
+
+    std::vector<pika::threads::detail::thread_pool_base*> pools;
+    for (std::size_t i = 0; i != pika::resource::get_num_thread_pools(); ++i)
+    {
+        pools.push_back(&pika::resource::get_thread_pool(i));
+    }
+
+    if (!vm.count("no-header"))
+    {
+        std::cout << "threads,sampling interval [ms],tasks,time per task [ns],samples,dropped "
+                     "samples\n";
+    }
+
+    bench(num_tasks, repetitions, "off", nullptr);
+    for (std::int64_t interval : vm["intervals"].as<std::vector<std::int64_t>>())
+    {
+        params.interval = std::chrono::milliseconds(interval);
+        bench(num_tasks, repetitions, std::to_string(interval),
+            std::make_unique<pika::detail::telemetry_sampler>(pools, params));
+    }
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("tasks", value<std::uint64_t>()->default_value(100000),
+         "number of tasks to spawn per repetition")
+        ("repetitions", value<int>()->default_value(5),
+         "number of repetitions, the fastest one is reported")
+        ("intervals", value<std::vector<std::int64_t>>()->multitoken()->default_value(
+             std::vector<std::int64_t>{100, 10, 1}, "100 10 1"),
+         "sampling intervals in milliseconds to benchmark")
+        ("destination", value<std::string>()->default_value("/dev/null"),
+         "file or unix:<path> socket to write the samples to")
+        ("format", value<std::string>()->default_value("csv"),
+         "format of the samples (csv or binary)")
+        ("no-header", "do not print out the csv header row");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}
@@ -0,0 +1,214 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark starts a large number of schedule_at operations on a
+// thread_pool_scheduler so that millions of timers are outstanding at the
+// same time. With --mode=fire the deadlines are spread evenly over an
+// interval and the benchmark reports the rate at which timers are scheduled
+// and completed, as well as how late the operations complete compared to
+// their deadline. With --mode=cancel all timers have a deadline far in the
+// future and are cancelled through a single stop request, and the benchmark
+// reports the rate at which timers are scheduled and cancelled.
+
+#include <pika/execution.hpp>
+#include <pika/init.hpp>
+#include <pika/latch.hpp>
+#include <pika/modules/timing.hpp>
+#include <pika/runtime.hpp>
+#include <pika/stop_token.hpp>
+#include <pika/type_support/detail/with_result_of.hpp>
+
+#include <fmt/ostream.h>
+#include <fmt/printf.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ex = pika::execution::experimental;
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+using clock_type = std::chrono::steady_clock;
+
+///////////////////////////////////////////////////////////////////////////////
+struct stop_token_env
+{
+    pika::stop_token stop_token;
+
+    friend pika::stop_token tag_invoke(ex::get_stop_token_t, stop_token_env const& e) noexcept
+    {
+        return e.stop_token;
+    }
+};
+
+struct timer_receiver
+{
+    using is_receiver = void;
+
+    clock_type::time_point deadline;
+    double* lateness;
+    std::atomic<std::size_t>* stopped;
+    pika::latch* latch;
+    pika::stop_token stop_token;
+
+    friend void tag_invoke(ex::set_value_t, timer_receiver&& r) noexcept
+    {
+        *r.lateness =
+            std::chrono::duration<double, std::micro>(clock_type::now() - r.deadline).count();
+        r.latch->count_down(1);
+    }
+
+    friend void tag_invoke(ex::set_stopped_t, timer_receiver&& r) noexcept
+    {
+        ++*r.stopped;
+        r.latch->count_down(1);
+    }
+
+    friend void tag_invoke(ex::set_error_t, timer_receiver&&, std::exception_ptr) noexcept
+    {
+        std::terminate();
+    }
+
+    friend stop_token_env tag_invoke(ex::get_env_t, timer_receiver const& r) noexcept
+    {
+        return {r.stop_token};
+    }
+};
+
+using operation_state_type = decltype(ex::connect(
+    ex::schedule_at(std::declval<ex::thread_pool_scheduler&>(), clock_type::now()),
+    std::declval<timer_receiver>()));
+
+double percentile(std::vector<double> const& sorted, double p)
+{
+    return sorted[std::min(
+        sorted.size() - 1, static_cast<std::size_t>(p * static_cast<double>(sorted.size())))];
+}
+
+void bench(std::string const& mode, std::size_t num_timers, std::chrono::milliseconds delay,
+    std::chrono::milliseconds spread)
+{
+    bool const cancel = mode == "cancel";
+    ex::thread_pool_scheduler sched{};
+
+    std::vector<std::optional<operation_state_type>> op_states(num_timers);
+    std::vector<double> lateness(num_timers, 0.0);
+    std::atomic<std::size_t> stopped{0};
+    pika::latch l(static_cast<std::ptrdiff_t>(num_timers + 1));
+    pika::stop_source ss;
+
+    clock_type::time_point const first_deadline =
+        clock_type::now() + (cancel ? std::chrono::hours(1) : delay);
+    pika::chrono::detail::high_resolution_timer timer;
+
+    for (std::size_t i = 0; i != num_timers; ++i)
+    {
+        clock_type::time_point const deadline = first_deadline + spread * i / num_timers;
+        op_states[i].emplace(pika::detail::with_result_of([&]() {
+            return ex::connect(ex::schedule_at(sched, deadline),
+                timer_receiver{deadline, &lateness[i], &stopped, &l, ss.get_token()});
+        }));
+        ex::start(*op_states[i]);
+    }
+    double const schedule_time = timer.elapsed();
+
+    timer.restart();
+    if (cancel)
+    {
+        ss.request_stop();
+    }
+    l.arrive_and_wait();
+    double const completion_time = timer.elapsed();
+
+    if (cancel && stopped != num_timers)
+    {
+        std::cerr << "only " << stopped << " of " << num_timers << " timers were cancelled\n";
+        std::terminate();
+    }
+
+    std::sort(lateness.begin(), lateness.end());
+    double mean = 0.0;
+    for (double t : lateness)
+    {
+        mean += t;
+    }
+    mean /= static_cast<double>(num_timers);
+
+    fmt::print(std::cout,
+        "{},{},{},{},{},{:.3f},{:.0f},{:.3f},{:.0f},{:.1f},{:.1f},{:.1f},{:.1f}\n", mode,
+        pika::get_num_worker_threads(), num_timers, delay.count(), spread.count(), schedule_time,
+        static_cast<double>(num_timers) / schedule_time, completion_time,
+        static_cast<double>(num_timers) / completion_time, mean, percentile(lateness, 0.5),
+        percentile(lateness, 0.99), lateness.back());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int pika_main(variables_map& vm)
+{
+    std::size_t const num_timers = vm["timers"].as<std::size_t>();
+    std::chrono::milliseconds const delay(vm["delay"].as<std::uint64_t>());
+    std::chrono::milliseconds const spread(vm["spread"].as<std::uint64_t>());
+    std::uint64_t const repetitions = vm["repetitions"].as<std::uint64_t>();
+
+    std::vector<std::string> modes = {"fire", "cancel"};
+    if (vm.count("mode"))
+    {
+        modes = {vm["mode"].as<std::string>()};
+    }
+
+    if (!vm.count("no-header"))
+    {
+        std::cout << "mode,threads,timers,delay [ms],spread [ms],schedule time [s],schedule rate "
+                     "[1/s],completion time [s],completion rate [1/s],mean lateness [us],median "
+                     "lateness [us],p99 lateness [us],max lateness [us]\n";
+    }
+
+    for (std::string const& mode : modes)
+    {
+        for (std::uint64_t r = 0; r != repetitions; ++r)
+        {
+            bench(mode, num_timers, delay, spread);
+        }
+    }
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("timers", value<std::size_t>()->default_value(1000000),
+         "number of outstanding timers")
+        ("delay", value<std::uint64_t>()->default_value(1000),
+         "time in milliseconds from starting the first timer until the first deadline")
+        ("spread", value<std::uint64_t>()->default_value(1000),
+         "interval in milliseconds over which the deadlines of the timers are spread")
+        ("mode", value<std::string>(),
+         "only run the given mode (fire or cancel)")
+        ("repetitions", value<std::uint64_t>()->default_value(3),
+         "number of times each measurement is repeated")
+        ("no-header", "do not print out the csv header row");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}
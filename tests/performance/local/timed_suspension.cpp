@@ -0,0 +1,166 @@
+//  Copyright (c) 2023 ETH Zurich
+//
+//  SPDX-License-Identifier: BSL-1.0
+//  Distributed under the Boost Software License, Version 1.0. (See accompanying
+//  file LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+
+// This benchmark spawns a large number of tasks that all sleep concurrently
+// until a deadline and reports the CPU time used by the process while the
+// tasks sleep, as well as how late the tasks wake up compared to their
+// deadline. The deadlines are spread evenly over an interval after all tasks
+// have been spawned. With --mode=suspend the tasks use
+// pika::this_thread::sleep_until, which suspends them until the timer wheel
+// of the thread pool resumes them. With --mode=yield the tasks yield in a loop
+// until the deadline has passed, which is how sleeping was implemented before
+// the timer wheel.
+
+#include <pika/execution.hpp>
+#include <pika/init.hpp>
+#include <pika/latch.hpp>
+#include <pika/modules/timing.hpp>
+#include <pika/runtime.hpp>
+#include <pika/thread.hpp>
+
+#include <fmt/ostream.h>
+#include <fmt/printf.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace ex = pika::execution::experimental;
+
+using pika::program_options::options_description;
+using pika::program_options::value;
+using pika::program_options::variables_map;
+
+using clock_type = std::chrono::steady_clock;
+
+///////////////////////////////////////////////////////////////////////////////
+void sleep_until(clock_type::time_point deadline, bool suspend)
+{
+    if (suspend)
+    {
+        pika::this_thread::sleep_until(deadline);
+        return;
+    }
+
+    do
+    {
+        pika::this_thread::yield();
+    } while (clock_type::now() < deadline);
+}
+
+double percentile(std::vector<double> const& sorted, double p)
+{
+    return sorted[std::min(
+        sorted.size() - 1, static_cast<std::size_t>(p * static_cast<double>(sorted.size())))];
+}
+
+void bench(std::string const& mode, std::size_t num_tasks, std::chrono::milliseconds delay,
+    std::chrono::milliseconds spread)
+{
+    bool const suspend = mode == "suspend";
+    ex::thread_pool_scheduler sched{};
+
+    // Lateness of every task in microseconds
+    std::vector<double> lateness(num_tasks);
+    pika::latch l(static_cast<std::ptrdiff_t>(num_tasks + 1));
+
+    clock_type::time_point const first_deadline = clock_type::now() + delay;
+    std::clock_t const cpu_start = std::clock();
+    pika::chrono::detail::high_resolution_timer timer;
+
+    for (std::size_t i = 0; i != num_tasks; ++i)
+    {
+        clock_type::time_point const deadline = first_deadline + spread * i / num_tasks;
+        ex::start_detached(ex::schedule(sched) | ex::then([&, i, deadline]() {
+            sleep_until(deadline, suspend);
+            lateness[i] =
+                std::chrono::duration<double, std::micro>(clock_type::now() - deadline).count();
+            l.count_down(1);
+        }));
+    }
+    double const spawn_time = timer.elapsed();
+
+    l.arrive_and_wait();
+    double const elapsed = timer.elapsed();
+    double const cpu_time = static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+
+    std::sort(lateness.begin(), lateness.end());
+    double mean = 0.0;
+    for (double t : lateness)
+    {
+        mean += t;
+    }
+    mean /= static_cast<double>(num_tasks);
+
+    std::size_t const num_threads = pika::get_num_worker_threads();
+    fmt::print(std::cout,
+        "{},{},{},{},{},{:.3f},{:.3f},{:.3f},{:.1f},{:.1f},{:.1f},{:.1f},{:.1f}\n", mode,
+        num_threads, num_tasks, delay.count(), spread.count(), spawn_time, elapsed, cpu_time,
+        100.0 * cpu_time / (elapsed * static_cast<double>(num_threads)), mean,
+        percentile(lateness, 0.5), percentile(lateness, 0.99), lateness.back());
+}
+
+///////////////////////////////////////////////////////////////////////////////
+int pika_main(variables_map& vm)
+{
+    std::size_t const num_tasks = vm["tasks"].as<std::size_t>();
+    std::chrono::milliseconds const delay(vm["delay"].as<std::uint64_t>());
+    std::chrono::milliseconds const spread(vm["spread"].as<std::uint64_t>());
+    std::uint64_t const repetitions = vm["repetitions"].as<std::uint64_t>();
+
+    std::vector<std::string> modes = {"suspend", "yield"};
+    if (vm.count("mode"))
+    {
+        modes = {vm["mode"].as<std::string>()};
+    }
+
+    if (!vm.count("no-header"))
+    {
+        std::cout << "mode,threads,tasks,delay [ms],spread [ms],spawn time [s],time [s],cpu time "
+                     "[s],cpu use [%],mean lateness [us],median lateness [us],p99 lateness "
+                     "[us],max lateness [us]\n";
+    }
+
+    for (std::string const& mode : modes)
+    {
+        for (std::uint64_t r = 0; r != repetitions; ++r)
+        {
+            bench(mode, num_tasks, delay, spread);
+        }
+    }
+
+    return pika::finalize();
+}
+
+int main(int argc, char* argv[])
+{
+    options_description cmdline("usage: " PIKA_APPLICATION_STRING " [options]");
+
+    // clang-format off
+    cmdline.add_options()
+        ("tasks", value<std::size_t>()->default_value(100000),
+         "number of concurrently sleeping tasks")
+        ("delay", value<std::uint64_t>()->default_value(500),
+         "time in milliseconds from spawning the first task until the first deadline")
+        ("spread", value<std::uint64_t>()->default_value(500),
+         "interval in milliseconds over which the deadlines of the tasks are spread")
+        ("mode", value<std::string>(),
+         "only run the given mode (suspend or yield)")
+        ("repetitions", value<std::uint64_t>()->default_value(3),
+         "number of times each measurement is repeated")
+        ("no-header", "do not print out the csv header row");
+    // clang-format on
+
+    pika::init_params init_args;
+    init_args.desc_cmdline = cmdline;
+
+    return pika::init(pika_main, argc, argv, init_args);
+}